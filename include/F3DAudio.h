@@ -229,6 +229,22 @@ struct F3DAUDIO_DSP_SETTINGS
 	float ListenerVelocityComponent;
 };
 
+/* See "extensions/F3DAudioBatchEXT.txt" for more details. */
+typedef struct F3DAUDIO_EMITTER_BATCH_EXT
+{
+	const F3DAUDIO_EMITTER *pTemplate;
+	uint32_t EmitterCount;
+	const float *pPositionX;
+	const float *pPositionY;
+	const float *pPositionZ;
+	const float *pVelocityX;	/* Optional */
+	const float *pVelocityY;	/* Optional */
+	const float *pVelocityZ;	/* Optional */
+	const float *pOrientFrontX;	/* Optional */
+	const float *pOrientFrontY;	/* Optional */
+	const float *pOrientFrontZ;	/* Optional */
+} F3DAUDIO_EMITTER_BATCH_EXT;
+
 #pragma pack(pop)
 
 /* Functions */
@@ -253,6 +269,15 @@ F3DAUDIOAPI void F3DAudioCalculate(
 	F3DAUDIO_DSP_SETTINGS *pDSPSettings
 );
 
+/* See "extensions/F3DAudioBatchEXT.txt" for more details. */
+F3DAUDIOAPI void F3DAudioCalculateBatchEXT(
+	const F3DAUDIO_HANDLE Instance,
+	const F3DAUDIO_LISTENER *pListener,
+	const F3DAUDIO_EMITTER_BATCH_EXT *pEmitters,
+	uint32_t Flags,
+	F3DAUDIO_DSP_SETTINGS *pDSPSettings
+);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -365,6 +365,40 @@ struct FACTNotification
 
 #pragma pack(pop)
 
+/* See "extensions/CueCommandsEXT.txt" for more details. */
+
+typedef enum FACTCueCommandTypeEXT
+{
+	FACTCUECOMMAND_SETVARIABLE_EXT,
+	FACTCUECOMMAND_SETMATRIX_EXT,
+	FACTCUECOMMAND_PLAY_EXT,
+	FACTCUECOMMAND_STOP_EXT
+} FACTCueCommandTypeEXT;
+
+typedef struct FACTCueCommandEXT
+{
+	FACTCue *pCue;
+	FACTCueCommandTypeEXT type;
+	FAUDIONAMELESS union
+	{
+		struct
+		{
+			uint16_t nIndex;
+			float nValue;
+		} variable;
+		struct
+		{
+			uint32_t uSrcChannelCount;
+			uint32_t uDstChannelCount;
+			const float *pMatrixCoefficients;
+		} matrix;
+		struct
+		{
+			uint32_t dwFlags;
+		} stop;
+	};
+} FACTCueCommandEXT;
+
 /* Constants */
 
 #define FACT_CONTENT_VERSION 46
@@ -500,6 +534,13 @@ FACTAPI uint32_t FACTAudioEngine_Initialize(
 	const FACTRuntimeParameters *pParams
 );
 
+/* See "extensions/BinaryCacheEXT.txt" for more details. */
+FACTAPI uint32_t FACTAudioEngine_SerializeEXT(
+	FACTAudioEngine *pEngine,
+	void *pBuffer,
+	uint32_t *pdwSize
+);
+
 FACTAPI uint32_t FACTAudioEngine_ShutDown(FACTAudioEngine *pEngine);
 
 FACTAPI uint32_t FACTAudioEngine_DoWork(FACTAudioEngine *pEngine);
@@ -573,6 +614,9 @@ FACTAPI uint32_t FACTAudioEngine_UnRegisterNotification(
 	const FACTNotificationDescription *pNotificationDescription
 );
 
+/* See "extensions/NotificationFDEXT.txt" for more details. */
+FACTAPI int32_t FACTAudioEngine_GetNotificationFDEXT(FACTAudioEngine *pEngine);
+
 FACTAPI uint16_t FACTAudioEngine_GetCategory(
 	FACTAudioEngine *pEngine,
 	const char *szFriendlyName
@@ -613,6 +657,21 @@ FACTAPI uint32_t FACTAudioEngine_GetGlobalVariable(
 	float *pnValue
 );
 
+/* See "extensions/CueCommandsEXT.txt" for more details. */
+FACTAPI uint32_t FACTAudioEngine_SubmitCueCommandsEXT(
+	FACTAudioEngine *pEngine,
+	const FACTCueCommandEXT *pCommands,
+	uint32_t commandCount
+);
+
+/* See "extensions/VirtualVoiceEXT.txt" for more details. */
+FACTAPI uint32_t FACTAudioEngine_SetVirtualVoiceParametersEXT(
+	FACTAudioEngine *pEngine,
+	int32_t fEnable,
+	uint32_t maxRealVoices,
+	float silenceThreshold
+);
+
 /* SoundBank Interface */
 
 FACTAPI uint16_t FACTSoundBank_GetCueIndex(
@@ -669,6 +728,13 @@ FACTAPI uint32_t FACTSoundBank_Stop(
 
 FACTAPI uint32_t FACTSoundBank_Destroy(FACTSoundBank *pSoundBank);
 
+/* See "extensions/BinaryCacheEXT.txt" for more details. */
+FACTAPI uint32_t FACTSoundBank_SerializeEXT(
+	FACTSoundBank *pSoundBank,
+	void *pBuffer,
+	uint32_t *pdwSize
+);
+
 FACTAPI uint32_t FACTSoundBank_GetState(
 	FACTSoundBank *pSoundBank,
 	uint32_t *pdwState
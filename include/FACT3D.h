@@ -99,6 +99,16 @@ static const float a7Point1Layout[] =
 	RIGHT_AZIMUTH
 };
 
+/* Types */
+
+/* See "extensions/FACT3DBatchEXT.txt" for more details. */
+typedef struct FACT3DCueEmitterEXT
+{
+	FACTCue *pCue;
+	F3DAUDIO_EMITTER *pEmitter;
+	F3DAUDIO_DSP_SETTINGS *pDSPSettings;
+} FACT3DCueEmitterEXT;
+
 /* Functions */
 
 FACTAPI uint32_t FACT3DInitialize(
@@ -118,6 +128,15 @@ FACTAPI uint32_t FACT3DApply(
 	FACTCue *pCue
 );
 
+/* See "extensions/FACT3DBatchEXT.txt" for more details. */
+FACTAPI uint32_t FACT3DCalculateApplyBatchEXT(
+	FACTAudioEngine *pEngine,
+	F3DAUDIO_HANDLE F3DInstance,
+	const F3DAUDIO_LISTENER *pListener,
+	FACT3DCueEmitterEXT *pCueEmitters,
+	uint32_t cueEmitterCount
+);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
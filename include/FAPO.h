@@ -106,6 +106,12 @@ typedef struct FAPOProcessBufferParameters
 #define FAPO_FLAG_INPLACE_REQUIRED		0x00000020
 #define FAPO_FLAG_INPLACE_SUPPORTED		0x00000010
 
+/* See "extensions/OverwritesOutputEXT.txt" for more details. */
+#define FAPO_FLAG_OVERWRITES_OUTPUT_EXT		0x00010000
+
+/* See "extensions/SilenceStaysSilentEXT.txt" for more details. */
+#define FAPO_FLAG_SILENCE_STAYS_SILENT_EXT	0x00020000
+
 /* FAPO Interface */
 
 #ifndef FAPO_DECL
@@ -255,6 +255,33 @@ FAPOAPI uint8_t* FAPOBase_BeginProcess(FAPOBase *fapo);
 
 FAPOAPI void FAPOBase_EndProcess(FAPOBase *fapo);
 
+/* See "extensions/ParameterRampEXT.txt" for more details. */
+
+typedef struct FAPOParameterRampEXT
+{
+	float Current;
+	float Target;
+	float Step;
+	uint32_t FramesLeft;
+} FAPOParameterRampEXT;
+
+FAPOAPI void FAPOParameterRamp_ResetEXT(
+	FAPOParameterRampEXT *pRamp,
+	float Value
+);
+
+FAPOAPI void FAPOParameterRamp_SetTargetEXT(
+	FAPOParameterRampEXT *pRamp,
+	float Target,
+	uint32_t FrameCount
+);
+
+FAPOAPI void FAPOParameterRamp_FillEXT(
+	FAPOParameterRampEXT *pRamp,
+	float *pValues,
+	uint32_t FrameCount
+);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
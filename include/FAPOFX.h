@@ -43,6 +43,9 @@ extern const FAudioGUID FAPOFX_CLSID_FXMasteringLimiter, FAPOFX_CLSID_FXMasterin
 extern const FAudioGUID FAPOFX_CLSID_FXReverb, FAPOFX_CLSID_FXReverb_LEGACY;
 extern const FAudioGUID FAPOFX_CLSID_FXEcho, FAPOFX_CLSID_FXEcho_LEGACY;
 
+/* See "extensions/ReverbLowCPUEXT.txt" for more details. */
+extern const FAudioGUID FAPOFX_CLSID_FXReverbLowCPUEXT;
+
 /* Structures */
 
 #pragma pack(push, 1)
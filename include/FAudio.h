@@ -1276,6 +1276,21 @@ FAUDIOAPI void FAudio_SetEngineProcedureEXT(
 	void *user
 );
 
+/* FAudio Fade Volume API
+ * See "extensions/FadeVolumeEXT.txt" for more information.
+ */
+
+FAUDIOAPI uint32_t FAudioVoice_SetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float Volume,
+	uint32_t FadeMilliseconds,
+	uint32_t OperationSet
+);
+FAUDIOAPI void FAudioVoice_GetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float *pVolume
+);
+
 
 /* FAudio I/O API */
 
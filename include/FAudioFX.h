@@ -45,6 +45,9 @@ extern "C" {
 extern const FAudioGUID FAudioFX_CLSID_AudioVolumeMeter;
 extern const FAudioGUID FAudioFX_CLSID_AudioReverb;
 
+/* See "extensions/ConvolutionReverbEXT.txt" for more details. */
+extern const FAudioGUID FAudioFX_CLSID_ConvolutionReverbEXT;
+
 /* Structures */
 
 #pragma pack(push, 1)
@@ -126,8 +129,33 @@ typedef struct FAudioFXReverbI3DL2Parameters
 	float HFReference;
 } FAudioFXReverbI3DL2Parameters;
 
+/* See "extensions/ConvolutionReverbEXT.txt" for more details. */
+typedef struct FAudioFXConvolutionReverbParametersEXT
+{
+	float WetDryMix;	/* 0 - 100 */
+	float Gain;		/* Linear, applied to the wet signal */
+} FAudioFXConvolutionReverbParametersEXT;
+
 #pragma pack(pop)
 
+/* See "extensions/ConvolutionReverbEXT.txt" for more details. */
+typedef struct FAudioFXImpulseResponseEXT
+{
+	const float *pSamples;	/* Interleaved, at the effect's sample rate */
+	uint32_t ChannelCount;	/* 1, or the effect's channel count */
+	uint32_t FrameCount;
+	uint32_t PartitionMode;
+	uint32_t WorkerCount;	/* 0 processes everything in Process */
+} FAudioFXImpulseResponseEXT;
+
+/* See "extensions/VolumeMeterHistoryEXT.txt" for more details. */
+typedef struct FAudioFXVolumeMeterHistoryEXT
+{
+	uint32_t ChannelCount;	/* Must match the effect's channel count */
+	uint32_t HistoryLength;	/* Entries kept, at least 2 */
+	uint32_t Decimation;	/* Process calls per entry, at least 1 */
+} FAudioFXVolumeMeterHistoryEXT;
+
 /* Constants */
 
 #define FAUDIOFX_DEBUG 1
@@ -199,6 +227,13 @@ typedef struct FAudioFXReverbI3DL2Parameters
 #define FAUDIOFX_REVERB_DEFAULT_DENSITY			100.0f
 #define FAUDIOFX_REVERB_DEFAULT_ROOM_SIZE		100.0f
 
+/* See "extensions/ConvolutionReverbEXT.txt" for more details. */
+#define FAUDIOFX_CONVOLUTION_PARTITION_UNIFORM_EXT	0
+#define FAUDIOFX_CONVOLUTION_PARTITION_NONUNIFORM_EXT	1
+#define FAUDIOFX_CONVOLUTION_MAX_WORKERS_EXT		8
+#define FAUDIOFX_CONVOLUTION_DEFAULT_WET_DRY_MIX_EXT	100.0f
+#define FAUDIOFX_CONVOLUTION_DEFAULT_GAIN_EXT		1.0f
+
 #define FAUDIOFX_I3DL2_PRESET_DEFAULT \
 	{100,-10000,    0,0.0f, 1.00f,0.50f,-10000,0.020f,-10000,0.040f,100.0f,100.0f,5000.0f}
 #define FAUDIOFX_I3DL2_PRESET_GENERIC \
@@ -289,6 +324,49 @@ FAUDIOAPI uint32_t FAudioCreateReverb9WithCustomAllocatorEXT(
 	FAudioReallocFunc customRealloc
 );
 
+/* See "extensions/ConvolutionReverbEXT.txt" for more details. */
+FAUDIOAPI uint32_t FAudioCreateConvolutionReverbEXT(
+	FAPO** ppApo,
+	const FAudioFXImpulseResponseEXT *pImpulseResponse,
+	uint32_t Flags
+);
+FAUDIOAPI uint32_t FAudioCreateConvolutionReverbWithCustomAllocatorEXT(
+	FAPO** ppApo,
+	const FAudioFXImpulseResponseEXT *pImpulseResponse,
+	uint32_t Flags,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc
+);
+
+/* See "extensions/VolumeMeterHistoryEXT.txt" for more details. */
+FAUDIOAPI uint32_t FAudioCreateVolumeMeterWithHistoryEXT(
+	FAPO** ppApo,
+	const FAudioFXVolumeMeterHistoryEXT *pHistory,
+	uint32_t Flags
+);
+FAUDIOAPI uint32_t FAudioCreateVolumeMeterWithHistoryAndCustomAllocatorEXT(
+	FAPO** ppApo,
+	const FAudioFXVolumeMeterHistoryEXT *pHistory,
+	uint32_t Flags,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc
+);
+FAUDIOAPI uint32_t FAudioFXVolumeMeter_GetHistoryEXT(
+	FAPO *pVolumeMeter,
+	float *pPeakLevels,
+	float *pRMSLevels,
+	uint32_t EntryCount,
+	uint32_t *pTotalEntries
+);
+
+/* See "extensions/ParameterRampEXT.txt" for more details. */
+FAUDIOAPI void FAudioFXReverb_SetParameterRampEXT(
+	FAPO *pReverb,
+	uint32_t FrameCount
+);
+
 FAUDIOAPI void ReverbConvertI3DL2ToNative(
 	const FAudioFXReverbI3DL2Parameters *pI3DL2,
 	FAudioFXReverbParameters *pNative
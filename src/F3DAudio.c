@@ -450,30 +450,86 @@ F3DAUDIOAPI uint8_t F3DAudioCheckCalculateParams(
  * MATRIX CALCULATION
  */
 
+/* Curves are stored as a list of points, so finding the segment for a distance
+ * means walking the list. When the same curve is used for a lot of emitters
+ * (see F3DAudioCalculateBatchEXT), we first split the curve's [0, 1] range
+ * into CURVE_TABLE_SIZE buckets and store where the walk ends for the start of
+ * each bucket. Lookups then start from there instead of from the first point.
+ * The walk itself is unchanged, so the results are identical either way.
+ */
+#define CURVE_TABLE_SIZE 64 /* Power of 2, so the bucket math is exact */
+
+typedef struct CurveTable
+{
+	F3DAUDIO_DISTANCE_CURVE *pCurve;
+	uint8_t hasBuckets;
+	uint32_t firstPoint[CURVE_TABLE_SIZE];
+} CurveTable;
+
+static inline void InitCurveTable(
+	CurveTable *table,
+	F3DAUDIO_DISTANCE_CURVE *pCurve,
+	uint8_t buildBuckets
+) {
+	F3DAUDIO_DISTANCE_CURVE_POINT *points;
+	uint32_t i, b;
+	float bucketStart;
+
+	table->pCurve = pCurve;
+	table->hasBuckets = buildBuckets && (pCurve != NULL);
+	if (!table->hasBuckets)
+	{
+		return;
+	}
+
+	points = pCurve->pPoints;
+	for (b = 0, i = 1; b < CURVE_TABLE_SIZE; b += 1)
+	{
+		/* Same condition as the walk in ComputeDistanceAttenuation */
+		bucketStart = (float) b / CURVE_TABLE_SIZE;
+		while (i < pCurve->PointCount && bucketStart >= points[i].Distance)
+		{
+			i += 1;
+		}
+		table->firstPoint[b] = i;
+	}
+}
+
 /* This function computes the distance either according to a curve if pCurve
  * isn't NULL, or according to the inverse distance law 1/d otherwise.
  */
 static inline float ComputeDistanceAttenuation(
 	float normalizedDistance,
-	F3DAUDIO_DISTANCE_CURVE *pCurve
+	const CurveTable *table
 ) {
 	float res;
 	float alpha;
 	uint32_t n_points;
 	size_t i;
-	if (pCurve)
+	if (table->pCurve)
 	{
-		F3DAUDIO_DISTANCE_CURVE_POINT* points = pCurve->pPoints;
-		n_points = pCurve->PointCount;
+		F3DAUDIO_DISTANCE_CURVE_POINT* points = table->pCurve->pPoints;
+		n_points = table->pCurve->PointCount;
 
 		/* By definition, the first point in the curve must be 0.0f
 		 * -Adrien
 		 */
 
+		/* Skip ahead if we can, see CurveTable */
+		i = 1;
+		if (table->hasBuckets && normalizedDistance >= 0.0f)
+		{
+			i = table->firstPoint[
+				(normalizedDistance < 1.0f) ?
+					(uint32_t) (normalizedDistance * CURVE_TABLE_SIZE) :
+					(CURVE_TABLE_SIZE - 1)
+			];
+		}
+
 		/* We advance i up until our normalizedDistance lies between the distances of
 		 * the i_th and (i-1)_th points, or we reach the last point.
 		 */
-		for (i = 1; (i < n_points) && (normalizedDistance >= points[i].Distance); i += 1);
+		for (; (i < n_points) && (normalizedDistance >= points[i].Distance); i += 1);
 		if (i == n_points)
 		{
 			/* We've reached the last point, so we use its value directly.
@@ -503,6 +559,83 @@ static inline float ComputeDistanceAttenuation(
 	return res;
 }
 
+#define DEFAULT_POINTS(name, x1, y1, x2, y2) \
+	static F3DAUDIO_DISTANCE_CURVE_POINT name##Points[2] = \
+	{ \
+		{ x1, y1 }, \
+		{ x2, y2 } \
+	}; \
+	static F3DAUDIO_DISTANCE_CURVE name##Default = \
+	{ \
+		(F3DAUDIO_DISTANCE_CURVE_POINT*) &name##Points[0], 2 \
+	};
+DEFAULT_POINTS(lpfDirect, 0.0f, 1.0f, 1.0f, 0.75f)
+DEFAULT_POINTS(lpfReverb, 0.0f, 0.75f, 1.0f, 0.75f)
+DEFAULT_POINTS(reverb, 0.0f, 1.0f, 1.0f, 0.0f)
+#undef DEFAULT_POINTS
+
+/* All the curves an emitter needs, with the defaults filled in */
+typedef struct EmitterCurves
+{
+	CurveTable volume;
+	CurveTable LFE;
+	CurveTable LPFDirect;
+	CurveTable LPFReverb;
+	CurveTable reverb;
+} EmitterCurves;
+
+static inline void InitEmitterCurves(
+	EmitterCurves *curves,
+	const F3DAUDIO_EMITTER *pEmitter,
+	uint32_t Flags,
+	uint8_t buildBuckets
+) {
+	if (Flags & F3DAUDIO_CALCULATE_MATRIX)
+	{
+		InitCurveTable(
+			&curves->volume,
+			pEmitter->pVolumeCurve,
+			buildBuckets
+		);
+		/* TODO: this could be skipped if the destination has no LFE */
+		InitCurveTable(
+			&curves->LFE,
+			pEmitter->pLFECurve,
+			buildBuckets
+		);
+	}
+	if (Flags & F3DAUDIO_CALCULATE_LPF_DIRECT)
+	{
+		InitCurveTable(
+			&curves->LPFDirect,
+			(pEmitter->pLPFDirectCurve != NULL) ?
+				pEmitter->pLPFDirectCurve :
+				&lpfDirectDefault,
+			buildBuckets
+		);
+	}
+	if (Flags & F3DAUDIO_CALCULATE_LPF_REVERB)
+	{
+		InitCurveTable(
+			&curves->LPFReverb,
+			(pEmitter->pLPFReverbCurve != NULL) ?
+				pEmitter->pLPFReverbCurve :
+				&lpfReverbDefault,
+			buildBuckets
+		);
+	}
+	if (Flags & F3DAUDIO_CALCULATE_REVERB)
+	{
+		InitCurveTable(
+			&curves->reverb,
+			(pEmitter->pReverbCurve != NULL) ?
+				pEmitter->pReverbCurve :
+				&reverbDefault,
+			buildBuckets
+		);
+	}
+}
+
 static inline float ComputeConeParameter(
 	float distance,
 	float angle,
@@ -606,6 +739,13 @@ typedef struct
 	uint32_t matrixIdx;
 } SpeakerInfo;
 
+/* Every speaker azimuth is a multiple of PI/8, so which pair of speakers an
+ * emitter lies between only depends on which of the 16 PI/8-wide sectors its
+ * azimuth falls in. Each configuration has a sector table that gives the index
+ * of the first speaker of that pair, see FindSpeakerAzimuths.
+ */
+#define AZIMUTH_SECTOR_COUNT 16
+
 typedef struct
 {
 	uint32_t configMask;
@@ -618,6 +758,8 @@ typedef struct
 	uint32_t numNonLFSpeakers;
 
 	int32_t LFSpeakerIdx;
+
+	const uint8_t *sectorSpeakers;
 } ConfigInfo;
 
 /* It is absolutely necessary that these are stored in increasing, *positive*
@@ -709,6 +851,65 @@ const SpeakerInfo k7Point1SurroundConfigSpeakers[] =
 	{ SPEAKER_AZIMUTH_FRONT_LEFT,	0 },
 };
 
+/* Start of each sector. These have to be the exact same float values as the
+ * speaker azimuths above, so use the same expressions where there's a speaker.
+ */
+static const float kSectorAzimuths[AZIMUTH_SECTOR_COUNT] =
+{
+	SPEAKER_AZIMUTH_CENTER,
+	SPEAKER_AZIMUTH_FRONT_RIGHT_OF_CENTER,
+	SPEAKER_AZIMUTH_FRONT_RIGHT,
+	F3DAUDIO_PI *  3.0f / 8.0f,
+	SPEAKER_AZIMUTH_SIDE_RIGHT,
+	F3DAUDIO_PI *  5.0f / 8.0f,
+	SPEAKER_AZIMUTH_BACK_RIGHT,
+	F3DAUDIO_PI *  7.0f / 8.0f,
+	SPEAKER_AZIMUTH_BACK_CENTER,
+	F3DAUDIO_PI *  9.0f / 8.0f,
+	SPEAKER_AZIMUTH_BACK_LEFT,
+	F3DAUDIO_PI * 11.0f / 8.0f,
+	SPEAKER_AZIMUTH_SIDE_LEFT,
+	F3DAUDIO_PI * 13.0f / 8.0f,
+	SPEAKER_AZIMUTH_FRONT_LEFT,
+	SPEAKER_AZIMUTH_FRONT_LEFT_OF_CENTER
+};
+
+/* For each sector, the index into the config's speakers of the speaker at or
+ * before the sector start. The pair is that speaker and the next one.
+ */
+static const uint8_t kMonoConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+static const uint8_t kStereoConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1
+};
+static const uint8_t kSurroundConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 3, 3
+};
+static const uint8_t kQuadConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	3, 3, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3
+};
+static const uint8_t k5Point1ConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4
+};
+static const uint8_t k7Point1ConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 6
+};
+static const uint8_t k5Point1SurroundConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 4, 4
+};
+static const uint8_t k7Point1SurroundConfigSectors[AZIMUTH_SECTOR_COUNT] =
+{
+	0, 0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 5, 5, 6, 6
+};
+
 /* With that organization, the index of the LF speaker into the matrix array
  * strangely looks *exactly* like the mystery field in the F3DAUDIO_HANDLE!!
  * We're keeping a separate field within ConfigInfo because it makes the code
@@ -717,16 +918,16 @@ const SpeakerInfo k7Point1SurroundConfigSpeakers[] =
  */
 const ConfigInfo kSpeakersConfigInfo[] =
 {
-	{ SPEAKER_MONO,			kMonoConfigSpeakers,		ARRAY_COUNT(kMonoConfigSpeakers),		-1 },
-	{ SPEAKER_STEREO,		kStereoConfigSpeakers,		ARRAY_COUNT(kStereoConfigSpeakers),		-1 },
-	{ SPEAKER_2POINT1,		k2Point1ConfigSpeakers,		ARRAY_COUNT(k2Point1ConfigSpeakers),		 2 },
-	{ SPEAKER_SURROUND,		kSurroundConfigSpeakers,	ARRAY_COUNT(kSurroundConfigSpeakers),		-1 },
-	{ SPEAKER_QUAD,			kQuadConfigSpeakers,		ARRAY_COUNT(kQuadConfigSpeakers),		-1 },
-	{ SPEAKER_4POINT1,		k4Point1ConfigSpeakers,		ARRAY_COUNT(k4Point1ConfigSpeakers),		 2 },
-	{ SPEAKER_5POINT1,		k5Point1ConfigSpeakers,		ARRAY_COUNT(k5Point1ConfigSpeakers),		 3 },
-	{ SPEAKER_7POINT1,		k7Point1ConfigSpeakers,		ARRAY_COUNT(k7Point1ConfigSpeakers),		 3 },
-	{ SPEAKER_5POINT1_SURROUND,	k5Point1SurroundConfigSpeakers,	ARRAY_COUNT(k5Point1SurroundConfigSpeakers),	 3 },
-	{ SPEAKER_7POINT1_SURROUND,	k7Point1SurroundConfigSpeakers,	ARRAY_COUNT(k7Point1SurroundConfigSpeakers),	 3 },
+	{ SPEAKER_MONO,			kMonoConfigSpeakers,		ARRAY_COUNT(kMonoConfigSpeakers),		-1,	kMonoConfigSectors },
+	{ SPEAKER_STEREO,		kStereoConfigSpeakers,		ARRAY_COUNT(kStereoConfigSpeakers),		-1,	kStereoConfigSectors },
+	{ SPEAKER_2POINT1,		k2Point1ConfigSpeakers,		ARRAY_COUNT(k2Point1ConfigSpeakers),		 2,	kStereoConfigSectors },
+	{ SPEAKER_SURROUND,		kSurroundConfigSpeakers,	ARRAY_COUNT(kSurroundConfigSpeakers),		-1,	kSurroundConfigSectors },
+	{ SPEAKER_QUAD,			kQuadConfigSpeakers,		ARRAY_COUNT(kQuadConfigSpeakers),		-1,	kQuadConfigSectors },
+	{ SPEAKER_4POINT1,		k4Point1ConfigSpeakers,		ARRAY_COUNT(k4Point1ConfigSpeakers),		 2,	kQuadConfigSectors },
+	{ SPEAKER_5POINT1,		k5Point1ConfigSpeakers,		ARRAY_COUNT(k5Point1ConfigSpeakers),		 3,	k5Point1ConfigSectors },
+	{ SPEAKER_7POINT1,		k7Point1ConfigSpeakers,		ARRAY_COUNT(k7Point1ConfigSpeakers),		 3,	k7Point1ConfigSectors },
+	{ SPEAKER_5POINT1_SURROUND,	k5Point1SurroundConfigSpeakers,	ARRAY_COUNT(k5Point1SurroundConfigSpeakers),	 3,	k5Point1SurroundConfigSectors },
+	{ SPEAKER_7POINT1_SURROUND,	k7Point1SurroundConfigSpeakers,	ARRAY_COUNT(k7Point1SurroundConfigSpeakers),	 3,	k7Point1SurroundConfigSectors },
 };
 
 /* A simple linear search is absolutely OK for 10 elements. */
@@ -755,48 +956,53 @@ static inline void FindSpeakerAzimuths(
 	uint8_t skipCenter,
 	const SpeakerInfo **speakerInfo
 ) {
-	uint32_t i, nexti = 0;
-	float a0 = 0.0f, a1 = 0.0f;
+	uint32_t i, nexti, sector;
+	float a0, a1;
 
 	FAudio_assert(config != NULL);
 
 	/* We want to find, given an azimuth, which speakers are the closest
-	 * ones (in terms of angle) to that azimuth.
-	 * This is done by iterating through the list of speaker azimuths, as
-	 * given to us by the current ConfigInfo (which stores speaker azimuths
-	 * in increasing order of azimuth for each possible speaker configuration;
-	 * each speaker azimuth is defined to be between 0 and 2PI by construction).
+	 * ones (in terms of angle) to that azimuth. The pair only changes at
+	 * PI/8 boundaries, so we look it up by sector (see ConfigInfo). The
+	 * multiply can land one sector off right at a boundary, so the
+	 * compares against the real sector starts settle it; an azimuth equal
+	 * to a speaker's belongs to the pair that starts with that speaker.
 	 */
-	for (i = 0; i < config->numNonLFSpeakers; i += 1)
+	if (emitterAzimuth <= 0.0f)
 	{
-		/* a0 and a1 are the azimuths of candidate speakers */
-		a0 = config->speakers[i].azimuth;
-		nexti = (i + 1) % config->numNonLFSpeakers;
-		a1 = config->speakers[nexti].azimuth;
-
-		if (a0 < a1)
-		{
-			if (emitterAzimuth >= a0 && emitterAzimuth < a1)
-			{
-				break;
-			}
-		}
-		/* It is possible for a speaker pair to enclose the singulary at 0 == 2PI:
-		 * consider for example the quad config, which has a front left speaker
-		 * at 7PI/4 and a front right speaker at PI/4. In that case a0 = 7PI/4 and
-		 * a1 = PI/4, and the way we know whether our current azimuth lies between
-		 * that pair is by checking whether the azimuth is greather than 7PI/4 or
-		 * whether it's less than PI/4. (By contract, currentAzimuth is always less
-		 * than 2PI.)
-		 */
-		else
-		{
-			if (emitterAzimuth >= a0 || emitterAzimuth < a1)
-			{
-				break;
-			}
-		}
+		sector = 0;
+	}
+	else if (emitterAzimuth >= F3DAUDIO_2PI)
+	{
+		sector = AZIMUTH_SECTOR_COUNT - 1;
+	}
+	else
+	{
+		sector = FAudio_min(
+			(uint32_t) (emitterAzimuth * (8.0f / F3DAUDIO_PI)),
+			AZIMUTH_SECTOR_COUNT - 1
+		);
+	}
+	while (	sector < (AZIMUTH_SECTOR_COUNT - 1) &&
+		emitterAzimuth >= kSectorAzimuths[sector + 1]	)
+	{
+		sector += 1;
 	}
+	while (sector > 0 && emitterAzimuth < kSectorAzimuths[sector])
+	{
+		sector -= 1;
+	}
+
+	/* a0 and a1 are the azimuths of the two speakers. It is possible
+	 * for a pair to enclose the singularity at 0 == 2PI: consider for
+	 * example the quad config, which has a front left speaker at 7PI/4
+	 * and a front right speaker at PI/4. In that case a0 = 7PI/4 and
+	 * a1 = PI/4.
+	 */
+	i = config->sectorSpeakers[sector];
+	nexti = (i + 1) % config->numNonLFSpeakers;
+	a0 = config->speakers[i].azimuth;
+	a1 = config->speakers[nexti].azimuth;
 	FAudio_assert(emitterAzimuth >= a0 || emitterAzimuth < a1);
 
 	/* skipCenter means that we don't want to use the center speaker.
@@ -1139,6 +1345,31 @@ static inline void ComputeEmitterChannelCoefficients(
 	}
 }
 
+/* Everything the matrix calculation needs that only depends on the listener
+ * and the output format. F3DAudioCalculateBatchEXT builds this once and reuses
+ * it for every emitter in the batch.
+ */
+typedef struct ListenerState
+{
+	const F3DAUDIO_LISTENER *pListener;
+	const ConfigInfo *config;
+	F3DAUDIO_BASIS basis;
+} ListenerState;
+
+static inline void InitListenerState(
+	ListenerState *state,
+	uint32_t ChannelMask,
+	const F3DAUDIO_LISTENER *pListener
+) {
+	state->pListener = pListener;
+	state->config = GetConfigInfo(ChannelMask);
+
+	/* Remember here that the coordinate system is Left-Handed. */
+	state->basis.front = pListener->OrientFront;
+	state->basis.right = VectorCross(pListener->OrientTop, pListener->OrientFront);
+	state->basis.top = pListener->OrientTop;
+}
+
 /* Calculations consist of several orthogonal steps that compose multiplicatively:
  *
  * First, we compute the attenuations (volume and LFE) due to distance, which
@@ -1177,35 +1408,37 @@ static inline void ComputeEmitterChannelCoefficients(
  * -Adrien
  */
 static inline void CalculateMatrix(
-	uint32_t ChannelMask,
+	const ListenerState *listener,
 	uint32_t Flags,
-	const F3DAUDIO_LISTENER *pListener,
 	const F3DAUDIO_EMITTER *pEmitter,
+	const EmitterCurves *curves,
 	uint32_t SrcChannelCount,
 	uint32_t DstChannelCount,
 	F3DAUDIO_VECTOR emitterToListener,
 	float eToLDistance,
 	float normalizedDistance,
+	float listenerFrontDot,
+	float emitterFrontDot,
 	float* MatrixCoefficients
 ) {
 	uint32_t iEC;
 	float curEmAzimuth;
-	const ConfigInfo* curConfig = GetConfigInfo(ChannelMask);
+	const F3DAUDIO_LISTENER *pListener = listener->pListener;
+	const ConfigInfo* curConfig = listener->config;
 	float attenuation = ComputeDistanceAttenuation(
 		normalizedDistance,
-		pEmitter->pVolumeCurve
+		&curves->volume
 	);
-	/* TODO: this could be skipped if the destination has no LFE */
 	float LFEattenuation = ComputeDistanceAttenuation(
 		normalizedDistance,
-		pEmitter->pLFECurve
+		&curves->LFE
 	);
 
 	F3DAUDIO_VECTOR listenerToEmitter;
 	F3DAUDIO_VECTOR listenerToEmChannel;
-	F3DAUDIO_BASIS listenerBasis;
 
-	/* Note: For both cone calculations, the angle might be NaN or infinite
+	/* Note: For both cone calculations, the dot products are the cosines
+	 * of the angles, already divided by eToLDistance. They are meaningless
 	 * if distance == 0... ComputeConeParameter *does* check for this
 	 * special case. It is necessary that we still go through the
 	 * ComputeConeParameter function, because omnidirectional cones might
@@ -1218,10 +1451,7 @@ static inline void CalculateMatrix(
 		 * this case
 		 * -Adrien
 		 */
-		const float angle = -FAudio_acosf(
-			VectorDot(pListener->OrientFront, emitterToListener) /
-			eToLDistance
-		);
+		const float angle = -FAudio_acosf(listenerFrontDot);
 
 		const float listenerConeParam = ComputeConeParameter(
 			eToLDistance,
@@ -1238,10 +1468,7 @@ static inline void CalculateMatrix(
 	/* See note above. */
 	if (pEmitter->pCone && pEmitter->ChannelCount == 1)
 	{
-		const float angle = FAudio_acosf(
-			VectorDot(pEmitter->OrientFront, emitterToListener) /
-			eToLDistance
-		);
+		const float angle = FAudio_acosf(emitterFrontDot);
 
 		const float emitterConeParam = ComputeConeParameter(
 			eToLDistance,
@@ -1278,12 +1505,6 @@ static inline void CalculateMatrix(
 	{
 		listenerToEmitter = VectorScale(emitterToListener, -1.0f);
 
-		/* Remember here that the coordinate system is Left-Handed. */
-		listenerBasis.front = pListener->OrientFront;
-		listenerBasis.right = VectorCross(pListener->OrientTop, pListener->OrientFront);
-		listenerBasis.top = pListener->OrientTop;
-
-
 		/* Handling the mono-channel emitter case separately is easier
 		 * than having it as a separate case of a for-loop; indeed, in
 		 * this case, we need to ignore the non-relevant values from the
@@ -1295,7 +1516,7 @@ static inline void CalculateMatrix(
 
 			ComputeEmitterChannelCoefficients(
 				curConfig,
-				&listenerBasis,
+				&listener->basis,
 				pEmitter->InnerRadius,
 				listenerToEmChannel,
 				attenuation,
@@ -1338,7 +1559,7 @@ static inline void CalculateMatrix(
 
 					ComputeEmitterChannelCoefficients(
 						curConfig,
-						&listenerBasis,
+						&listener->basis,
 						pEmitter->InnerRadius,
 						listenerToEmChannel,
 						attenuation,
@@ -1370,13 +1591,13 @@ static inline void CalculateMatrix(
  * Adapted from algorithm published as a part of the webaudio specification:
  * https://dvcs.w3.org/hg/audio/raw-file/tip/webaudio/specification.html#Spatialization-doppler-shift
  * -Chad
+ *
+ * The velocity components come in already projected onto emitterToListener
+ * (see ProjectOntoDirection) and are clamped in place.
  */
 static inline void CalculateDoppler(
 	float SpeedOfSound,
-	const F3DAUDIO_LISTENER* pListener,
-	const F3DAUDIO_EMITTER* pEmitter,
-	F3DAUDIO_VECTOR emitterToListener,
-	float eToLDistance,
+	float DopplerScaler,
 	float* listenerVelocityComponent,
 	float* emitterVelocityComponent,
 	float* DopplerFactor
@@ -1384,23 +1605,9 @@ static inline void CalculateDoppler(
 	float scaledSpeedOfSound;
 	*DopplerFactor = 1.0f;
 
-	/* Project... */
-	if (eToLDistance != 0.0f)
-	{
-		*listenerVelocityComponent =
-			VectorDot(emitterToListener, pListener->Velocity) / eToLDistance;
-		*emitterVelocityComponent =
-			VectorDot(emitterToListener, pEmitter->Velocity) / eToLDistance;
-	}
-	else
-	{
-		*listenerVelocityComponent = 0.0f;
-		*emitterVelocityComponent = 0.0f;
-	}
-
-	if (pEmitter->DopplerScaler > 0.0f)
+	if (DopplerScaler > 0.0f)
 	{
-		scaledSpeedOfSound = SpeedOfSound / pEmitter->DopplerScaler;
+		scaledSpeedOfSound = SpeedOfSound / DopplerScaler;
 
 		/* Clamp... */
 		*listenerVelocityComponent = FAudio_min(
@@ -1414,9 +1621,9 @@ static inline void CalculateDoppler(
 
 		/* ... then Multiply. */
 		*DopplerFactor = (
-			SpeedOfSound - pEmitter->DopplerScaler * *listenerVelocityComponent
+			SpeedOfSound - DopplerScaler * *listenerVelocityComponent
 		) / (
-			SpeedOfSound - pEmitter->DopplerScaler * *emitterVelocityComponent
+			SpeedOfSound - DopplerScaler * *emitterVelocityComponent
 		);
 		if (isnan(*DopplerFactor)) /* If emitter/listener are at the same pos... */
 		{
@@ -1432,54 +1639,64 @@ static inline void CalculateDoppler(
 	}
 }
 
-void F3DAudioCalculate(
+/* Projects v onto the normalized emitterToListener vector. If the emitter is
+ * exactly on the listener there is no direction, so the projection is 0.
+ */
+static inline float ProjectOntoDirection(
+	F3DAUDIO_VECTOR emitterToListener,
+	float eToLDistance,
+	F3DAUDIO_VECTOR v
+) {
+	if (eToLDistance != 0.0f)
+	{
+		return VectorDot(emitterToListener, v) / eToLDistance;
+	}
+	return 0.0f;
+}
+
+/*
+ * PUTTING IT TOGETHER
+ */
+
+/* Everything after the distance and the projections onto emitterToListener.
+ * F3DAudioCalculate and F3DAudioCalculateBatchEXT only differ in how they get
+ * those, so the results are identical for the same emitter.
+ *
+ * The dot products are only read when the flags/cones ask for them:
+ * listenerFrontDot for the listener cone, emitterFrontDot for the emitter cone
+ * and EMITTER_ANGLE, and the velocity components for DOPPLER.
+ */
+static inline void CalculateEmitter(
 	const F3DAUDIO_HANDLE Instance,
-	const F3DAUDIO_LISTENER *pListener,
+	const ListenerState *listener,
 	const F3DAUDIO_EMITTER *pEmitter,
+	const EmitterCurves *curves,
 	uint32_t Flags,
+	F3DAUDIO_VECTOR emitterToListener,
+	float eToLDistance,
+	float normalizedDistance,
+	float listenerFrontDot,
+	float emitterFrontDot,
+	float listenerVelocityComponent,
+	float emitterVelocityComponent,
 	F3DAUDIO_DSP_SETTINGS *pDSPSettings
 ) {
 	uint32_t i;
-	F3DAUDIO_VECTOR emitterToListener;
-	float eToLDistance, normalizedDistance, dp;
-
-	#define DEFAULT_POINTS(name, x1, y1, x2, y2) \
-		static F3DAUDIO_DISTANCE_CURVE_POINT name##Points[2] = \
-		{ \
-			{ x1, y1 }, \
-			{ x2, y2 } \
-		}; \
-		static F3DAUDIO_DISTANCE_CURVE name##Default = \
-		{ \
-			(F3DAUDIO_DISTANCE_CURVE_POINT*) &name##Points[0], 2 \
-		};
-	DEFAULT_POINTS(lpfDirect, 0.0f, 1.0f, 1.0f, 0.75f)
-	DEFAULT_POINTS(lpfReverb, 0.0f, 0.75f, 1.0f, 0.75f)
-	DEFAULT_POINTS(reverb, 0.0f, 1.0f, 1.0f, 0.0f)
-	#undef DEFAULT_POINTS
-
-	/* For XACT, this calculates "Distance" */
-	emitterToListener = VectorSub(pListener->Position, pEmitter->Position);
-	eToLDistance = VectorLength(emitterToListener);
-	pDSPSettings->EmitterToListenerDistance = eToLDistance;
-
-	F3DAudioCheckCalculateParams(Instance, pListener, pEmitter, Flags, pDSPSettings);
-
-	/* This is used by MATRIX, LPF, and REVERB */
-	normalizedDistance = eToLDistance / pEmitter->CurveDistanceScaler;
 
 	if (Flags & F3DAUDIO_CALCULATE_MATRIX)
 	{
 		CalculateMatrix(
-			SPEAKERMASK(Instance),
+			listener,
 			Flags,
-			pListener,
 			pEmitter,
+			curves,
 			pDSPSettings->SrcChannelCount,
 			pDSPSettings->DstChannelCount,
 			emitterToListener,
 			eToLDistance,
 			normalizedDistance,
+			listenerFrontDot,
+			emitterFrontDot,
 			pDSPSettings->pMatrixCoefficients
 		);
 	}
@@ -1488,9 +1705,7 @@ void F3DAudioCalculate(
 	{
 		pDSPSettings->LPFDirectCoefficient = ComputeDistanceAttenuation(
 			normalizedDistance,
-			(pEmitter->pLPFDirectCurve != NULL) ?
-				pEmitter->pLPFDirectCurve :
-				&lpfDirectDefault
+			&curves->LPFDirect
 		);
 	}
 
@@ -1498,9 +1713,7 @@ void F3DAudioCalculate(
 	{
 		pDSPSettings->LPFReverbCoefficient = ComputeDistanceAttenuation(
 			normalizedDistance,
-			(pEmitter->pLPFReverbCurve != NULL) ?
-				pEmitter->pLPFReverbCurve :
-				&lpfReverbDefault
+			&curves->LPFReverb
 		);
 	}
 
@@ -1508,21 +1721,18 @@ void F3DAudioCalculate(
 	{
 		pDSPSettings->ReverbLevel = ComputeDistanceAttenuation(
 			normalizedDistance,
-			(pEmitter->pReverbCurve != NULL) ?
-				pEmitter->pReverbCurve :
-				&reverbDefault
+			&curves->reverb
 		);
 	}
 
 	/* For XACT, this calculates "DopplerPitchScalar" */
 	if (Flags & F3DAUDIO_CALCULATE_DOPPLER)
 	{
+		pDSPSettings->ListenerVelocityComponent = listenerVelocityComponent;
+		pDSPSettings->EmitterVelocityComponent = emitterVelocityComponent;
 		CalculateDoppler(
 			SPEEDOFSOUND(Instance),
-			pListener,
-			pEmitter,
-			emitterToListener,
-			eToLDistance,
+			pEmitter->DopplerScaler,
 			&pDSPSettings->ListenerVelocityComponent,
 			&pDSPSettings->EmitterVelocityComponent,
 			&pDSPSettings->DopplerFactor
@@ -1543,8 +1753,7 @@ void F3DAudioCalculate(
 		else
 		{
 			/* Note: pEmitter->OrientFront is normalized. */
-			dp = VectorDot(emitterToListener, pEmitter->OrientFront) / eToLDistance;
-			pDSPSettings->EmitterToListenerAngle = FAudio_acosf(dp);
+			pDSPSettings->EmitterToListenerAngle = FAudio_acosf(emitterFrontDot);
 		}
 	}
 
@@ -1560,4 +1769,366 @@ void F3DAudioCalculate(
 	}
 }
 
+void F3DAudioCalculate(
+	const F3DAUDIO_HANDLE Instance,
+	const F3DAUDIO_LISTENER *pListener,
+	const F3DAUDIO_EMITTER *pEmitter,
+	uint32_t Flags,
+	F3DAUDIO_DSP_SETTINGS *pDSPSettings
+) {
+	ListenerState listener;
+	EmitterCurves curves;
+	F3DAUDIO_VECTOR emitterToListener;
+	float eToLDistance;
+
+	/* For XACT, this calculates "Distance" */
+	emitterToListener = VectorSub(pListener->Position, pEmitter->Position);
+	eToLDistance = VectorLength(emitterToListener);
+	pDSPSettings->EmitterToListenerDistance = eToLDistance;
+
+	F3DAudioCheckCalculateParams(Instance, pListener, pEmitter, Flags, pDSPSettings);
+
+	/* A single lookup per curve isn't worth building the buckets */
+	InitListenerState(&listener, SPEAKERMASK(Instance), pListener);
+	InitEmitterCurves(&curves, pEmitter, Flags, 0);
+	CalculateEmitter(
+		Instance,
+		&listener,
+		pEmitter,
+		&curves,
+		Flags,
+		emitterToListener,
+		eToLDistance,
+		/* This is used by MATRIX, LPF, and REVERB */
+		eToLDistance / pEmitter->CurveDistanceScaler,
+		ProjectOntoDirection(
+			emitterToListener,
+			eToLDistance,
+			pListener->OrientFront
+		),
+		ProjectOntoDirection(
+			emitterToListener,
+			eToLDistance,
+			pEmitter->OrientFront
+		),
+		ProjectOntoDirection(
+			emitterToListener,
+			eToLDistance,
+			pListener->Velocity
+		),
+		ProjectOntoDirection(
+			emitterToListener,
+			eToLDistance,
+			pEmitter->Velocity
+		),
+		pDSPSettings
+	);
+}
+
+/*
+ * BATCHED CALCULATION
+ */
+
+/* Emitters are processed in blocks of this many, so the structure-of-arrays
+ * scratch space fits on the stack and stays in L1.
+ */
+#define BATCH_BLOCK_SIZE 64
+
+/* ProjectOntoDirection for a whole block. If x is NULL, v is used for every
+ * emitter, otherwise v comes from the x/y/z arrays.
+ */
+static inline void ProjectBlockOntoDirection(
+	const float *restrict toListenerX,
+	const float *restrict toListenerY,
+	const float *restrict toListenerZ,
+	const float *restrict distance,
+	const float *restrict x,
+	const float *restrict y,
+	const float *restrict z,
+	F3DAUDIO_VECTOR v,
+	float *restrict result,
+	uint32_t count
+) {
+	uint32_t i;
+	float dot;
+
+	if (x == NULL)
+	{
+		for (i = 0; i < count; i += 1)
+		{
+			dot = (	(toListenerX[i] * v.x) +
+				(toListenerY[i] * v.y) +
+				(toListenerZ[i] * v.z)	);
+			result[i] = (distance[i] != 0.0f) ? (dot / distance[i]) : 0.0f;
+		}
+	}
+	else
+	{
+		for (i = 0; i < count; i += 1)
+		{
+			dot = (	(toListenerX[i] * x[i]) +
+				(toListenerY[i] * y[i]) +
+				(toListenerZ[i] * z[i])	);
+			result[i] = (distance[i] != 0.0f) ? (dot / distance[i]) : 0.0f;
+		}
+	}
+}
+
+F3DAUDIOAPI void F3DAudioCalculateBatchEXT(
+	const F3DAUDIO_HANDLE Instance,
+	const F3DAUDIO_LISTENER *pListener,
+	const F3DAUDIO_EMITTER_BATCH_EXT *pEmitters,
+	uint32_t Flags,
+	F3DAUDIO_DSP_SETTINGS *pDSPSettings
+) {
+	ListenerState listener;
+	EmitterCurves curves;
+	F3DAUDIO_EMITTER emitter;
+	F3DAUDIO_DSP_SETTINGS *settings;
+	F3DAUDIO_VECTOR templateTop;
+	uint32_t base, count, i, j;
+	uint8_t needListenerFront, needEmitterFront, needVelocity;
+	float topDot, topLength;
+	float toListenerX[BATCH_BLOCK_SIZE];
+	float toListenerY[BATCH_BLOCK_SIZE];
+	float toListenerZ[BATCH_BLOCK_SIZE];
+	float distance[BATCH_BLOCK_SIZE];
+	float normalizedDistance[BATCH_BLOCK_SIZE];
+	float listenerFrontDot[BATCH_BLOCK_SIZE];
+	float emitterFrontDot[BATCH_BLOCK_SIZE];
+	float listenerVelocity[BATCH_BLOCK_SIZE];
+	float emitterVelocity[BATCH_BLOCK_SIZE];
+
+	POINTER_CHECK(pEmitters);
+	POINTER_CHECK(pEmitters->pTemplate);
+	POINTER_CHECK(pEmitters->pPositionX);
+	POINTER_CHECK(pEmitters->pPositionY);
+	POINTER_CHECK(pEmitters->pPositionZ);
+	POINTER_CHECK(pDSPSettings);
+	if (pEmitters->EmitterCount == 0)
+	{
+		return;
+	}
+
+	/* Everything but the per-emitter vectors comes from the template, so
+	 * the curves are shared by the whole batch. They are rebuilt on every
+	 * call, so changes to the template's curves are always picked up.
+	 */
+	emitter = *pEmitters->pTemplate;
+	templateTop = emitter.OrientTop;
+	InitListenerState(&listener, SPEAKERMASK(Instance), pListener);
+	InitEmitterCurves(&curves, &emitter, Flags, 1);
+
+	needListenerFront = (
+		(Flags & F3DAUDIO_CALCULATE_MATRIX) &&
+		pListener->pCone != NULL
+	);
+	needEmitterFront = (
+		(	(Flags & F3DAUDIO_CALCULATE_MATRIX) &&
+			emitter.pCone != NULL &&
+			emitter.ChannelCount == 1	) ||
+		(Flags & F3DAUDIO_CALCULATE_EMITTER_ANGLE)
+	);
+	needVelocity = (Flags & F3DAUDIO_CALCULATE_DOPPLER) != 0;
+
+	for (base = 0; base < pEmitters->EmitterCount; base += count)
+	{
+		count = FAudio_min(
+			pEmitters->EmitterCount - base,
+			BATCH_BLOCK_SIZE
+		);
+
+		/* Structure-of-arrays pass: distances and projections */
+
+		FAudio_INTERNAL_EmitterDistances(
+			pEmitters->pPositionX + base,
+			pEmitters->pPositionY + base,
+			pEmitters->pPositionZ + base,
+			pListener->Position.x,
+			pListener->Position.y,
+			pListener->Position.z,
+			toListenerX,
+			toListenerY,
+			toListenerZ,
+			distance,
+			count
+		);
+
+		for (i = 0; i < count; i += 1)
+		{
+			normalizedDistance[i] = (
+				distance[i] / emitter.CurveDistanceScaler
+			);
+		}
+
+		if (needListenerFront)
+		{
+			ProjectBlockOntoDirection(
+				toListenerX,
+				toListenerY,
+				toListenerZ,
+				distance,
+				NULL,
+				NULL,
+				NULL,
+				pListener->OrientFront,
+				listenerFrontDot,
+				count
+			);
+		}
+		if (needEmitterFront)
+		{
+			ProjectBlockOntoDirection(
+				toListenerX,
+				toListenerY,
+				toListenerZ,
+				distance,
+				pEmitters->pOrientFrontX ? pEmitters->pOrientFrontX + base : NULL,
+				pEmitters->pOrientFrontY ? pEmitters->pOrientFrontY + base : NULL,
+				pEmitters->pOrientFrontZ ? pEmitters->pOrientFrontZ + base : NULL,
+				emitter.OrientFront,
+				emitterFrontDot,
+				count
+			);
+		}
+		if (needVelocity)
+		{
+			ProjectBlockOntoDirection(
+				toListenerX,
+				toListenerY,
+				toListenerZ,
+				distance,
+				NULL,
+				NULL,
+				NULL,
+				pListener->Velocity,
+				listenerVelocity,
+				count
+			);
+			ProjectBlockOntoDirection(
+				toListenerX,
+				toListenerY,
+				toListenerZ,
+				distance,
+				pEmitters->pVelocityX ? pEmitters->pVelocityX + base : NULL,
+				pEmitters->pVelocityY ? pEmitters->pVelocityY + base : NULL,
+				pEmitters->pVelocityZ ? pEmitters->pVelocityZ + base : NULL,
+				emitter.Velocity,
+				emitterVelocity,
+				count
+			);
+		}
+
+		/* Per-emitter pass: curves, cones and the matrix */
+
+		for (i = 0; i < count; i += 1)
+		{
+			j = base + i;
+			settings = &pDSPSettings[j];
+
+			emitter.Position = Vec(
+				pEmitters->pPositionX[j],
+				pEmitters->pPositionY[j],
+				pEmitters->pPositionZ[j]
+			);
+			if (pEmitters->pOrientFrontX != NULL)
+			{
+				emitter.OrientFront = Vec(
+					pEmitters->pOrientFrontX[j],
+					pEmitters->pOrientFrontY[j],
+					pEmitters->pOrientFrontZ[j]
+				);
+				if (emitter.ChannelCount > 1)
+				{
+					/* The template's top is only orthogonal to the
+					 * template's front, so remove this emitter's
+					 * front from it to get a proper basis again.
+					 */
+					topDot = VectorDot(templateTop, emitter.OrientFront);
+					emitter.OrientTop = VectorSub(
+						templateTop,
+						VectorScale(emitter.OrientFront, topDot)
+					);
+					topLength = VectorLength(emitter.OrientTop);
+					if (topLength > 0.0f)
+					{
+						topLength = 1.0f / topLength;
+						emitter.OrientTop = VectorScale(
+							emitter.OrientTop,
+							topLength
+						);
+					}
+				}
+			}
+			if (pEmitters->pVelocityX != NULL)
+			{
+				emitter.Velocity = Vec(
+					pEmitters->pVelocityX[j],
+					pEmitters->pVelocityY[j],
+					pEmitters->pVelocityZ[j]
+				);
+			}
+
+			settings->EmitterToListenerDistance = distance[i];
+
+			/* The template only needs a full check once, after that
+			 * only the per-emitter data can be wrong.
+			 */
+			if (j == 0)
+			{
+				F3DAudioCheckCalculateParams(
+					Instance,
+					pListener,
+					&emitter,
+					Flags,
+					settings
+				);
+			}
+			else
+			{
+				PARAM_CHECK(
+					settings->SrcChannelCount == emitter.ChannelCount,
+					"Invalid channel count, DSP settings and emitter must agree"
+				);
+				PARAM_CHECK(
+					settings->DstChannelCount == SPEAKERCOUNT(Instance),
+					"Invalid channel count, DSP settings and speaker configuration must agree"
+				);
+				if (Flags & F3DAUDIO_CALCULATE_MATRIX)
+				{
+					POINTER_CHECK(settings->pMatrixCoefficients);
+				}
+				if (	pEmitters->pOrientFrontX != NULL &&
+					(needEmitterFront || emitter.ChannelCount > 1)	)
+				{
+					VECTOR_NORMAL_CHECK(emitter.OrientFront);
+				}
+				if (	pEmitters->pOrientFrontX != NULL &&
+					emitter.ChannelCount > 1	)
+				{
+					/* Fails if the front is parallel to the top */
+					VECTOR_NORMAL_CHECK(emitter.OrientTop);
+					VECTOR_BASE_CHECK(emitter.OrientFront, emitter.OrientTop);
+				}
+			}
+
+			CalculateEmitter(
+				Instance,
+				&listener,
+				&emitter,
+				&curves,
+				Flags,
+				Vec(toListenerX[i], toListenerY[i], toListenerZ[i]),
+				distance[i],
+				normalizedDistance[i],
+				needListenerFront ? listenerFrontDot[i] : 0.0f,
+				needEmitterFront ? emitterFrontDot[i] : 0.0f,
+				needVelocity ? listenerVelocity[i] : 0.0f,
+				needVelocity ? emitterVelocity[i] : 0.0f,
+				settings
+			);
+		}
+	}
+}
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
@@ -60,6 +60,10 @@ uint32_t FACTCreateEngineWithCustomAllocatorEXT(
 	(*ppEngine)->sbLock = FAudio_PlatformCreateMutex();
 	(*ppEngine)->wbLock = FAudio_PlatformCreateMutex();
 	(*ppEngine)->apiLock = FAudio_PlatformCreateMutex();
+	(*ppEngine)->varLock = FAudio_PlatformCreateMutex();
+	(*ppEngine)->cmdLock = FAudio_PlatformCreateMutex();
+	(*ppEngine)->jobLock = FAudio_PlatformCreateMutex();
+	(*ppEngine)->notificationFD = -1;
 	(*ppEngine)->pMalloc = customMalloc;
 	(*ppEngine)->pFree = customFree;
 	(*ppEngine)->pRealloc = customRealloc;
@@ -89,6 +93,10 @@ uint32_t FACTAudioEngine_Release(FACTAudioEngine *pEngine)
 	FAudio_PlatformDestroyMutex(pEngine->wbLock);
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	FAudio_PlatformDestroyMutex(pEngine->apiLock);
+	FAudio_PlatformDestroyMutex(pEngine->varLock);
+	FAudio_PlatformDestroyMutex(pEngine->cmdLock);
+	FAudio_PlatformDestroyMutex(pEngine->jobLock);
+	FAudio_PlatformDestroyEventFD(pEngine->notificationFD);
 	if (pEngine->settings != NULL)
 	{
 		pEngine->pFree(pEngine->settings);
@@ -225,6 +233,19 @@ uint32_t FACTAudioEngine_Initialize(
 		pEngine->rpcs = NULL;
 		pEngine->dspPresets = NULL;
 	}
+	else if (FACT_INTERNAL_IsCache(
+		pParams->pGlobalSettingsBuffer,
+		pParams->globalSettingsBufferSize,
+		FACT_CACHE_MAGIC_ENGINE
+	)) {
+		/* BinaryCacheEXT */
+		parseRet = FACT_INTERNAL_LoadAudioEngineCache(pEngine, pParams);
+		if (parseRet != 0)
+		{
+			FAudio_PlatformUnlockMutex(pEngine->apiLock);
+			return parseRet;
+		}
+	}
 	else
 	{
 		/* Parse the file */
@@ -236,8 +257,14 @@ uint32_t FACTAudioEngine_Initialize(
 		}
 	}
 
+	/* Resolve these now, rather than on every update */
+	FACT_INTERNAL_FindTimeVariables(pEngine);
+	pEngine->globalVariablesDirty = 1;
+	pEngine->globalVariablesVersion += 1;
+
 	/* Peristent Notifications */
 	pEngine->notifications = 0;
+	FACT_INTERNAL_InitNotificationQueue(pEngine);
 	pEngine->cue_context = NULL;
 	pEngine->sb_context = NULL;
 	pEngine->wb_context = NULL;
@@ -323,6 +350,7 @@ uint32_t FACTAudioEngine_Initialize(
 	}
 
 	pEngine->initialized = 1;
+	pEngine->apiWake = FAudio_PlatformCreateSemaphore(0);
 	pEngine->apiThread = FAudio_PlatformCreateThread(
 		FACT_INTERNAL_APIThread,
 		"FACT Thread",
@@ -333,17 +361,42 @@ uint32_t FACTAudioEngine_Initialize(
 	return 0;
 }
 
+uint32_t FACTAudioEngine_SerializeEXT(
+	FACTAudioEngine *pEngine,
+	void *pBuffer,
+	uint32_t *pdwSize
+) {
+	uint32_t retval;
+	if (pEngine == NULL)
+	{
+		return 1;
+	}
+
+	FAudio_PlatformLockMutex(pEngine->apiLock);
+	retval = FACT_INTERNAL_SerializeAudioEngine(pEngine, pBuffer, pdwSize);
+	FAudio_PlatformUnlockMutex(pEngine->apiLock);
+	return retval;
+}
+
 uint32_t FACTAudioEngine_ShutDown(FACTAudioEngine *pEngine)
 {
 	uint32_t i, refcount;
-	FAudioMutex mutex;
+	int32_t notificationFD;
+	FAudioMutex mutex, varLock, cmdLock, jobLock;
 	FAudioMallocFunc pMalloc;
 	FAudioFreeFunc pFree;
 	FAudioReallocFunc pRealloc;
 
 	/* Close thread, then lock ASAP */
 	pEngine->initialized = 0;
+	FACT_INTERNAL_WakeAPIThread(pEngine);
 	FAudio_PlatformWaitThread(pEngine->apiThread, NULL);
+	if (pEngine->apiWake != NULL)
+	{
+		FAudio_PlatformDestroySemaphore(pEngine->apiWake);
+		pEngine->apiWake = NULL;
+	}
+	FACT_INTERNAL_DestroyWorkers(pEngine);
 	FAudio_PlatformLockMutex(pEngine->apiLock);
 
 	/* Stop the platform stream before freeing stuff! */
@@ -364,38 +417,58 @@ uint32_t FACTAudioEngine_ShutDown(FACTAudioEngine *pEngine)
 		FACTSoundBank_Destroy((FACTSoundBank*) pEngine->sbList->entry);
 	}
 
-	/* Category data */
-	for (i = 0; i < pEngine->categoryCount; i += 1)
+	if (pEngine->cache != NULL)
 	{
-		pEngine->pFree(pEngine->categoryNames[i]);
+		/* BinaryCacheEXT, everything lives in one block */
+		pEngine->pFree(pEngine->cache);
 	}
-	pEngine->pFree(pEngine->categoryNames);
-	pEngine->pFree(pEngine->categories);
-
-	/* Variable data */
-	for (i = 0; i < pEngine->variableCount; i += 1)
+	else
 	{
-		pEngine->pFree(pEngine->variableNames[i]);
-	}
-	pEngine->pFree(pEngine->variableNames);
-	pEngine->pFree(pEngine->variables);
-	pEngine->pFree(pEngine->globalVariableValues);
+		/* Category data */
+		for (i = 0; i < pEngine->categoryCount; i += 1)
+		{
+			pEngine->pFree(pEngine->categoryNames[i]);
+		}
+		pEngine->pFree(pEngine->categoryNames);
+		pEngine->pFree(pEngine->categories);
 
-	/* RPC data */
-	for (i = 0; i < pEngine->rpcCount; i += 1)
-	{
-		pEngine->pFree(pEngine->rpcs[i].points);
-	}
-	pEngine->pFree(pEngine->rpcs);
-	pEngine->pFree(pEngine->rpcCodes);
+		/* Variable data */
+		for (i = 0; i < pEngine->variableCount; i += 1)
+		{
+			pEngine->pFree(pEngine->variableNames[i]);
+		}
+		pEngine->pFree(pEngine->variableNames);
+		pEngine->pFree(pEngine->variables);
+		pEngine->pFree(pEngine->globalVariableValues);
 
-	/* DSP data */
-	for (i = 0; i < pEngine->dspPresetCount; i += 1)
-	{
-		pEngine->pFree(pEngine->dspPresets[i].parameters);
+		/* RPC data */
+		for (i = 0; i < pEngine->rpcCount; i += 1)
+		{
+			pEngine->pFree(pEngine->rpcs[i].points);
+			pEngine->pFree(pEngine->rpcs[i].table);
+		}
+		pEngine->pFree(pEngine->rpcs);
+		pEngine->pFree(pEngine->rpcCodes);
+
+		/* DSP data */
+		for (i = 0; i < pEngine->dspPresetCount; i += 1)
+		{
+			pEngine->pFree(pEngine->dspPresets[i].parameters);
+		}
+		pEngine->pFree(pEngine->dspPresets);
+		pEngine->pFree(pEngine->dspPresetCodes);
 	}
-	pEngine->pFree(pEngine->dspPresets);
-	pEngine->pFree(pEngine->dspPresetCodes);
+
+	/* VirtualVoiceEXT scratch space */
+	pEngine->pFree(pEngine->voiceCandidates);
+
+	/* All the Sounds are back in the pool by now */
+	FACT_INTERNAL_FreeSoundPool(pEngine);
+	pEngine->soundPoolBlockSize = 0;
+
+	/* Pending CueCommandsEXT, the Cues are all gone anyway */
+	pEngine->pFree(pEngine->commands);
+	pEngine->pFree(pEngine->applyCommands);
 
 	/* Audio resources */
 	if (pEngine->reverbVoice != NULL)
@@ -414,6 +487,10 @@ uint32_t FACTAudioEngine_ShutDown(FACTAudioEngine *pEngine)
 	/* Finally. */
 	refcount = pEngine->refcount;
 	mutex = pEngine->apiLock;
+	varLock = pEngine->varLock;
+	cmdLock = pEngine->cmdLock;
+	jobLock = pEngine->jobLock;
+	notificationFD = pEngine->notificationFD;
 	pMalloc = pEngine->pMalloc;
 	pFree = pEngine->pFree;
 	pRealloc = pEngine->pRealloc;
@@ -423,6 +500,12 @@ uint32_t FACTAudioEngine_ShutDown(FACTAudioEngine *pEngine)
 	pEngine->pRealloc = pRealloc;
 	pEngine->refcount = refcount;
 	pEngine->apiLock = mutex;
+	pEngine->varLock = varLock;
+	pEngine->cmdLock = cmdLock;
+	pEngine->jobLock = jobLock;
+
+	/* Apps may have this in an epoll set, so it outlives ShutDown */
+	pEngine->notificationFD = notificationFD;
 
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return 0;
@@ -432,43 +515,33 @@ uint32_t FACTAudioEngine_DoWork(FACTAudioEngine *pEngine)
 {
 	uint8_t i;
 	FACTCue *cue;
-	LinkedList *list;
-	FACTNotification *note;
 
-	FAudio_PlatformLockMutex(pEngine->apiLock);
+	/* The queue is lock-free, no need for apiLock here */
+	FACT_INTERNAL_DispatchNotifications(pEngine);
 
-	while (pEngine->wb_notifications_list)
-	{
-		note = (FACTNotification*) pEngine->wb_notifications_list->entry;
-		pEngine->notificationCallback(note);
-		LinkedList_RemoveEntry(&pEngine->wb_notifications_list, note, pEngine->apiLock, pEngine->pFree);
-	}
+	FAudio_PlatformLockMutex(pEngine->apiLock);
 
-	list = pEngine->sbList;
-	while (list != NULL)
+	/* Only active Cues can have a playing Sound */
+	cue = pEngine->activeCues;
+	while (cue != NULL)
 	{
-		cue = ((FACTSoundBank*) list->entry)->cueList;
-		while (cue != NULL)
+		if (cue->playingSound != NULL)
+		for (i = 0; i < cue->playingSound->sound->trackCount; i += 1)
 		{
-			if (cue->playingSound != NULL)
-			for (i = 0; i < cue->playingSound->sound->trackCount; i += 1)
+			if (	cue->playingSound->tracks[i].upcomingWave.wave == NULL &&
+				cue->playingSound->tracks[i].waveEvtInst->loopCount > 0	)
 			{
-				if (	cue->playingSound->tracks[i].upcomingWave.wave == NULL &&
-					cue->playingSound->tracks[i].waveEvtInst->loopCount > 0	)
-				{
-					FACT_INTERNAL_GetNextWave(
-						cue,
-						cue->playingSound->sound,
-						&cue->playingSound->sound->tracks[i],
-						&cue->playingSound->tracks[i],
-						cue->playingSound->tracks[i].waveEvt,
-						cue->playingSound->tracks[i].waveEvtInst
-					);
-				}
+				FACT_INTERNAL_GetNextWave(
+					cue,
+					cue->playingSound->sound,
+					&cue->playingSound->sound->tracks[i],
+					&cue->playingSound->tracks[i],
+					cue->playingSound->tracks[i].waveEvt,
+					cue->playingSound->tracks[i].waveEvtInst
+				);
 			}
-			cue = cue->next;
 		}
-		list = list->next;
+		cue = cue->activeNext;
 	}
 
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
@@ -485,12 +558,29 @@ uint32_t FACTAudioEngine_CreateSoundBank(
 ) {
 	uint32_t retval;
 	FAudio_PlatformLockMutex(pEngine->apiLock);
-	retval = FACT_INTERNAL_ParseSoundBank(
-		pEngine,
-		pvBuffer,
-		dwSize,
-		ppSoundBank
-	);
+	if (FACT_INTERNAL_IsCache(pvBuffer, dwSize, FACT_CACHE_MAGIC_SOUNDBANK))
+	{
+		/* BinaryCacheEXT */
+		retval = FACT_INTERNAL_LoadSoundBankCache(
+			pEngine,
+			pvBuffer,
+			dwSize,
+			ppSoundBank
+		);
+	}
+	else
+	{
+		retval = FACT_INTERNAL_ParseSoundBank(
+			pEngine,
+			pvBuffer,
+			dwSize,
+			ppSoundBank
+		);
+	}
+	if (retval == 0)
+	{
+		FACT_INTERNAL_GrowSoundPool(pEngine, *ppSoundBank);
+	}
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return retval;
 }
@@ -503,7 +593,7 @@ uint32_t FACTAudioEngine_CreateInMemoryWaveBank(
 	uint32_t dwAllocAttributes,
 	FACTWaveBank **ppWaveBank
 ) {
-	FACTNotification *note;
+	FACTNotification note;
 	uint32_t retval;
 	FAudio_PlatformLockMutex(pEngine->apiLock);
 	retval = FACT_INTERNAL_ParseWaveBank(
@@ -518,11 +608,10 @@ uint32_t FACTAudioEngine_CreateInMemoryWaveBank(
 	);
 	if (pEngine->notifications & NOTIFY_WAVEBANKPREPARED)
 	{
-		note = (FACTNotification*) pEngine->pMalloc(sizeof(FACTNotification));
-		note->type = FACTNOTIFICATIONTYPE_WAVEBANKPREPARED;
-		note->waveBank.pWaveBank = *ppWaveBank;
-		note->pvContext = pEngine->wb_context;
-		LinkedList_AddEntry(&pEngine->wb_notifications_list, note, pEngine->apiLock, pEngine->pMalloc);
+		note.type = FACTNOTIFICATIONTYPE_WAVEBANKPREPARED;
+		note.waveBank.pWaveBank = *ppWaveBank;
+		note.pvContext = pEngine->wb_context;
+		FACT_INTERNAL_QueueNotification(pEngine, &note);
 	}
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return retval;
@@ -533,7 +622,7 @@ uint32_t FACTAudioEngine_CreateStreamingWaveBank(
 	const FACTStreamingParameters *pParms,
 	FACTWaveBank **ppWaveBank
 ) {
-	FACTNotification *note;
+	FACTNotification note;
 	uint32_t retval, packetSize;
 	FAudio_PlatformLockMutex(pEngine->apiLock);
 	if (	pEngine->pReadFile == FACT_INTERNAL_DefaultReadFile &&
@@ -558,11 +647,10 @@ uint32_t FACTAudioEngine_CreateStreamingWaveBank(
 	);
 	if (pEngine->notifications & NOTIFY_WAVEBANKPREPARED)
 	{
-		note = (FACTNotification*) pEngine->pMalloc(sizeof(FACTNotification));
-		note->type = FACTNOTIFICATIONTYPE_WAVEBANKPREPARED;
-		note->waveBank.pWaveBank = *ppWaveBank;
-		note->pvContext = pEngine->wb_context;
-		LinkedList_AddEntry(&pEngine->wb_notifications_list, note, pEngine->apiLock, pEngine->pMalloc);
+		note.type = FACTNOTIFICATIONTYPE_WAVEBANKPREPARED;
+		note.waveBank.pWaveBank = *ppWaveBank;
+		note.pvContext = pEngine->wb_context;
+		FACT_INTERNAL_QueueNotification(pEngine, &note);
 	}
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return retval;
@@ -858,21 +946,31 @@ uint32_t FACTAudioEngine_UnRegisterNotification(
 	return 0;
 }
 
+int32_t FACTAudioEngine_GetNotificationFDEXT(FACTAudioEngine *pEngine)
+{
+	int32_t fd;
+	FAudio_PlatformLockMutex(pEngine->apiLock);
+	if (pEngine->notificationFD < 0)
+	{
+		pEngine->notificationFD = FAudio_PlatformCreateEventFD();
+	}
+	fd = pEngine->notificationFD;
+	FAudio_PlatformUnlockMutex(pEngine->apiLock);
+	return fd;
+}
+
 uint16_t FACTAudioEngine_GetCategory(
 	FACTAudioEngine *pEngine,
 	const char *szFriendlyName
 ) {
 	uint16_t i;
-	FAudio_PlatformLockMutex(pEngine->apiLock);
 	for (i = 0; i < pEngine->categoryCount; i += 1)
 	{
 		if (FAudio_strcmp(szFriendlyName, pEngine->categoryNames[i]) == 0)
 		{
-			FAudio_PlatformUnlockMutex(pEngine->apiLock);
 			return i;
 		}
 	}
-	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return FACTCATEGORY_INVALID;
 }
 
@@ -972,6 +1070,7 @@ uint32_t FACTAudioEngine_SetVolume(
 			);
 		}
 	}
+	FACT_INTERNAL_WakeAPIThread(pEngine);
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return 0;
 }
@@ -1013,17 +1112,14 @@ uint16_t FACTAudioEngine_GetGlobalVariableIndex(
 	const char *szFriendlyName
 ) {
 	uint16_t i;
-	FAudio_PlatformLockMutex(pEngine->apiLock);
 	for (i = 0; i < pEngine->variableCount; i += 1)
 	{
 		if (	FAudio_strcmp(szFriendlyName, pEngine->variableNames[i]) == 0 &&
 			!(pEngine->variables[i].accessibility & 0x04)	)
 		{
-			FAudio_PlatformUnlockMutex(pEngine->apiLock);
 			return i;
 		}
 	}
-	FAudio_PlatformUnlockMutex(pEngine->apiLock);
 	return FACTVARIABLEINDEX_INVALID;
 }
 
@@ -1034,7 +1130,8 @@ uint32_t FACTAudioEngine_SetGlobalVariable(
 ) {
 	FACTVariable *var;
 
-	FAudio_PlatformLockMutex(pEngine->apiLock);
+	/* Variables have their own lock, no need to wait for the API thread */
+	FAudio_PlatformLockMutex(pEngine->varLock);
 
 	var = &pEngine->variables[nIndex];
 	FAudio_assert(var->accessibility & 0x01);
@@ -1045,8 +1142,11 @@ uint32_t FACTAudioEngine_SetGlobalVariable(
 		var->minValue,
 		var->maxValue
 	);
+	pEngine->globalVariablesDirty = 1;
+	pEngine->globalVariablesVersion += 1;
 
-	FAudio_PlatformUnlockMutex(pEngine->apiLock);
+	FAudio_PlatformUnlockMutex(pEngine->varLock);
+	FACT_INTERNAL_WakeAPIThread(pEngine);
 	return 0;
 }
 
@@ -1057,14 +1157,140 @@ uint32_t FACTAudioEngine_GetGlobalVariable(
 ) {
 	FACTVariable *var;
 
-	FAudio_PlatformLockMutex(pEngine->apiLock);
+	FAudio_PlatformLockMutex(pEngine->varLock);
 
 	var = &pEngine->variables[nIndex];
 	FAudio_assert(var->accessibility & 0x01);
 	FAudio_assert(!(var->accessibility & 0x04));
 	*pnValue = pEngine->globalVariableValues[nIndex];
 
+	FAudio_PlatformUnlockMutex(pEngine->varLock);
+	return 0;
+}
+
+uint32_t FACTAudioEngine_SubmitCueCommandsEXT(
+	FACTAudioEngine *pEngine,
+	const FACTCueCommandEXT *pCommands,
+	uint32_t commandCount
+) {
+	FACTCueCommand *cmd;
+	uint32_t i;
+	if (pEngine == NULL)
+	{
+		return 1;
+	}
+	if (commandCount == 0)
+	{
+		return 0;
+	}
+	if (pCommands == NULL)
+	{
+		return FAUDIO_E_INVALID_CALL;
+	}
+
+	/* Validate first, the batch goes in all or nothing */
+	for (i = 0; i < commandCount; i += 1)
+	{
+		if (pCommands[i].pCue == NULL)
+		{
+			return FAUDIO_E_INVALID_CALL;
+		}
+		if (	pCommands[i].type == FACTCUECOMMAND_SETVARIABLE_EXT &&
+			(	pCommands[i].variable.nIndex == FACTINDEX_INVALID ||
+				pCommands[i].variable.nIndex >= pEngine->variableCount	)	)
+		{
+			return FAUDIO_E_INVALID_CALL;
+		}
+
+		/* Same rules as FACTCue_SetVariable, which only asserts them */
+		if (	pCommands[i].type == FACTCUECOMMAND_SETVARIABLE_EXT &&
+			(	!(pEngine->variables[pCommands[i].variable.nIndex].accessibility & 0x01) ||
+				(pEngine->variables[pCommands[i].variable.nIndex].accessibility & 0x02) ||
+				!(pEngine->variables[pCommands[i].variable.nIndex].accessibility & 0x04)	)	)
+		{
+			return FAUDIO_E_INVALID_CALL;
+		}
+		if (	pCommands[i].type == FACTCUECOMMAND_SETMATRIX_EXT &&
+			(	pCommands[i].matrix.pMatrixCoefficients == NULL ||
+				pCommands[i].matrix.uSrcChannelCount == 0 ||
+				pCommands[i].matrix.uSrcChannelCount > 2 ||
+				pCommands[i].matrix.uDstChannelCount == 0 ||
+				pCommands[i].matrix.uDstChannelCount > 8	)	)
+		{
+			return FAUDIO_E_INVALID_CALL;
+		}
+		if (pCommands[i].type > FACTCUECOMMAND_STOP_EXT)
+		{
+			return FAUDIO_E_INVALID_CALL;
+		}
+	}
+
+	/* Only the command list lock, the API thread can keep working */
+	FAudio_PlatformLockMutex(pEngine->cmdLock);
+	if ((pEngine->commandCount + commandCount) > pEngine->commandCapacity)
+	{
+		pEngine->commandCapacity = FAudio_max(
+			pEngine->commandCapacity * 2,
+			pEngine->commandCount + commandCount
+		);
+		pEngine->commands = (FACTCueCommand*) pEngine->pRealloc(
+			pEngine->commands,
+			sizeof(FACTCueCommand) * pEngine->commandCapacity
+		);
+	}
+	cmd = &pEngine->commands[pEngine->commandCount];
+	for (i = 0; i < commandCount; i += 1, cmd += 1)
+	{
+		cmd->cue = pCommands[i].pCue;
+		cmd->type = pCommands[i].type;
+		if (cmd->type == FACTCUECOMMAND_SETVARIABLE_EXT)
+		{
+			cmd->variable.index = pCommands[i].variable.nIndex;
+			cmd->variable.value = pCommands[i].variable.nValue;
+		}
+		else if (cmd->type == FACTCUECOMMAND_SETMATRIX_EXT)
+		{
+			cmd->matrix.srcChannels = pCommands[i].matrix.uSrcChannelCount;
+			cmd->matrix.dstChannels = pCommands[i].matrix.uDstChannelCount;
+			FAudio_memcpy(
+				cmd->matrix.coefficients,
+				pCommands[i].matrix.pMatrixCoefficients,
+				sizeof(float) * (
+					cmd->matrix.srcChannels *
+					cmd->matrix.dstChannels
+				)
+			);
+		}
+		else if (cmd->type == FACTCUECOMMAND_STOP_EXT)
+		{
+			cmd->stopFlags = pCommands[i].stop.dwFlags;
+		}
+	}
+	pEngine->commandCount += commandCount;
+	FAudio_PlatformUnlockMutex(pEngine->cmdLock);
+
+	FACT_INTERNAL_WakeAPIThread(pEngine);
+	return 0;
+}
+
+uint32_t FACTAudioEngine_SetVirtualVoiceParametersEXT(
+	FACTAudioEngine *pEngine,
+	int32_t fEnable,
+	uint32_t maxRealVoices,
+	float silenceThreshold
+) {
+	if (pEngine == NULL)
+	{
+		return 1;
+	}
+	FAudio_PlatformLockMutex(pEngine->apiLock);
+	pEngine->virtualVoicesEnabled = (fEnable != 0);
+	pEngine->maxRealVoices = maxRealVoices;
+	pEngine->virtualThreshold = silenceThreshold;
 	FAudio_PlatformUnlockMutex(pEngine->apiLock);
+
+	/* Disabling promotes everything on the next update */
+	FACT_INTERNAL_WakeAPIThread(pEngine);
 	return 0;
 }
 
@@ -1080,19 +1306,14 @@ uint16_t FACTSoundBank_GetCueIndex(
 		return FACTINDEX_INVALID;
 	}
 
-	FAudio_PlatformLockMutex(pSoundBank->parentEngine->apiLock);
 	if (pSoundBank->cueNames != NULL)
 	for (i = 0; i < pSoundBank->cueCount; i += 1)
 	{
 		if (FAudio_strcmp(szFriendlyName, pSoundBank->cueNames[i]) == 0)
 		{
-			FAudio_PlatformUnlockMutex(
-				pSoundBank->parentEngine->apiLock
-			);
 			return i;
 		}
 	}
-	FAudio_PlatformUnlockMutex(pSoundBank->parentEngine->apiLock);
 	return FACTINDEX_INVALID;
 }
 
@@ -1420,87 +1641,95 @@ uint32_t FACTSoundBank_Destroy(FACTSoundBank *pSoundBank)
 		);
 	}
 
-	/* SoundBank Name */
-	pSoundBank->parentEngine->pFree(pSoundBank->name);
-
-	/* Cue data */
-	pSoundBank->parentEngine->pFree(pSoundBank->cues);
-
-	/* WaveBank Name data */
-	for (i = 0; i < pSoundBank->wavebankCount; i += 1)
+	if (pSoundBank->cache != NULL)
 	{
-		pSoundBank->parentEngine->pFree(pSoundBank->wavebankNames[i]);
+		/* BinaryCacheEXT, everything lives in one block */
+		pSoundBank->parentEngine->pFree(pSoundBank->cache);
 	}
-	pSoundBank->parentEngine->pFree(pSoundBank->wavebankNames);
-
-	/* Sound data */
-	for (i = 0; i < pSoundBank->soundCount; i += 1)
+	else
 	{
-		for (j = 0; j < pSoundBank->sounds[i].trackCount; j += 1)
+		/* SoundBank Name */
+		pSoundBank->parentEngine->pFree(pSoundBank->name);
+
+		/* Cue data */
+		pSoundBank->parentEngine->pFree(pSoundBank->cues);
+
+		/* WaveBank Name data */
+		for (i = 0; i < pSoundBank->wavebankCount; i += 1)
+		{
+			pSoundBank->parentEngine->pFree(pSoundBank->wavebankNames[i]);
+		}
+		pSoundBank->parentEngine->pFree(pSoundBank->wavebankNames);
+
+		/* Sound data */
+		for (i = 0; i < pSoundBank->soundCount; i += 1)
 		{
-			for (k = 0; k < pSoundBank->sounds[i].tracks[j].eventCount; k += 1)
+			for (j = 0; j < pSoundBank->sounds[i].trackCount; j += 1)
 			{
-				#define MATCH(t) \
-					pSoundBank->sounds[i].tracks[j].events[k].type == t
-				if (	MATCH(FACTEVENT_PLAYWAVE) ||
-					MATCH(FACTEVENT_PLAYWAVETRACKVARIATION) ||
-					MATCH(FACTEVENT_PLAYWAVEEFFECTVARIATION) ||
-					MATCH(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION)	)
+				for (k = 0; k < pSoundBank->sounds[i].tracks[j].eventCount; k += 1)
 				{
-					if (pSoundBank->sounds[i].tracks[j].events[k].wave.isComplex)
+					#define MATCH(t) \
+						pSoundBank->sounds[i].tracks[j].events[k].type == t
+					if (	MATCH(FACTEVENT_PLAYWAVE) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVEEFFECTVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION)	)
 					{
-						pSoundBank->parentEngine->pFree(
-							pSoundBank->sounds[i].tracks[j].events[k].wave.complex.tracks
-						);
-						pSoundBank->parentEngine->pFree(
-							pSoundBank->sounds[i].tracks[j].events[k].wave.complex.wavebanks
-						);
-						pSoundBank->parentEngine->pFree(
-							pSoundBank->sounds[i].tracks[j].events[k].wave.complex.weights
-						);
+						if (pSoundBank->sounds[i].tracks[j].events[k].wave.isComplex)
+						{
+							pSoundBank->parentEngine->pFree(
+								pSoundBank->sounds[i].tracks[j].events[k].wave.complex.tracks
+							);
+							pSoundBank->parentEngine->pFree(
+								pSoundBank->sounds[i].tracks[j].events[k].wave.complex.wavebanks
+							);
+							pSoundBank->parentEngine->pFree(
+								pSoundBank->sounds[i].tracks[j].events[k].wave.complex.weights
+							);
+						}
 					}
+					#undef MATCH
 				}
-				#undef MATCH
+				pSoundBank->parentEngine->pFree(
+					pSoundBank->sounds[i].tracks[j].events
+				);
 			}
+			pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].tracks);
+			pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].rpcCodes);
+			pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].dspCodes);
+		}
+		pSoundBank->parentEngine->pFree(pSoundBank->sounds);
+		pSoundBank->parentEngine->pFree(pSoundBank->soundCodes);
+
+		/* Variation data */
+		for (i = 0; i < pSoundBank->variationCount; i += 1)
+		{
 			pSoundBank->parentEngine->pFree(
-				pSoundBank->sounds[i].tracks[j].events
+				pSoundBank->variations[i].entries
 			);
 		}
-		pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].tracks);
-		pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].rpcCodes);
-		pSoundBank->parentEngine->pFree(pSoundBank->sounds[i].dspCodes);
-	}
-	pSoundBank->parentEngine->pFree(pSoundBank->sounds);
-	pSoundBank->parentEngine->pFree(pSoundBank->soundCodes);
+		pSoundBank->parentEngine->pFree(pSoundBank->variations);
+		pSoundBank->parentEngine->pFree(pSoundBank->variationCodes);
 
-	/* Variation data */
-	for (i = 0; i < pSoundBank->variationCount; i += 1)
-	{
-		pSoundBank->parentEngine->pFree(
-			pSoundBank->variations[i].entries
-		);
-	}
-	pSoundBank->parentEngine->pFree(pSoundBank->variations);
-	pSoundBank->parentEngine->pFree(pSoundBank->variationCodes);
-
-	/* Transition data */
-	for (i = 0; i < pSoundBank->transitionCount; i += 1)
-	{
-		pSoundBank->parentEngine->pFree(
-			pSoundBank->transitions[i].entries
-		);
-	}
-	pSoundBank->parentEngine->pFree(pSoundBank->transitions);
-	pSoundBank->parentEngine->pFree(pSoundBank->transitionCodes);
+		/* Transition data */
+		for (i = 0; i < pSoundBank->transitionCount; i += 1)
+		{
+			pSoundBank->parentEngine->pFree(
+				pSoundBank->transitions[i].entries
+			);
+		}
+		pSoundBank->parentEngine->pFree(pSoundBank->transitions);
+		pSoundBank->parentEngine->pFree(pSoundBank->transitionCodes);
 
-	/* Cue Name data */
-	if (pSoundBank->cueNames != NULL)
-	{
-		for (i = 0; i < pSoundBank->cueCount; i += 1)
+		/* Cue Name data */
+		if (pSoundBank->cueNames != NULL)
 		{
-			pSoundBank->parentEngine->pFree(pSoundBank->cueNames[i]);
+			for (i = 0; i < pSoundBank->cueCount; i += 1)
+			{
+				pSoundBank->parentEngine->pFree(pSoundBank->cueNames[i]);
+			}
+			pSoundBank->parentEngine->pFree(pSoundBank->cueNames);
 		}
-		pSoundBank->parentEngine->pFree(pSoundBank->cueNames);
 	}
 
 	/* Finally. */
@@ -1525,6 +1754,23 @@ uint32_t FACTSoundBank_Destroy(FACTSoundBank *pSoundBank)
 	return 0;
 }
 
+uint32_t FACTSoundBank_SerializeEXT(
+	FACTSoundBank *pSoundBank,
+	void *pBuffer,
+	uint32_t *pdwSize
+) {
+	uint32_t retval;
+	if (pSoundBank == NULL)
+	{
+		return 1;
+	}
+
+	FAudio_PlatformLockMutex(pSoundBank->parentEngine->apiLock);
+	retval = FACT_INTERNAL_SerializeSoundBank(pSoundBank, pBuffer, pdwSize);
+	FAudio_PlatformUnlockMutex(pSoundBank->parentEngine->apiLock);
+	return retval;
+}
+
 uint32_t FACTSoundBank_GetState(
 	FACTSoundBank *pSoundBank,
 	uint32_t *pdwState
@@ -1584,6 +1830,7 @@ uint32_t FACTWaveBank_Destroy(FACTWaveBank *pWaveBank)
 			FACTWave_Destroy(wave);
 		}
 	}
+	FACT_INTERNAL_FreeWavePool(pWaveBank);
 
 	if (pWaveBank->parentEngine != NULL)
 	{
@@ -1706,17 +1953,14 @@ uint16_t FACTWaveBank_GetWaveIndex(
 		return FACTINDEX_INVALID;
 	}
 
-	FAudio_PlatformLockMutex(pWaveBank->parentEngine->apiLock);
 	curName = pWaveBank->waveBankNames;
 	for (i = 0; i < pWaveBank->entryCount; i += 1, curName += 64)
 	{
 		if (FAudio_strncmp(szFriendlyName, curName, 64) == 0)
 		{
-			FAudio_PlatformUnlockMutex(pWaveBank->parentEngine->apiLock);
 			return i;
 		}
 	}
-	FAudio_PlatformUnlockMutex(pWaveBank->parentEngine->apiLock);
 
 	return FACTINDEX_INVALID;
 }
@@ -1797,33 +2041,21 @@ uint32_t FACTWaveBank_Prepare(
 		FAudioADPCMWaveFormat adpcm;
 		FAudioXMA2WaveFormat xma2;
 	} format;
+	FAudioFilterParameters filter;
+	FAudioVoiceState voiceState;
 	FACTWaveBankEntry *entry;
 	FACTSeekTable *seek;
+	uint32_t streamSize;
 	if (pWaveBank == NULL)
 	{
 		*ppWave = NULL;
 		return 1;
 	}
 
-	*ppWave = (FACTWave*) pWaveBank->parentEngine->pMalloc(sizeof(FACTWave));
-
 	FAudio_PlatformLockMutex(pWaveBank->parentEngine->apiLock);
 
 	entry = &pWaveBank->entries[nWaveIndex];
 
-	/* Engine references */
-	(*ppWave)->parentBank = pWaveBank;
-	(*ppWave)->parentCue = NULL;
-	(*ppWave)->index = nWaveIndex;
-	(*ppWave)->notifyOnDestroy = 0;
-	(*ppWave)->usercontext = NULL;
-
-	/* Playback */
-	(*ppWave)->state = FACT_STATE_PREPARED;
-	(*ppWave)->volume = 1.0f;
-	(*ppWave)->pitch = 0;
-	(*ppWave)->loopCount = nLoopCount;
-
 	/* TODO: Convert dwPlayOffset to a byte offset */
 	FAudio_assert(dwPlayOffset == 0);
 #if 0
@@ -1932,40 +2164,83 @@ uint32_t FACTWaveBank_Prepare(
 	{
 		FAudio_assert(0 && "Rebuild your WaveBanks with ADPCM!");
 	}
-	(*ppWave)->callback.callback.OnBufferEnd = pWaveBank->streaming ?
-		FACT_INTERNAL_OnBufferEnd :
-		NULL;
-	(*ppWave)->callback.callback.OnBufferStart = NULL;
-	(*ppWave)->callback.callback.OnLoopEnd = NULL;
-	(*ppWave)->callback.callback.OnStreamEnd = FACT_INTERNAL_OnStreamEnd;
-	(*ppWave)->callback.callback.OnVoiceError = NULL;
-	(*ppWave)->callback.callback.OnVoiceProcessingPassEnd = NULL;
-	(*ppWave)->callback.callback.OnVoiceProcessingPassStart = NULL;
-	(*ppWave)->callback.wave = *ppWave;
-	(*ppWave)->srcChannels = format.pcm.nChannels;
-	FAudio_CreateSourceVoice(
-		pWaveBank->parentEngine->audio,
-		&(*ppWave)->voice,
-		&format.pcm,
-		FAUDIO_VOICE_USEFILTER, /* FIXME: Can this be optional? */
-		4.0f,
-		(FAudioVoiceCallback*) &(*ppWave)->callback,
-		&sends,
-		NULL
-	);
+
+	/* Try to recycle a Wave with a compatible voice first */
+	*ppWave = FACT_INTERNAL_ReuseWave(pWaveBank, &format.pcm);
+	if (*ppWave != NULL)
+	{
+		/* Undo whatever the last owner did to the voice */
+		filter.Type = FAUDIO_DEFAULT_FILTER_TYPE;
+		filter.Frequency = FAUDIO_DEFAULT_FILTER_FREQUENCY;
+		filter.OneOverQ = FAUDIO_DEFAULT_FILTER_ONEOVERQ;
+		FAudioVoice_SetOutputVoices((*ppWave)->voice, &sends);
+		FAudioVoice_SetVolume((*ppWave)->voice, 1.0f, 0);
+		FAudioVoice_SetFadeVolumeEXT((*ppWave)->voice, 1.0f, 0, 0);
+		FAudioVoice_SetFilterParameters((*ppWave)->voice, &filter, 0);
+		FAudioSourceVoice_SetFrequencyRatio((*ppWave)->voice, 1.0f, 0);
+	}
+	else
+	{
+		*ppWave = (FACTWave*) pWaveBank->parentEngine->pMalloc(
+			sizeof(FACTWave)
+		);
+		(*ppWave)->streamCache = NULL;
+		(*ppWave)->streamCacheLen = 0;
+		(*ppWave)->poolNext = NULL;
+		(*ppWave)->callback.callback.OnBufferEnd = pWaveBank->streaming ?
+			FACT_INTERNAL_OnBufferEnd :
+			NULL;
+		(*ppWave)->callback.callback.OnBufferStart = NULL;
+		(*ppWave)->callback.callback.OnLoopEnd = NULL;
+		(*ppWave)->callback.callback.OnStreamEnd = FACT_INTERNAL_OnStreamEnd;
+		(*ppWave)->callback.callback.OnVoiceError = NULL;
+		(*ppWave)->callback.callback.OnVoiceProcessingPassEnd = NULL;
+		(*ppWave)->callback.callback.OnVoiceProcessingPassStart = NULL;
+		(*ppWave)->callback.wave = *ppWave;
+		(*ppWave)->srcChannels = format.pcm.nChannels;
+		FAudio_CreateSourceVoice(
+			pWaveBank->parentEngine->audio,
+			&(*ppWave)->voice,
+			&format.pcm,
+			FAUDIO_VOICE_USEFILTER, /* FIXME: Can this be optional? */
+			4.0f,
+			(FAudioVoiceCallback*) &(*ppWave)->callback,
+			&sends,
+			NULL
+		);
+	}
+
+	/* Engine references */
+	(*ppWave)->parentBank = pWaveBank;
+	(*ppWave)->parentCue = NULL;
+	(*ppWave)->index = nWaveIndex;
+	(*ppWave)->notifyOnDestroy = 0;
+	(*ppWave)->usercontext = NULL;
+
+	/* Playback */
+	(*ppWave)->state = FACT_STATE_PREPARED;
+	(*ppWave)->volume = 1.0f;
+	(*ppWave)->pitch = 0;
+	(*ppWave)->loopCount = nLoopCount;
+
+	/* VirtualVoiceEXT */
+	FAudioSourceVoice_GetState((*ppWave)->voice, &voiceState, 0);
+	(*ppWave)->isVirtual = 0;
+	(*ppWave)->samplesBase = voiceState.SamplesPlayed;
+
 	if (pWaveBank->streaming)
 	{
 		/* Init stream cache info */
 		if (format.pcm.wFormatTag == FAUDIO_FORMAT_PCM)
 		{
-			(*ppWave)->streamSize = (
+			streamSize = (
 				format.pcm.nSamplesPerSec *
 				format.pcm.nBlockAlign
 			);
 		}
 		else if (format.pcm.wFormatTag == FAUDIO_FORMAT_MSADPCM)
 		{
-			(*ppWave)->streamSize = (
+			streamSize = (
 				format.pcm.nSamplesPerSec /
 				format.adpcm.wSamplesPerBlock *
 				format.pcm.nBlockAlign
@@ -1974,15 +2249,28 @@ uint32_t FACTWaveBank_Prepare(
 		else
 		{
 			/* Screw it, load the whole thing */
-			(*ppWave)->streamSize = entry->PlayRegion.dwLength;
+			streamSize = entry->PlayRegion.dwLength;
 
 			/* XACT does NOT support loop subregions for these formats */
 			FAudio_assert(entry->LoopRegion.dwStartSample == 0);
 			FAudio_assert(entry->LoopRegion.dwTotalSamples == 0 || entry->LoopRegion.dwTotalSamples == entry->Duration);
 		}
-		(*ppWave)->streamCache = (uint8_t*) pWaveBank->parentEngine->pMalloc(
-			(*ppWave)->streamSize
-		);
+		(*ppWave)->streamSize = streamSize;
+
+		/* Recycled Waves keep their cache if it's big enough */
+		if ((*ppWave)->streamCacheLen < streamSize)
+		{
+			if ((*ppWave)->streamCache != NULL)
+			{
+				pWaveBank->parentEngine->pFree(
+					(*ppWave)->streamCache
+				);
+			}
+			(*ppWave)->streamCache = (uint8_t*) pWaveBank->parentEngine->pMalloc(
+				streamSize
+			);
+			(*ppWave)->streamCacheLen = streamSize;
+		}
 		(*ppWave)->streamOffset = entry->PlayRegion.dwOffset;
 
 		/* Read and submit first buffer from the WaveBank */
@@ -1990,8 +2278,6 @@ uint32_t FACTWaveBank_Prepare(
 	}
 	else
 	{
-		(*ppWave)->streamCache = NULL;
-
 		buffer.Flags = FAUDIO_END_OF_STREAM;
 		buffer.AudioBytes = entry->PlayRegion.dwLength;
 		buffer.pAudioData = FAudio_memptr(
@@ -2106,6 +2392,7 @@ uint32_t FACTWave_Destroy(FACTWave *pWave)
 {
 	FAudioMutex mutex;
 	FACTNotification note;
+	uint8_t pooled;
 	if (pWave == NULL)
 	{
 		return 1;
@@ -2123,10 +2410,15 @@ uint32_t FACTWave_Destroy(FACTWave *pWave)
 		pWave->parentBank->parentEngine->pFree
 	);
 
-	FAudioVoice_DestroyVoice(pWave->voice);
-	if (pWave->streamCache != NULL)
+	/* The voice and stream cache can often be reused by the next Wave */
+	pooled = FACT_INTERNAL_RetireWave(pWave);
+	if (!pooled)
 	{
-		pWave->parentBank->parentEngine->pFree(pWave->streamCache);
+		FAudioVoice_DestroyVoice(pWave->voice);
+		if (pWave->streamCache != NULL)
+		{
+			pWave->parentBank->parentEngine->pFree(pWave->streamCache);
+		}
 	}
 	if (pWave->notifyOnDestroy || pWave->parentBank->parentEngine->notifications & NOTIFY_WAVEDESTROY)
 	{
@@ -2144,7 +2436,10 @@ uint32_t FACTWave_Destroy(FACTWave *pWave)
 	}
 
 	mutex = pWave->parentBank->parentEngine->apiLock;
-	pWave->parentBank->parentEngine->pFree(pWave);
+	if (!pooled)
+	{
+		pWave->parentBank->parentEngine->pFree(pWave);
+	}
 	FAudio_PlatformUnlockMutex(mutex);
 	return 0;
 }
@@ -2175,12 +2470,14 @@ uint32_t FACTWave_Stop(FACTWave *pWave, uint32_t dwFlags)
 	}
 	FAudio_PlatformLockMutex(pWave->parentBank->parentEngine->apiLock);
 
-	/* There are two ways that a Wave might be stopped immediately:
+	/* There are three ways that a Wave might be stopped immediately:
 	 * 1. The program explicitly asks for it
 	 * 2. The Wave is paused and therefore we can't do fade/release effects
+	 * 3. The Wave is virtual, so nobody would hear the tail anyway
 	 */
 	if (	dwFlags & FACT_FLAG_STOP_IMMEDIATE ||
-		pWave->state & FACT_STATE_PAUSED	)
+		pWave->state & FACT_STATE_PAUSED ||
+		pWave->isVirtual	)
 	{
 		pWave->state |= FACT_STATE_STOPPED;
 		pWave->state &= ~(
@@ -2190,6 +2487,11 @@ uint32_t FACTWave_Stop(FACTWave *pWave, uint32_t dwFlags)
 		);
 		FAudioSourceVoice_Stop(pWave->voice, 0, 0);
 		FAudioSourceVoice_FlushSourceBuffers(pWave->voice);
+		if (pWave->isVirtual)
+		{
+			pWave->isVirtual = 0;
+			pWave->parentBank->parentEngine->virtualVoiceCount -= 1;
+		}
 	}
 	else
 	{
@@ -2241,7 +2543,12 @@ uint32_t FACTWave_Pause(FACTWave *pWave, int32_t fPause)
 	else
 	{
 		pWave->state &= ~FACT_STATE_PAUSED;
-		FAudioSourceVoice_Start(pWave->voice, 0, 0);
+
+		/* Virtual Waves get started when they become real again */
+		if (!pWave->isVirtual)
+		{
+			FAudioSourceVoice_Start(pWave->voice, 0, 0);
+		}
 	}
 
 	FAudio_PlatformUnlockMutex(pWave->parentBank->parentEngine->apiLock);
@@ -2440,6 +2747,8 @@ uint32_t FACTCue_Destroy(FACTCue *pCue)
 		cue = cue->next;
 	}
 	FAudio_assert(cue != NULL && "Could not find Cue reference!");
+	FACT_INTERNAL_UnscheduleCue(pCue);
+	FACT_INTERNAL_PurgeCueCommands(pCue->parentBank->parentEngine, pCue);
 
 	pCue->parentBank->parentEngine->pFree(pCue->variableValues);
 	FACT_INTERNAL_SendCueNotification(pCue, NOTIFY_CUEDESTROY, FACTNOTIFICATIONTYPE_CUEDESTROYED);
@@ -2487,6 +2796,9 @@ uint32_t FACTCue_Play(FACTCue *pCue)
 
 			FACT_INTERNAL_SendCueNotification(pCue, NOTIFY_CUESTOP, FACTNOTIFICATIONTYPE_CUESTOP);
 
+			/* Managed Cues still need to be cleaned up */
+			FACT_INTERNAL_ScheduleCue(pCue);
+
 			FAudio_PlatformUnlockMutex(
 				pCue->parentBank->parentEngine->apiLock
 			);
@@ -2572,6 +2884,11 @@ uint32_t FACTCue_Play(FACTCue *pCue)
 	/* Need an initial sound to play */
 	if (!FACT_INTERNAL_CreateSound(pCue, fadeInMS))
 	{
+		if (pCue->state & FACT_STATE_STOPPED)
+		{
+			/* Category limit, managed Cues need cleanup */
+			FACT_INTERNAL_ScheduleCue(pCue);
+		}
 		FAudio_PlatformUnlockMutex(
 			pCue->parentBank->parentEngine->apiLock
 		);
@@ -2589,6 +2906,7 @@ uint32_t FACTCue_Play(FACTCue *pCue)
 	FACT_INTERNAL_SendCueNotification(pCue, NOTIFY_CUEPLAY, FACTNOTIFICATIONTYPE_CUEPLAY);
 
 	pCue->start = FAudio_timems();
+	FACT_INTERNAL_ScheduleCue(pCue);
 
 	/* If it's a simple wave, just play it! */
 	if (pCue->simpleWave != NULL)
@@ -2694,6 +3012,7 @@ uint32_t FACTCue_Stop(FACTCue *pCue, uint32_t dwFlags)
 	}
 
 	FACT_INTERNAL_SendCueNotification(pCue, NOTIFY_CUESTOP, FACTNOTIFICATIONTYPE_CUESTOP);
+	FACT_INTERNAL_WakeAPIThread(pCue->parentBank->parentEngine);
 
 	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->apiLock);
 	return 0;
@@ -2777,19 +3096,14 @@ uint16_t FACTCue_GetVariableIndex(
 	{
 		return FACTVARIABLEINDEX_INVALID;
 	}
-	FAudio_PlatformLockMutex(pCue->parentBank->parentEngine->apiLock);
 	for (i = 0; i < pCue->parentBank->parentEngine->variableCount; i += 1)
 	{
 		if (	FAudio_strcmp(szFriendlyName, pCue->parentBank->parentEngine->variableNames[i]) == 0 &&
 			pCue->parentBank->parentEngine->variables[i].accessibility & 0x04	)
 		{
-			FAudio_PlatformUnlockMutex(
-				pCue->parentBank->parentEngine->apiLock
-			);
 			return i;
 		}
 	}
-	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->apiLock);
 	return FACTVARIABLEINDEX_INVALID;
 }
 
@@ -2809,7 +3123,8 @@ uint32_t FACTCue_SetVariable(
 		return 1;
 	}
 
-	FAudio_PlatformLockMutex(pCue->parentBank->parentEngine->apiLock);
+	/* Variables have their own lock, no need to wait for the API thread */
+	FAudio_PlatformLockMutex(pCue->parentBank->parentEngine->varLock);
 
 	var = &pCue->parentBank->parentEngine->variables[nIndex];
 	FAudio_assert(var->accessibility & 0x01);
@@ -2820,8 +3135,9 @@ uint32_t FACTCue_SetVariable(
 		var->minValue,
 		var->maxValue
 	);
+	pCue->variablesDirty = 1;
 
-	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->apiLock);
+	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->varLock);
 	return 0;
 }
 
@@ -2842,7 +3158,7 @@ uint32_t FACTCue_GetVariable(
 		return 1;
 	}
 
-	FAudio_PlatformLockMutex(pCue->parentBank->parentEngine->apiLock);
+	FAudio_PlatformLockMutex(pCue->parentBank->parentEngine->varLock);
 
 	var = &pCue->parentBank->parentEngine->variables[nIndex];
 	FAudio_assert(var->accessibility & 0x01);
@@ -2857,7 +3173,7 @@ uint32_t FACTCue_GetVariable(
 		*nValue = pCue->variableValues[nIndex];
 	}
 
-	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->apiLock);
+	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->varLock);
 	return 0;
 }
 
@@ -2911,6 +3227,7 @@ uint32_t FACTCue_Pause(FACTCue *pCue, int32_t fPause)
 			}
 		}
 	}
+	FACT_INTERNAL_WakeAPIThread(pCue->parentBank->parentEngine);
 
 	FAudio_PlatformUnlockMutex(pCue->parentBank->parentEngine->apiLock);
 	return 0;
@@ -25,6 +25,7 @@
  */
 
 #include "FACT3D.h"
+#include "FACT_internal.h"
 
 uint32_t FACT3DInitialize(
 	FACTAudioEngine *pEngine,
@@ -169,4 +170,134 @@ uint32_t FACT3DApply(
 	return 0;
 }
 
+/* FACT3DBatchEXT */
+
+/* Fewer pairs than this per thread aren't worth the wakeup */
+#define FACT3D_MIN_PAIRS_PER_WORKER 16
+
+typedef struct FACT3DBatchJob
+{
+	uint8_t *instance;
+	const F3DAUDIO_LISTENER *listener;
+	FACT3DCueEmitterEXT *pairs;
+} FACT3DBatchJob;
+
+static void FACT3D_INTERNAL_CalculateJob(
+	void *data,
+	uint32_t start,
+	uint32_t end
+) {
+	FACT3DBatchJob *job = (FACT3DBatchJob*) data;
+	F3DAUDIO_EMITTER emitter;
+	uint32_t i;
+
+	for (i = start; i < end; i += 1)
+	{
+		if (job->pairs[i].pEmitter == NULL)
+		{
+			continue;
+		}
+
+		/* FACT3DCalculate fills in defaults on the emitter it's given,
+		 * and pairs may share an emitter across threads, so it only
+		 * gets to write to a copy.
+		 */
+		emitter = *job->pairs[i].pEmitter;
+		FACT3DCalculate(
+			job->instance,
+			job->listener,
+			&emitter,
+			job->pairs[i].pDSPSettings
+		);
+	}
+}
+
+uint32_t FACT3DCalculateApplyBatchEXT(
+	FACTAudioEngine *pEngine,
+	F3DAUDIO_HANDLE F3DInstance,
+	const F3DAUDIO_LISTENER *pListener,
+	FACT3DCueEmitterEXT *pCueEmitters,
+	uint32_t cueEmitterCount
+) {
+	FACT3DBatchJob job;
+	F3DAUDIO_DSP_SETTINGS *settings;
+	FACTCue *cue = NULL;
+	uint16_t distance, doppler, orientation;
+	uint32_t i;
+
+	if (	pEngine == NULL ||
+		pListener == NULL ||
+		pCueEmitters == NULL ||
+		cueEmitterCount == 0	)
+	{
+		return 0;
+	}
+
+	/* The math touches nothing but the pairs, so no engine locks yet */
+	job.instance = F3DInstance;
+	job.listener = pListener;
+	job.pairs = pCueEmitters;
+	FACT_INTERNAL_ParallelFor(
+		pEngine,
+		FACT3D_INTERNAL_CalculateJob,
+		&job,
+		cueEmitterCount,
+		FACT3D_MIN_PAIRS_PER_WORKER
+	);
+
+	/* Cue variables are engine-wide, so the FACT3DApply lookups only need
+	 * to happen once for the whole batch.
+	 */
+	for (i = 0; i < cueEmitterCount && cue == NULL; i += 1)
+	{
+		cue = pCueEmitters[i].pCue;
+	}
+	if (cue == NULL)
+	{
+		return 0;
+	}
+	distance = FACTCue_GetVariableIndex(cue, "Distance");
+	doppler = FACTCue_GetVariableIndex(cue, "DopplerPitchScalar");
+	orientation = FACTCue_GetVariableIndex(cue, "OrientationAngle");
+
+	/* Same calls as FACT3DApply, with both locks held for the batch */
+	FAudio_PlatformLockMutex(pEngine->apiLock);
+	FAudio_PlatformLockMutex(pEngine->varLock);
+	for (i = 0; i < cueEmitterCount; i += 1)
+	{
+		cue = pCueEmitters[i].pCue;
+		settings = pCueEmitters[i].pDSPSettings;
+		if (cue == NULL || settings == NULL)
+		{
+			continue;
+		}
+		FAudio_assert(cue->parentBank->parentEngine == pEngine);
+
+		FACTCue_SetMatrixCoefficients(
+			cue,
+			settings->SrcChannelCount,
+			settings->DstChannelCount,
+			settings->pMatrixCoefficients
+		);
+		FACTCue_SetVariable(
+			cue,
+			distance,
+			settings->EmitterToListenerDistance
+		);
+		FACTCue_SetVariable(
+			cue,
+			doppler,
+			settings->DopplerFactor
+		);
+		FACTCue_SetVariable(
+			cue,
+			orientation,
+			settings->EmitterToListenerAngle * (180.0f / F3DAUDIO_PI)
+		);
+	}
+	FAudio_PlatformUnlockMutex(pEngine->varLock);
+	FAudio_PlatformUnlockMutex(pEngine->apiLock);
+	return 0;
+}
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
@@ -302,6 +302,7 @@ void FACT_INTERNAL_GetNextWave(
 		&trackInst->upcomingWave.wave
 	);
 	trackInst->upcomingWave.wave->parentCue = cue;
+	trackInst->upcomingWave.fadeType = 0;
 	if (sound->dspCodeCount > 0) /* Never more than 1...? */
 	{
 		reverbDesc[0].Flags = 0;
@@ -485,6 +486,142 @@ void FACT_INTERNAL_GetNextWave(
 	}
 }
 
+/* SoundInstance blocks hold the instance, then the tracks, then all the
+ * tracks' events, so one block covers a whole Sound.
+ */
+#define FACT_POOL_ALIGN(x) (((x) + 7) & ~((size_t) 7))
+#define FACT_SOUND_POOL_PREALLOC 16
+
+static size_t FACT_INTERNAL_SoundBlockSize(FACTSound *sound)
+{
+	uint8_t i;
+	size_t size = FACT_POOL_ALIGN(sizeof(FACTSoundInstance));
+	size += FACT_POOL_ALIGN(sizeof(FACTTrackInstance) * sound->trackCount);
+	for (i = 0; i < sound->trackCount; i += 1)
+	{
+		size += FACT_POOL_ALIGN(
+			sizeof(FACTEventInstance) * sound->tracks[i].eventCount
+		);
+	}
+	return size;
+}
+
+void FACT_INTERNAL_GrowSoundPool(FACTAudioEngine *engine, FACTSoundBank *sb)
+{
+	uint16_t i;
+	size_t size, blockSize = engine->soundPoolBlockSize;
+	FACTSoundInstance *block;
+
+	for (i = 0; i < sb->soundCount; i += 1)
+	{
+		size = FACT_INTERNAL_SoundBlockSize(&sb->sounds[i]);
+		if (size > blockSize)
+		{
+			blockSize = size;
+		}
+	}
+	if (blockSize == engine->soundPoolBlockSize)
+	{
+		return;
+	}
+
+	/* The old blocks are too small now. Blocks still in use get freed
+	 * when their Sound is destroyed, since their blockSize won't match.
+	 */
+	FACT_INTERNAL_FreeSoundPool(engine);
+	engine->soundPoolBlockSize = (uint32_t) blockSize;
+	for (i = 0; i < FACT_SOUND_POOL_PREALLOC; i += 1)
+	{
+		block = (FACTSoundInstance*) engine->pMalloc(blockSize);
+		block->blockSize = (uint32_t) blockSize;
+		block->poolNext = engine->soundPool;
+		engine->soundPool = block;
+	}
+}
+
+void FACT_INTERNAL_FreeSoundPool(FACTAudioEngine *engine)
+{
+	FACTSoundInstance *block;
+	while (engine->soundPool != NULL)
+	{
+		block = engine->soundPool;
+		engine->soundPool = block->poolNext;
+		engine->pFree(block);
+	}
+}
+
+static FACTSoundInstance* FACT_INTERNAL_AllocSoundInstance(
+	FACTAudioEngine *engine,
+	FACTSound *sound
+) {
+	uint8_t i;
+	uint8_t *ptr;
+	FACTSoundInstance *result;
+
+	FAudio_assert(FACT_INTERNAL_SoundBlockSize(sound) <= engine->soundPoolBlockSize);
+	if (engine->soundPool != NULL)
+	{
+		result = engine->soundPool;
+		engine->soundPool = result->poolNext;
+	}
+	else
+	{
+		result = (FACTSoundInstance*) engine->pMalloc(
+			engine->soundPoolBlockSize
+		);
+		result->blockSize = engine->soundPoolBlockSize;
+	}
+	result->poolNext = NULL;
+
+	ptr = (uint8_t*) result + FACT_POOL_ALIGN(sizeof(FACTSoundInstance));
+	result->tracks = (FACTTrackInstance*) ptr;
+	ptr += FACT_POOL_ALIGN(sizeof(FACTTrackInstance) * sound->trackCount);
+	for (i = 0; i < sound->trackCount; i += 1)
+	{
+		result->tracks[i].events = (FACTEventInstance*) ptr;
+		ptr += FACT_POOL_ALIGN(
+			sizeof(FACTEventInstance) * sound->tracks[i].eventCount
+		);
+	}
+	return result;
+}
+
+static void FACT_INTERNAL_FreeSoundInstance(
+	FACTAudioEngine *engine,
+	FACTSoundInstance *sound
+) {
+	if (sound->blockSize == engine->soundPoolBlockSize)
+	{
+		sound->poolNext = engine->soundPool;
+		engine->soundPool = sound;
+	}
+	else
+	{
+		engine->pFree(sound);
+	}
+}
+
+#undef FACT_POOL_ALIGN
+
+static uint8_t FACT_INTERNAL_HasTimeRPC(
+	FACTAudioEngine *engine,
+	uint8_t codeCount,
+	uint32_t *codes
+) {
+	FACTRPC *rpc;
+	uint8_t i;
+	for (i = 0; i < codeCount; i += 1)
+	{
+		rpc = FACT_INTERNAL_GetRPC(engine, codes[i]);
+		if (	rpc->variable == engine->attackTimeVariable ||
+			rpc->variable == engine->releaseTimeVariable	)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
 uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 {
 	int32_t i, j, k;
@@ -728,8 +865,9 @@ uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 			category->instanceCount += 1;
 		}
 
-		newSound = (FACTSoundInstance*) cue->parentBank->parentEngine->pMalloc(
-			sizeof(FACTSoundInstance)
+		newSound = FACT_INTERNAL_AllocSoundInstance(
+			cue->parentBank->parentEngine,
+			baseSound
 		);
 		newSound->parentCue = cue;
 		newSound->sound = baseSound;
@@ -749,9 +887,6 @@ uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 			newSound->fadeStart = 0;
 			newSound->fadeTarget = 0;
 		}
-		newSound->tracks = (FACTTrackInstance*) cue->parentBank->parentEngine->pMalloc(
-			sizeof(FACTTrackInstance) * newSound->sound->trackCount
-		);
 		for (i = 0; i < newSound->sound->trackCount; i += 1)
 		{
 			newSound->tracks[i].rpcData.rpcVolume = 0.0f;
@@ -768,15 +903,14 @@ uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 			newSound->tracks[i].activeWave.basePitch = 0;
 			newSound->tracks[i].activeWave.baseQFactor = FAUDIO_DEFAULT_FILTER_ONEOVERQ;
 			newSound->tracks[i].activeWave.baseFrequency = FAUDIO_DEFAULT_FILTER_FREQUENCY;
+			newSound->tracks[i].activeWave.fadeType = 0;
 			newSound->tracks[i].upcomingWave.wave = NULL;
 			newSound->tracks[i].upcomingWave.baseVolume = 0.0f;
 			newSound->tracks[i].upcomingWave.basePitch = 0;
 			newSound->tracks[i].upcomingWave.baseQFactor = FAUDIO_DEFAULT_FILTER_ONEOVERQ;
 			newSound->tracks[i].upcomingWave.baseFrequency = FAUDIO_DEFAULT_FILTER_FREQUENCY;
+			newSound->tracks[i].upcomingWave.fadeType = 0;
 
-			newSound->tracks[i].events = (FACTEventInstance*) cue->parentBank->parentEngine->pMalloc(
-				sizeof(FACTEventInstance) * newSound->sound->tracks[i].eventCount
-			);
 			for (j = 0; j < newSound->sound->tracks[i].eventCount; j += 1)
 			{
 				evt = &newSound->sound->tracks[i].events[j];
@@ -844,6 +978,24 @@ uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 			}
 		}
 
+		/* Time-based RPCs change on every update, the rest only
+		 * when their variables do
+		 */
+		newSound->rpcDirty = 1;
+		newSound->timeRPCs = FACT_INTERNAL_HasTimeRPC(
+			cue->parentBank->parentEngine,
+			newSound->sound->rpcCodeCount,
+			newSound->sound->rpcCodes
+		);
+		for (i = 0; i < newSound->sound->trackCount; i += 1)
+		{
+			newSound->timeRPCs |= FACT_INTERNAL_HasTimeRPC(
+				cue->parentBank->parentEngine,
+				newSound->sound->tracks[i].rpcCodeCount,
+				newSound->sound->tracks[i].rpcCodes
+			);
+		}
+
 		/* Calculate Max RPC Release Time */
 		cue->maxRpcReleaseTime = 0;
 		for (i = 0; i < newSound->sound->trackCount; i += 1)
@@ -857,10 +1009,8 @@ uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS)
 				if (	rpc->parameter == RPC_PARAMETER_VOLUME &&
 					cue->parentBank->parentEngine->variables[rpc->variable].accessibility & 0x04	)
 				{
-					if (FAudio_strcmp(
-						newSound->parentCue->parentBank->parentEngine->variableNames[rpc->variable],
-						"ReleaseTime"
-					) == 0) {
+					if (rpc->variable == cue->parentBank->parentEngine->releaseTimeVariable)
+					{
 						lastX = rpc->points[rpc->pointCount - 1].x;
 						if (lastX > cue->maxRpcReleaseTime)
 						{
@@ -912,11 +1062,7 @@ void FACT_INTERNAL_DestroySound(FACTSoundInstance *sound)
 				sound->tracks[i].upcomingWave.wave
 			);
 		}
-		sound->parentCue->parentBank->parentEngine->pFree(
-			sound->tracks[i].events
-		);
 	}
-	sound->parentCue->parentBank->parentEngine->pFree(sound->tracks);
 
 	if (sound->sound->category != FACTCATEGORY_INVALID)
 	{
@@ -933,7 +1079,10 @@ void FACT_INTERNAL_DestroySound(FACTSoundInstance *sound)
 
 		FACT_INTERNAL_SendCueNotification(sound->parentCue, NOTIFY_CUESTOP, FACTNOTIFICATIONTYPE_CUESTOP);
 	}
-	sound->parentCue->parentBank->parentEngine->pFree(sound);
+	FACT_INTERNAL_FreeSoundInstance(
+		sound->parentCue->parentBank->parentEngine,
+		sound
+	);
 }
 
 void FACT_INTERNAL_BeginFadeOut(FACTSoundInstance *sound, uint16_t fadeOutMS)
@@ -1053,6 +1202,87 @@ float FACT_INTERNAL_CalculateRPC(
 	return result;
 }
 
+/* CalculateRPC is exact but slow (linear search, pow), so at parse time we
+ * sample each curve into a table and the API thread just interpolates.
+ */
+void FACT_INTERNAL_BuildRPCTable(FACTAudioEngine *engine, FACTRPC *rpc)
+{
+	float range;
+	uint32_t i;
+
+	range = rpc->points[rpc->pointCount - 1].x - rpc->points[0].x;
+	if (range <= 0.0f)
+	{
+		/* Flat, CalculateRPC returns the first point for everything */
+		rpc->tableStart = 0.0f;
+		rpc->tableScale = 0.0f;
+		rpc->table = NULL;
+		return;
+	}
+
+	rpc->tableStart = rpc->points[0].x;
+	rpc->tableScale = FACT_RPC_TABLE_SIZE / range;
+	rpc->table = (float*) engine->pMalloc(
+		sizeof(float) * (FACT_RPC_TABLE_SIZE + 1)
+	);
+	for (i = 0; i <= FACT_RPC_TABLE_SIZE; i += 1)
+	{
+		rpc->table[i] = FACT_INTERNAL_CalculateRPC(
+			rpc,
+			rpc->tableStart + (i * range / FACT_RPC_TABLE_SIZE)
+		);
+	}
+}
+
+static inline float FACT_INTERNAL_EvaluateRPC(const FACTRPC *rpc, float var)
+{
+	float pos, frac;
+	uint32_t idx;
+
+	if (rpc->table == NULL)
+	{
+		return rpc->points[0].y;
+	}
+
+	/* Written so that NaN lands on the first point, too */
+	pos = (var - rpc->tableStart) * rpc->tableScale;
+	if (!(pos > 0.0f))
+	{
+		return rpc->table[0];
+	}
+	if (pos >= FACT_RPC_TABLE_SIZE)
+	{
+		return rpc->table[FACT_RPC_TABLE_SIZE];
+	}
+	idx = (uint32_t) pos;
+	frac = pos - idx;
+	return rpc->table[idx] + (
+		(rpc->table[idx + 1] - rpc->table[idx]) * frac
+	);
+}
+
+void FACT_INTERNAL_FindTimeVariables(FACTAudioEngine *engine)
+{
+	uint16_t i;
+	engine->attackTimeVariable = FACTVARIABLEINDEX_INVALID;
+	engine->releaseTimeVariable = FACTVARIABLEINDEX_INVALID;
+	for (i = 0; i < engine->variableCount; i += 1)
+	{
+		if (!(engine->variables[i].accessibility & 0x04))
+		{
+			continue;
+		}
+		if (FAudio_strcmp(engine->variableNames[i], "AttackTime") == 0)
+		{
+			engine->attackTimeVariable = i;
+		}
+		else if (FAudio_strcmp(engine->variableNames[i], "ReleaseTime") == 0)
+		{
+			engine->releaseTimeVariable = i;
+		}
+	}
+}
+
 void FACT_INTERNAL_UpdateRPCs(
 	FACTCue *cue,
 	uint8_t codeCount,
@@ -1081,16 +1311,12 @@ void FACT_INTERNAL_UpdateRPCs(
 			);
 			if (engine->variables[rpc->variable].accessibility & 0x04)
 			{
-				if (FAudio_strcmp(
-					engine->variableNames[rpc->variable],
-					"AttackTime"
-				) == 0) {
+				if (rpc->variable == engine->attackTimeVariable)
+				{
 					variableValue = (float) elapsedTrack;
 				}
-				else if (FAudio_strcmp(
-					engine->variableNames[rpc->variable],
-					"ReleaseTime"
-				) == 0) {
+				else if (rpc->variable == engine->releaseTimeVariable)
+				{
 					if (cue->playingSound->fadeType == 3) /* Release RPC */
 					{
 						variableValue = (float) (timestamp - cue->playingSound->fadeStart);
@@ -1102,19 +1328,24 @@ void FACT_INTERNAL_UpdateRPCs(
 				}
 				else
 				{
+					FAudio_PlatformLockMutex(engine->varLock);
 					variableValue = cue->variableValues[rpc->variable];
+					FAudio_PlatformUnlockMutex(engine->varLock);
 				}
 
-				rpcResult = FACT_INTERNAL_CalculateRPC(
+				rpcResult = FACT_INTERNAL_EvaluateRPC(
 					rpc,
 					variableValue
 				);
 			}
 			else
 			{
-				rpcResult = FACT_INTERNAL_CalculateRPC(
+				FAudio_PlatformLockMutex(engine->varLock);
+				variableValue = engine->globalVariableValues[rpc->variable];
+				FAudio_PlatformUnlockMutex(engine->varLock);
+				rpcResult = FACT_INTERNAL_EvaluateRPC(
 					rpc,
-					engine->globalVariableValues[rpc->variable]
+					variableValue
 				);
 			}
 			if (rpc->parameter == RPC_PARAMETER_VOLUME)
@@ -1156,7 +1387,19 @@ void FACT_INTERNAL_UpdateEngine(FACTAudioEngine *engine)
 {
 	FAudioFXReverbParameters rvbPar;
 	uint16_t i, j, par;
-	float rpcResult;
+	float rpcResult, value;
+	uint8_t dirty;
+
+	/* Everything here only depends on the global variables */
+	FAudio_PlatformLockMutex(engine->varLock);
+	dirty = engine->globalVariablesDirty;
+	engine->globalVariablesDirty = 0;
+	FAudio_PlatformUnlockMutex(engine->varLock);
+	if (!dirty)
+	{
+		return;
+	}
+
 	for (i = 0; i < engine->rpcCount; i += 1)
 	{
 		if (engine->rpcs[i].parameter >= RPC_PARAMETER_COUNT)
@@ -1170,9 +1413,12 @@ void FACT_INTERNAL_UpdateEngine(FACTAudioEngine *engine)
 					 * What if there's more than one?
 					 */
 					par = engine->rpcs[i].parameter - RPC_PARAMETER_COUNT;
-					rpcResult = FACT_INTERNAL_CalculateRPC(
+					FAudio_PlatformLockMutex(engine->varLock);
+					value = engine->globalVariableValues[engine->rpcs[i].variable];
+					FAudio_PlatformUnlockMutex(engine->varLock);
+					rpcResult = FACT_INTERNAL_EvaluateRPC(
 						&engine->rpcs[i],
-						engine->globalVariableValues[engine->rpcs[i].variable]
+						value
 					);
 					engine->dspPresets[j].parameters[par].value = FAudio_clamp(
 						rpcResult,
@@ -1455,6 +1701,40 @@ void FACT_INTERNAL_ActivateEvent(
 	evtInst->finished = 1;
 }
 
+/* Instance limiting fades run in the mixer (see FadeVolumeEXT), so they don't
+ * step with our updates. Each Wave gets the rest of the fade once.
+ */
+static void FACT_INTERNAL_FadeWave(
+	FACTSoundInstance *sound,
+	FACTTrackInstance *trackInst,
+	float fadeVolume,
+	uint32_t timestamp
+) {
+	FAudioVoice *voice = trackInst->activeWave.wave->voice;
+	uint32_t elapsed;
+
+	if (	(sound->fadeType != 1 && sound->fadeType != 2) ||
+		trackInst->activeWave.fadeType == sound->fadeType	)
+	{
+		return;
+	}
+
+	/* A Wave that started mid-fade has to catch up first */
+	if (trackInst->activeWave.fadeType == 0)
+	{
+		FAudioVoice_SetFadeVolumeEXT(voice, fadeVolume, 0, 0);
+	}
+
+	elapsed = timestamp - sound->fadeStart;
+	FAudioVoice_SetFadeVolumeEXT(
+		voice,
+		(sound->fadeType == 1) ? 1.0f : 0.0f,
+		(elapsed < sound->fadeTarget) ? (sound->fadeTarget - elapsed) : 0,
+		0
+	);
+	trackInst->activeWave.fadeType = sound->fadeType;
+}
+
 uint8_t FACT_INTERNAL_UpdateSound(FACTSoundInstance *sound, uint32_t timestamp)
 {
 	uint8_t i, j;
@@ -1462,6 +1742,8 @@ uint8_t FACT_INTERNAL_UpdateSound(FACTSoundInstance *sound, uint32_t timestamp)
 	uint32_t elapsedCue;
 	FACTEventInstance *evtInst;
 	FAudioFilterParameters filterParams;
+	FACTCue *cue = sound->parentCue;
+	FACTAudioEngine *engine = cue->parentBank->parentEngine;
 	uint8_t finished = 1;
 
 	/* Instance limiting Fade in/out */
@@ -1515,29 +1797,44 @@ uint8_t FACT_INTERNAL_UpdateSound(FACTSoundInstance *sound, uint32_t timestamp)
 	 */
 	elapsedCue = timestamp - (sound->parentCue->start - sound->parentCue->elapsed);
 
-	/* RPC updates */
-	sound->rpcData.rpcFilterFreq = -1.0f;
-	sound->rpcData.rpcFilterQFactor = -1.0f;
-	FACT_INTERNAL_UpdateRPCs(
-		sound->parentCue,
-		sound->sound->rpcCodeCount,
-		sound->sound->rpcCodes,
-		&sound->rpcData,
-		timestamp,
-		elapsedCue - sound->tracks[0].events[0].timestamp
-	);
-	for (i = 0; i < sound->sound->trackCount; i += 1)
+	/* RPC updates, only when a variable they read has changed. The last
+	 * results stay in rpcData until then.
+	 */
+	FAudio_PlatformLockMutex(engine->varLock);
+	if (	cue->variablesDirty ||
+		cue->globalVariablesVersion != engine->globalVariablesVersion	)
+	{
+		sound->rpcDirty = 1;
+		cue->variablesDirty = 0;
+		cue->globalVariablesVersion = engine->globalVariablesVersion;
+	}
+	FAudio_PlatformUnlockMutex(engine->varLock);
+	if (sound->rpcDirty || sound->timeRPCs)
 	{
-		sound->tracks[i].rpcData.rpcFilterFreq = sound->rpcData.rpcFilterFreq;
-		sound->tracks[i].rpcData.rpcFilterQFactor = sound->rpcData.rpcFilterQFactor;
+		sound->rpcDirty = 0;
+		sound->rpcData.rpcFilterFreq = -1.0f;
+		sound->rpcData.rpcFilterQFactor = -1.0f;
 		FACT_INTERNAL_UpdateRPCs(
 			sound->parentCue,
-			sound->sound->tracks[i].rpcCodeCount,
-			sound->sound->tracks[i].rpcCodes,
-			&sound->tracks[i].rpcData,
+			sound->sound->rpcCodeCount,
+			sound->sound->rpcCodes,
+			&sound->rpcData,
 			timestamp,
-			elapsedCue - sound->sound->tracks[i].events[0].timestamp
+			elapsedCue - sound->tracks[0].events[0].timestamp
 		);
+		for (i = 0; i < sound->sound->trackCount; i += 1)
+		{
+			sound->tracks[i].rpcData.rpcFilterFreq = sound->rpcData.rpcFilterFreq;
+			sound->tracks[i].rpcData.rpcFilterQFactor = sound->rpcData.rpcFilterQFactor;
+			FACT_INTERNAL_UpdateRPCs(
+				sound->parentCue,
+				sound->sound->tracks[i].rpcCodeCount,
+				sound->sound->tracks[i].rpcCodes,
+				&sound->tracks[i].rpcData,
+				timestamp,
+				elapsedCue - sound->sound->tracks[i].events[0].timestamp
+			);
+		}
 	}
 
 	/* Go through each event for each track */
@@ -1604,8 +1901,13 @@ uint8_t FACT_INTERNAL_UpdateSound(FACTSoundInstance *sound, uint32_t timestamp)
 				sound->tracks[i].evtVolume
 			) * sound->parentCue->parentBank->parentEngine->categories[
 				sound->sound->category
-			].currentVolume *
-			fadeVolume
+			].currentVolume
+		);
+		FACT_INTERNAL_FadeWave(
+			sound,
+			&sound->tracks[i],
+			fadeVolume,
+			timestamp
 		);
 		FACTWave_SetPitch(
 			sound->tracks[i].activeWave.wave,
@@ -1703,11 +2005,7 @@ void FACT_INTERNAL_UpdateCue(FACTCue *cue)
 							sound->tracks[i].upcomingWave.wave
 						);
 					}
-					cue->parentBank->parentEngine->pFree(
-						sound->tracks[i].events
-					);
 				}
-				cue->parentBank->parentEngine->pFree(sound->tracks);
 
 				if (sound->sound->category != FACTCATEGORY_INVALID)
 				{
@@ -1715,6 +2013,10 @@ void FACT_INTERNAL_UpdateCue(FACTCue *cue)
 						sound->sound->category
 					].instanceCount -= 1;
 				}
+				FACT_INTERNAL_FreeSoundInstance(
+					cue->parentBank->parentEngine,
+					sound
+				);
 			}
 
 			/* TODO: Reset cue times? Transition tables...?
@@ -1727,1618 +2029,3464 @@ void FACT_INTERNAL_UpdateCue(FACTCue *cue)
 	}
 }
 
-/* FACT Thread */
+/* Virtual Voices
+ *
+ * A virtual Wave keeps "playing" with its source voice stopped, so it costs
+ * nothing in the mixer. We track how many samples it would have played and
+ * resubmit its buffer from that point when it becomes real again. This only
+ * works for in-memory PCM/ADPCM Waves, where we can start a buffer anywhere;
+ * everything else always stays real.
+ */
 
-int32_t FACT_INTERNAL_APIThread(void* enginePtr)
+static inline uint8_t FACT_INTERNAL_CanVirtualize(FACTWave *wave)
 {
-	FACTAudioEngine *engine = (FACTAudioEngine*) enginePtr;
-	LinkedList *sbList;
-	FACTCue *cue, *cBackup;
-	uint32_t timestamp, updateTime;
-
-	/* Needs to match the audio thread priority, or else the scheduler will
-	 * let this thread sit around with a lock while the audio thread spins
-	 * infinitely!
-	 */
-	FAudio_PlatformThreadPriority(FAUDIO_THREAD_PRIORITY_HIGH);
-
-threadstart:
-	FAudio_PlatformLockMutex(engine->apiLock);
-
-	/* We want the timestamp to be uniform across all Cues.
-	 * Oftentimes many Cues are played at once with the expectation
-	 * that they will sync, so give them all the same timestamp
-	 * so all the various actions will go together even if it takes
-	 * an extra millisecond to get through the whole Cue list.
-	 */
-	timestamp = FAudio_timems();
+	return (	!wave->parentBank->streaming && (
+			wave->voice->src.format->wFormatTag == FAUDIO_FORMAT_PCM ||
+			wave->voice->src.format->wFormatTag == FAUDIO_FORMAT_MSADPCM	)	);
+}
 
-	FACT_INTERNAL_UpdateEngine(engine);
+/* Converts samples played (counting loops) into a buffer position and the
+ * number of loops still to go. Returns 0 if the Wave would be done by now.
+ */
+static uint8_t FACT_INTERNAL_GetVirtualPosition(
+	FACTWave *wave,
+	uint64_t played,
+	uint32_t *position,
+	uint8_t *loopsLeft
+) {
+	FACTWaveBankEntry *entry = &wave->parentBank->entries[wave->index];
+	uint64_t loopStart, loopLength, loopEnd, loop;
 
-	sbList = engine->sbList;
-	while (sbList != NULL)
+	if (wave->loopCount == 0)
 	{
-		cue = ((FACTSoundBank*) sbList->entry)->cueList;
-		while (cue != NULL)
-		{
-			FACT_INTERNAL_UpdateCue(cue);
-
-			if (cue->state & FACT_STATE_PAUSED)
-			{
-				cue = cue->next;
-				continue;
-			}
-
-			if (cue->playingSound != NULL)
-			{
-				if (FACT_INTERNAL_UpdateSound(cue->playingSound, timestamp))
-				{
-					FACT_INTERNAL_DestroySound(cue->playingSound);
-				}
-			}
+		*position = (uint32_t) played;
+		*loopsLeft = 0;
+		return played < entry->Duration;
+	}
 
-			/* Destroy if it's done and not user-handled. */
-			if (cue->managed && (cue->state & FACT_STATE_STOPPED))
-			{
-				cBackup = cue->next;
-				FACTCue_Destroy(cue);
-				cue = cBackup;
-			}
-			else
-			{
-				cue = cue->next;
-			}
-		}
-		sbList = sbList->next;
+	/* Same defaults as FAudioSourceVoice_SubmitSourceBuffer */
+	loopStart = entry->LoopRegion.dwStartSample;
+	loopLength = entry->LoopRegion.dwTotalSamples;
+	if (loopLength == 0)
+	{
+		loopLength = entry->Duration - loopStart;
 	}
+	loopEnd = loopStart + loopLength;
 
-	FAudio_PlatformUnlockMutex(engine->apiLock);
+	if (played < loopEnd)
+	{
+		*position = (uint32_t) played;
+		*loopsLeft = wave->loopCount;
+		return 1;
+	}
 
-	if (engine->initialized)
+	/* Loop 1 starts the first time we hit loopEnd */
+	loop = ((played - loopEnd) / loopLength) + 1;
+	if (	wave->loopCount == FAUDIO_LOOP_INFINITE ||
+		loop <= wave->loopCount	)
 	{
-		/* FIXME: 10ms is based on the XAudio2 update time...? */
-		updateTime = FAudio_timems() - timestamp;
-		if (updateTime < 10)
-		{
-			FAudio_sleep(10 - updateTime);
-		}
-		goto threadstart;
+		*position = (uint32_t) (loopStart + ((played - loopEnd) % loopLength));
+		*loopsLeft = (wave->loopCount == FAUDIO_LOOP_INFINITE) ?
+			FAUDIO_LOOP_INFINITE :
+			(uint8_t) (wave->loopCount - loop);
+		return 1;
 	}
 
-	return 0;
+	/* Out of loops, on to the end of the Wave */
+	played -= loopEnd + (wave->loopCount * loopLength);
+	*position = (uint32_t) (loopEnd + played);
+	*loopsLeft = 0;
+	return *position < entry->Duration;
 }
 
-/* FAudio callbacks */
+static void FACT_INTERNAL_VirtualizeWave(FACTWave *wave, uint32_t timestamp)
+{
+	FAudioVoiceState state;
 
-void FACT_INTERNAL_OnBufferEnd(FAudioVoiceCallback *callback, void* pContext)
+	/* Stopping the voice leaves its buffer where it is, we only need
+	 * the position to catch up later
+	 */
+	FAudioSourceVoice_Stop(wave->voice, 0, 0);
+	FAudioSourceVoice_GetState(wave->voice, &state, 0);
+	wave->virtualSamples = state.SamplesPlayed - wave->samplesBase;
+	wave->virtualTime = timestamp;
+	wave->isVirtual = 1;
+	wave->parentBank->parentEngine->virtualVoiceCount += 1;
+}
+
+static void FACT_INTERNAL_DevirtualizeWave(FACTWave *wave)
 {
+	FACTWaveBankEntry *entry = &wave->parentBank->entries[wave->index];
+	FAudioVoiceState state;
 	FAudioBuffer buffer;
-	FAudioBufferWMA bufferWMA;
-	FACTWaveCallback *c = (FACTWaveCallback*) callback;
-	FACTWaveBankEntry *entry;
-	uint32_t end, left, length;
-
-	entry = &c->wave->parentBank->entries[c->wave->index];
+	uint32_t position;
+	uint8_t loopsLeft;
+
+	wave->isVirtual = 0;
+	wave->parentBank->parentEngine->virtualVoiceCount -= 1;
+
+	if (!FACT_INTERNAL_GetVirtualPosition(
+		wave,
+		wave->virtualSamples,
+		&position,
+		&loopsLeft
+	)) {
+		/* Finished while we weren't listening */
+		FACT_INTERNAL_OnStreamEnd(&wave->callback.callback);
+		return;
+	}
 
-	/* Calculate total bytes left in this wave iteration */
-	if (c->wave->loopCount > 0 && entry->LoopRegion.dwTotalSamples > 0)
+	FAudioSourceVoice_FlushSourceBuffers(wave->voice);
+	buffer.Flags = FAUDIO_END_OF_STREAM;
+	buffer.AudioBytes = entry->PlayRegion.dwLength;
+	buffer.pAudioData = FAudio_memptr(
+		wave->parentBank->io,
+		entry->PlayRegion.dwOffset
+	);
+	buffer.PlayBegin = position;
+	buffer.PlayLength = entry->Duration - position;
+	if (loopsLeft == 0)
 	{
-		length = entry->LoopRegion.dwStartSample + entry->LoopRegion.dwTotalSamples;
-		if (entry->Format.wFormatTag == 0x0)
-		{
-			length = (
-				length *
-				entry->Format.nChannels *
-				(1 << entry->Format.wBitsPerSample)
-			);
-		}
-		else if (entry->Format.wFormatTag == 0x2)
-		{
-			length = (
-				length /
-				/* wSamplesPerBlock */
-				((entry->Format.wBlockAlign + 16) * 2) *
-				/* nBlockAlign */
-				((entry->Format.wBlockAlign + 22) * entry->Format.nChannels)
-			);
-		}
-		else
-		{
-			length = entry->PlayRegion.dwLength;
-		}
+		buffer.LoopBegin = 0;
+		buffer.LoopLength = 0;
+		buffer.LoopCount = 0;
 	}
 	else
 	{
-		length = entry->PlayRegion.dwLength;
+		/* PlayBegin may be inside the loop, which is fine */
+		buffer.LoopBegin = entry->LoopRegion.dwStartSample;
+		buffer.LoopLength = entry->LoopRegion.dwTotalSamples;
+		buffer.LoopCount = loopsLeft;
 	}
-	end = entry->PlayRegion.dwOffset + length;
-	left = length - (c->wave->streamOffset - entry->PlayRegion.dwOffset);
+	buffer.pContext = NULL;
+	FAudioSourceVoice_SubmitSourceBuffer(wave->voice, &buffer, NULL);
 
-	/* Don't bother if we're EOS or the Wave has stopped */
-	if (	(c->wave->streamOffset >= end) ||
-		(c->wave->state & FACT_STATE_STOPPED)	)
+	/* Keep SamplesPlayed - samplesBase counting from where we left off */
+	FAudioSourceVoice_GetState(wave->voice, &state, 0);
+	wave->samplesBase = state.SamplesPlayed - wave->virtualSamples;
+
+	if (!(wave->state & FACT_STATE_PAUSED))
+	{
+		FAudioSourceVoice_Start(wave->voice, 0, 0);
+	}
+}
+
+static void FACT_INTERNAL_AdvanceVirtualWave(FACTWave *wave, uint32_t timestamp)
+{
+	FACTWaveBankEntry *entry = &wave->parentBank->entries[wave->index];
+	uint32_t position;
+	uint8_t loopsLeft;
+	double rate;
+
+	if (!(wave->state & FACT_STATE_PAUSED))
+	{
+		rate = (
+			entry->Format.nSamplesPerSec *
+			FAudio_pow(2.0, wave->pitch / 1200.0)
+		);
+		wave->virtualSamples += (uint64_t) (
+			(timestamp - wave->virtualTime) * rate / 1000.0
+		);
+	}
+	wave->virtualTime = timestamp;
+
+	if (!FACT_INTERNAL_GetVirtualPosition(
+		wave,
+		wave->virtualSamples,
+		&position,
+		&loopsLeft
+	)) {
+		wave->isVirtual = 0;
+		wave->parentBank->parentEngine->virtualVoiceCount -= 1;
+		FACT_INTERNAL_OnStreamEnd(&wave->callback.callback);
+	}
+}
+
+/* The mixer only moves a fade while the voice plays, so a virtual Wave's
+ * fade is stuck where it stopped. Ask the Sound's clock instead.
+ */
+static float FACT_INTERNAL_GetFadeVolume(
+	FACTSoundInstance *sound,
+	uint32_t timestamp
+) {
+	uint32_t elapsed;
+
+	if (sound == NULL || (sound->fadeType != 1 && sound->fadeType != 2))
+	{
+		return 1.0f;
+	}
+	elapsed = timestamp - sound->fadeStart;
+	if (elapsed >= sound->fadeTarget)
+	{
+		return (sound->fadeType == 1) ? 1.0f : 0.0f;
+	}
+	if (sound->fadeType == 1) /* Fade In */
+	{
+		return (float) elapsed / (float) sound->fadeTarget;
+	}
+	return 1.0f - ((float) elapsed / (float) sound->fadeTarget);
+}
+
+static void FACT_INTERNAL_AddVoiceCandidate(
+	FACTAudioEngine *engine,
+	uint32_t *count,
+	FACTWave *wave,
+	FACTSoundInstance *sound,
+	FACTTrackInstance *track,
+	uint8_t priority,
+	uint32_t timestamp
+) {
+	FACTVoiceCandidate *c;
+	if (	wave == NULL ||
+		!(wave->state & FACT_STATE_PLAYING) ||
+		(wave->state & FACT_STATE_STOPPED)	)
 	{
 		return;
 	}
+	if (*count == engine->voiceCandidateCapacity)
+	{
+		engine->voiceCandidateCapacity = FAudio_max(
+			engine->voiceCandidateCapacity * 2,
+			64
+		);
+		engine->voiceCandidates = (FACTVoiceCandidate*) engine->pRealloc(
+			engine->voiceCandidates,
+			sizeof(FACTVoiceCandidate) * engine->voiceCandidateCapacity
+		);
+	}
+	c = &engine->voiceCandidates[*count];
+	c->wave = wave;
+	c->sound = sound;
+	c->track = track;
+	c->fadeVolume = FACT_INTERNAL_GetFadeVolume(sound, timestamp);
+	c->volume = wave->volume * c->fadeVolume;
+	c->priority = priority;
+	c->canVirtualize = FACT_INTERNAL_CanVirtualize(wave);
+	*count += 1;
+}
 
-	/* Assign buffer memory */
-	buffer.pAudioData = c->wave->streamCache;
-	buffer.AudioBytes = FAudio_min(
-		c->wave->streamSize,
-		left
-	);
+uint32_t FACT_INTERNAL_UpdateVirtualVoices(
+	FACTAudioEngine *engine,
+	uint32_t timestamp
+) {
+	FACTVoiceCandidate tmp, *c;
+	FACTCue *cue;
+	uint32_t i, j, count, real;
+	uint8_t keep, priority;
 
-	/* Read! */
-	FACT_INTERNAL_ReadFile(
-		c->wave->parentBank->parentEngine->pReadFile,
-		c->wave->parentBank->parentEngine->pGetOverlappedResult,
-		c->wave->parentBank->io,
-		c->wave->streamOffset,
-		c->wave->parentBank->packetSize,
-		&c->wave->parentBank->packetBuffer,
-		&c->wave->parentBank->packetBufferLen,
-		c->wave->parentBank->parentEngine->pRealloc,
-		c->wave->streamCache,
-		buffer.AudioBytes
-	);
-	c->wave->streamOffset += buffer.AudioBytes;
+	if (!engine->virtualVoicesEnabled && engine->virtualVoiceCount == 0)
+	{
+		return FAUDIO_WAIT_INFINITE;
+	}
 
-	/* Last buffer in the stream? */
-	buffer.Flags = 0;
-	if (c->wave->streamOffset >= end)
+	/* Gather every playing Wave */
+	count = 0;
+	for (cue = engine->activeCues; cue != NULL; cue = cue->activeNext)
 	{
-		/* Loop if applicable */
-		if (c->wave->loopCount > 0)
+		FACT_INTERNAL_AddVoiceCandidate(
+			engine,
+			&count,
+			cue->simpleWave,
+			NULL,
+			NULL,
+			0,
+			timestamp
+		);
+		if (cue->playingSound == NULL)
 		{
-			if (c->wave->loopCount != 255)
-			{
-				c->wave->loopCount -= 1;
-			}
-			c->wave->streamOffset = entry->PlayRegion.dwOffset;
+			continue;
+		}
+		priority = cue->playingSound->sound->priority;
+		for (i = 0; i < cue->playingSound->sound->trackCount; i += 1)
+		{
+			FACT_INTERNAL_AddVoiceCandidate(
+				engine,
+				&count,
+				cue->playingSound->tracks[i].activeWave.wave,
+				cue->playingSound,
+				&cue->playingSound->tracks[i],
+				priority,
+				timestamp
+			);
+		}
+	}
 
-			/* Loop start */
-			if (entry->Format.wFormatTag == 0x0)
-			{
-				c->wave->streamOffset += (
-					entry->LoopRegion.dwStartSample *
-					entry->Format.nChannels *
-					(1 << entry->Format.wBitsPerSample)
-				);
-			}
-			else if (entry->Format.wFormatTag == 0x2)
+	/* Most important first: priority, then loudness. Insertion sort is
+	 * fine, this list is about as long as the voice budget.
+	 */
+	for (i = 1; i < count; i += 1)
+	{
+		tmp = engine->voiceCandidates[i];
+		j = i;
+		while (	j > 0 && (
+			engine->voiceCandidates[j - 1].priority < tmp.priority || (
+			engine->voiceCandidates[j - 1].priority == tmp.priority &&
+			engine->voiceCandidates[j - 1].volume < tmp.volume	))	)
+		{
+			engine->voiceCandidates[j] = engine->voiceCandidates[j - 1];
+			j -= 1;
+		}
+		engine->voiceCandidates[j] = tmp;
+	}
+
+	/* Fill the budget, everything else goes virtual */
+	real = 0;
+	for (i = 0; i < count; i += 1)
+	{
+		c = &engine->voiceCandidates[i];
+		keep = (
+			!engine->virtualVoicesEnabled ||
+			!c->canVirtualize || (
+				c->volume > engine->virtualThreshold &&
+				(engine->maxRealVoices == 0 || real < engine->maxRealVoices)
+			)
+		);
+		if (keep)
+		{
+			real += 1;
+			if (c->wave->isVirtual)
 			{
-				c->wave->streamOffset += (
-					entry->LoopRegion.dwStartSample /
-					/* wSamplesPerBlock */
-					((entry->Format.wBlockAlign + 16) * 2) *
-					/* nBlockAlign */
-					((entry->Format.wBlockAlign + 22) * entry->Format.nChannels)
-				);
+				FACT_INTERNAL_DevirtualizeWave(c->wave);
+
+				/* Pick the fade up from where it is now */
+				if (	c->track != NULL && (
+					c->sound->fadeType == 1 ||
+					c->sound->fadeType == 2	)	)
+				{
+					c->track->activeWave.fadeType = 0;
+					FACT_INTERNAL_FadeWave(
+						c->sound,
+						c->track,
+						c->fadeVolume,
+						timestamp
+					);
+				}
+				else
+				{
+					FAudioVoice_SetFadeVolumeEXT(
+						c->wave->voice,
+						c->fadeVolume,
+						0,
+						0
+					);
+				}
 			}
 		}
+		else if (c->wave->isVirtual)
+		{
+			FACT_INTERNAL_AdvanceVirtualWave(c->wave, timestamp);
+		}
 		else
 		{
-			buffer.Flags = FAUDIO_END_OF_STREAM;
+			FACT_INTERNAL_VirtualizeWave(c->wave, timestamp);
 		}
 	}
 
-	/* Unused properties */
-	buffer.PlayBegin = 0;
-	buffer.PlayLength = 0;
-	buffer.LoopBegin = 0;
-	buffer.LoopLength = 0;
-	buffer.LoopCount = 0;
-	buffer.pContext = NULL;
+	/* Virtual Waves still need to notice when they end */
+	return (engine->virtualVoiceCount > 0) ?
+		FACT_API_UPDATE_MS :
+		FAUDIO_WAIT_INFINITE;
+}
 
-	/* Submit, finally. */
-	if (entry->Format.wFormatTag == 0x3)
+/* FACT Thread */
+
+/* The API thread only looks at Cues that are in the engine's active list.
+ * A Cue is added when it starts playing and is dropped by the thread once it
+ * has stopped, so prepared/stopped Cues cost nothing per update. Anything
+ * that changes what the thread needs to do should wake it up.
+ */
+
+void FACT_INTERNAL_WakeAPIThread(FACTAudioEngine *engine)
+{
+	if (engine->apiWake != NULL)
 	{
-		bufferWMA.pDecodedPacketCumulativeBytes =
-			c->wave->parentBank->seekTables[c->wave->index].entries;
-		bufferWMA.PacketCount =
-			c->wave->parentBank->seekTables[c->wave->index].entryCount;
-		FAudioSourceVoice_SubmitSourceBuffer(
-			c->wave->voice,
-			&buffer,
-			&bufferWMA
-		);
+		FAudio_PlatformPostSemaphore(engine->apiWake);
 	}
-	else
+}
+
+void FACT_INTERNAL_ScheduleCue(FACTCue *cue)
+{
+	FACTAudioEngine *engine = cue->parentBank->parentEngine;
+	if (!cue->scheduled)
 	{
-		FAudioSourceVoice_SubmitSourceBuffer(
-			c->wave->voice,
-			&buffer,
-			NULL
-		);
+		cue->scheduled = 1;
+		cue->activeNext = NULL;
+		cue->activePrev = engine->activeCuesTail;
+		if (engine->activeCuesTail != NULL)
+		{
+			engine->activeCuesTail->activeNext = cue;
+		}
+		else
+		{
+			engine->activeCues = cue;
+		}
+		engine->activeCuesTail = cue;
 	}
+	FACT_INTERNAL_WakeAPIThread(engine);
 }
 
-void FACT_INTERNAL_OnStreamEnd(FAudioVoiceCallback *callback)
+void FACT_INTERNAL_UnscheduleCue(FACTCue *cue)
 {
-	FACTWaveCallback *c = (FACTWaveCallback*) callback;
-
-	c->wave->state = FACT_STATE_STOPPED;
-
-	if (	c->wave->parentCue != NULL &&
-		c->wave->parentCue->simpleWave == c->wave	)
+	FACTAudioEngine *engine = cue->parentBank->parentEngine;
+	if (!cue->scheduled)
 	{
-		c->wave->parentCue->state |= FACT_STATE_STOPPED;
-		c->wave->parentCue->state &= ~(
-			FACT_STATE_PLAYING |
-			FACT_STATE_STOPPING
-		);
-		c->wave->parentCue->data->instanceCount -= 1;
+		return;
+	}
+	if (cue->activePrev != NULL)
+	{
+		cue->activePrev->activeNext = cue->activeNext;
+	}
+	else
+	{
+		engine->activeCues = cue->activeNext;
+	}
+	if (cue->activeNext != NULL)
+	{
+		cue->activeNext->activePrev = cue->activePrev;
 	}
+	else
+	{
+		engine->activeCuesTail = cue->activePrev;
+	}
+	cue->activeNext = NULL;
+	cue->activePrev = NULL;
+	cue->scheduled = 0;
 }
 
-/* FAudioIOStream functions */
+/* CueCommandsEXT */
 
-int32_t FACTCALL FACT_INTERNAL_DefaultReadFile(
-	void *hFile,
-	void *buffer,
-	uint32_t nNumberOfBytesToRead,
-	uint32_t *lpNumberOfBytesRead, /* Not referenced! */
-	FACTOverlapped *lpOverlapped
-) {
-	FAudioIOStream *io = (FAudioIOStream*) hFile;
-	lpOverlapped->Internal = (void*) 0x00000103; /* STATUS_PENDING */
-	FAudio_PlatformLockMutex((FAudioMutex) io->lock);
-	io->seek(io->data, (size_t) lpOverlapped->Pointer, FAUDIO_SEEK_SET);
-	lpOverlapped->InternalHigh = (void*) (size_t) (io->read(
-		io->data,
-		buffer,
-		nNumberOfBytesToRead,
-		1
-	) * nNumberOfBytesToRead);
-	FAudio_PlatformUnlockMutex((FAudioMutex) io->lock);
-	lpOverlapped->Internal = 0; /* STATUS_SUCCESS */
-	return 1;
+void FACT_INTERNAL_PurgeCueCommands(FACTAudioEngine *engine, FACTCue *cue)
+{
+	uint32_t i;
+	FAudio_PlatformLockMutex(engine->cmdLock);
+	for (i = 0; i < engine->commandCount; i += 1)
+	{
+		if (engine->commands[i].cue == cue)
+		{
+			engine->commands[i].cue = NULL;
+		}
+	}
+	FAudio_PlatformUnlockMutex(engine->cmdLock);
 }
 
-int32_t FACTCALL FACT_INTERNAL_DefaultGetOverlappedResult(
-	void *hFile,
-	FACTOverlapped *lpOverlapped,
-	uint32_t *lpNumberOfBytesTransferred,
-	int32_t bWait
-) {
-	*lpNumberOfBytesTransferred = (uint32_t) (size_t) lpOverlapped->InternalHigh;
-	return 1;
+static void FACT_INTERNAL_ApplyCueCommands(FACTAudioEngine *engine)
+{
+	FACTCueCommand *cmd;
+	uint32_t i, count, capacity;
+
+	/* Take the whole batch, new submissions go to the other list */
+	FAudio_PlatformLockMutex(engine->cmdLock);
+	count = engine->commandCount;
+	cmd = engine->commands;
+	capacity = engine->commandCapacity;
+	engine->commands = engine->applyCommands;
+	engine->commandCapacity = engine->applyCapacity;
+	engine->commandCount = 0;
+	engine->applyCommands = cmd;
+	engine->applyCapacity = capacity;
+	FAudio_PlatformUnlockMutex(engine->cmdLock);
+
+	for (i = 0; i < count; i += 1, cmd += 1)
+	{
+		if (cmd->cue == NULL)
+		{
+			/* Destroyed before we got to it */
+			continue;
+		}
+		switch (cmd->type)
+		{
+		case FACTCUECOMMAND_SETVARIABLE_EXT:
+			FACTCue_SetVariable(
+				cmd->cue,
+				cmd->variable.index,
+				cmd->variable.value
+			);
+			break;
+		case FACTCUECOMMAND_SETMATRIX_EXT:
+			FACTCue_SetMatrixCoefficients(
+				cmd->cue,
+				cmd->matrix.srcChannels,
+				cmd->matrix.dstChannels,
+				cmd->matrix.coefficients
+			);
+			break;
+		case FACTCUECOMMAND_PLAY_EXT:
+			if (!(cmd->cue->state & (FACT_STATE_PLAYING | FACT_STATE_STOPPING)))
+			{
+				FACTCue_Play(cmd->cue);
+			}
+			break;
+		case FACTCUECOMMAND_STOP_EXT:
+			FACTCue_Stop(cmd->cue, cmd->stopFlags);
+			break;
+		default:
+			FAudio_assert(0 && "Unknown cue command!");
+			break;
+		}
+	}
 }
 
-/* Parsing functions */
+/* Returns how many milliseconds this Cue can go without an update */
+static uint32_t FACT_INTERNAL_GetCueDeadline(FACTCue *cue, uint32_t timestamp)
+{
+	FACTSoundInstance *sound = cue->playingSound;
+	uint32_t elapsedCue, elapsedFade, evtTime, next;
+	uint8_t i, j;
 
-#define READ_FUNC(type, size, bitsize, suffix) \
-	static inline type read_##suffix(uint8_t **ptr, const uint8_t swapendian) \
-	{ \
-		type result = *((type*) *ptr); \
-		*ptr += size; \
-		return swapendian ? \
-			FAudio_swap##bitsize##BE(result) : \
-			FAudio_swap##bitsize##LE(result); \
+	/* Paused Cues don't move, simple waves only need us when they end
+	 * (see OnStreamEnd). Either way, we'll be woken up.
+	 */
+	if (sound == NULL || (cue->state & FACT_STATE_PAUSED))
+	{
+		return FAUDIO_WAIT_INFINITE;
 	}
 
-static inline uint8_t read_u8(uint8_t **ptr)
-{
-	uint8_t result = *((uint8_t*) *ptr);
-	*ptr += 1;
-	return result;
-}
-READ_FUNC(uint16_t, 2, 16, u16)
-READ_FUNC(uint32_t, 4, 32, u32)
-READ_FUNC(int16_t, 2, 16, s16)
-READ_FUNC(int32_t, 4, 32, s32)
-static inline float read_f32(uint8_t **ptr, const uint8_t swapendian)
-{
-	float result = *((float*) *ptr);
-	*ptr += 4;
-	return result;
-}
+	/* Release RPCs, RPCs and interactive variations change every update */
+	if (	((cue->state & FACT_STATE_STOPPING) && sound->fadeType == 0) ||
+		sound->fadeType == 3 ||
+		sound->sound->rpcCodeCount > 0 ||
+		(!(cue->data->flags & 0x04) && cue->variation->flags == 3)	)
+	{
+		return FACT_API_UPDATE_MS;
+	}
 
-#undef READ_FUNC
+	/* Fades run in the mixer, we only finish them off */
+	next = FAUDIO_WAIT_INFINITE;
+	if (sound->fadeType != 0)
+	{
+		elapsedFade = timestamp - sound->fadeStart;
+		next = (elapsedFade < sound->fadeTarget) ?
+			(sound->fadeTarget - elapsedFade) :
+			0;
+	}
 
-static inline float read_volbyte(uint8_t **ptr)
+	/* Otherwise we only need to be around for the next event */
+	elapsedCue = timestamp - (cue->start - cue->elapsed);
+	for (i = 0; i < sound->sound->trackCount; i += 1)
+	{
+		if (sound->sound->tracks[i].rpcCodeCount > 0)
+		{
+			return FACT_API_UPDATE_MS;
+		}
+		for (j = 0; j < sound->sound->tracks[i].eventCount; j += 1)
+		{
+			if (sound->tracks[i].events[j].finished)
+			{
+				continue;
+			}
+			evtTime = sound->tracks[i].events[j].timestamp;
+			if (evtTime <= elapsedCue)
+			{
+				/* Still running, probably a ramp */
+				return FACT_API_UPDATE_MS;
+			}
+			next = FAudio_min(next, evtTime - elapsedCue);
+		}
+	}
+	return next;
+}
+
+int32_t FACT_INTERNAL_APIThread(void* enginePtr)
 {
-	/* FIXME: This magnificent beauty came from Mathematica!
-	 * The byte values for all possible input dB values from the .xap are here:
-	 * http://www.flibitijibibo.com/XACTVolume.txt
-	 * Yes, this is actually what the XACT builder really does.
-	 *
-	 * Thanks to Kenny for plotting all that data.
-	 * -flibit
+	FACTAudioEngine *engine = (FACTAudioEngine*) enginePtr;
+	FACTCue *cue, *cBackup;
+	uint32_t timestamp, updateTime, nextUpdate, deadline;
+
+	/* Needs to match the audio thread priority, or else the scheduler will
+	 * let this thread sit around with a lock while the audio thread spins
+	 * infinitely!
 	 */
-	return (float) ((3969.0 * FAudio_log10(read_u8(ptr) / 28240.0)) + 8715.0);
-}
+	FAudio_PlatformThreadPriority(FAUDIO_THREAD_PRIORITY_HIGH);
 
-uint32_t FACT_INTERNAL_ParseAudioEngine(
-	FACTAudioEngine *pEngine,
-	const FACTRuntimeParameters *pParams
-) {
-	uint32_t	categoryOffset,
-			variableOffset,
-			blob1Offset,
-			categoryNameIndexOffset,
-			blob2Offset,
-			variableNameIndexOffset,
-			categoryNameOffset,
-			variableNameOffset,
-			rpcOffset,
-			dspPresetOffset,
-			dspParameterOffset;
-	uint16_t blob1Count, blob2Count;
-	uint8_t version, tool;
-	uint8_t se;
-	uint32_t magic;
-	size_t memsize;
-	uint16_t i, j;
+threadstart:
+	FAudio_PlatformLockMutex(engine->apiLock);
 
-	uint8_t *ptr = (uint8_t*) pParams->pGlobalSettingsBuffer;
-	uint8_t *start = ptr;
+	/* We want the timestamp to be uniform across all Cues.
+	 * Oftentimes many Cues are played at once with the expectation
+	 * that they will sync, so give them all the same timestamp
+	 * so all the various actions will go together even if it takes
+	 * an extra millisecond to get through the whole Cue list.
+	 */
+	timestamp = FAudio_timems();
 
-	magic = read_u32(&ptr, 0);
-	se = magic == 0x58475346; /* Swap Endian */
-	if (magic != 0x46534758 && magic != 0x58475346) /* 'XGSF' */
-	{
-		return -1; /* TODO: NOT XACT FILE */
-	}
+	FACT_INTERNAL_ApplyCueCommands(engine);
+	FACT_INTERNAL_UpdateEngine(engine);
 
-	if (!FACT_INTERNAL_SupportedContent(read_u16(&ptr, se)))
+	nextUpdate = FAUDIO_WAIT_INFINITE;
+	cue = engine->activeCues;
+	while (cue != NULL)
 	{
-		return -2;
+		FACT_INTERNAL_UpdateCue(cue);
+
+		if (cue->state & FACT_STATE_PAUSED)
+		{
+			cue = cue->activeNext;
+			continue;
+		}
+
+		if (cue->playingSound != NULL)
+		{
+			if (FACT_INTERNAL_UpdateSound(cue->playingSound, timestamp))
+			{
+				FACT_INTERNAL_DestroySound(cue->playingSound);
+			}
+		}
+
+		if (cue->state & FACT_STATE_STOPPED)
+		{
+			/* Destroy if it's done and not user-handled. */
+			cBackup = cue->activeNext;
+			if (cue->managed)
+			{
+				FACTCue_Destroy(cue);
+			}
+			else
+			{
+				FACT_INTERNAL_UnscheduleCue(cue);
+			}
+			cue = cBackup;
+		}
+		else
+		{
+			deadline = FACT_INTERNAL_GetCueDeadline(cue, timestamp);
+			nextUpdate = FAudio_min(nextUpdate, deadline);
+			cue = cue->activeNext;
+		}
 	}
 
-	tool = read_u16(&ptr, se); /* Tool version */
-	if (tool != 42)
+	/* VirtualVoiceEXT */
+	deadline = FACT_INTERNAL_UpdateVirtualVoices(engine, timestamp);
+	nextUpdate = FAudio_min(nextUpdate, deadline);
+
+	FAudio_PlatformUnlockMutex(engine->apiLock);
+
+	if (engine->initialized)
 	{
-		return -3;
+		/* Sleep until something is due or we get poked */
+		updateTime = FAudio_timems() - timestamp;
+		if (nextUpdate != FAUDIO_WAIT_INFINITE)
+		{
+			nextUpdate = (nextUpdate > updateTime) ?
+				(nextUpdate - updateTime) :
+				0;
+		}
+		if (nextUpdate > 0)
+		{
+			FAudio_PlatformWaitSemaphore(engine->apiWake, nextUpdate);
+		}
+
+		/* Many pokes still only need one update */
+		while (FAudio_PlatformWaitSemaphore(engine->apiWake, 0));
+
+		/* ... but one of them may have been ShutDown */
+		if (engine->initialized)
+		{
+			goto threadstart;
+		}
 	}
 
-	ptr += 2; /* Unknown value */
+	return 0;
+}
 
-	/* Last modified, unused */
-	ptr += 8;
+/* Worker Pool */
 
-	/* XACT Version (Windows == 3, Xbox == 7) */
-	version = read_u8(&ptr);
-	if (	version != 3 &&
-		version != 7	)
+/* More threads than this only add wakeup latency for jobs as small as ours */
+#define FACT_MAX_WORKERS 7
+
+static int32_t FAUDIOCALL FACT_INTERNAL_WorkerThread(void *workerPtr)
+{
+	FACTWorker *worker = (FACTWorker*) workerPtr;
+
+	FAudio_PlatformWaitSemaphore(worker->wake, FAUDIO_WAIT_INFINITE);
+	while (!worker->quit)
 	{
-		return -4; /* TODO: VERSION TOO OLD */
+		worker->func(worker->data, worker->start, worker->end);
+		FAudio_PlatformPostSemaphore(worker->done);
+		FAudio_PlatformWaitSemaphore(worker->wake, FAUDIO_WAIT_INFINITE);
 	}
+	return 0;
+}
 
-	/* Object counts */
-	pEngine->categoryCount = read_u16(&ptr, se);
-	pEngine->variableCount = read_u16(&ptr, se);
-	blob1Count = read_u16(&ptr, se);
-	blob2Count = read_u16(&ptr, se);
-	pEngine->rpcCount = read_u16(&ptr, se);
-	pEngine->dspPresetCount = read_u16(&ptr, se);
-	pEngine->dspParameterCount = read_u16(&ptr, se);
+static void FACT_INTERNAL_CreateWorkers(FACTAudioEngine *engine)
+{
+	FACTWorker *worker;
+	uint32_t i, count;
 
-	/* Object offsets */
-	categoryOffset = read_u32(&ptr, se);
-	variableOffset = read_u32(&ptr, se);
-	blob1Offset = read_u32(&ptr, se);
-	categoryNameIndexOffset = read_u32(&ptr, se);
-	blob2Offset = read_u32(&ptr, se);
-	variableNameIndexOffset = read_u32(&ptr, se);
-	categoryNameOffset = read_u32(&ptr, se);
-	variableNameOffset = read_u32(&ptr, se);
-	rpcOffset = read_u32(&ptr, se);
-	dspPresetOffset = read_u32(&ptr, se);
-	dspParameterOffset = read_u32(&ptr, se);
+	/* The calling thread takes a share of every job too */
+	count = FAudio_PlatformGetCPUCount();
+	if (count <= 1)
+	{
+		return;
+	}
+	count = FAudio_min(count - 1, FACT_MAX_WORKERS);
 
-	/* Category data */
-	FAudio_assert((ptr - start) == categoryOffset);
-	pEngine->categories = (FACTAudioCategory*) pEngine->pMalloc(
-		sizeof(FACTAudioCategory) * pEngine->categoryCount
+	engine->workers = (FACTWorker*) engine->pMalloc(
+		sizeof(FACTWorker) * count
 	);
-	for (i = 0; i < pEngine->categoryCount; i += 1)
+	if (engine->workers == NULL)
 	{
-		pEngine->categories[i].instanceLimit = read_u8(&ptr);
-		pEngine->categories[i].fadeInMS = read_u16(&ptr, se);
-		pEngine->categories[i].fadeOutMS = read_u16(&ptr, se);
-		pEngine->categories[i].maxInstanceBehavior = read_u8(&ptr) >> 3;
-		pEngine->categories[i].parentCategory = read_u16(&ptr, se);
-		pEngine->categories[i].volume = FACT_INTERNAL_CalculateAmplitudeRatio(
-			read_volbyte(&ptr)
+		return;
+	}
+	for (i = 0; i < count; i += 1)
+	{
+		worker = &engine->workers[i];
+		FAudio_zero(worker, sizeof(FACTWorker));
+		worker->engine = engine;
+		worker->wake = FAudio_PlatformCreateSemaphore(0);
+		worker->done = FAudio_PlatformCreateSemaphore(0);
+		worker->thread = FAudio_PlatformCreateThread(
+			FACT_INTERNAL_WorkerThread,
+			"FACTWorker",
+			worker
 		);
-		pEngine->categories[i].visibility = read_u8(&ptr);
-		pEngine->categories[i].instanceCount = 0;
-		pEngine->categories[i].currentVolume = 1.0f;
+		if (worker->thread == NULL)
+		{
+			/* Run with whatever we managed to start */
+			FAudio_PlatformDestroySemaphore(worker->wake);
+			FAudio_PlatformDestroySemaphore(worker->done);
+			break;
+		}
+		engine->workerCount += 1;
 	}
+}
 
-	/* Variable data */
-	FAudio_assert((ptr - start) == variableOffset);
-	pEngine->variables = (FACTVariable*) pEngine->pMalloc(
-		sizeof(FACTVariable) * pEngine->variableCount
-	);
-	for (i = 0; i < pEngine->variableCount; i += 1)
+void FACT_INTERNAL_ParallelFor(
+	FACTAudioEngine *engine,
+	FACTJobFunc func,
+	void *data,
+	uint32_t count,
+	uint32_t minPerWorker
+) {
+	FACTWorker *worker;
+	uint32_t i, jobs;
+
+	FAudio_PlatformLockMutex(engine->jobLock);
+
+	if (engine->workers == NULL && count >= minPerWorker * 2)
 	{
-		pEngine->variables[i].accessibility = read_u8(&ptr);
-		pEngine->variables[i].initialValue = read_f32(&ptr, se);
-		pEngine->variables[i].minValue = read_f32(&ptr, se);
-		pEngine->variables[i].maxValue = read_f32(&ptr, se);
+		FACT_INTERNAL_CreateWorkers(engine);
 	}
 
-	/* Global variable storage. Some unused data for non-global vars */
-	pEngine->globalVariableValues = (float*) pEngine->pMalloc(
-		sizeof(float) * pEngine->variableCount
-	);
-	for (i = 0; i < pEngine->variableCount; i += 1)
+	/* Don't wake up workers that would have next to nothing to do */
+	jobs = FAudio_min(engine->workerCount + 1, count / minPerWorker);
+	if (jobs <= 1)
 	{
-		pEngine->globalVariableValues[i] = pEngine->variables[i].initialValue;
+		func(data, 0, count);
+		FAudio_PlatformUnlockMutex(engine->jobLock);
+		return;
 	}
 
-	/* RPC data */
-	if (pEngine->rpcCount > 0)
+	/* Job 0 runs on this thread, the rest go to the workers */
+	for (i = 1; i < jobs; i += 1)
 	{
-		FAudio_assert((ptr - start) == rpcOffset);
-		pEngine->rpcs = (FACTRPC*) pEngine->pMalloc(
-			sizeof(FACTRPC) *
-			pEngine->rpcCount
-		);
-		pEngine->rpcCodes = (uint32_t*) pEngine->pMalloc(
-			sizeof(uint32_t) *
-			pEngine->rpcCount
+		worker = &engine->workers[i - 1];
+		worker->func = func;
+		worker->data = data;
+		worker->start = (uint32_t) (((uint64_t) count * i) / jobs);
+		worker->end = (uint32_t) (((uint64_t) count * (i + 1)) / jobs);
+		FAudio_PlatformPostSemaphore(worker->wake);
+	}
+	func(data, 0, count / jobs);
+	for (i = 1; i < jobs; i += 1)
+	{
+		FAudio_PlatformWaitSemaphore(
+			engine->workers[i - 1].done,
+			FAUDIO_WAIT_INFINITE
 		);
-		for (i = 0; i < pEngine->rpcCount; i += 1)
-		{
-			pEngine->rpcCodes[i] = (uint32_t) (ptr - start);
-			pEngine->rpcs[i].variable = read_u16(&ptr, se);
-			pEngine->rpcs[i].pointCount = read_u8(&ptr);
-			pEngine->rpcs[i].parameter = read_u16(&ptr, se);
-			pEngine->rpcs[i].points = (FACTRPCPoint*) pEngine->pMalloc(
-				sizeof(FACTRPCPoint) *
-				pEngine->rpcs[i].pointCount
-			);
-			for (j = 0; j < pEngine->rpcs[i].pointCount; j += 1)
-			{
-				pEngine->rpcs[i].points[j].x = read_f32(&ptr, se);
-				pEngine->rpcs[i].points[j].y = read_f32(&ptr, se);
-				pEngine->rpcs[i].points[j].type = read_u8(&ptr);
-			}
-		}
 	}
 
-	/* DSP Preset data */
-	if (pEngine->dspPresetCount > 0)
+	FAudio_PlatformUnlockMutex(engine->jobLock);
+}
+
+void FACT_INTERNAL_DestroyWorkers(FACTAudioEngine *engine)
+{
+	FACTWorker *worker;
+	uint32_t i;
+
+	FAudio_PlatformLockMutex(engine->jobLock);
+	for (i = 0; i < engine->workerCount; i += 1)
 	{
-		FAudio_assert((ptr - start) == dspPresetOffset);
-		pEngine->dspPresets = (FACTDSPPreset*) pEngine->pMalloc(
-			sizeof(FACTDSPPreset) *
-			pEngine->dspPresetCount
-		);
-		pEngine->dspPresetCodes = (uint32_t*) pEngine->pMalloc(
-			sizeof(uint32_t) *
-			pEngine->dspPresetCount
-		);
-		for (i = 0; i < pEngine->dspPresetCount; i += 1)
+		worker = &engine->workers[i];
+		worker->quit = 1;
+		FAudio_PlatformPostSemaphore(worker->wake);
+		FAudio_PlatformWaitThread(worker->thread, NULL);
+		FAudio_PlatformDestroySemaphore(worker->wake);
+		FAudio_PlatformDestroySemaphore(worker->done);
+	}
+	if (engine->workers != NULL)
+	{
+		engine->pFree(engine->workers);
+		engine->workers = NULL;
+	}
+	engine->workerCount = 0;
+	FAudio_PlatformUnlockMutex(engine->jobLock);
+}
+
+/* FAudio callbacks */
+
+void FACT_INTERNAL_OnBufferEnd(FAudioVoiceCallback *callback, void* pContext)
+{
+	FAudioBuffer buffer;
+	FAudioBufferWMA bufferWMA;
+	FACTWaveCallback *c = (FACTWaveCallback*) callback;
+	FACTWaveBankEntry *entry;
+	uint32_t end, left, length;
+
+	entry = &c->wave->parentBank->entries[c->wave->index];
+
+	/* Calculate total bytes left in this wave iteration */
+	if (c->wave->loopCount > 0 && entry->LoopRegion.dwTotalSamples > 0)
+	{
+		length = entry->LoopRegion.dwStartSample + entry->LoopRegion.dwTotalSamples;
+		if (entry->Format.wFormatTag == 0x0)
 		{
-			pEngine->dspPresetCodes[i] = (uint32_t) (ptr - start);
-			pEngine->dspPresets[i].accessibility = read_u8(&ptr);
-			pEngine->dspPresets[i].parameterCount = read_u16(&ptr, se);
-			ptr += 2; /* Unknown value */
-			pEngine->dspPresets[i].parameters = (FACTDSPParameter*) pEngine->pMalloc(
-				sizeof(FACTDSPParameter) *
-				pEngine->dspPresets[i].parameterCount
-			); /* This will be filled in just a moment... */
+			length = (
+				length *
+				entry->Format.nChannels *
+				(1 << entry->Format.wBitsPerSample)
+			);
+		}
+		else if (entry->Format.wFormatTag == 0x2)
+		{
+			length = (
+				length /
+				/* wSamplesPerBlock */
+				((entry->Format.wBlockAlign + 16) * 2) *
+				/* nBlockAlign */
+				((entry->Format.wBlockAlign + 22) * entry->Format.nChannels)
+			);
+		}
+		else
+		{
+			length = entry->PlayRegion.dwLength;
 		}
+	}
+	else
+	{
+		length = entry->PlayRegion.dwLength;
+	}
+	end = entry->PlayRegion.dwOffset + length;
+	left = length - (c->wave->streamOffset - entry->PlayRegion.dwOffset);
 
-		/* DSP Parameter data */
-		FAudio_assert((ptr - start) == dspParameterOffset);
-		for (i = 0; i < pEngine->dspPresetCount; i += 1)
+	/* Don't bother if we're EOS or the Wave has stopped */
+	if (	(c->wave->streamOffset >= end) ||
+		(c->wave->state & FACT_STATE_STOPPED)	)
+	{
+		return;
+	}
+
+	/* Assign buffer memory */
+	buffer.pAudioData = c->wave->streamCache;
+	buffer.AudioBytes = FAudio_min(
+		c->wave->streamSize,
+		left
+	);
+
+	/* Read! */
+	FACT_INTERNAL_ReadFile(
+		c->wave->parentBank->parentEngine->pReadFile,
+		c->wave->parentBank->parentEngine->pGetOverlappedResult,
+		c->wave->parentBank->io,
+		c->wave->streamOffset,
+		c->wave->parentBank->packetSize,
+		&c->wave->parentBank->packetBuffer,
+		&c->wave->parentBank->packetBufferLen,
+		c->wave->parentBank->parentEngine->pRealloc,
+		c->wave->streamCache,
+		buffer.AudioBytes
+	);
+	c->wave->streamOffset += buffer.AudioBytes;
+
+	/* Last buffer in the stream? */
+	buffer.Flags = 0;
+	if (c->wave->streamOffset >= end)
+	{
+		/* Loop if applicable */
+		if (c->wave->loopCount > 0)
 		{
-			for (j = 0; j < pEngine->dspPresets[i].parameterCount; j += 1)
+			if (c->wave->loopCount != 255)
 			{
-				pEngine->dspPresets[i].parameters[j].type = read_u8(&ptr);
-				pEngine->dspPresets[i].parameters[j].value = read_f32(&ptr, se);
-				pEngine->dspPresets[i].parameters[j].minVal = read_f32(&ptr, se);
-				pEngine->dspPresets[i].parameters[j].maxVal = read_f32(&ptr, se);
-				pEngine->dspPresets[i].parameters[j].unknown = read_u16(&ptr, se);
+				c->wave->loopCount -= 1;
+			}
+			c->wave->streamOffset = entry->PlayRegion.dwOffset;
+
+			/* Loop start */
+			if (entry->Format.wFormatTag == 0x0)
+			{
+				c->wave->streamOffset += (
+					entry->LoopRegion.dwStartSample *
+					entry->Format.nChannels *
+					(1 << entry->Format.wBitsPerSample)
+				);
+			}
+			else if (entry->Format.wFormatTag == 0x2)
+			{
+				c->wave->streamOffset += (
+					entry->LoopRegion.dwStartSample /
+					/* wSamplesPerBlock */
+					((entry->Format.wBlockAlign + 16) * 2) *
+					/* nBlockAlign */
+					((entry->Format.wBlockAlign + 22) * entry->Format.nChannels)
+				);
 			}
 		}
+		else
+		{
+			buffer.Flags = FAUDIO_END_OF_STREAM;
+		}
 	}
 
-	/* Blob #1, no idea what this is... */
-	FAudio_assert((ptr - start) == blob1Offset);
-	ptr += blob1Count * 2;
-
-	/* Category Name Index data */
-	FAudio_assert((ptr - start) == categoryNameIndexOffset);
-	ptr += pEngine->categoryCount * 6; /* FIXME: index as assert value? */
+	/* Unused properties */
+	buffer.PlayBegin = 0;
+	buffer.PlayLength = 0;
+	buffer.LoopBegin = 0;
+	buffer.LoopLength = 0;
+	buffer.LoopCount = 0;
+	buffer.pContext = NULL;
 
-	/* Category Name data */
-	FAudio_assert((ptr - start) == categoryNameOffset);
-	pEngine->categoryNames = (char**) pEngine->pMalloc(
-		sizeof(char*) *
-		pEngine->categoryCount
-	);
-	for (i = 0; i < pEngine->categoryCount; i += 1)
+	/* Submit, finally. */
+	if (entry->Format.wFormatTag == 0x3)
 	{
-		memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
-		pEngine->categoryNames[i] = (char*) pEngine->pMalloc(memsize);
-		FAudio_memcpy(pEngine->categoryNames[i], ptr, memsize);
-		ptr += memsize;
+		bufferWMA.pDecodedPacketCumulativeBytes =
+			c->wave->parentBank->seekTables[c->wave->index].entries;
+		bufferWMA.PacketCount =
+			c->wave->parentBank->seekTables[c->wave->index].entryCount;
+		FAudioSourceVoice_SubmitSourceBuffer(
+			c->wave->voice,
+			&buffer,
+			&bufferWMA
+		);
+	}
+	else
+	{
+		FAudioSourceVoice_SubmitSourceBuffer(
+			c->wave->voice,
+			&buffer,
+			NULL
+		);
 	}
+}
 
-	/* Blob #2, no idea what this is... */
-	FAudio_assert((ptr - start) == blob2Offset);
-	ptr += blob2Count * 2;
+void FACT_INTERNAL_OnStreamEnd(FAudioVoiceCallback *callback)
+{
+	FACTWaveCallback *c = (FACTWaveCallback*) callback;
 
-	/* Variable Name Index data */
-	FAudio_assert((ptr - start) == variableNameIndexOffset);
-	ptr += pEngine->variableCount * 6; /* FIXME: index as assert value? */
+	c->wave->state = FACT_STATE_STOPPED;
 
-	/* Variable Name data */
-	FAudio_assert((ptr - start) == variableNameOffset);
-	pEngine->variableNames = (char**) pEngine->pMalloc(
-		sizeof(char*) *
-		pEngine->variableCount
-	);
-	for (i = 0; i < pEngine->variableCount; i += 1)
+	if (	c->wave->parentCue != NULL &&
+		c->wave->parentCue->simpleWave == c->wave	)
 	{
-		memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
-		pEngine->variableNames[i] = (char*) pEngine->pMalloc(memsize);
-		FAudio_memcpy(pEngine->variableNames[i], ptr, memsize);
-		ptr += memsize;
+		c->wave->parentCue->state |= FACT_STATE_STOPPED;
+		c->wave->parentCue->state &= ~(
+			FACT_STATE_PLAYING |
+			FACT_STATE_STOPPING
+		);
+		c->wave->parentCue->data->instanceCount -= 1;
 	}
 
-	/* Store this pointer in case we're asked to free it */
-	if (pParams->globalSettingsFlags & FACT_FLAG_MANAGEDATA)
+	/* Track waves move on to the next event, simple waves get cleaned up */
+	FACT_INTERNAL_WakeAPIThread(c->wave->parentBank->parentEngine);
+}
+
+/* Notification Queue
+ *
+ * This is a bounded queue where each slot has a sequence number: a slot
+ * is free for the producer at position N when its sequence is N, and full
+ * for the consumer at position N when its sequence is N + 1. Producers
+ * claim a position by CAS'ing notificationHead, so nobody ever blocks.
+ */
+
+void FACT_INTERNAL_InitNotificationQueue(FACTAudioEngine *engine)
+{
+	int32_t i;
+	for (i = 0; i < FACT_NOTIFICATION_QUEUE_SIZE; i += 1)
 	{
-		pEngine->settings = pParams->pGlobalSettingsBuffer;
+		FAudio_PlatformAtomicSet(&engine->notificationQueue[i].sequence, i);
 	}
-
-	/* Finally. */
-	FAudio_assert((ptr - start) == pParams->globalSettingsBufferSize);
-	return 0;
+	FAudio_PlatformAtomicSet(&engine->notificationHead, 0);
+	FAudio_PlatformAtomicSet(&engine->notificationConsumer, 0);
+	engine->notificationTail = 0;
 }
 
-void FACT_INTERNAL_ParseTrackEvents(
-	uint8_t **ptr,
-	uint8_t se,
-	FACTTrack *track,
-	FAudioMallocFunc pMalloc
+void FACT_INTERNAL_QueueNotification(
+	FACTAudioEngine *engine,
+	const FACTNotification *note
 ) {
-	uint32_t evtInfo;
-	uint8_t minWeight, maxWeight, separator;
-	uint8_t i;
-	uint16_t j;
+	FACTQueuedNotification *slot;
+	uint32_t pos;
+	int32_t diff;
 
-	track->eventCount = read_u8(ptr);
-	track->events = (FACTEvent*) pMalloc(
-		sizeof(FACTEvent) *
-		track->eventCount
-	);
-	FAudio_zero(track->events, sizeof(FACTEvent) * track->eventCount);
-	for (i = 0; i < track->eventCount; i += 1)
+	pos = (uint32_t) FAudio_PlatformAtomicGet(&engine->notificationHead);
+	for (;;)
 	{
-		evtInfo = read_u32(ptr, se);
-		track->events[i].randomOffset = read_u16(ptr, se);
+		slot = &engine->notificationQueue[pos & (FACT_NOTIFICATION_QUEUE_SIZE - 1)];
+		diff = (int32_t) (
+			(uint32_t) FAudio_PlatformAtomicGet(&slot->sequence) - pos
+		);
+		if (diff == 0)
+		{
+			if (FAudio_PlatformAtomicCAS(
+				&engine->notificationHead,
+				(int32_t) pos,
+				(int32_t) (pos + 1)
+			)) {
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			/* Full, nobody is calling DoWork. Better late than never! */
+			engine->notificationCallback(note);
+			return;
+		}
+		pos = (uint32_t) FAudio_PlatformAtomicGet(&engine->notificationHead);
+	}
 
-		track->events[i].type = evtInfo & 0x001F;
-		track->events[i].timestamp = (evtInfo >> 5) & 0xFFFF;
+	slot->note = *note;
+	FAudio_PlatformAtomicSet(&slot->sequence, (int32_t) (pos + 1));
+	FAudio_PlatformSignalEventFD(engine->notificationFD);
+}
 
-		separator = read_u8(ptr);
-		FAudio_assert(separator == 0xFF); /* Separator? */
+void FACT_INTERNAL_DispatchNotifications(FACTAudioEngine *engine)
+{
+	FACTQueuedNotification *slot;
+	FACTNotification note;
+	uint32_t pos;
 
-		#define EVTTYPE(t) (track->events[i].type == t)
-		if (EVTTYPE(FACTEVENT_STOP))
+	/* Someone else is already on it */
+	if (!FAudio_PlatformAtomicCAS(&engine->notificationConsumer, 0, 1))
+	{
+		return;
+	}
+
+	FAudio_PlatformClearEventFD(engine->notificationFD);
+	pos = (uint32_t) engine->notificationTail;
+	for (;;)
+	{
+		slot = &engine->notificationQueue[pos & (FACT_NOTIFICATION_QUEUE_SIZE - 1)];
+		if ((uint32_t) FAudio_PlatformAtomicGet(&slot->sequence) != pos + 1)
 		{
-			track->events[i].stop.flags = read_u8(ptr);
+			break;
 		}
-		else if (EVTTYPE(FACTEVENT_PLAYWAVE))
-		{
-			/* Basic Wave */
-			track->events[i].wave.isComplex = 0;
-			track->events[i].wave.flags = read_u8(ptr);
-			track->events[i].wave.simple.track = read_u16(ptr, se);
-			track->events[i].wave.simple.wavebank = read_u8(ptr);
-			track->events[i].wave.loopCount = read_u8(ptr);
-			track->events[i].wave.position = read_u16(ptr, se);
-			track->events[i].wave.angle = read_u16(ptr, se);
 
-			/* No Effect Variation */
-			track->events[i].wave.variationFlags = 0;
-		}
-		else if (EVTTYPE(FACTEVENT_PLAYWAVETRACKVARIATION))
-		{
-			/* Complex Wave */
-			track->events[i].wave.isComplex = 1;
-			track->events[i].wave.flags = read_u8(ptr);
-			track->events[i].wave.loopCount = read_u8(ptr);
-			track->events[i].wave.position = read_u16(ptr, se);
-			track->events[i].wave.angle = read_u16(ptr, se);
+		/* Copy out and release the slot before calling back, in case
+		 * the callback causes more notifications
+		 */
+		note = slot->note;
+		FAudio_PlatformAtomicSet(
+			&slot->sequence,
+			(int32_t) (pos + FACT_NOTIFICATION_QUEUE_SIZE)
+		);
+		pos += 1;
+		engine->notificationTail = (int32_t) pos;
 
-			/* Track Variation */
-			evtInfo = read_u32(ptr, se);
-			track->events[i].wave.complex.trackCount = evtInfo & 0xFFFF;
-			track->events[i].wave.complex.variation = (evtInfo >> 16) & 0xFFFF;
-			*ptr += 4; /* Unknown values */
-			track->events[i].wave.complex.tracks = (uint16_t*) pMalloc(
-				sizeof(uint16_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			track->events[i].wave.complex.wavebanks = (uint8_t*) pMalloc(
-				sizeof(uint8_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			track->events[i].wave.complex.weights = (uint8_t*) pMalloc(
-				sizeof(uint8_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			for (j = 0; j < track->events[i].wave.complex.trackCount; j += 1)
-			{
-				track->events[i].wave.complex.tracks[j] = read_u16(ptr, se);
-				track->events[i].wave.complex.wavebanks[j] = read_u8(ptr);
-				minWeight = read_u8(ptr);
-				maxWeight = read_u8(ptr);
-				track->events[i].wave.complex.weights[j] = (
-					maxWeight - minWeight
-				);
-			}
+		engine->notificationCallback(&note);
+	}
 
-			/* No Effect Variation */
-			track->events[i].wave.variationFlags = 0;
-		}
-		else if (EVTTYPE(FACTEVENT_PLAYWAVEEFFECTVARIATION))
-		{
-			/* Basic Wave */
-			track->events[i].wave.isComplex = 0;
-			track->events[i].wave.flags = read_u8(ptr);
-			track->events[i].wave.simple.track = read_u16(ptr, se);
-			track->events[i].wave.simple.wavebank = read_u8(ptr);
-			track->events[i].wave.loopCount = read_u8(ptr);
-			track->events[i].wave.position = read_u16(ptr, se);
-			track->events[i].wave.angle = read_u16(ptr, se);
+	FAudio_PlatformAtomicSet(&engine->notificationConsumer, 0);
+}
 
-			/* Effect Variation */
-			track->events[i].wave.minPitch = read_s16(ptr, se);
-			track->events[i].wave.maxPitch = read_s16(ptr, se);
-			track->events[i].wave.minVolume = read_volbyte(ptr);
-			track->events[i].wave.maxVolume = read_volbyte(ptr);
-			track->events[i].wave.minFrequency = read_f32(ptr, se);
-			track->events[i].wave.maxFrequency = read_f32(ptr, se);
-			track->events[i].wave.minQFactor = read_f32(ptr, se);
-			track->events[i].wave.maxQFactor = read_f32(ptr, se);
-			track->events[i].wave.variationFlags = read_u16(ptr, se);
-		}
-		else if (EVTTYPE(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION))
-		{
-			/* Complex Wave */
-			track->events[i].wave.isComplex = 1;
-			track->events[i].wave.flags = read_u8(ptr);
-			track->events[i].wave.loopCount = read_u8(ptr);
-			track->events[i].wave.position = read_u16(ptr, se);
-			track->events[i].wave.angle = read_u16(ptr, se);
+/* Wave pooling */
 
-			/* Effect Variation */
-			track->events[i].wave.minPitch = read_s16(ptr, se);
-			track->events[i].wave.maxPitch = read_s16(ptr, se);
-			track->events[i].wave.minVolume = read_volbyte(ptr);
-			track->events[i].wave.maxVolume = read_volbyte(ptr);
-			track->events[i].wave.minFrequency = read_f32(ptr, se);
-			track->events[i].wave.maxFrequency = read_f32(ptr, se);
-			track->events[i].wave.minQFactor = read_f32(ptr, se);
-			track->events[i].wave.maxQFactor = read_f32(ptr, se);
-			track->events[i].wave.variationFlags = read_u16(ptr, se);
+FACTWave* FACT_INTERNAL_ReuseWave(
+	FACTWaveBank *wb,
+	const FAudioWaveFormatEx *format
+) {
+	FACTWave *wave, **prev;
+	FAudioWaveFormatEx *voiceFormat;
 
-			/* Track Variation */
-			evtInfo = read_u32(ptr, se);
-			track->events[i].wave.complex.trackCount = evtInfo & 0xFFFF;
-			track->events[i].wave.complex.variation = (evtInfo >> 16) & 0xFFFF;
-			*ptr += 4; /* Unknown values */
-			track->events[i].wave.complex.tracks = (uint16_t*) pMalloc(
-				sizeof(uint16_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			track->events[i].wave.complex.wavebanks = (uint8_t*) pMalloc(
-				sizeof(uint8_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			track->events[i].wave.complex.weights = (uint8_t*) pMalloc(
-				sizeof(uint8_t) *
-				track->events[i].wave.complex.trackCount
-			);
-			for (j = 0; j < track->events[i].wave.complex.trackCount; j += 1)
-			{
-				track->events[i].wave.complex.tracks[j] = read_u16(ptr, se);
-				track->events[i].wave.complex.wavebanks[j] = read_u8(ptr);
-				minWeight = read_u8(ptr);
-				maxWeight = read_u8(ptr);
-				track->events[i].wave.complex.weights[j] = (
-					maxWeight - minWeight
-				);
-			}
-		}
-		else if (	EVTTYPE(FACTEVENT_PITCH) ||
-				EVTTYPE(FACTEVENT_VOLUME) ||
-				EVTTYPE(FACTEVENT_PITCHREPEATING) ||
-				EVTTYPE(FACTEVENT_VOLUMEREPEATING)	)
+	prev = &wb->wavePool;
+	while (*prev != NULL)
+	{
+		wave = *prev;
+		voiceFormat = wave->voice->src.format;
+
+		/* Everything but the sample rate has to match */
+		if (	voiceFormat->wFormatTag == format->wFormatTag &&
+			voiceFormat->nChannels == format->nChannels &&
+			voiceFormat->nBlockAlign == format->nBlockAlign &&
+			voiceFormat->wBitsPerSample == format->wBitsPerSample	)
 		{
-			track->events[i].value.settings = read_u8(ptr);
-			if (track->events[i].value.settings & 1) /* Ramp */
-			{
-				track->events[i].value.repeats = 0;
-				track->events[i].value.ramp.initialValue = read_f32(ptr, se);
-				track->events[i].value.ramp.initialSlope = read_f32(ptr, se) * 100;
-				track->events[i].value.ramp.slopeDelta = read_f32(ptr, se);
-				track->events[i].value.ramp.duration = read_u16(ptr, se);
-			}
-			else /* Equation */
-			{
-				track->events[i].value.equation.flags = read_u8(ptr);
-
-				/* SetValue, SetRandomValue, anything else? */
-				FAudio_assert(track->events[i].value.equation.flags & 0x0C);
+			*prev = wave->poolNext;
+			wave->poolNext = NULL;
+			wb->wavePoolCount -= 1;
 
-				track->events[i].value.equation.value1 = read_f32(ptr, se);
-				track->events[i].value.equation.value2 = read_f32(ptr, se);
-
-				*ptr += 5; /* Unknown values */
-
-				if (	EVTTYPE(FACTEVENT_PITCHREPEATING) ||
-					EVTTYPE(FACTEVENT_VOLUMEREPEATING)	)
-				{
-					track->events[i].value.repeats = read_u16(ptr, se);
-					track->events[i].value.frequency = read_u16(ptr, se);
-				}
-				else
-				{
-					track->events[i].value.repeats = 0;
-				}
+			if (voiceFormat->nSamplesPerSec != format->nSamplesPerSec)
+			{
+				/* Only fails with queued buffers, which we never pool */
+				FAudioSourceVoice_SetSourceSampleRate(
+					wave->voice,
+					format->nSamplesPerSec
+				);
 			}
+			return wave;
 		}
-		else if (EVTTYPE(FACTEVENT_MARKER))
-		{
-			track->events[i].marker.marker = read_u32(ptr, se);
-			track->events[i].marker.repeats = 0;
-			track->events[i].marker.frequency = 0;
-		}
-		else if (EVTTYPE(FACTEVENT_MARKERREPEATING))
-		{
-			track->events[i].marker.marker = read_u32(ptr, se);
-			track->events[i].marker.repeats = read_u16(ptr, se);
-			track->events[i].marker.frequency = read_u16(ptr, se);
-		}
-		else
-		{
-			FAudio_assert(0 && "Unknown event type!");
-		}
-		#undef EVTTYPE
+		prev = &wave->poolNext;
 	}
+	return NULL;
 }
 
-uint32_t FACT_INTERNAL_ParseSoundBank(
-	FACTAudioEngine *pEngine,
-	const void *pvBuffer,
-	uint32_t dwSize,
-	FACTSoundBank **ppSoundBank
-) {
-	FACTSoundBank *sb;
-	uint16_t	contentVersion,
-			cueSimpleCount,
-			cueComplexCount,
-			cueTotalAlign;
-	int32_t	cueSimpleOffset,
-		cueComplexOffset,
-		cueNameOffset,
-		variationOffset,
-		transitionOffset,
-		wavebankNameOffset,
-		cueHashOffset,
-		cueNameIndexOffset,
-		soundOffset;
-	uint32_t entryCountAndFlags;
-	uint16_t filterData;
-	uint8_t platform;
-	size_t memsize;
-	uint16_t i, j, k, cur, tool;
-	uint8_t *ptrBookmark;
-
-	uint8_t *ptr = (uint8_t*) pvBuffer;
-	uint8_t *start = ptr;
-
-	uint32_t magic = read_u32(&ptr, 0);
-	uint8_t se = magic == 0x5344424B; /* Swap Endian */
+uint8_t FACT_INTERNAL_RetireWave(FACTWave *wave)
+{
+	FACTWaveBank *wb = wave->parentBank;
+	FAudioSourceVoice *voice = wave->voice;
+	uint8_t idle;
 
-	if (magic != 0x4B424453 && magic != 0x5344424B)  /* 'SDBK' */
+	if (wb->wavePoolCount >= FACT_WAVE_POOL_MAX)
 	{
-		return -1; /* TODO: NOT XACT FILE */
+		return 0;
 	}
 
-	contentVersion = read_u16(&ptr, se);
-	if (!FACT_INTERNAL_SupportedContent(contentVersion))
+	/* XMA2/WMA voices get their seek info from the format, so every Wave
+	 * needs its own. PCM and ADPCM only differ in the sample rate.
+	 */
+	if (	voice->src.format->wFormatTag != FAUDIO_FORMAT_PCM &&
+		voice->src.format->wFormatTag != FAUDIO_FORMAT_MSADPCM	)
 	{
-		return -2;
+		return 0;
 	}
 
-	tool = read_u16(&ptr, se); /* Tool version */
-	if (tool != 43)
+	/* If a flush is still pending, the mixer will call back into this
+	 * Wave later, so it can't be handed to anyone else.
+	 */
+	FAudio_PlatformLockMutex(voice->src.bufferLock);
+	idle = (	voice->src.active == 0 &&
+			voice->src.bufferList == NULL &&
+			voice->src.flushList == NULL	);
+	FAudio_PlatformUnlockMutex(voice->src.bufferLock);
+	if (!idle)
 	{
-		return -3;
+		return 0;
 	}
 
-	/* CRC, unused */
-	ptr += 2;
-
-	/* Last modified, unused */
-	ptr += 8;
+	wave->state = FACT_STATE_STOPPED;
+	wave->parentCue = NULL;
+	wave->poolNext = wb->wavePool;
+	wb->wavePool = wave;
+	wb->wavePoolCount += 1;
+	return 1;
+}
 
-	/* Windows == 1, Xbox == 3. 0 is unknown, probably old content */
-	platform = read_u8(&ptr);
-	if (	platform != 0 &&
-		platform != 1 &&
-		platform != 3	)
+void FACT_INTERNAL_FreeWavePool(FACTWaveBank *wb)
+{
+	FACTWave *wave;
+	while (wb->wavePool != NULL)
 	{
-		return -4; /* TODO: WRONG PLATFORM */
+		wave = wb->wavePool;
+		wb->wavePool = wave->poolNext;
+		FAudioVoice_DestroyVoice(wave->voice);
+		if (wave->streamCache != NULL)
+		{
+			wb->parentEngine->pFree(wave->streamCache);
+		}
+		wb->parentEngine->pFree(wave);
 	}
+	wb->wavePoolCount = 0;
+}
 
-	sb = (FACTSoundBank*) pEngine->pMalloc(sizeof(FACTSoundBank));
-	sb->parentEngine = pEngine;
-	sb->cueList = NULL;
-	sb->notifyOnDestroy = 0;
-	sb->usercontext = NULL;
-
-	cueSimpleCount = read_u16(&ptr, se);
-	cueComplexCount = read_u16(&ptr, se);
-
-	ptr += 2; /* Unknown value */
-
-	cueTotalAlign = read_u16(&ptr, se); /* FIXME: Why? */
-	sb->cueCount = cueSimpleCount + cueComplexCount;
-	sb->wavebankCount = read_u8(&ptr);
-	sb->soundCount = read_u16(&ptr, se);
+/* FAudioIOStream functions */
 
-	/* Cue name length, unused */
-	ptr += 2;
+int32_t FACTCALL FACT_INTERNAL_DefaultReadFile(
+	void *hFile,
+	void *buffer,
+	uint32_t nNumberOfBytesToRead,
+	uint32_t *lpNumberOfBytesRead, /* Not referenced! */
+	FACTOverlapped *lpOverlapped
+) {
+	FAudioIOStream *io = (FAudioIOStream*) hFile;
+	lpOverlapped->Internal = (void*) 0x00000103; /* STATUS_PENDING */
+	FAudio_PlatformLockMutex((FAudioMutex) io->lock);
+	io->seek(io->data, (size_t) lpOverlapped->Pointer, FAUDIO_SEEK_SET);
+	lpOverlapped->InternalHigh = (void*) (size_t) (io->read(
+		io->data,
+		buffer,
+		nNumberOfBytesToRead,
+		1
+	) * nNumberOfBytesToRead);
+	FAudio_PlatformUnlockMutex((FAudioMutex) io->lock);
+	lpOverlapped->Internal = 0; /* STATUS_SUCCESS */
+	return 1;
+}
+
+int32_t FACTCALL FACT_INTERNAL_DefaultGetOverlappedResult(
+	void *hFile,
+	FACTOverlapped *lpOverlapped,
+	uint32_t *lpNumberOfBytesTransferred,
+	int32_t bWait
+) {
+	*lpNumberOfBytesTransferred = (uint32_t) (size_t) lpOverlapped->InternalHigh;
+	return 1;
+}
+
+/* Parsing functions */
+
+#define READ_FUNC(type, size, bitsize, suffix) \
+	static inline type read_##suffix(uint8_t **ptr, const uint8_t swapendian) \
+	{ \
+		type result = *((type*) *ptr); \
+		*ptr += size; \
+		return swapendian ? \
+			FAudio_swap##bitsize##BE(result) : \
+			FAudio_swap##bitsize##LE(result); \
+	}
+
+static inline uint8_t read_u8(uint8_t **ptr)
+{
+	uint8_t result = *((uint8_t*) *ptr);
+	*ptr += 1;
+	return result;
+}
+READ_FUNC(uint16_t, 2, 16, u16)
+READ_FUNC(uint32_t, 4, 32, u32)
+READ_FUNC(int16_t, 2, 16, s16)
+READ_FUNC(int32_t, 4, 32, s32)
+static inline float read_f32(uint8_t **ptr, const uint8_t swapendian)
+{
+	float result = *((float*) *ptr);
+	*ptr += 4;
+	return result;
+}
+
+#undef READ_FUNC
+
+static inline float read_volbyte(uint8_t **ptr)
+{
+	/* FIXME: This magnificent beauty came from Mathematica!
+	 * The byte values for all possible input dB values from the .xap are here:
+	 * http://www.flibitijibibo.com/XACTVolume.txt
+	 * Yes, this is actually what the XACT builder really does.
+	 *
+	 * Thanks to Kenny for plotting all that data.
+	 * -flibit
+	 */
+	return (float) ((3969.0 * FAudio_log10(read_u8(ptr) / 28240.0)) + 8715.0);
+}
+
+uint32_t FACT_INTERNAL_ParseAudioEngine(
+	FACTAudioEngine *pEngine,
+	const FACTRuntimeParameters *pParams
+) {
+	uint32_t	categoryOffset,
+			variableOffset,
+			blob1Offset,
+			categoryNameIndexOffset,
+			blob2Offset,
+			variableNameIndexOffset,
+			categoryNameOffset,
+			variableNameOffset,
+			rpcOffset,
+			dspPresetOffset,
+			dspParameterOffset;
+	uint16_t blob1Count, blob2Count;
+	uint8_t version, tool;
+	uint8_t se;
+	uint32_t magic;
+	size_t memsize;
+	uint16_t i, j;
+
+	uint8_t *ptr = (uint8_t*) pParams->pGlobalSettingsBuffer;
+	uint8_t *start = ptr;
+
+	magic = read_u32(&ptr, 0);
+	se = magic == 0x58475346; /* Swap Endian */
+	if (magic != 0x46534758 && magic != 0x58475346) /* 'XGSF' */
+	{
+		return -1; /* TODO: NOT XACT FILE */
+	}
+
+	if (!FACT_INTERNAL_SupportedContent(read_u16(&ptr, se)))
+	{
+		return -2;
+	}
+
+	tool = read_u16(&ptr, se); /* Tool version */
+	if (tool != 42)
+	{
+		return -3;
+	}
 
 	ptr += 2; /* Unknown value */
 
-	cueSimpleOffset = read_s32(&ptr, se);
-	cueComplexOffset = read_s32(&ptr, se);
-	cueNameOffset = read_s32(&ptr, se);
+	/* Last modified, unused */
+	ptr += 8;
 
-	ptr += 4; /* Unknown value */
+	/* XACT Version (Windows == 3, Xbox == 7) */
+	version = read_u8(&ptr);
+	if (	version != 3 &&
+		version != 7	)
+	{
+		return -4; /* TODO: VERSION TOO OLD */
+	}
 
-	variationOffset = read_s32(&ptr, se);
-	transitionOffset = read_s32(&ptr, se);
-	wavebankNameOffset = read_s32(&ptr, se);
-	cueHashOffset = read_s32(&ptr, se);
-	cueNameIndexOffset = read_s32(&ptr, se);
-	soundOffset = read_s32(&ptr, se);
+	/* Object counts */
+	pEngine->categoryCount = read_u16(&ptr, se);
+	pEngine->variableCount = read_u16(&ptr, se);
+	blob1Count = read_u16(&ptr, se);
+	blob2Count = read_u16(&ptr, se);
+	pEngine->rpcCount = read_u16(&ptr, se);
+	pEngine->dspPresetCount = read_u16(&ptr, se);
+	pEngine->dspParameterCount = read_u16(&ptr, se);
+
+	/* Object offsets */
+	categoryOffset = read_u32(&ptr, se);
+	variableOffset = read_u32(&ptr, se);
+	blob1Offset = read_u32(&ptr, se);
+	categoryNameIndexOffset = read_u32(&ptr, se);
+	blob2Offset = read_u32(&ptr, se);
+	variableNameIndexOffset = read_u32(&ptr, se);
+	categoryNameOffset = read_u32(&ptr, se);
+	variableNameOffset = read_u32(&ptr, se);
+	rpcOffset = read_u32(&ptr, se);
+	dspPresetOffset = read_u32(&ptr, se);
+	dspParameterOffset = read_u32(&ptr, se);
+
+	/* Category data */
+	FAudio_assert((ptr - start) == categoryOffset);
+	pEngine->categories = (FACTAudioCategory*) pEngine->pMalloc(
+		sizeof(FACTAudioCategory) * pEngine->categoryCount
+	);
+	for (i = 0; i < pEngine->categoryCount; i += 1)
+	{
+		pEngine->categories[i].instanceLimit = read_u8(&ptr);
+		pEngine->categories[i].fadeInMS = read_u16(&ptr, se);
+		pEngine->categories[i].fadeOutMS = read_u16(&ptr, se);
+		pEngine->categories[i].maxInstanceBehavior = read_u8(&ptr) >> 3;
+		pEngine->categories[i].parentCategory = read_u16(&ptr, se);
+		pEngine->categories[i].volume = FACT_INTERNAL_CalculateAmplitudeRatio(
+			read_volbyte(&ptr)
+		);
+		pEngine->categories[i].visibility = read_u8(&ptr);
+		pEngine->categories[i].instanceCount = 0;
+		pEngine->categories[i].currentVolume = 1.0f;
+	}
+
+	/* Variable data */
+	FAudio_assert((ptr - start) == variableOffset);
+	pEngine->variables = (FACTVariable*) pEngine->pMalloc(
+		sizeof(FACTVariable) * pEngine->variableCount
+	);
+	for (i = 0; i < pEngine->variableCount; i += 1)
+	{
+		pEngine->variables[i].accessibility = read_u8(&ptr);
+		pEngine->variables[i].initialValue = read_f32(&ptr, se);
+		pEngine->variables[i].minValue = read_f32(&ptr, se);
+		pEngine->variables[i].maxValue = read_f32(&ptr, se);
+	}
+
+	/* Global variable storage. Some unused data for non-global vars */
+	pEngine->globalVariableValues = (float*) pEngine->pMalloc(
+		sizeof(float) * pEngine->variableCount
+	);
+	for (i = 0; i < pEngine->variableCount; i += 1)
+	{
+		pEngine->globalVariableValues[i] = pEngine->variables[i].initialValue;
+	}
+
+	/* RPC data */
+	if (pEngine->rpcCount > 0)
+	{
+		FAudio_assert((ptr - start) == rpcOffset);
+		pEngine->rpcs = (FACTRPC*) pEngine->pMalloc(
+			sizeof(FACTRPC) *
+			pEngine->rpcCount
+		);
+		pEngine->rpcCodes = (uint32_t*) pEngine->pMalloc(
+			sizeof(uint32_t) *
+			pEngine->rpcCount
+		);
+		for (i = 0; i < pEngine->rpcCount; i += 1)
+		{
+			pEngine->rpcCodes[i] = (uint32_t) (ptr - start);
+			pEngine->rpcs[i].variable = read_u16(&ptr, se);
+			pEngine->rpcs[i].pointCount = read_u8(&ptr);
+			pEngine->rpcs[i].parameter = read_u16(&ptr, se);
+			pEngine->rpcs[i].points = (FACTRPCPoint*) pEngine->pMalloc(
+				sizeof(FACTRPCPoint) *
+				pEngine->rpcs[i].pointCount
+			);
+			for (j = 0; j < pEngine->rpcs[i].pointCount; j += 1)
+			{
+				pEngine->rpcs[i].points[j].x = read_f32(&ptr, se);
+				pEngine->rpcs[i].points[j].y = read_f32(&ptr, se);
+				pEngine->rpcs[i].points[j].type = read_u8(&ptr);
+			}
+			FACT_INTERNAL_BuildRPCTable(pEngine, &pEngine->rpcs[i]);
+		}
+	}
+
+	/* DSP Preset data */
+	if (pEngine->dspPresetCount > 0)
+	{
+		FAudio_assert((ptr - start) == dspPresetOffset);
+		pEngine->dspPresets = (FACTDSPPreset*) pEngine->pMalloc(
+			sizeof(FACTDSPPreset) *
+			pEngine->dspPresetCount
+		);
+		pEngine->dspPresetCodes = (uint32_t*) pEngine->pMalloc(
+			sizeof(uint32_t) *
+			pEngine->dspPresetCount
+		);
+		for (i = 0; i < pEngine->dspPresetCount; i += 1)
+		{
+			pEngine->dspPresetCodes[i] = (uint32_t) (ptr - start);
+			pEngine->dspPresets[i].accessibility = read_u8(&ptr);
+			pEngine->dspPresets[i].parameterCount = read_u16(&ptr, se);
+			ptr += 2; /* Unknown value */
+			pEngine->dspPresets[i].parameters = (FACTDSPParameter*) pEngine->pMalloc(
+				sizeof(FACTDSPParameter) *
+				pEngine->dspPresets[i].parameterCount
+			); /* This will be filled in just a moment... */
+		}
+
+		/* DSP Parameter data */
+		FAudio_assert((ptr - start) == dspParameterOffset);
+		for (i = 0; i < pEngine->dspPresetCount; i += 1)
+		{
+			for (j = 0; j < pEngine->dspPresets[i].parameterCount; j += 1)
+			{
+				pEngine->dspPresets[i].parameters[j].type = read_u8(&ptr);
+				pEngine->dspPresets[i].parameters[j].value = read_f32(&ptr, se);
+				pEngine->dspPresets[i].parameters[j].minVal = read_f32(&ptr, se);
+				pEngine->dspPresets[i].parameters[j].maxVal = read_f32(&ptr, se);
+				pEngine->dspPresets[i].parameters[j].unknown = read_u16(&ptr, se);
+			}
+		}
+	}
+
+	/* Blob #1, no idea what this is... */
+	FAudio_assert((ptr - start) == blob1Offset);
+	ptr += blob1Count * 2;
+
+	/* Category Name Index data */
+	FAudio_assert((ptr - start) == categoryNameIndexOffset);
+	ptr += pEngine->categoryCount * 6; /* FIXME: index as assert value? */
+
+	/* Category Name data */
+	FAudio_assert((ptr - start) == categoryNameOffset);
+	pEngine->categoryNames = (char**) pEngine->pMalloc(
+		sizeof(char*) *
+		pEngine->categoryCount
+	);
+	for (i = 0; i < pEngine->categoryCount; i += 1)
+	{
+		memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
+		pEngine->categoryNames[i] = (char*) pEngine->pMalloc(memsize);
+		FAudio_memcpy(pEngine->categoryNames[i], ptr, memsize);
+		ptr += memsize;
+	}
+
+	/* Blob #2, no idea what this is... */
+	FAudio_assert((ptr - start) == blob2Offset);
+	ptr += blob2Count * 2;
+
+	/* Variable Name Index data */
+	FAudio_assert((ptr - start) == variableNameIndexOffset);
+	ptr += pEngine->variableCount * 6; /* FIXME: index as assert value? */
+
+	/* Variable Name data */
+	FAudio_assert((ptr - start) == variableNameOffset);
+	pEngine->variableNames = (char**) pEngine->pMalloc(
+		sizeof(char*) *
+		pEngine->variableCount
+	);
+	for (i = 0; i < pEngine->variableCount; i += 1)
+	{
+		memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
+		pEngine->variableNames[i] = (char*) pEngine->pMalloc(memsize);
+		FAudio_memcpy(pEngine->variableNames[i], ptr, memsize);
+		ptr += memsize;
+	}
+
+	/* Store this pointer in case we're asked to free it */
+	if (pParams->globalSettingsFlags & FACT_FLAG_MANAGEDATA)
+	{
+		pEngine->settings = pParams->pGlobalSettingsBuffer;
+	}
+
+	/* Finally. */
+	FAudio_assert((ptr - start) == pParams->globalSettingsBufferSize);
+	return 0;
+}
+
+void FACT_INTERNAL_ParseTrackEvents(
+	uint8_t **ptr,
+	uint8_t se,
+	FACTTrack *track,
+	FAudioMallocFunc pMalloc
+) {
+	uint32_t evtInfo;
+	uint8_t minWeight, maxWeight, separator;
+	uint8_t i;
+	uint16_t j;
+
+	track->eventCount = read_u8(ptr);
+	track->events = (FACTEvent*) pMalloc(
+		sizeof(FACTEvent) *
+		track->eventCount
+	);
+	FAudio_zero(track->events, sizeof(FACTEvent) * track->eventCount);
+	for (i = 0; i < track->eventCount; i += 1)
+	{
+		evtInfo = read_u32(ptr, se);
+		track->events[i].randomOffset = read_u16(ptr, se);
+
+		track->events[i].type = evtInfo & 0x001F;
+		track->events[i].timestamp = (evtInfo >> 5) & 0xFFFF;
+
+		separator = read_u8(ptr);
+		FAudio_assert(separator == 0xFF); /* Separator? */
+
+		#define EVTTYPE(t) (track->events[i].type == t)
+		if (EVTTYPE(FACTEVENT_STOP))
+		{
+			track->events[i].stop.flags = read_u8(ptr);
+		}
+		else if (EVTTYPE(FACTEVENT_PLAYWAVE))
+		{
+			/* Basic Wave */
+			track->events[i].wave.isComplex = 0;
+			track->events[i].wave.flags = read_u8(ptr);
+			track->events[i].wave.simple.track = read_u16(ptr, se);
+			track->events[i].wave.simple.wavebank = read_u8(ptr);
+			track->events[i].wave.loopCount = read_u8(ptr);
+			track->events[i].wave.position = read_u16(ptr, se);
+			track->events[i].wave.angle = read_u16(ptr, se);
+
+			/* No Effect Variation */
+			track->events[i].wave.variationFlags = 0;
+		}
+		else if (EVTTYPE(FACTEVENT_PLAYWAVETRACKVARIATION))
+		{
+			/* Complex Wave */
+			track->events[i].wave.isComplex = 1;
+			track->events[i].wave.flags = read_u8(ptr);
+			track->events[i].wave.loopCount = read_u8(ptr);
+			track->events[i].wave.position = read_u16(ptr, se);
+			track->events[i].wave.angle = read_u16(ptr, se);
+
+			/* Track Variation */
+			evtInfo = read_u32(ptr, se);
+			track->events[i].wave.complex.trackCount = evtInfo & 0xFFFF;
+			track->events[i].wave.complex.variation = (evtInfo >> 16) & 0xFFFF;
+			*ptr += 4; /* Unknown values */
+			track->events[i].wave.complex.tracks = (uint16_t*) pMalloc(
+				sizeof(uint16_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			track->events[i].wave.complex.wavebanks = (uint8_t*) pMalloc(
+				sizeof(uint8_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			track->events[i].wave.complex.weights = (uint8_t*) pMalloc(
+				sizeof(uint8_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			for (j = 0; j < track->events[i].wave.complex.trackCount; j += 1)
+			{
+				track->events[i].wave.complex.tracks[j] = read_u16(ptr, se);
+				track->events[i].wave.complex.wavebanks[j] = read_u8(ptr);
+				minWeight = read_u8(ptr);
+				maxWeight = read_u8(ptr);
+				track->events[i].wave.complex.weights[j] = (
+					maxWeight - minWeight
+				);
+			}
+
+			/* No Effect Variation */
+			track->events[i].wave.variationFlags = 0;
+		}
+		else if (EVTTYPE(FACTEVENT_PLAYWAVEEFFECTVARIATION))
+		{
+			/* Basic Wave */
+			track->events[i].wave.isComplex = 0;
+			track->events[i].wave.flags = read_u8(ptr);
+			track->events[i].wave.simple.track = read_u16(ptr, se);
+			track->events[i].wave.simple.wavebank = read_u8(ptr);
+			track->events[i].wave.loopCount = read_u8(ptr);
+			track->events[i].wave.position = read_u16(ptr, se);
+			track->events[i].wave.angle = read_u16(ptr, se);
+
+			/* Effect Variation */
+			track->events[i].wave.minPitch = read_s16(ptr, se);
+			track->events[i].wave.maxPitch = read_s16(ptr, se);
+			track->events[i].wave.minVolume = read_volbyte(ptr);
+			track->events[i].wave.maxVolume = read_volbyte(ptr);
+			track->events[i].wave.minFrequency = read_f32(ptr, se);
+			track->events[i].wave.maxFrequency = read_f32(ptr, se);
+			track->events[i].wave.minQFactor = read_f32(ptr, se);
+			track->events[i].wave.maxQFactor = read_f32(ptr, se);
+			track->events[i].wave.variationFlags = read_u16(ptr, se);
+		}
+		else if (EVTTYPE(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION))
+		{
+			/* Complex Wave */
+			track->events[i].wave.isComplex = 1;
+			track->events[i].wave.flags = read_u8(ptr);
+			track->events[i].wave.loopCount = read_u8(ptr);
+			track->events[i].wave.position = read_u16(ptr, se);
+			track->events[i].wave.angle = read_u16(ptr, se);
+
+			/* Effect Variation */
+			track->events[i].wave.minPitch = read_s16(ptr, se);
+			track->events[i].wave.maxPitch = read_s16(ptr, se);
+			track->events[i].wave.minVolume = read_volbyte(ptr);
+			track->events[i].wave.maxVolume = read_volbyte(ptr);
+			track->events[i].wave.minFrequency = read_f32(ptr, se);
+			track->events[i].wave.maxFrequency = read_f32(ptr, se);
+			track->events[i].wave.minQFactor = read_f32(ptr, se);
+			track->events[i].wave.maxQFactor = read_f32(ptr, se);
+			track->events[i].wave.variationFlags = read_u16(ptr, se);
+
+			/* Track Variation */
+			evtInfo = read_u32(ptr, se);
+			track->events[i].wave.complex.trackCount = evtInfo & 0xFFFF;
+			track->events[i].wave.complex.variation = (evtInfo >> 16) & 0xFFFF;
+			*ptr += 4; /* Unknown values */
+			track->events[i].wave.complex.tracks = (uint16_t*) pMalloc(
+				sizeof(uint16_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			track->events[i].wave.complex.wavebanks = (uint8_t*) pMalloc(
+				sizeof(uint8_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			track->events[i].wave.complex.weights = (uint8_t*) pMalloc(
+				sizeof(uint8_t) *
+				track->events[i].wave.complex.trackCount
+			);
+			for (j = 0; j < track->events[i].wave.complex.trackCount; j += 1)
+			{
+				track->events[i].wave.complex.tracks[j] = read_u16(ptr, se);
+				track->events[i].wave.complex.wavebanks[j] = read_u8(ptr);
+				minWeight = read_u8(ptr);
+				maxWeight = read_u8(ptr);
+				track->events[i].wave.complex.weights[j] = (
+					maxWeight - minWeight
+				);
+			}
+		}
+		else if (	EVTTYPE(FACTEVENT_PITCH) ||
+				EVTTYPE(FACTEVENT_VOLUME) ||
+				EVTTYPE(FACTEVENT_PITCHREPEATING) ||
+				EVTTYPE(FACTEVENT_VOLUMEREPEATING)	)
+		{
+			track->events[i].value.settings = read_u8(ptr);
+			if (track->events[i].value.settings & 1) /* Ramp */
+			{
+				track->events[i].value.repeats = 0;
+				track->events[i].value.ramp.initialValue = read_f32(ptr, se);
+				track->events[i].value.ramp.initialSlope = read_f32(ptr, se) * 100;
+				track->events[i].value.ramp.slopeDelta = read_f32(ptr, se);
+				track->events[i].value.ramp.duration = read_u16(ptr, se);
+			}
+			else /* Equation */
+			{
+				track->events[i].value.equation.flags = read_u8(ptr);
+
+				/* SetValue, SetRandomValue, anything else? */
+				FAudio_assert(track->events[i].value.equation.flags & 0x0C);
+
+				track->events[i].value.equation.value1 = read_f32(ptr, se);
+				track->events[i].value.equation.value2 = read_f32(ptr, se);
+
+				*ptr += 5; /* Unknown values */
+
+				if (	EVTTYPE(FACTEVENT_PITCHREPEATING) ||
+					EVTTYPE(FACTEVENT_VOLUMEREPEATING)	)
+				{
+					track->events[i].value.repeats = read_u16(ptr, se);
+					track->events[i].value.frequency = read_u16(ptr, se);
+				}
+				else
+				{
+					track->events[i].value.repeats = 0;
+				}
+			}
+		}
+		else if (EVTTYPE(FACTEVENT_MARKER))
+		{
+			track->events[i].marker.marker = read_u32(ptr, se);
+			track->events[i].marker.repeats = 0;
+			track->events[i].marker.frequency = 0;
+		}
+		else if (EVTTYPE(FACTEVENT_MARKERREPEATING))
+		{
+			track->events[i].marker.marker = read_u32(ptr, se);
+			track->events[i].marker.repeats = read_u16(ptr, se);
+			track->events[i].marker.frequency = read_u16(ptr, se);
+		}
+		else
+		{
+			FAudio_assert(0 && "Unknown event type!");
+		}
+		#undef EVTTYPE
+	}
+}
+
+uint32_t FACT_INTERNAL_ParseSoundBank(
+	FACTAudioEngine *pEngine,
+	const void *pvBuffer,
+	uint32_t dwSize,
+	FACTSoundBank **ppSoundBank
+) {
+	FACTSoundBank *sb;
+	uint16_t	contentVersion,
+			cueSimpleCount,
+			cueComplexCount,
+			cueTotalAlign;
+	int32_t	cueSimpleOffset,
+		cueComplexOffset,
+		cueNameOffset,
+		variationOffset,
+		transitionOffset,
+		wavebankNameOffset,
+		cueHashOffset,
+		cueNameIndexOffset,
+		soundOffset;
+	uint32_t entryCountAndFlags;
+	uint16_t filterData;
+	uint8_t platform;
+	size_t memsize;
+	uint16_t i, j, k, cur, tool;
+	uint8_t *ptrBookmark;
+
+	uint8_t *ptr = (uint8_t*) pvBuffer;
+	uint8_t *start = ptr;
+
+	uint32_t magic = read_u32(&ptr, 0);
+	uint8_t se = magic == 0x5344424B; /* Swap Endian */
+
+	if (magic != 0x4B424453 && magic != 0x5344424B)  /* 'SDBK' */
+	{
+		return -1; /* TODO: NOT XACT FILE */
+	}
+
+	contentVersion = read_u16(&ptr, se);
+	if (!FACT_INTERNAL_SupportedContent(contentVersion))
+	{
+		return -2;
+	}
+
+	tool = read_u16(&ptr, se); /* Tool version */
+	if (tool != 43)
+	{
+		return -3;
+	}
+
+	/* CRC, unused */
+	ptr += 2;
+
+	/* Last modified, unused */
+	ptr += 8;
+
+	/* Windows == 1, Xbox == 3. 0 is unknown, probably old content */
+	platform = read_u8(&ptr);
+	if (	platform != 0 &&
+		platform != 1 &&
+		platform != 3	)
+	{
+		return -4; /* TODO: WRONG PLATFORM */
+	}
+
+	sb = (FACTSoundBank*) pEngine->pMalloc(sizeof(FACTSoundBank));
+	sb->parentEngine = pEngine;
+	sb->cueList = NULL;
+	sb->notifyOnDestroy = 0;
+	sb->usercontext = NULL;
+	sb->cache = NULL;
+
+	cueSimpleCount = read_u16(&ptr, se);
+	cueComplexCount = read_u16(&ptr, se);
+
+	ptr += 2; /* Unknown value */
+
+	cueTotalAlign = read_u16(&ptr, se); /* FIXME: Why? */
+	sb->cueCount = cueSimpleCount + cueComplexCount;
+	sb->wavebankCount = read_u8(&ptr);
+	sb->soundCount = read_u16(&ptr, se);
+
+	/* Cue name length, unused */
+	ptr += 2;
+
+	ptr += 2; /* Unknown value */
+
+	cueSimpleOffset = read_s32(&ptr, se);
+	cueComplexOffset = read_s32(&ptr, se);
+	cueNameOffset = read_s32(&ptr, se);
+
+	ptr += 4; /* Unknown value */
+
+	variationOffset = read_s32(&ptr, se);
+	transitionOffset = read_s32(&ptr, se);
+	wavebankNameOffset = read_s32(&ptr, se);
+	cueHashOffset = read_s32(&ptr, se);
+	cueNameIndexOffset = read_s32(&ptr, se);
+	soundOffset = read_s32(&ptr, se);
+
+	/* SoundBank Name */
+	memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
+	sb->name = (char*) pEngine->pMalloc(memsize);
+	FAudio_memcpy(sb->name, ptr, memsize);
+	ptr += 64;
+
+	/* WaveBank Name data */
+	FAudio_assert((ptr - start) == wavebankNameOffset);
+	sb->wavebankNames = (char**) pEngine->pMalloc(
+		sizeof(char*) *
+		sb->wavebankCount
+	);
+	for (i = 0; i < sb->wavebankCount; i += 1)
+	{
+		memsize = FAudio_strlen((char*) ptr) + 1;
+		sb->wavebankNames[i] = (char*) pEngine->pMalloc(memsize);
+		FAudio_memcpy(sb->wavebankNames[i], ptr, memsize);
+		ptr += 64;
+	}
+
+	/* Sound data */
+	FAudio_assert((ptr - start) == soundOffset);
+	sb->sounds = (FACTSound*) pEngine->pMalloc(
+		sizeof(FACTSound) *
+		sb->soundCount
+	);
+	sb->soundCodes = (uint32_t*) pEngine->pMalloc(
+		sizeof(uint32_t) *
+		sb->soundCount
+	);
+	for (i = 0; i < sb->soundCount; i += 1)
+	{
+		sb->soundCodes[i] = (uint32_t) (ptr - start);
+		sb->sounds[i].flags = read_u8(&ptr);
+		sb->sounds[i].category = read_u16(&ptr, se);
+		sb->sounds[i].volume = read_volbyte(&ptr);
+		sb->sounds[i].pitch = read_s16(&ptr, se);
+		sb->sounds[i].priority = read_u8(&ptr);
+
+		/* Length of sound entry, unused */
+		ptr += 2;
+
+		/* Simple/Complex Track data */
+		if (sb->sounds[i].flags & 0x01)
+		{
+			sb->sounds[i].trackCount = read_u8(&ptr);
+			memsize = sizeof(FACTTrack) * sb->sounds[i].trackCount;
+			sb->sounds[i].tracks = (FACTTrack*) pEngine->pMalloc(memsize);
+			FAudio_zero(sb->sounds[i].tracks, memsize);
+		}
+		else
+		{
+			sb->sounds[i].trackCount = 1;
+			memsize = sizeof(FACTTrack) * sb->sounds[i].trackCount;
+			sb->sounds[i].tracks = (FACTTrack*) pEngine->pMalloc(memsize);
+			FAudio_zero(sb->sounds[i].tracks, memsize);
+			sb->sounds[i].tracks[0].volume = 0.0f;
+			sb->sounds[i].tracks[0].filter = 0xFF;
+			sb->sounds[i].tracks[0].eventCount = 1;
+			sb->sounds[i].tracks[0].events = (FACTEvent*) pEngine->pMalloc(
+				sizeof(FACTEvent)
+			);
+			FAudio_zero(
+				sb->sounds[i].tracks[0].events,
+				sizeof(FACTEvent)
+			);
+			sb->sounds[i].tracks[0].events[0].type = FACTEVENT_PLAYWAVE;
+			sb->sounds[i].tracks[0].events[0].wave.position = 0; /* FIXME */
+			sb->sounds[i].tracks[0].events[0].wave.angle = 0; /* FIXME */
+			sb->sounds[i].tracks[0].events[0].wave.simple.track = read_u16(&ptr, se);
+			sb->sounds[i].tracks[0].events[0].wave.simple.wavebank = read_u8(&ptr);
+		}
+
+		/* RPC Code data */
+		if (sb->sounds[i].flags & 0x0E)
+		{
+			const uint16_t rpcDataLength = read_u16(&ptr, se);
+			ptrBookmark = ptr - 2;
+
+			#define COPYRPCBLOCK(loc) \
+				loc.rpcCodeCount = read_u8(&ptr); \
+				memsize = sizeof(uint32_t) * loc.rpcCodeCount; \
+				loc.rpcCodes = (uint32_t*) pEngine->pMalloc(memsize); \
+				for (k = 0; k < loc.rpcCodeCount; k += 1) \
+				{ \
+					loc.rpcCodes[k] = read_u32(&ptr, se); \
+				} \
+
+			/* Sound has attached RPCs */
+			if (sb->sounds[i].flags & 0x02)
+			{
+				COPYRPCBLOCK(sb->sounds[i])
+			}
+			else
+			{
+				sb->sounds[i].rpcCodeCount = 0;
+				sb->sounds[i].rpcCodes = NULL;
+			}
+
+			/* Tracks have attached RPCs */
+			if (sb->sounds[i].flags & 0x04)
+			{
+				for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+				{
+					COPYRPCBLOCK(sb->sounds[i].tracks[j])
+				}
+			}
+			else
+			{
+				for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+				{
+					sb->sounds[i].tracks[j].rpcCodeCount = 0;
+					sb->sounds[i].tracks[j].rpcCodes = NULL;
+				}
+			}
+
+			#undef COPYRPCBLOCK
+
+			/* FIXME: Does 0x08 mean something for RPCs...? */
+			FAudio_assert((ptr - ptrBookmark) == rpcDataLength);
+		}
+		else
+		{
+			sb->sounds[i].rpcCodeCount = 0;
+			sb->sounds[i].rpcCodes = NULL;
+			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+			{
+				sb->sounds[i].tracks[j].rpcCodeCount = 0;
+				sb->sounds[i].tracks[j].rpcCodes = NULL;
+			}
+		}
+
+		/* DSP Preset Code data */
+		if (sb->sounds[i].flags & 0x10)
+		{
+			/* DSP presets length, unused */
+			ptr += 2;
+
+			sb->sounds[i].dspCodeCount = read_u8(&ptr);
+			memsize = sizeof(uint32_t) * sb->sounds[i].dspCodeCount;
+			sb->sounds[i].dspCodes = (uint32_t*) pEngine->pMalloc(memsize);
+			for (j = 0; j < sb->sounds[i].dspCodeCount; j += 1)
+			{
+				sb->sounds[i].dspCodes[j] = read_u32(&ptr, se);
+			}
+		}
+		else
+		{
+			sb->sounds[i].dspCodeCount = 0;
+			sb->sounds[i].dspCodes = NULL;
+		}
+
+		/* Track data */
+		if (sb->sounds[i].flags & 0x01)
+		{
+			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+			{
+				sb->sounds[i].tracks[j].volume = read_volbyte(&ptr);
+
+				sb->sounds[i].tracks[j].code = read_u32(&ptr, se);
+
+				if (contentVersion == FACT_CONTENT_VERSION_3_0)
+				{
+					/* 3.0 doesn't have track filter data */
+					sb->sounds[i].tracks[j].filter = 0xFF;
+					sb->sounds[i].tracks[j].qfactor = 0;
+					sb->sounds[i].tracks[j].frequency = 0;
+					continue;
+				}
+
+				filterData = read_u16(&ptr, se);
+				if (filterData & 0x0001)
+				{
+					sb->sounds[i].tracks[j].filter =
+						(filterData >> 1) & 0x02;
+				}
+				else
+				{
+					/* Huh...? */
+					sb->sounds[i].tracks[j].filter = 0xFF;
+				}
+				sb->sounds[i].tracks[j].qfactor = (filterData >> 8) & 0xFF;
+				sb->sounds[i].tracks[j].frequency = read_u16(&ptr, se);
+			}
+
+			/* All Track events are stored at the end of the block */
+			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+			{
+				FAudio_assert((ptr - start) == sb->sounds[i].tracks[j].code);
+				FACT_INTERNAL_ParseTrackEvents(
+					&ptr,
+					se,
+					&sb->sounds[i].tracks[j],
+					pEngine->pMalloc
+				);
+			}
+		}
+	}
+
+	/* All Cue data */
+	sb->variationCount = 0;
+	sb->transitionCount = 0;
+	sb->cues = (FACTCueData*) pEngine->pMalloc(
+		sizeof(FACTCueData) *
+		sb->cueCount
+	);
+	cur = 0;
+
+	/* Simple Cue data */
+	FAudio_assert(cueSimpleCount == 0 || (ptr - start) == cueSimpleOffset);
+	for (i = 0; i < cueSimpleCount; i += 1, cur += 1)
+	{
+		sb->cues[cur].flags = read_u8(&ptr);
+		sb->cues[cur].sbCode = read_u32(&ptr, se);
+		sb->cues[cur].transitionOffset = 0;
+		sb->cues[cur].instanceLimit = 0xFF;
+		sb->cues[cur].fadeInMS = 0;
+		sb->cues[cur].fadeOutMS = 0;
+		sb->cues[cur].maxInstanceBehavior = 0;
+		sb->cues[cur].instanceCount = 0;
+	}
+
+	/* Complex Cue data */
+	FAudio_assert(cueComplexCount == 0 || (ptr - start) == cueComplexOffset);
+	for (i = 0; i < cueComplexCount; i += 1, cur += 1)
+	{
+		sb->cues[cur].flags = read_u8(&ptr);
+		sb->cues[cur].sbCode = read_u32(&ptr, se);
+		sb->cues[cur].transitionOffset = read_u32(&ptr, se);
+		if (sb->cues[cur].transitionOffset == 0xFFFFFFFF)
+		{
+			/* FIXME: Why */
+			sb->cues[cur].transitionOffset = 0;
+		}
+		sb->cues[cur].instanceLimit = read_u8(&ptr);
+		sb->cues[cur].fadeInMS = read_u16(&ptr, se);
+		sb->cues[cur].fadeOutMS = read_u16(&ptr, se);
+		sb->cues[cur].maxInstanceBehavior = read_u8(&ptr) >> 3;
+		sb->cues[cur].instanceCount = 0;
+
+		if (!(sb->cues[cur].flags & 0x04))
+		{
+			/* FIXME: Is this the only way to get this...? */
+			sb->variationCount += 1;
+		}
+		if (sb->cues[cur].transitionOffset > 0)
+		{
+			/* FIXME: Is this the only way to get this...? */
+			sb->transitionCount += 1;
+		}
+	}
+
+	/* Variation data */
+	if (sb->variationCount > 0)
+	{
+		FAudio_assert((ptr - start) == variationOffset);
+		sb->variations = (FACTVariationTable*) pEngine->pMalloc(
+			sizeof(FACTVariationTable) *
+			sb->variationCount
+		);
+		sb->variationCodes = (uint32_t*) pEngine->pMalloc(
+			sizeof(uint32_t) *
+			sb->variationCount
+		);
+	}
+	else
+	{
+		sb->variations = NULL;
+		sb->variationCodes = NULL;
+	}
+	for (i = 0; i < sb->variationCount; i += 1)
+	{
+		sb->variationCodes[i] = (uint32_t) (ptr - start);
+		entryCountAndFlags = read_u32(&ptr, se);
+		sb->variations[i].entryCount = entryCountAndFlags & 0xFFFF;
+		sb->variations[i].flags = (entryCountAndFlags >> (16 + 3)) & 0x07;
+		ptr += 2; /* Unknown value */
+		sb->variations[i].variable = read_s16(&ptr, se);
+		memsize = sizeof(FACTVariation) * sb->variations[i].entryCount;
+		sb->variations[i].entries = (FACTVariation*) pEngine->pMalloc(
+			memsize
+		);
+		FAudio_zero(sb->variations[i].entries, memsize);
+
+		if (sb->variations[i].flags == 0)
+		{
+			/* Wave with byte min/max */
+			sb->variations[i].isComplex = 0;
+			for (j = 0; j < sb->variations[i].entryCount; j += 1)
+			{
+				sb->variations[i].entries[j].simple.track = read_u16(&ptr, se);
+				sb->variations[i].entries[j].simple.wavebank = read_u8(&ptr);
+				sb->variations[i].entries[j].minWeight = read_u8(&ptr) / 255.0f;
+				sb->variations[i].entries[j].maxWeight = read_u8(&ptr) / 255.0f;
+			}
+		}
+		else if (sb->variations[i].flags == 1)
+		{
+			/* Complex with byte min/max */
+			sb->variations[i].isComplex = 1;
+			for (j = 0; j < sb->variations[i].entryCount; j += 1)
+			{
+				sb->variations[i].entries[j].soundCode = read_u32(&ptr, se);
+				sb->variations[i].entries[j].minWeight = read_u8(&ptr) / 255.0f;
+				sb->variations[i].entries[j].maxWeight = read_u8(&ptr) / 255.0f;
+			}
+		}
+		else if (sb->variations[i].flags == 3)
+		{
+			/* Complex Interactive Variation with float min/max */
+			sb->variations[i].isComplex = 1;
+			for (j = 0; j < sb->variations[i].entryCount; j += 1)
+			{
+				sb->variations[i].entries[j].soundCode = read_u32(&ptr, se);
+				sb->variations[i].entries[j].minWeight = read_f32(&ptr, se);
+				sb->variations[i].entries[j].maxWeight = read_f32(&ptr, se);
+				sb->variations[i].entries[j].linger = read_u32(&ptr, se);
+			}
+		}
+		else if (sb->variations[i].flags == 4)
+		{
+			/* Compact Wave */
+			sb->variations[i].isComplex = 0;
+			for (j = 0; j < sb->variations[i].entryCount; j += 1)
+			{
+				sb->variations[i].entries[j].simple.track = read_u16(&ptr, se);
+				sb->variations[i].entries[j].simple.wavebank = read_u8(&ptr);
+				sb->variations[i].entries[j].minWeight = 0.0f;
+				sb->variations[i].entries[j].maxWeight = 1.0f;
+			}
+		}
+		else
+		{
+			FAudio_assert(0 && "Unknown variation type!");
+		}
+	}
+
+	/* Transition data */
+	if (sb->transitionCount > 0)
+	{
+		FAudio_assert((ptr - start) == transitionOffset);
+		sb->transitions = (FACTTransitionTable*) pEngine->pMalloc(
+			sizeof(FACTTransitionTable) *
+			sb->transitionCount
+		);
+		sb->transitionCodes = (uint32_t*) pEngine->pMalloc(
+			sizeof(uint32_t) *
+			sb->transitionCount
+		);
+	}
+	else
+	{
+		sb->transitions = NULL;
+		sb->transitionCodes = NULL;
+	}
+	for (i = 0; i < sb->transitionCount; i += 1)
+	{
+		sb->transitionCodes[i] = (uint32_t) (ptr - start);
+		sb->transitions[i].entryCount = read_u32(&ptr, se);
+		memsize = sizeof(FACTTransition) * sb->transitions[i].entryCount;
+		sb->transitions[i].entries = (FACTTransition*) pEngine->pMalloc(
+			memsize
+		);
+		FAudio_zero(sb->transitions[i].entries, memsize);
+		for (j = 0; j < sb->transitions[i].entryCount; j += 1)
+		{
+			sb->transitions[i].entries[j].soundCode = read_s32(&ptr, se);
+			sb->transitions[i].entries[j].srcMarkerMin = read_u32(&ptr, se);
+			sb->transitions[i].entries[j].srcMarkerMax = read_u32(&ptr, se);
+			sb->transitions[i].entries[j].dstMarkerMin = read_u32(&ptr, se);
+			sb->transitions[i].entries[j].dstMarkerMax = read_u32(&ptr, se);
+			sb->transitions[i].entries[j].fadeIn = read_u16(&ptr, se);
+			sb->transitions[i].entries[j].fadeOut = read_u16(&ptr, se);
+			sb->transitions[i].entries[j].flags = read_u16(&ptr, se);
+		}
+	}
+
+	/* Cue Hash data? No idea what this is... */
+	if (cueHashOffset != -1)
+	{
+		FAudio_assert((ptr - start) == cueHashOffset);
+		ptr += 2 * cueTotalAlign;
+	}
+
+	/* Cue Name Index data */
+	if (cueNameIndexOffset != -1)
+	{
+		FAudio_assert((ptr - start) == cueNameIndexOffset);
+		ptr += 6 * sb->cueCount; /* FIXME: index as assert value? */
+	}
+
+	/* Cue Name data */
+	if (cueNameOffset != -1)
+	{
+		FAudio_assert((ptr - start) == cueNameOffset);
+		sb->cueNames = (char**) pEngine->pMalloc(
+			sizeof(char*) *
+			sb->cueCount
+		);
+		for (i = 0; i < sb->cueCount; i += 1)
+		{
+			memsize = FAudio_strlen((char*) ptr) + 1;
+			sb->cueNames[i] = (char*) pEngine->pMalloc(memsize);
+			FAudio_memcpy(sb->cueNames[i], ptr, memsize);
+			ptr += memsize;
+		}
+	}
+	else
+	{
+		sb->cueNames = NULL;
+	}
+
+	/* Add to the Engine SoundBank list */
+	LinkedList_AddEntry(
+		&pEngine->sbList,
+		sb,
+		pEngine->sbLock,
+		pEngine->pMalloc
+	);
+
+	/* Finally. */
+	FAudio_assert((ptr - start) == dwSize);
+	*ppSoundBank = sb;
+	return 0;
+}
+
+/* This parser is based on the unxwb project, written by Luigi Auriemma.
+ *
+ * While the unxwb project was released under the GPL, Luigi has given us
+ * permission to use the unxwb sources under the zlib license.
+ *
+ * The unxwb website can be found here:
+ *
+ * http://aluigi.altervista.org/papers.htm#xbox
+ */
+uint32_t FACT_INTERNAL_ParseWaveBank(
+	FACTAudioEngine *pEngine,
+	void* io,
+	uint32_t offset,
+	uint32_t packetSize,
+	FACTReadFileCallback pRead,
+	FACTGetOverlappedResultCallback pOverlap,
+	uint16_t isStreaming,
+	FACTWaveBank **ppWaveBank
+) {
+	uint8_t se = 0; /* Swap Endian */
+	FACTWaveBank *wb;
+	size_t memsize;
+	uint32_t i, j;
+	FACTWaveBankHeader header;
+	FACTWaveBankData wbinfo;
+	uint32_t compactEntry;
+	int32_t seekTableOffset;
+	uint32_t fileOffset;
+	uint8_t *packetBuffer = NULL;
+	uint32_t packetBufferLen = 0;
+	uint16_t *pcm;
+
+	#define SEEKSET(loc) \
+		fileOffset = offset + loc;
+	#define SEEKCUR(loc) \
+		fileOffset += loc;
+	#define READ(dst, size) \
+		FACT_INTERNAL_ReadFile( \
+			pRead, \
+			pOverlap, \
+			io, \
+			fileOffset, \
+			packetSize, \
+			&packetBuffer, \
+			&packetBufferLen, \
+			pEngine->pRealloc, \
+			dst, \
+			size \
+		); \
+		SEEKCUR(size)
 
-	/* SoundBank Name */
-	memsize = FAudio_strlen((char*) ptr) + 1; /* Dastardly! */
-	sb->name = (char*) pEngine->pMalloc(memsize);
-	FAudio_memcpy(sb->name, ptr, memsize);
-	ptr += 64;
+	#define DOSWAP_16(x) x = FAudio_swap16BE(x)
+	#define DOSWAP_32(x) x = FAudio_swap32BE(x)
+	#define DOSWAP_64(x) x = FAudio_swap64BE(x)
 
-	/* WaveBank Name data */
-	FAudio_assert((ptr - start) == wavebankNameOffset);
-	sb->wavebankNames = (char**) pEngine->pMalloc(
-		sizeof(char*) *
-		sb->wavebankCount
-	);
-	for (i = 0; i < sb->wavebankCount; i += 1)
+	fileOffset = offset;
+	READ(&header, sizeof(header))
+	se = header.dwSignature == 0x57424E44;
+	if (se)
 	{
-		memsize = FAudio_strlen((char*) ptr) + 1;
-		sb->wavebankNames[i] = (char*) pEngine->pMalloc(memsize);
-		FAudio_memcpy(sb->wavebankNames[i], ptr, memsize);
-		ptr += 64;
+		DOSWAP_32(header.dwSignature);
+		DOSWAP_32(header.dwVersion);
+		DOSWAP_32(header.dwHeaderVersion);
+		for (i = 0; i < FACT_WAVEBANK_SEGIDX_COUNT; i += 1)
+		{
+			DOSWAP_32(header.Segments[i].dwOffset);
+			DOSWAP_32(header.Segments[i].dwLength);
+		}
 	}
-
-	/* Sound data */
-	FAudio_assert((ptr - start) == soundOffset);
-	sb->sounds = (FACTSound*) pEngine->pMalloc(
-		sizeof(FACTSound) *
-		sb->soundCount
-	);
-	sb->soundCodes = (uint32_t*) pEngine->pMalloc(
-		sizeof(uint32_t) *
-		sb->soundCount
-	);
-	for (i = 0; i < sb->soundCount; i += 1)
+	if (header.dwSignature != 0x444E4257)
 	{
-		sb->soundCodes[i] = (uint32_t) (ptr - start);
-		sb->sounds[i].flags = read_u8(&ptr);
-		sb->sounds[i].category = read_u16(&ptr, se);
-		sb->sounds[i].volume = read_volbyte(&ptr);
-		sb->sounds[i].pitch = read_s16(&ptr, se);
-		sb->sounds[i].priority = read_u8(&ptr);
+		return -1; /* TODO: NOT XACT FILE */
+	}
 
-		/* Length of sound entry, unused */
-		ptr += 2;
+	if (!FACT_INTERNAL_SupportedContent(header.dwVersion))
+	{
+		return -2;
+	}
 
-		/* Simple/Complex Track data */
-		if (sb->sounds[i].flags & 0x01)
-		{
-			sb->sounds[i].trackCount = read_u8(&ptr);
-			memsize = sizeof(FACTTrack) * sb->sounds[i].trackCount;
-			sb->sounds[i].tracks = (FACTTrack*) pEngine->pMalloc(memsize);
-			FAudio_zero(sb->sounds[i].tracks, memsize);
-		}
-		else
-		{
-			sb->sounds[i].trackCount = 1;
-			memsize = sizeof(FACTTrack) * sb->sounds[i].trackCount;
-			sb->sounds[i].tracks = (FACTTrack*) pEngine->pMalloc(memsize);
-			FAudio_zero(sb->sounds[i].tracks, memsize);
-			sb->sounds[i].tracks[0].volume = 0.0f;
-			sb->sounds[i].tracks[0].filter = 0xFF;
-			sb->sounds[i].tracks[0].eventCount = 1;
-			sb->sounds[i].tracks[0].events = (FACTEvent*) pEngine->pMalloc(
-				sizeof(FACTEvent)
-			);
-			FAudio_zero(
-				sb->sounds[i].tracks[0].events,
-				sizeof(FACTEvent)
-			);
-			sb->sounds[i].tracks[0].events[0].type = FACTEVENT_PLAYWAVE;
-			sb->sounds[i].tracks[0].events[0].wave.position = 0; /* FIXME */
-			sb->sounds[i].tracks[0].events[0].wave.angle = 0; /* FIXME */
-			sb->sounds[i].tracks[0].events[0].wave.simple.track = read_u16(&ptr, se);
-			sb->sounds[i].tracks[0].events[0].wave.simple.wavebank = read_u8(&ptr);
-		}
+	if (!FACT_INTERNAL_SupportedWBContent(header.dwHeaderVersion))
+	{
+		return -3;
+	}
 
-		/* RPC Code data */
-		if (sb->sounds[i].flags & 0x0E)
-		{
-			const uint16_t rpcDataLength = read_u16(&ptr, se);
-			ptrBookmark = ptr - 2;
+	wb = (FACTWaveBank*) pEngine->pMalloc(sizeof(FACTWaveBank));
+	wb->parentEngine = pEngine;
+	wb->waveList = NULL;
+	wb->waveLock = FAudio_PlatformCreateMutex();
+	wb->packetSize = packetSize;
+	wb->io = io;
+	wb->notifyOnDestroy = 0;
+	wb->usercontext = NULL;
+	wb->wavePool = NULL;
+	wb->wavePoolCount = 0;
 
-			#define COPYRPCBLOCK(loc) \
-				loc.rpcCodeCount = read_u8(&ptr); \
-				memsize = sizeof(uint32_t) * loc.rpcCodeCount; \
-				loc.rpcCodes = (uint32_t*) pEngine->pMalloc(memsize); \
-				for (k = 0; k < loc.rpcCodeCount; k += 1) \
-				{ \
-					loc.rpcCodes[k] = read_u32(&ptr, se); \
-				} \
+	/* WaveBank Data */
+	SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_BANKDATA].dwOffset)
+	READ(&wbinfo, sizeof(wbinfo))
+	if (se)
+	{
+		DOSWAP_32(wbinfo.dwFlags);
+		DOSWAP_32(wbinfo.dwEntryCount);
+		DOSWAP_32(wbinfo.dwEntryMetaDataElementSize);
+		DOSWAP_32(wbinfo.dwEntryNameElementSize);
+		DOSWAP_32(wbinfo.dwAlignment);
+		DOSWAP_32(wbinfo.CompactFormat.dwValue);
+		DOSWAP_64(wbinfo.BuildTime);
+	}
+	wb->streaming = (wbinfo.dwFlags & FACT_WAVEBANK_TYPE_STREAMING);
+	wb->entryCount = wbinfo.dwEntryCount;
+	memsize = FAudio_strlen(wbinfo.szBankName) + 1;
+	wb->name = (char*) pEngine->pMalloc(memsize);
+	FAudio_memcpy(wb->name, wbinfo.szBankName, memsize);
+	memsize = sizeof(FACTWaveBankEntry) * wbinfo.dwEntryCount;
+	wb->entries = (FACTWaveBankEntry*) pEngine->pMalloc(memsize);
+	FAudio_zero(wb->entries, memsize);
+	memsize = sizeof(uint32_t) * wbinfo.dwEntryCount;
+	wb->entryRefs = (uint32_t*) pEngine->pMalloc(memsize);
+	FAudio_zero(wb->entryRefs, memsize);
 
-			/* Sound has attached RPCs */
-			if (sb->sounds[i].flags & 0x02)
-			{
-				COPYRPCBLOCK(sb->sounds[i])
-			}
-			else
-			{
-				sb->sounds[i].rpcCodeCount = 0;
-				sb->sounds[i].rpcCodes = NULL;
-			}
+	/* FIXME: How much do we care about this? */
+	FAudio_assert(wb->streaming == isStreaming);
+	wb->streaming = isStreaming;
 
-			/* Tracks have attached RPCs */
-			if (sb->sounds[i].flags & 0x04)
-			{
-				for (j = 0; j < sb->sounds[i].trackCount; j += 1)
-				{
-					COPYRPCBLOCK(sb->sounds[i].tracks[j])
-				}
-			}
-			else
+	/* WaveBank Entry Metadata */
+	SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYMETADATA].dwOffset)
+	if (wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_COMPACT)
+	{
+		for (i = 0; i < wbinfo.dwEntryCount - 1; i += 1)
+		{
+			READ(&compactEntry, sizeof(compactEntry))
+			if (se)
 			{
-				for (j = 0; j < sb->sounds[i].trackCount; j += 1)
-				{
-					sb->sounds[i].tracks[j].rpcCodeCount = 0;
-					sb->sounds[i].tracks[j].rpcCodes = NULL;
-				}
+				DOSWAP_32(compactEntry);
 			}
+			wb->entries[i].PlayRegion.dwOffset = (
+				(compactEntry & ((1 << 21) - 1)) *
+				wbinfo.dwAlignment
+			);
+			wb->entries[i].PlayRegion.dwLength = (
+				(compactEntry >> 21) & ((1 << 11) - 1)
+			);
 
-			#undef COPYRPCBLOCK
+			/* TODO: Deviation table */
+			SEEKCUR(wbinfo.dwEntryMetaDataElementSize)
+			wb->entries[i].PlayRegion.dwLength = (
+				(compactEntry & ((1 << 21) - 1)) *
+				wbinfo.dwAlignment
+			) - wb->entries[i].PlayRegion.dwOffset;
 
-			/* FIXME: Does 0x08 mean something for RPCs...? */
-			FAudio_assert((ptr - ptrBookmark) == rpcDataLength);
+			wb->entries[i].PlayRegion.dwOffset +=
+				header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
 		}
-		else
+
+		READ(&compactEntry, sizeof(compactEntry))
+		if (se)
 		{
-			sb->sounds[i].rpcCodeCount = 0;
-			sb->sounds[i].rpcCodes = NULL;
-			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
-			{
-				sb->sounds[i].tracks[j].rpcCodeCount = 0;
-				sb->sounds[i].tracks[j].rpcCodes = NULL;
-			}
+			DOSWAP_32(compactEntry);
 		}
+		wb->entries[i].PlayRegion.dwOffset = (
+			(compactEntry & ((1 << 21) - 1)) *
+			wbinfo.dwAlignment
+		);
 
-		/* DSP Preset Code data */
-		if (sb->sounds[i].flags & 0x10)
+		/* TODO: Deviation table */
+		SEEKCUR(wbinfo.dwEntryMetaDataElementSize)
+		wb->entries[i].PlayRegion.dwLength = (
+			header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwLength -
+			wb->entries[i].PlayRegion.dwOffset
+		);
+
+		wb->entries[i].PlayRegion.dwOffset +=
+			header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
+	}
+	else
+	{
+		for (i = 0; i < wbinfo.dwEntryCount; i += 1)
 		{
-			/* DSP presets length, unused */
-			ptr += 2;
+			READ(&wb->entries[i], wbinfo.dwEntryMetaDataElementSize)
+			if (se)
+			{
+				DOSWAP_32(wb->entries[i].dwFlagsAndDuration);
+				DOSWAP_32(wb->entries[i].Format.dwValue);
+				DOSWAP_32(wb->entries[i].PlayRegion.dwOffset);
+				DOSWAP_32(wb->entries[i].PlayRegion.dwLength);
+				DOSWAP_32(wb->entries[i].LoopRegion.dwStartSample);
+				DOSWAP_32(wb->entries[i].LoopRegion.dwTotalSamples);
+			}
+			wb->entries[i].PlayRegion.dwOffset +=
+				header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
 
-			sb->sounds[i].dspCodeCount = read_u8(&ptr);
-			memsize = sizeof(uint32_t) * sb->sounds[i].dspCodeCount;
-			sb->sounds[i].dspCodes = (uint32_t*) pEngine->pMalloc(memsize);
-			for (j = 0; j < sb->sounds[i].dspCodeCount; j += 1)
+			/* If it's in-memory big-endian PCM, swap! */
+			if (	se &&
+				!wb->streaming &&
+				wb->entries[i].Format.wFormatTag == 0x0 &&
+				wb->entries[i].Format.wBitsPerSample == 1	)
 			{
-				sb->sounds[i].dspCodes[j] = read_u32(&ptr, se);
+				pcm = (uint16_t*) FAudio_memptr(
+					(FAudioIOStream*) wb->io,
+					wb->entries[i].PlayRegion.dwOffset
+				);
+				for (j = 0; j < wb->entries[i].PlayRegion.dwLength; j += 2, pcm += 1)
+				{
+					DOSWAP_16(*pcm);
+				}
 			}
 		}
-		else
+
+		/* FIXME: This is a bit hacky. */
+		if (wbinfo.dwEntryMetaDataElementSize < 24)
 		{
-			sb->sounds[i].dspCodeCount = 0;
-			sb->sounds[i].dspCodes = NULL;
+			for (i = 0; i < wbinfo.dwEntryCount; i += 1)
+			{
+				wb->entries[i].PlayRegion.dwLength =
+					header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwLength;
+			}
 		}
+	}
 
-		/* Track data */
-		if (sb->sounds[i].flags & 0x01)
+	/* WaveBank Seek Tables */
+	if (	wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_SEEKTABLES &&
+		header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwLength > 0	)
+	{
+		/* The seek table data layout is an absolute disaster! */
+		wb->seekTables = (FACTSeekTable*) pEngine->pMalloc(
+			wbinfo.dwEntryCount * sizeof(FACTSeekTable)
+		);
+		for (i = 0; i < wbinfo.dwEntryCount; i += 1)
 		{
-			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+			/* Get the table offset... */
+			SEEKSET(
+				header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwOffset +
+				i * sizeof(uint32_t)
+			)
+			READ(&seekTableOffset, sizeof(int32_t))
+			if (se)
 			{
-				sb->sounds[i].tracks[j].volume = read_volbyte(&ptr);
+				DOSWAP_32(seekTableOffset);
+			}
 
-				sb->sounds[i].tracks[j].code = read_u32(&ptr, se);
+			/* If the offset is -1, this wave needs no table */
+			if (seekTableOffset == -1)
+			{
+				wb->seekTables[i].entryCount = 0;
+				wb->seekTables[i].entries = NULL;
+				continue;
+			}
 
-				if (contentVersion == FACT_CONTENT_VERSION_3_0)
-				{
-					/* 3.0 doesn't have track filter data */
-					sb->sounds[i].tracks[j].filter = 0xFF;
-					sb->sounds[i].tracks[j].qfactor = 0;
-					sb->sounds[i].tracks[j].frequency = 0;
-					continue;
-				}
+			/* Go to the table offset, after the offset table... */
+			SEEKSET(
+				header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwOffset +
+				(wbinfo.dwEntryCount * sizeof(uint32_t)) +
+				seekTableOffset
+			)
 
-				filterData = read_u16(&ptr, se);
-				if (filterData & 0x0001)
-				{
-					sb->sounds[i].tracks[j].filter =
-						(filterData >> 1) & 0x02;
-				}
-				else
-				{
-					/* Huh...? */
-					sb->sounds[i].tracks[j].filter = 0xFF;
-				}
-				sb->sounds[i].tracks[j].qfactor = (filterData >> 8) & 0xFF;
-				sb->sounds[i].tracks[j].frequency = read_u16(&ptr, se);
+			/* Read the table, finally. */
+			READ(&wb->seekTables[i].entryCount, sizeof(uint32_t))
+			if (se)
+			{
+				DOSWAP_32(wb->seekTables[i].entryCount);
 			}
-
-			/* All Track events are stored at the end of the block */
-			for (j = 0; j < sb->sounds[i].trackCount; j += 1)
+			wb->seekTables[i].entries = (uint32_t*) pEngine->pMalloc(
+				wb->seekTables[i].entryCount * sizeof(uint32_t)
+			);
+			READ(
+				wb->seekTables[i].entries,
+				wb->seekTables[i].entryCount * sizeof(uint32_t)
+			)
+			if (se)
 			{
-				FAudio_assert((ptr - start) == sb->sounds[i].tracks[j].code);
-				FACT_INTERNAL_ParseTrackEvents(
-					&ptr,
-					se,
-					&sb->sounds[i].tracks[j],
-					pEngine->pMalloc
-				);
+				for (j = 0; j < wb->seekTables[i].entryCount; j += 1)
+				{
+					DOSWAP_32(wb->seekTables[i].entries[j]);
+				}
 			}
 		}
 	}
-
-	/* All Cue data */
-	sb->variationCount = 0;
-	sb->transitionCount = 0;
-	sb->cues = (FACTCueData*) pEngine->pMalloc(
-		sizeof(FACTCueData) *
-		sb->cueCount
-	);
-	cur = 0;
-
-	/* Simple Cue data */
-	FAudio_assert(cueSimpleCount == 0 || (ptr - start) == cueSimpleOffset);
-	for (i = 0; i < cueSimpleCount; i += 1, cur += 1)
-	{
-		sb->cues[cur].flags = read_u8(&ptr);
-		sb->cues[cur].sbCode = read_u32(&ptr, se);
-		sb->cues[cur].transitionOffset = 0;
-		sb->cues[cur].instanceLimit = 0xFF;
-		sb->cues[cur].fadeInMS = 0;
-		sb->cues[cur].fadeOutMS = 0;
-		sb->cues[cur].maxInstanceBehavior = 0;
-		sb->cues[cur].instanceCount = 0;
-	}
-
-	/* Complex Cue data */
-	FAudio_assert(cueComplexCount == 0 || (ptr - start) == cueComplexOffset);
-	for (i = 0; i < cueComplexCount; i += 1, cur += 1)
+	else
 	{
-		sb->cues[cur].flags = read_u8(&ptr);
-		sb->cues[cur].sbCode = read_u32(&ptr, se);
-		sb->cues[cur].transitionOffset = read_u32(&ptr, se);
-		if (sb->cues[cur].transitionOffset == 0xFFFFFFFF)
-		{
-			/* FIXME: Why */
-			sb->cues[cur].transitionOffset = 0;
-		}
-		sb->cues[cur].instanceLimit = read_u8(&ptr);
-		sb->cues[cur].fadeInMS = read_u16(&ptr, se);
-		sb->cues[cur].fadeOutMS = read_u16(&ptr, se);
-		sb->cues[cur].maxInstanceBehavior = read_u8(&ptr) >> 3;
-		sb->cues[cur].instanceCount = 0;
-
-		if (!(sb->cues[cur].flags & 0x04))
-		{
-			/* FIXME: Is this the only way to get this...? */
-			sb->variationCount += 1;
-		}
-		if (sb->cues[cur].transitionOffset > 0)
-		{
-			/* FIXME: Is this the only way to get this...? */
-			sb->transitionCount += 1;
-		}
+		wb->seekTables = NULL;
 	}
 
-	/* Variation data */
-	if (sb->variationCount > 0)
+	/* WaveBank Entry Names */
+	if (wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_ENTRYNAMES)
 	{
-		FAudio_assert((ptr - start) == variationOffset);
-		sb->variations = (FACTVariationTable*) pEngine->pMalloc(
-			sizeof(FACTVariationTable) *
-			sb->variationCount
-		);
-		sb->variationCodes = (uint32_t*) pEngine->pMalloc(
-			sizeof(uint32_t) *
-			sb->variationCount
-		);
+		SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYNAMES].dwOffset)
+		wb->waveBankNames = (char*) pEngine->pMalloc(64 * wbinfo.dwEntryCount);
+		READ(wb->waveBankNames, 64 * wbinfo.dwEntryCount);
 	}
 	else
 	{
-		sb->variations = NULL;
-		sb->variationCodes = NULL;
+		wb->waveBankNames = NULL;
 	}
-	for (i = 0; i < sb->variationCount; i += 1)
+
+	/* Add to the Engine WaveBank list */
+	LinkedList_AddEntry(
+		&pEngine->wbList,
+		wb,
+		pEngine->wbLock,
+		pEngine->pMalloc
+	);
+
+	/* Finally. */
+	wb->packetBuffer = packetBuffer;
+	wb->packetBufferLen = packetBufferLen;
+	*ppWaveBank = wb;
+	return 0;
+}
+
+/* Binary Cache Functions
+ *
+ * A cache is the parsed form of an XGS/XSB, written out as one block where
+ * every pointer is stored as an offset from the start of the block. Loading
+ * one is a single allocation, a memcpy and a pointer fixup pass, rather than
+ * the hundreds of tiny allocations the parsers above make for a big project.
+ *
+ * The layout is only meant to be read by the same build that wrote it, so
+ * the header carries a signature of the structure sizes; anything that does
+ * not match is rejected and the caller should fall back to the real file.
+ */
+
+#define FACT_CACHE_VERSION 2
+
+typedef struct FACTCacheHeader
+{
+	uint32_t magic;
+	uint32_t layout;
+	uint32_t size;
+	uint32_t reserved;
+} FACTCacheHeader;
+
+typedef struct FACTAudioEngineCache
+{
+	FACTCacheHeader header;
+
+	uint16_t categoryCount;
+	uint16_t variableCount;
+	uint16_t rpcCount;
+	uint16_t dspPresetCount;
+	uint16_t dspParameterCount;
+
+	char **categoryNames;
+	char **variableNames;
+	uint32_t *rpcCodes;
+	uint32_t *dspPresetCodes;
+
+	FACTAudioCategory *categories;
+	FACTVariable *variables;
+	FACTRPC *rpcs;
+	FACTDSPPreset *dspPresets;
+	float *globalVariableValues;
+} FACTAudioEngineCache;
+
+typedef struct FACTSoundBankCache
+{
+	FACTCacheHeader header;
+
+	uint16_t cueCount;
+	uint8_t wavebankCount;
+	uint16_t soundCount;
+	uint16_t variationCount;
+	uint16_t transitionCount;
+
+	char **wavebankNames;
+	char **cueNames;
+
+	char *name;
+	FACTCueData *cues;
+	FACTSound *sounds;
+	uint32_t *soundCodes;
+	FACTVariationTable *variations;
+	uint32_t *variationCodes;
+	FACTTransitionTable *transitions;
+	uint32_t *transitionCodes;
+} FACTSoundBankCache;
+
+typedef struct FACTCacheWriter
+{
+	uint8_t *base; /* NULL when only measuring */
+	size_t size;
+} FACTCacheWriter;
+
+static uint32_t FACT_INTERNAL_CacheLayout()
+{
+	uint32_t hash = FACT_CACHE_VERSION;
+	#define HASH(t) hash = (hash * 31) + (uint32_t) sizeof(t);
+	HASH(void*)
+	HASH(FACTAudioCategory)
+	HASH(FACTVariable)
+	HASH(FACTRPCPoint)
+	HASH(FACTRPC)
+	HASH(FACTDSPParameter)
+	HASH(FACTDSPPreset)
+	HASH(FACTEvent)
+	HASH(FACTTrack)
+	HASH(FACTSound)
+	HASH(FACTCueData)
+	HASH(FACTVariation)
+	HASH(FACTVariationTable)
+	HASH(FACTTransition)
+	HASH(FACTTransitionTable)
+	HASH(FACTAudioEngineCache)
+	HASH(FACTSoundBankCache)
+	#undef HASH
+	return hash;
+}
+
+static size_t FACT_INTERNAL_CacheWrite(
+	FACTCacheWriter *writer,
+	const void *data,
+	size_t len
+) {
+	size_t offset;
+	if (data == NULL)
 	{
-		sb->variationCodes[i] = (uint32_t) (ptr - start);
-		entryCountAndFlags = read_u32(&ptr, se);
-		sb->variations[i].entryCount = entryCountAndFlags & 0xFFFF;
-		sb->variations[i].flags = (entryCountAndFlags >> (16 + 3)) & 0x07;
-		ptr += 2; /* Unknown value */
-		sb->variations[i].variable = read_s16(&ptr, se);
-		memsize = sizeof(FACTVariation) * sb->variations[i].entryCount;
-		sb->variations[i].entries = (FACTVariation*) pEngine->pMalloc(
-			memsize
-		);
-		FAudio_zero(sb->variations[i].entries, memsize);
+		return 0;
+	}
 
-		if (sb->variations[i].flags == 0)
-		{
-			/* Wave with byte min/max */
-			sb->variations[i].isComplex = 0;
-			for (j = 0; j < sb->variations[i].entryCount; j += 1)
-			{
-				sb->variations[i].entries[j].simple.track = read_u16(&ptr, se);
-				sb->variations[i].entries[j].simple.wavebank = read_u8(&ptr);
-				sb->variations[i].entries[j].minWeight = read_u8(&ptr) / 255.0f;
-				sb->variations[i].entries[j].maxWeight = read_u8(&ptr) / 255.0f;
-			}
-		}
-		else if (sb->variations[i].flags == 1)
-		{
-			/* Complex with byte min/max */
-			sb->variations[i].isComplex = 1;
-			for (j = 0; j < sb->variations[i].entryCount; j += 1)
-			{
-				sb->variations[i].entries[j].soundCode = read_u32(&ptr, se);
-				sb->variations[i].entries[j].minWeight = read_u8(&ptr) / 255.0f;
-				sb->variations[i].entries[j].maxWeight = read_u8(&ptr) / 255.0f;
-			}
-		}
-		else if (sb->variations[i].flags == 3)
-		{
-			/* Complex Interactive Variation with float min/max */
-			sb->variations[i].isComplex = 1;
-			for (j = 0; j < sb->variations[i].entryCount; j += 1)
-			{
-				sb->variations[i].entries[j].soundCode = read_u32(&ptr, se);
-				sb->variations[i].entries[j].minWeight = read_f32(&ptr, se);
-				sb->variations[i].entries[j].maxWeight = read_f32(&ptr, se);
-				sb->variations[i].entries[j].linger = read_u32(&ptr, se);
-			}
-		}
-		else if (sb->variations[i].flags == 4)
+	/* Keep everything aligned so the block can be used in place */
+	offset = (writer->size + 7) & ~((size_t) 7);
+	if (writer->base != NULL)
+	{
+		FAudio_memcpy(writer->base + offset, data, len);
+	}
+	writer->size = offset + len;
+	return offset;
+}
+
+#define CACHE_AT(type, offset) ((type*) (writer->base + (offset)))
+#define CACHE_PATCH(dst, offset) \
+	if (writer->base != NULL) \
+	{ \
+		dst = (void*) (offset); \
+	}
+
+static size_t FACT_INTERNAL_CacheWriteStrings(
+	FACTCacheWriter *writer,
+	char **strings,
+	uint16_t count
+) {
+	size_t offset, str;
+	uint16_t i;
+
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		strings,
+		sizeof(char*) * count
+	);
+	for (i = 0; i < count; i += 1)
+	{
+		str = FACT_INTERNAL_CacheWrite(
+			writer,
+			strings[i],
+			FAudio_strlen(strings[i]) + 1
+		);
+		CACHE_PATCH(CACHE_AT(char*, offset)[i], str)
+	}
+	return offset;
+}
+
+static void FACT_INTERNAL_WriteAudioEngineCache(
+	FACTCacheWriter *writer,
+	void *object
+) {
+	FACTAudioEngine *pEngine = (FACTAudioEngine*) object;
+	FACTAudioEngineCache root;
+	size_t offset, sub;
+	uint16_t i;
+
+	FAudio_zero(&root, sizeof(root));
+	root.header.magic = FACT_CACHE_MAGIC_ENGINE;
+	root.header.layout = FACT_INTERNAL_CacheLayout();
+	root.categoryCount = pEngine->categoryCount;
+	root.variableCount = pEngine->variableCount;
+	root.rpcCount = pEngine->rpcCount;
+	root.dspPresetCount = pEngine->dspPresetCount;
+	root.dspParameterCount = pEngine->dspParameterCount;
+	FACT_INTERNAL_CacheWrite(writer, &root, sizeof(root));
+	#define ROOT CACHE_AT(FACTAudioEngineCache, 0)
+
+	/* Category data */
+	offset = FACT_INTERNAL_CacheWriteStrings(
+		writer,
+		pEngine->categoryNames,
+		pEngine->categoryCount
+	);
+	CACHE_PATCH(ROOT->categoryNames, offset)
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->categories,
+		sizeof(FACTAudioCategory) * pEngine->categoryCount
+	);
+	CACHE_PATCH(ROOT->categories, offset)
+	if (writer->base != NULL)
+	{
+		/* Store the state as it was right after parsing */
+		for (i = 0; i < pEngine->categoryCount; i += 1)
 		{
-			/* Compact Wave */
-			sb->variations[i].isComplex = 0;
-			for (j = 0; j < sb->variations[i].entryCount; j += 1)
-			{
-				sb->variations[i].entries[j].simple.track = read_u16(&ptr, se);
-				sb->variations[i].entries[j].simple.wavebank = read_u8(&ptr);
-				sb->variations[i].entries[j].minWeight = 0.0f;
-				sb->variations[i].entries[j].maxWeight = 1.0f;
-			}
+			CACHE_AT(FACTAudioCategory, offset)[i].instanceCount = 0;
+			CACHE_AT(FACTAudioCategory, offset)[i].currentVolume = 1.0f;
 		}
-		else
+	}
+
+	/* Variable data */
+	offset = FACT_INTERNAL_CacheWriteStrings(
+		writer,
+		pEngine->variableNames,
+		pEngine->variableCount
+	);
+	CACHE_PATCH(ROOT->variableNames, offset)
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->variables,
+		sizeof(FACTVariable) * pEngine->variableCount
+	);
+	CACHE_PATCH(ROOT->variables, offset)
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->globalVariableValues,
+		sizeof(float) * pEngine->variableCount
+	);
+	CACHE_PATCH(ROOT->globalVariableValues, offset)
+	if (writer->base != NULL && offset != 0)
+	{
+		for (i = 0; i < pEngine->variableCount; i += 1)
 		{
-			FAudio_assert(0 && "Unknown variation type!");
+			CACHE_AT(float, offset)[i] =
+				pEngine->variables[i].initialValue;
 		}
 	}
 
-	/* Transition data */
-	if (sb->transitionCount > 0)
+	/* RPC data */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->rpcs,
+		sizeof(FACTRPC) * pEngine->rpcCount
+	);
+	CACHE_PATCH(ROOT->rpcs, offset)
+	for (i = 0; i < pEngine->rpcCount; i += 1)
 	{
-		FAudio_assert((ptr - start) == transitionOffset);
-		sb->transitions = (FACTTransitionTable*) pEngine->pMalloc(
-			sizeof(FACTTransitionTable) *
-			sb->transitionCount
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pEngine->rpcs[i].points,
+			sizeof(FACTRPCPoint) * pEngine->rpcs[i].pointCount
 		);
-		sb->transitionCodes = (uint32_t*) pEngine->pMalloc(
-			sizeof(uint32_t) *
-			sb->transitionCount
+		CACHE_PATCH(CACHE_AT(FACTRPC, offset)[i].points, sub)
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pEngine->rpcs[i].table,
+			sizeof(float) * (FACT_RPC_TABLE_SIZE + 1)
 		);
+		CACHE_PATCH(CACHE_AT(FACTRPC, offset)[i].table, sub)
 	}
-	else
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->rpcCodes,
+		sizeof(uint32_t) * pEngine->rpcCount
+	);
+	CACHE_PATCH(ROOT->rpcCodes, offset)
+
+	/* DSP data */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->dspPresets,
+		sizeof(FACTDSPPreset) * pEngine->dspPresetCount
+	);
+	CACHE_PATCH(ROOT->dspPresets, offset)
+	for (i = 0; i < pEngine->dspPresetCount; i += 1)
 	{
-		sb->transitions = NULL;
-		sb->transitionCodes = NULL;
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pEngine->dspPresets[i].parameters,
+			sizeof(FACTDSPParameter) * pEngine->dspPresets[i].parameterCount
+		);
+		CACHE_PATCH(CACHE_AT(FACTDSPPreset, offset)[i].parameters, sub)
 	}
-	for (i = 0; i < sb->transitionCount; i += 1)
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pEngine->dspPresetCodes,
+		sizeof(uint32_t) * pEngine->dspPresetCount
+	);
+	CACHE_PATCH(ROOT->dspPresetCodes, offset)
+
+	if (writer->base != NULL)
 	{
-		sb->transitionCodes[i] = (uint32_t) (ptr - start);
-		sb->transitions[i].entryCount = read_u32(&ptr, se);
-		memsize = sizeof(FACTTransition) * sb->transitions[i].entryCount;
-		sb->transitions[i].entries = (FACTTransition*) pEngine->pMalloc(
-			memsize
-		);
-		FAudio_zero(sb->transitions[i].entries, memsize);
-		for (j = 0; j < sb->transitions[i].entryCount; j += 1)
-		{
-			sb->transitions[i].entries[j].soundCode = read_s32(&ptr, se);
-			sb->transitions[i].entries[j].srcMarkerMin = read_u32(&ptr, se);
-			sb->transitions[i].entries[j].srcMarkerMax = read_u32(&ptr, se);
-			sb->transitions[i].entries[j].dstMarkerMin = read_u32(&ptr, se);
-			sb->transitions[i].entries[j].dstMarkerMax = read_u32(&ptr, se);
-			sb->transitions[i].entries[j].fadeIn = read_u16(&ptr, se);
-			sb->transitions[i].entries[j].fadeOut = read_u16(&ptr, se);
-			sb->transitions[i].entries[j].flags = read_u16(&ptr, se);
-		}
+		ROOT->header.size = (uint32_t) writer->size;
 	}
+	#undef ROOT
+}
 
-	/* Cue Hash data? No idea what this is... */
-	if (cueHashOffset != -1)
+static void FACT_INTERNAL_WriteSoundBankCache(
+	FACTCacheWriter *writer,
+	void *object
+) {
+	FACTSoundBank *pSoundBank = (FACTSoundBank*) object;
+	FACTSoundBankCache root;
+	FACTEvent *evt;
+	size_t offset, sound, track, event, sub;
+	uint16_t i, j, k;
+
+	FAudio_zero(&root, sizeof(root));
+	root.header.magic = FACT_CACHE_MAGIC_SOUNDBANK;
+	root.header.layout = FACT_INTERNAL_CacheLayout();
+	root.cueCount = pSoundBank->cueCount;
+	root.wavebankCount = pSoundBank->wavebankCount;
+	root.soundCount = pSoundBank->soundCount;
+	root.variationCount = pSoundBank->variationCount;
+	root.transitionCount = pSoundBank->transitionCount;
+	FACT_INTERNAL_CacheWrite(writer, &root, sizeof(root));
+	#define ROOT CACHE_AT(FACTSoundBankCache, 0)
+
+	/* Strings */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->name,
+		FAudio_strlen(pSoundBank->name) + 1
+	);
+	CACHE_PATCH(ROOT->name, offset)
+	offset = FACT_INTERNAL_CacheWriteStrings(
+		writer,
+		pSoundBank->wavebankNames,
+		pSoundBank->wavebankCount
+	);
+	CACHE_PATCH(ROOT->wavebankNames, offset)
+	if (pSoundBank->cueNames != NULL)
 	{
-		FAudio_assert((ptr - start) == cueHashOffset);
-		ptr += 2 * cueTotalAlign;
+		offset = FACT_INTERNAL_CacheWriteStrings(
+			writer,
+			pSoundBank->cueNames,
+			pSoundBank->cueCount
+		);
+		CACHE_PATCH(ROOT->cueNames, offset)
 	}
 
-	/* Cue Name Index data */
-	if (cueNameIndexOffset != -1)
+	/* Cue data */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->cues,
+		sizeof(FACTCueData) * pSoundBank->cueCount
+	);
+	CACHE_PATCH(ROOT->cues, offset)
+	if (writer->base != NULL)
 	{
-		FAudio_assert((ptr - start) == cueNameIndexOffset);
-		ptr += 6 * sb->cueCount; /* FIXME: index as assert value? */
+		for (i = 0; i < pSoundBank->cueCount; i += 1)
+		{
+			CACHE_AT(FACTCueData, offset)[i].instanceCount = 0;
+		}
 	}
 
-	/* Cue Name data */
-	if (cueNameOffset != -1)
+	/* Sound data */
+	sound = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->sounds,
+		sizeof(FACTSound) * pSoundBank->soundCount
+	);
+	CACHE_PATCH(ROOT->sounds, sound)
+	for (i = 0; i < pSoundBank->soundCount; i += 1)
 	{
-		FAudio_assert((ptr - start) == cueNameOffset);
-		sb->cueNames = (char**) pEngine->pMalloc(
-			sizeof(char*) *
-			sb->cueCount
+		track = FACT_INTERNAL_CacheWrite(
+			writer,
+			pSoundBank->sounds[i].tracks,
+			sizeof(FACTTrack) * pSoundBank->sounds[i].trackCount
 		);
-		for (i = 0; i < sb->cueCount; i += 1)
+		CACHE_PATCH(CACHE_AT(FACTSound, sound)[i].tracks, track)
+		for (j = 0; j < pSoundBank->sounds[i].trackCount; j += 1)
 		{
-			memsize = FAudio_strlen((char*) ptr) + 1;
-			sb->cueNames[i] = (char*) pEngine->pMalloc(memsize);
-			FAudio_memcpy(sb->cueNames[i], ptr, memsize);
-			ptr += memsize;
+			sub = FACT_INTERNAL_CacheWrite(
+				writer,
+				pSoundBank->sounds[i].tracks[j].rpcCodes,
+				sizeof(uint32_t) * pSoundBank->sounds[i].tracks[j].rpcCodeCount
+			);
+			CACHE_PATCH(CACHE_AT(FACTTrack, track)[j].rpcCodes, sub)
+
+			event = FACT_INTERNAL_CacheWrite(
+				writer,
+				pSoundBank->sounds[i].tracks[j].events,
+				sizeof(FACTEvent) * pSoundBank->sounds[i].tracks[j].eventCount
+			);
+			CACHE_PATCH(CACHE_AT(FACTTrack, track)[j].events, event)
+			for (k = 0; k < pSoundBank->sounds[i].tracks[j].eventCount; k += 1)
+			{
+				evt = &pSoundBank->sounds[i].tracks[j].events[k];
+				#define MATCH(t) evt->type == t
+				if (	!(	MATCH(FACTEVENT_PLAYWAVE) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVEEFFECTVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION)	) ||
+					!evt->wave.isComplex	)
+				{
+					continue;
+				}
+				#undef MATCH
+				sub = FACT_INTERNAL_CacheWrite(
+					writer,
+					evt->wave.complex.tracks,
+					sizeof(uint16_t) * evt->wave.complex.trackCount
+				);
+				CACHE_PATCH(CACHE_AT(FACTEvent, event)[k].wave.complex.tracks, sub)
+				sub = FACT_INTERNAL_CacheWrite(
+					writer,
+					evt->wave.complex.wavebanks,
+					sizeof(uint8_t) * evt->wave.complex.trackCount
+				);
+				CACHE_PATCH(CACHE_AT(FACTEvent, event)[k].wave.complex.wavebanks, sub)
+				sub = FACT_INTERNAL_CacheWrite(
+					writer,
+					evt->wave.complex.weights,
+					sizeof(uint8_t) * evt->wave.complex.trackCount
+				);
+				CACHE_PATCH(CACHE_AT(FACTEvent, event)[k].wave.complex.weights, sub)
+			}
 		}
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pSoundBank->sounds[i].rpcCodes,
+			sizeof(uint32_t) * pSoundBank->sounds[i].rpcCodeCount
+		);
+		CACHE_PATCH(CACHE_AT(FACTSound, sound)[i].rpcCodes, sub)
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pSoundBank->sounds[i].dspCodes,
+			sizeof(uint32_t) * pSoundBank->sounds[i].dspCodeCount
+		);
+		CACHE_PATCH(CACHE_AT(FACTSound, sound)[i].dspCodes, sub)
 	}
-	else
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->soundCodes,
+		sizeof(uint32_t) * pSoundBank->soundCount
+	);
+	CACHE_PATCH(ROOT->soundCodes, offset)
+
+	/* Variation data */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->variations,
+		sizeof(FACTVariationTable) * pSoundBank->variationCount
+	);
+	CACHE_PATCH(ROOT->variations, offset)
+	for (i = 0; i < pSoundBank->variationCount; i += 1)
 	{
-		sb->cueNames = NULL;
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pSoundBank->variations[i].entries,
+			sizeof(FACTVariation) * pSoundBank->variations[i].entryCount
+		);
+		CACHE_PATCH(CACHE_AT(FACTVariationTable, offset)[i].entries, sub)
 	}
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->variationCodes,
+		sizeof(uint32_t) * pSoundBank->variationCount
+	);
+	CACHE_PATCH(ROOT->variationCodes, offset)
 
-	/* Add to the Engine SoundBank list */
-	LinkedList_AddEntry(
-		&pEngine->sbList,
-		sb,
-		pEngine->sbLock,
-		pEngine->pMalloc
+	/* Transition data */
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->transitions,
+		sizeof(FACTTransitionTable) * pSoundBank->transitionCount
+	);
+	CACHE_PATCH(ROOT->transitions, offset)
+	for (i = 0; i < pSoundBank->transitionCount; i += 1)
+	{
+		sub = FACT_INTERNAL_CacheWrite(
+			writer,
+			pSoundBank->transitions[i].entries,
+			sizeof(FACTTransition) * pSoundBank->transitions[i].entryCount
+		);
+		CACHE_PATCH(CACHE_AT(FACTTransitionTable, offset)[i].entries, sub)
+	}
+	offset = FACT_INTERNAL_CacheWrite(
+		writer,
+		pSoundBank->transitionCodes,
+		sizeof(uint32_t) * pSoundBank->transitionCount
 	);
+	CACHE_PATCH(ROOT->transitionCodes, offset)
 
-	/* Finally. */
-	FAudio_assert((ptr - start) == dwSize);
-	*ppSoundBank = sb;
+	if (writer->base != NULL)
+	{
+		ROOT->header.size = (uint32_t) writer->size;
+	}
+	#undef ROOT
+}
+
+#undef CACHE_AT
+#undef CACHE_PATCH
+
+static uint32_t FACT_INTERNAL_Serialize(
+	void (*write)(FACTCacheWriter*, void*),
+	void *object,
+	void *pBuffer,
+	uint32_t *pdwSize
+) {
+	FACTCacheWriter writer;
+
+	/* First pass measures, second pass writes */
+	writer.base = NULL;
+	writer.size = 0;
+	write(&writer, object);
+
+	if (pBuffer == NULL)
+	{
+		*pdwSize = (uint32_t) writer.size;
+		return 0;
+	}
+	if (*pdwSize < writer.size)
+	{
+		*pdwSize = (uint32_t) writer.size;
+		return FAUDIO_E_INVALID_CALL;
+	}
+
+	FAudio_zero(pBuffer, writer.size); /* Padding, for stable output */
+	writer.base = (uint8_t*) pBuffer;
+	writer.size = 0;
+	write(&writer, object);
+	*pdwSize = (uint32_t) writer.size;
 	return 0;
 }
 
-/* This parser is based on the unxwb project, written by Luigi Auriemma.
- *
- * While the unxwb project was released under the GPL, Luigi has given us
- * permission to use the unxwb sources under the zlib license.
- *
- * The unxwb website can be found here:
- *
- * http://aluigi.altervista.org/papers.htm#xbox
- */
-uint32_t FACT_INTERNAL_ParseWaveBank(
+uint32_t FACT_INTERNAL_SerializeAudioEngine(
 	FACTAudioEngine *pEngine,
-	void* io,
-	uint32_t offset,
-	uint32_t packetSize,
-	FACTReadFileCallback pRead,
-	FACTGetOverlappedResultCallback pOverlap,
-	uint16_t isStreaming,
-	FACTWaveBank **ppWaveBank
+	void *pBuffer,
+	uint32_t *pdwSize
 ) {
-	uint8_t se = 0; /* Swap Endian */
-	FACTWaveBank *wb;
-	size_t memsize;
-	uint32_t i, j;
-	FACTWaveBankHeader header;
-	FACTWaveBankData wbinfo;
-	uint32_t compactEntry;
-	int32_t seekTableOffset;
-	uint32_t fileOffset;
-	uint8_t *packetBuffer = NULL;
-	uint32_t packetBufferLen = 0;
-	uint16_t *pcm;
+	return FACT_INTERNAL_Serialize(
+		FACT_INTERNAL_WriteAudioEngineCache,
+		pEngine,
+		pBuffer,
+		pdwSize
+	);
+}
 
-	#define SEEKSET(loc) \
-		fileOffset = offset + loc;
-	#define SEEKCUR(loc) \
-		fileOffset += loc;
-	#define READ(dst, size) \
-		FACT_INTERNAL_ReadFile( \
-			pRead, \
-			pOverlap, \
-			io, \
-			fileOffset, \
-			packetSize, \
-			&packetBuffer, \
-			&packetBufferLen, \
-			pEngine->pRealloc, \
-			dst, \
-			size \
-		); \
-		SEEKCUR(size)
+uint32_t FACT_INTERNAL_SerializeSoundBank(
+	FACTSoundBank *pSoundBank,
+	void *pBuffer,
+	uint32_t *pdwSize
+) {
+	return FACT_INTERNAL_Serialize(
+		FACT_INTERNAL_WriteSoundBankCache,
+		pSoundBank,
+		pBuffer,
+		pdwSize
+	);
+}
 
-	#define DOSWAP_16(x) x = FAudio_swap16BE(x)
-	#define DOSWAP_32(x) x = FAudio_swap32BE(x)
-	#define DOSWAP_64(x) x = FAudio_swap64BE(x)
+uint8_t FACT_INTERNAL_IsCache(
+	const void *pvBuffer,
+	uint32_t dwSize,
+	uint32_t magic
+) {
+	return (	pvBuffer != NULL &&
+			dwSize >= sizeof(FACTCacheHeader) &&
+			((const FACTCacheHeader*) pvBuffer)->magic == magic	);
+}
 
-	fileOffset = offset;
-	READ(&header, sizeof(header))
-	se = header.dwSignature == 0x57424E44;
-	if (se)
+/* Turns a stored offset back into a pointer into the block. The whole array
+ * has to fit inside the block, otherwise the data is corrupt.
+ */
+static uint8_t FACT_INTERNAL_CacheFixup(
+	uint8_t *base,
+	size_t size,
+	void **p,
+	size_t elementSize,
+	size_t count
+) {
+	size_t offset = (size_t) *p;
+	if (offset == 0)
 	{
-		DOSWAP_32(header.dwSignature);
-		DOSWAP_32(header.dwVersion);
-		DOSWAP_32(header.dwHeaderVersion);
-		for (i = 0; i < FACT_WAVEBANK_SEGIDX_COUNT; i += 1)
+		/* Only empty arrays were stored as NULL */
+		return count == 0;
+	}
+	if (	offset < sizeof(FACTCacheHeader) ||
+		offset > size ||
+		(offset & 7) != 0 ||
+		count > (size - offset) / elementSize	)
+	{
+		return 0;
+	}
+	*p = (void*) (base + offset);
+	return 1;
+}
+
+static uint8_t FACT_INTERNAL_CacheFixupString(
+	uint8_t *base,
+	size_t size,
+	char **p
+) {
+	size_t offset = (size_t) *p;
+	size_t i;
+	if (offset < sizeof(FACTCacheHeader) || offset >= size)
+	{
+		return 0;
+	}
+	for (i = offset; i < size; i += 1)
+	{
+		if (base[i] == '\0')
 		{
-			DOSWAP_32(header.Segments[i].dwOffset);
-			DOSWAP_32(header.Segments[i].dwLength);
+			*p = (char*) (base + offset);
+			return 1;
 		}
 	}
-	if (header.dwSignature != 0x444E4257)
+	return 0;
+}
+
+#define CACHE_FIXUP(p, count) \
+	if (!FACT_INTERNAL_CacheFixup( \
+		base, \
+		size, \
+		(void**) &p, \
+		sizeof(*p), \
+		count \
+	)) { \
+		goto corrupt; \
+	}
+#define CACHE_FIXUP_STRING(p) \
+	if (!FACT_INTERNAL_CacheFixupString(base, size, &p)) \
+	{ \
+		goto corrupt; \
+	}
+
+static uint8_t* FACT_INTERNAL_LoadCache(
+	FACTAudioEngine *pEngine,
+	const void *pvBuffer,
+	size_t size,
+	size_t rootSize
+) {
+	const FACTCacheHeader *header = (const FACTCacheHeader*) pvBuffer;
+	uint8_t *base;
+
+	if (	size < rootSize ||
+		header->layout != FACT_INTERNAL_CacheLayout() ||
+		header->size != size	)
 	{
-		return -1; /* TODO: NOT XACT FILE */
+		return NULL;
 	}
 
-	if (!FACT_INTERNAL_SupportedContent(header.dwVersion))
+	/* Copy, since the runtime writes to the category/cue state */
+	base = (uint8_t*) pEngine->pMalloc(size);
+	FAudio_memcpy(base, pvBuffer, size);
+	return base;
+}
+
+uint32_t FACT_INTERNAL_LoadAudioEngineCache(
+	FACTAudioEngine *pEngine,
+	const FACTRuntimeParameters *pParams
+) {
+	FACTAudioEngineCache *root;
+	uint8_t *base;
+	size_t size = pParams->globalSettingsBufferSize;
+	uint16_t i, j;
+
+	base = FACT_INTERNAL_LoadCache(
+		pEngine,
+		pParams->pGlobalSettingsBuffer,
+		size,
+		sizeof(FACTAudioEngineCache)
+	);
+	if (base == NULL)
 	{
 		return -2;
 	}
+	root = (FACTAudioEngineCache*) base;
 
-	if (!FACT_INTERNAL_SupportedWBContent(header.dwHeaderVersion))
+	CACHE_FIXUP(root->categoryNames, root->categoryCount)
+	for (i = 0; i < root->categoryCount; i += 1)
 	{
-		return -3;
+		CACHE_FIXUP_STRING(root->categoryNames[i])
 	}
-
-	wb = (FACTWaveBank*) pEngine->pMalloc(sizeof(FACTWaveBank));
-	wb->parentEngine = pEngine;
-	wb->waveList = NULL;
-	wb->waveLock = FAudio_PlatformCreateMutex();
-	wb->packetSize = packetSize;
-	wb->io = io;
-	wb->notifyOnDestroy = 0;
-	wb->usercontext = NULL;
-
-	/* WaveBank Data */
-	SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_BANKDATA].dwOffset)
-	READ(&wbinfo, sizeof(wbinfo))
-	if (se)
+	CACHE_FIXUP(root->categories, root->categoryCount)
+	CACHE_FIXUP(root->variableNames, root->variableCount)
+	for (i = 0; i < root->variableCount; i += 1)
 	{
-		DOSWAP_32(wbinfo.dwFlags);
-		DOSWAP_32(wbinfo.dwEntryCount);
-		DOSWAP_32(wbinfo.dwEntryMetaDataElementSize);
-		DOSWAP_32(wbinfo.dwEntryNameElementSize);
-		DOSWAP_32(wbinfo.dwAlignment);
-		DOSWAP_32(wbinfo.CompactFormat.dwValue);
-		DOSWAP_64(wbinfo.BuildTime);
+		CACHE_FIXUP_STRING(root->variableNames[i])
 	}
-	wb->streaming = (wbinfo.dwFlags & FACT_WAVEBANK_TYPE_STREAMING);
-	wb->entryCount = wbinfo.dwEntryCount;
-	memsize = FAudio_strlen(wbinfo.szBankName) + 1;
-	wb->name = (char*) pEngine->pMalloc(memsize);
-	FAudio_memcpy(wb->name, wbinfo.szBankName, memsize);
-	memsize = sizeof(FACTWaveBankEntry) * wbinfo.dwEntryCount;
-	wb->entries = (FACTWaveBankEntry*) pEngine->pMalloc(memsize);
-	FAudio_zero(wb->entries, memsize);
-	memsize = sizeof(uint32_t) * wbinfo.dwEntryCount;
-	wb->entryRefs = (uint32_t*) pEngine->pMalloc(memsize);
-	FAudio_zero(wb->entryRefs, memsize);
-
-	/* FIXME: How much do we care about this? */
-	FAudio_assert(wb->streaming == isStreaming);
-	wb->streaming = isStreaming;
-
-	/* WaveBank Entry Metadata */
-	SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYMETADATA].dwOffset)
-	if (wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_COMPACT)
+	CACHE_FIXUP(root->variables, root->variableCount)
+	CACHE_FIXUP(root->globalVariableValues, root->variableCount)
+	CACHE_FIXUP(root->rpcs, root->rpcCount)
+	for (i = 0; i < root->rpcCount; i += 1)
 	{
-		for (i = 0; i < wbinfo.dwEntryCount - 1; i += 1)
+		if (root->rpcs[i].pointCount == 0)
 		{
-			READ(&compactEntry, sizeof(compactEntry))
-			if (se)
-			{
-				DOSWAP_32(compactEntry);
-			}
-			wb->entries[i].PlayRegion.dwOffset = (
-				(compactEntry & ((1 << 21) - 1)) *
-				wbinfo.dwAlignment
-			);
-			wb->entries[i].PlayRegion.dwLength = (
-				(compactEntry >> 21) & ((1 << 11) - 1)
-			);
-
-			/* TODO: Deviation table */
-			SEEKCUR(wbinfo.dwEntryMetaDataElementSize)
-			wb->entries[i].PlayRegion.dwLength = (
-				(compactEntry & ((1 << 21) - 1)) *
-				wbinfo.dwAlignment
-			) - wb->entries[i].PlayRegion.dwOffset;
-
-			wb->entries[i].PlayRegion.dwOffset +=
-				header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
+			goto corrupt;
 		}
-
-		READ(&compactEntry, sizeof(compactEntry))
-		if (se)
+		CACHE_FIXUP(root->rpcs[i].points, root->rpcs[i].pointCount)
+		if (root->rpcs[i].table != NULL) /* NULL for flat curves */
 		{
-			DOSWAP_32(compactEntry);
+			CACHE_FIXUP(root->rpcs[i].table, FACT_RPC_TABLE_SIZE + 1)
 		}
-		wb->entries[i].PlayRegion.dwOffset = (
-			(compactEntry & ((1 << 21) - 1)) *
-			wbinfo.dwAlignment
-		);
-
-		/* TODO: Deviation table */
-		SEEKCUR(wbinfo.dwEntryMetaDataElementSize)
-		wb->entries[i].PlayRegion.dwLength = (
-			header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwLength -
-			wb->entries[i].PlayRegion.dwOffset
-		);
+	}
+	CACHE_FIXUP(root->rpcCodes, root->rpcCount)
+	CACHE_FIXUP(root->dspPresets, root->dspPresetCount)
+	for (i = 0; i < root->dspPresetCount; i += 1)
+	{
+		CACHE_FIXUP(
+			root->dspPresets[i].parameters,
+			root->dspPresets[i].parameterCount
+		)
+	}
+	CACHE_FIXUP(root->dspPresetCodes, root->dspPresetCount)
 
-		wb->entries[i].PlayRegion.dwOffset +=
-			header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
+	/* Indices into the arrays above */
+	for (i = 0; i < root->categoryCount; i += 1)
+	{
+		if (	root->categories[i].parentCategory < -1 ||
+			root->categories[i].parentCategory >= root->categoryCount	)
+		{
+			goto corrupt;
+		}
 	}
-	else
+	for (i = 0; i < root->rpcCount; i += 1)
 	{
-		for (i = 0; i < wbinfo.dwEntryCount; i += 1)
+		if (root->rpcs[i].variable >= root->variableCount)
 		{
-			READ(&wb->entries[i], wbinfo.dwEntryMetaDataElementSize)
-			if (se)
-			{
-				DOSWAP_32(wb->entries[i].dwFlagsAndDuration);
-				DOSWAP_32(wb->entries[i].Format.dwValue);
-				DOSWAP_32(wb->entries[i].PlayRegion.dwOffset);
-				DOSWAP_32(wb->entries[i].PlayRegion.dwLength);
-				DOSWAP_32(wb->entries[i].LoopRegion.dwStartSample);
-				DOSWAP_32(wb->entries[i].LoopRegion.dwTotalSamples);
-			}
-			wb->entries[i].PlayRegion.dwOffset +=
-				header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwOffset;
-
-			/* If it's in-memory big-endian PCM, swap! */
-			if (	se &&
-				!wb->streaming &&
-				wb->entries[i].Format.wFormatTag == 0x0 &&
-				wb->entries[i].Format.wBitsPerSample == 1	)
+			goto corrupt;
+		}
+		if (root->rpcs[i].parameter >= RPC_PARAMETER_COUNT)
+		{
+			for (j = 0; j < root->dspPresetCount; j += 1)
 			{
-				pcm = (uint16_t*) FAudio_memptr(
-					(FAudioIOStream*) wb->io,
-					wb->entries[i].PlayRegion.dwOffset
-				);
-				for (j = 0; j < wb->entries[i].PlayRegion.dwLength; j += 2, pcm += 1)
+				if (	root->rpcs[i].parameter - RPC_PARAMETER_COUNT >=
+					root->dspPresets[j].parameterCount	)
 				{
-					DOSWAP_16(*pcm);
+					goto corrupt;
 				}
 			}
 		}
+	}
 
-		/* FIXME: This is a bit hacky. */
-		if (wbinfo.dwEntryMetaDataElementSize < 24)
+	pEngine->categoryCount = root->categoryCount;
+	pEngine->variableCount = root->variableCount;
+	pEngine->rpcCount = root->rpcCount;
+	pEngine->dspPresetCount = root->dspPresetCount;
+	pEngine->dspParameterCount = root->dspParameterCount;
+	pEngine->categoryNames = root->categoryNames;
+	pEngine->variableNames = root->variableNames;
+	pEngine->rpcCodes = root->rpcCodes;
+	pEngine->dspPresetCodes = root->dspPresetCodes;
+	pEngine->categories = root->categories;
+	pEngine->variables = root->variables;
+	pEngine->rpcs = root->rpcs;
+	pEngine->dspPresets = root->dspPresets;
+	pEngine->globalVariableValues = root->globalVariableValues;
+	pEngine->cache = base;
+
+	/* Store this pointer in case we're asked to free it */
+	if (pParams->globalSettingsFlags & FACT_FLAG_MANAGEDATA)
+	{
+		pEngine->settings = pParams->pGlobalSettingsBuffer;
+	}
+	return 0;
+
+corrupt:
+	pEngine->pFree(base);
+	return -1;
+}
+
+uint32_t FACT_INTERNAL_LoadSoundBankCache(
+	FACTAudioEngine *pEngine,
+	const void *pvBuffer,
+	uint32_t dwSize,
+	FACTSoundBank **ppSoundBank
+) {
+	FACTSoundBankCache *root;
+	FACTSoundBank *sb;
+	FACTEvent *evt;
+	uint8_t *base;
+	size_t size = dwSize;
+	uint16_t i, j, k, l;
+
+	base = FACT_INTERNAL_LoadCache(
+		pEngine,
+		pvBuffer,
+		size,
+		sizeof(FACTSoundBankCache)
+	);
+	if (base == NULL)
+	{
+		return -2;
+	}
+	root = (FACTSoundBankCache*) base;
+
+	CACHE_FIXUP_STRING(root->name)
+	CACHE_FIXUP(root->wavebankNames, root->wavebankCount)
+	for (i = 0; i < root->wavebankCount; i += 1)
+	{
+		CACHE_FIXUP_STRING(root->wavebankNames[i])
+	}
+	if (root->cueNames != NULL)
+	{
+		CACHE_FIXUP(root->cueNames, root->cueCount)
+		for (i = 0; i < root->cueCount; i += 1)
 		{
-			for (i = 0; i < wbinfo.dwEntryCount; i += 1)
-			{
-				wb->entries[i].PlayRegion.dwLength =
-					header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYWAVEDATA].dwLength;
-			}
+			CACHE_FIXUP_STRING(root->cueNames[i])
 		}
 	}
-
-	/* WaveBank Seek Tables */
-	if (	wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_SEEKTABLES &&
-		header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwLength > 0	)
+	CACHE_FIXUP(root->cues, root->cueCount)
+	CACHE_FIXUP(root->sounds, root->soundCount)
+	for (i = 0; i < root->soundCount; i += 1)
 	{
-		/* The seek table data layout is an absolute disaster! */
-		wb->seekTables = (FACTSeekTable*) pEngine->pMalloc(
-			wbinfo.dwEntryCount * sizeof(FACTSeekTable)
-		);
-		for (i = 0; i < wbinfo.dwEntryCount; i += 1)
+		if (	root->sounds[i].category != FACTCATEGORY_INVALID &&
+			root->sounds[i].category >= pEngine->categoryCount	)
 		{
-			/* Get the table offset... */
-			SEEKSET(
-				header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwOffset +
-				i * sizeof(uint32_t)
+			goto corrupt;
+		}
+		CACHE_FIXUP(root->sounds[i].tracks, root->sounds[i].trackCount)
+		for (j = 0; j < root->sounds[i].trackCount; j += 1)
+		{
+			CACHE_FIXUP(
+				root->sounds[i].tracks[j].rpcCodes,
+				root->sounds[i].tracks[j].rpcCodeCount
 			)
-			READ(&seekTableOffset, sizeof(int32_t))
-			if (se)
-			{
-				DOSWAP_32(seekTableOffset);
-			}
-
-			/* If the offset is -1, this wave needs no table */
-			if (seekTableOffset == -1)
-			{
-				wb->seekTables[i].entryCount = 0;
-				wb->seekTables[i].entries = NULL;
-				continue;
-			}
-
-			/* Go to the table offset, after the offset table... */
-			SEEKSET(
-				header.Segments[FACT_WAVEBANK_SEGIDX_SEEKTABLES].dwOffset +
-				(wbinfo.dwEntryCount * sizeof(uint32_t)) +
-				seekTableOffset
+			CACHE_FIXUP(
+				root->sounds[i].tracks[j].events,
+				root->sounds[i].tracks[j].eventCount
 			)
-
-			/* Read the table, finally. */
-			READ(&wb->seekTables[i].entryCount, sizeof(uint32_t))
-			if (se)
+			for (k = 0; k < root->sounds[i].tracks[j].eventCount; k += 1)
 			{
-				DOSWAP_32(wb->seekTables[i].entryCount);
+				evt = &root->sounds[i].tracks[j].events[k];
+				#define MATCH(t) evt->type == t
+				if (	!(	MATCH(FACTEVENT_PLAYWAVE) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVEEFFECTVARIATION) ||
+						MATCH(FACTEVENT_PLAYWAVETRACKEFFECTVARIATION)	)	)
+				{
+					continue;
+				}
+				#undef MATCH
+				if (!evt->wave.isComplex)
+				{
+					if (evt->wave.simple.wavebank >= root->wavebankCount)
+					{
+						goto corrupt;
+					}
+					continue;
+				}
+				if (evt->wave.complex.trackCount == 0)
+				{
+					goto corrupt;
+				}
+				CACHE_FIXUP(
+					evt->wave.complex.tracks,
+					evt->wave.complex.trackCount
+				)
+				CACHE_FIXUP(
+					evt->wave.complex.wavebanks,
+					evt->wave.complex.trackCount
+				)
+				CACHE_FIXUP(
+					evt->wave.complex.weights,
+					evt->wave.complex.trackCount
+				)
+				for (l = 0; l < evt->wave.complex.trackCount; l += 1)
+				{
+					if (evt->wave.complex.wavebanks[l] >= root->wavebankCount)
+					{
+						goto corrupt;
+					}
+				}
 			}
-			wb->seekTables[i].entries = (uint32_t*) pEngine->pMalloc(
-				wb->seekTables[i].entryCount * sizeof(uint32_t)
-			);
-			READ(
-				wb->seekTables[i].entries,
-				wb->seekTables[i].entryCount * sizeof(uint32_t)
-			)
-			if (se)
+		}
+		CACHE_FIXUP(root->sounds[i].rpcCodes, root->sounds[i].rpcCodeCount)
+		CACHE_FIXUP(root->sounds[i].dspCodes, root->sounds[i].dspCodeCount)
+	}
+	CACHE_FIXUP(root->soundCodes, root->soundCount)
+	CACHE_FIXUP(root->variations, root->variationCount)
+	for (i = 0; i < root->variationCount; i += 1)
+	{
+		if (	root->variations[i].flags == 3 &&
+			(	root->variations[i].variable < 0 ||
+				root->variations[i].variable >= pEngine->variableCount	)	)
+		{
+			goto corrupt;
+		}
+		CACHE_FIXUP(
+			root->variations[i].entries,
+			root->variations[i].entryCount
+		)
+		if (!root->variations[i].isComplex)
+		{
+			for (j = 0; j < root->variations[i].entryCount; j += 1)
 			{
-				for (j = 0; j < wb->seekTables[i].entryCount; j += 1)
+				if (root->variations[i].entries[j].simple.wavebank >= root->wavebankCount)
 				{
-					DOSWAP_32(wb->seekTables[i].entries[j]);
+					goto corrupt;
 				}
 			}
 		}
 	}
-	else
+	CACHE_FIXUP(root->variationCodes, root->variationCount)
+	CACHE_FIXUP(root->transitions, root->transitionCount)
+	for (i = 0; i < root->transitionCount; i += 1)
 	{
-		wb->seekTables = NULL;
+		CACHE_FIXUP(
+			root->transitions[i].entries,
+			root->transitions[i].entryCount
+		)
 	}
+	CACHE_FIXUP(root->transitionCodes, root->transitionCount)
 
-	/* WaveBank Entry Names */
-	if (wbinfo.dwFlags & FACT_WAVEBANK_FLAGS_ENTRYNAMES)
-	{
-		SEEKSET(header.Segments[FACT_WAVEBANK_SEGIDX_ENTRYNAMES].dwOffset)
-		wb->waveBankNames = (char*) pEngine->pMalloc(64 * wbinfo.dwEntryCount);
-		READ(wb->waveBankNames, 64 * wbinfo.dwEntryCount);
-	}
-	else
-	{
-		wb->waveBankNames = NULL;
-	}
+	sb = (FACTSoundBank*) pEngine->pMalloc(sizeof(FACTSoundBank));
+	FAudio_zero(sb, sizeof(FACTSoundBank));
+	sb->parentEngine = pEngine;
+	sb->cueCount = root->cueCount;
+	sb->wavebankCount = root->wavebankCount;
+	sb->soundCount = root->soundCount;
+	sb->variationCount = root->variationCount;
+	sb->transitionCount = root->transitionCount;
+	sb->wavebankNames = root->wavebankNames;
+	sb->cueNames = root->cueNames;
+	sb->name = root->name;
+	sb->cues = root->cues;
+	sb->sounds = root->sounds;
+	sb->soundCodes = root->soundCodes;
+	sb->variations = root->variations;
+	sb->variationCodes = root->variationCodes;
+	sb->transitions = root->transitions;
+	sb->transitionCodes = root->transitionCodes;
+	sb->cache = base;
 
-	/* Add to the Engine WaveBank list */
+	/* Add to the Engine SoundBank list */
 	LinkedList_AddEntry(
-		&pEngine->wbList,
-		wb,
-		pEngine->wbLock,
+		&pEngine->sbList,
+		sb,
+		pEngine->sbLock,
 		pEngine->pMalloc
 	);
 
 	/* Finally. */
-	wb->packetBuffer = packetBuffer;
-	wb->packetBufferLen = packetBufferLen;
-	*ppWaveBank = wb;
+	*ppSoundBank = sb;
 	return 0;
+
+corrupt:
+	pEngine->pFree(base);
+	return -1;
 }
 
+#undef CACHE_FIXUP
+#undef CACHE_FIXUP_STRING
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
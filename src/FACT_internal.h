@@ -69,12 +69,20 @@ typedef enum FACTRPCParameter
 	RPC_PARAMETER_COUNT /* If >=, DSP Parameter! */
 } FACTRPCParameter;
 
+/* Resolution of the sampled curve used by the API thread */
+#define FACT_RPC_TABLE_SIZE 512
+
 typedef struct FACTRPC
 {
 	uint16_t variable;
 	uint8_t pointCount;
 	uint16_t parameter;
 	FACTRPCPoint *points;
+
+	/* Curve sampled at parse time, FACT_RPC_TABLE_SIZE + 1 entries */
+	float tableStart;
+	float tableScale;
+	float *table;
 } FACTRPC;
 
 typedef struct FACTDSPParameter
@@ -303,6 +311,29 @@ typedef struct FACTTransitionTable
 	FACTTransition *entries;
 } FACTTransitionTable;
 
+/* Internal Cue Command Types */
+
+typedef struct FACTCueCommand
+{
+	FACTCue *cue;
+	FACTCueCommandTypeEXT type;
+	FAUDIONAMELESS union
+	{
+		struct
+		{
+			uint16_t index;
+			float value;
+		} variable;
+		struct
+		{
+			uint32_t srcChannels;
+			uint32_t dstChannels;
+			float coefficients[2 * 8]; /* Stereo input, 7.1 output */
+		} matrix;
+		uint32_t stopFlags;
+	};
+} FACTCueCommand;
+
 /* Internal WaveBank Types */
 
 typedef struct FACTSeekTable
@@ -341,6 +372,8 @@ typedef struct FACTTrackInstance
 
 	/* RPC instance data */
 	FACTInstanceRPCData rpcData;
+	uint8_t rpcDirty; /* Inputs changed since the last RPC update */
+	uint8_t timeRPCs; /* Uses AttackTime/ReleaseTime, so always dirty */
 
 	/* SetPitch/SetVolume data */
 	float evtPitch;
@@ -354,6 +387,7 @@ typedef struct FACTTrackInstance
 		int16_t basePitch;
 		float baseQFactor;
 		float baseFrequency;
+		uint8_t fadeType; /* Sound fade given to the voice, or 0 */
 	} activeWave, upcomingWave;
 	FACTEvent *waveEvt;
 	FACTEventInstance *waveEvtInst;
@@ -369,6 +403,8 @@ typedef struct FACTSoundInstance
 
 	/* RPC instance data */
 	FACTInstanceRPCData rpcData;
+	uint8_t rpcDirty; /* Inputs changed since the last RPC update */
+	uint8_t timeRPCs; /* Uses AttackTime/ReleaseTime, so always dirty */
 
 	/* Fade data */
 	uint32_t fadeStart;
@@ -377,10 +413,57 @@ typedef struct FACTSoundInstance
 
 	/* Engine references */
 	FACTCue *parentCue;
+
+	/* Pool block size, next free block while in the pool */
+	uint32_t blockSize;
+	struct FACTSoundInstance *poolNext;
 } FACTSoundInstance;
 
+/* Notification Queue Types */
+
+/* Must be a power of two */
+#define FACT_NOTIFICATION_QUEUE_SIZE 64
+
+typedef struct FACTQueuedNotification
+{
+	/* See FACT_INTERNAL_QueueNotification */
+	volatile int32_t sequence;
+	FACTNotification note;
+} FACTQueuedNotification;
+
 /* Internal Wave Types */
 
+typedef struct FACTVoiceCandidate
+{
+	FACTWave *wave;
+	FACTSoundInstance *sound; /* NULL for simple Waves */
+	FACTTrackInstance *track;
+	float fadeVolume;
+	float volume;
+	uint8_t priority;
+	uint8_t canVirtualize;
+} FACTVoiceCandidate;
+
+/* Internal Worker Types */
+
+/* Processes items [start, end) of a FACT_INTERNAL_ParallelFor job */
+typedef void (*FACTJobFunc)(void *data, uint32_t start, uint32_t end);
+
+typedef struct FACTWorker
+{
+	FACTAudioEngine *engine;
+	FAudioThread thread;
+	FAudioSemaphore wake;
+	FAudioSemaphore done;
+	uint8_t quit;
+
+	/* Current job, set before wake is posted */
+	FACTJobFunc func;
+	void *data;
+	uint32_t start;
+	uint32_t end;
+} FACTWorker;
+
 typedef struct FACTWaveCallback
 {
 	FAudioVoiceCallback callback;
@@ -427,8 +510,56 @@ struct FACTAudioEngine
 	/* Engine thread */
 	FAudioThread apiThread;
 	FAudioMutex apiLock;
+	FAudioSemaphore apiWake;
+
+	/* Guards globalVariableValues and each Cue's variableValues. Always
+	 * taken after apiLock, never before it.
+	 */
+	FAudioMutex varLock;
+	uint8_t globalVariablesDirty;
+	uint32_t globalVariablesVersion;
+
+	/* Time-based RPC variables, resolved at Initialize */
+	uint16_t attackTimeVariable;
+	uint16_t releaseTimeVariable;
 	uint8_t initialized;
 
+	/* Cues the API thread has to look at, see FACT_INTERNAL_ScheduleCue */
+	FACTCue *activeCues;
+	FACTCue *activeCuesTail;
+
+	/* CueCommandsEXT, applied at the start of the next API thread update.
+	 * The thread swaps the pending list with the apply list so cmdLock is
+	 * never held while the commands run.
+	 */
+	FAudioMutex cmdLock;
+	FACTCueCommand *commands;
+	uint32_t commandCount;
+	uint32_t commandCapacity;
+	FACTCueCommand *applyCommands;
+	uint32_t applyCapacity;
+
+	/* VirtualVoiceEXT */
+	uint8_t virtualVoicesEnabled;
+	uint32_t maxRealVoices;
+	float virtualThreshold;
+	uint32_t virtualVoiceCount;
+	FACTVoiceCandidate *voiceCandidates;
+	uint32_t voiceCandidateCapacity;
+
+	/* Free SoundInstance blocks, each big enough for the largest Sound
+	 * (plus its tracks and events) of any SoundBank loaded so far
+	 */
+	FACTSoundInstance *soundPool;
+	uint32_t soundPoolBlockSize;
+
+	/* Worker pool for FACT_INTERNAL_ParallelFor, started on first use.
+	 * jobLock allows one job at a time and outlives ShutDown.
+	 */
+	FAudioMutex jobLock;
+	FACTWorker *workers;
+	uint32_t workerCount;
+
 	/* Allocator callbacks */
 	FAudioMallocFunc pMalloc;
 	FAudioFreeFunc pFree;
@@ -440,10 +571,23 @@ struct FACTAudioEngine
 	void *sb_context;
 	void *wb_context;
 	void *wave_context;
-	LinkedList *wb_notifications_list;
+
+	/* Deferred notifications, delivered by DoWork. Any thread may queue,
+	 * only the thread that wins notificationConsumer dequeues.
+	 */
+	FACTQueuedNotification notificationQueue[FACT_NOTIFICATION_QUEUE_SIZE];
+	volatile int32_t notificationHead;
+	volatile int32_t notificationConsumer;
+	int32_t notificationTail;
+
+	/* NotificationFDEXT, -1 until requested */
+	int32_t notificationFD;
 
 	/* Settings handle */
 	void *settings;
+
+	/* BinaryCacheEXT block, owns all parsed data when non-NULL */
+	void *cache;
 };
 
 struct FACTSoundBank
@@ -474,6 +618,9 @@ struct FACTSoundBank
 	uint32_t *variationCodes;
 	FACTTransitionTable *transitions;
 	uint32_t *transitionCodes;
+
+	/* BinaryCacheEXT block, owns all parsed data when non-NULL */
+	void *cache;
 };
 
 struct FACTWaveBank
@@ -499,6 +646,12 @@ struct FACTWaveBank
 	uint8_t *packetBuffer;
 	uint32_t packetBufferLen;
 	void* io;
+
+	/* Destroyed Waves kept around with their voices, see
+	 * FACT_INTERNAL_RetireWave
+	 */
+	FACTWave *wavePool;
+	uint32_t wavePoolCount;
 };
 
 struct FACTWave
@@ -520,6 +673,18 @@ struct FACTWave
 	uint32_t streamSize;
 	uint32_t streamOffset;
 	uint8_t *streamCache;
+	uint32_t streamCacheLen;
+
+	/* Next Wave in the WaveBank pool */
+	FACTWave *poolNext;
+
+	/* VirtualVoiceEXT: while isVirtual, the voice is stopped and the
+	 * play position (in samples, counting loops) is advanced by time
+	 */
+	uint8_t isVirtual;
+	uint32_t virtualTime;
+	uint64_t samplesBase;
+	uint64_t virtualSamples;
 
 	/* FAudio references */
 	uint16_t srcChannels;
@@ -554,6 +719,10 @@ struct FACTCue
 	float *variableValues;
 	float interactive;
 
+	/* RPC dirty tracking, guarded by the engine's varLock */
+	uint8_t variablesDirty;
+	uint32_t globalVariablesVersion;
+
 	/* Playback */
 	uint32_t state;
 	FACTWave *simpleWave;
@@ -570,6 +739,11 @@ struct FACTCue
 	/* Timer */
 	uint32_t start;
 	uint32_t elapsed;
+
+	/* API thread schedule */
+	uint8_t scheduled;
+	FACTCue *activeNext;
+	FACTCue *activePrev;
 };
 
 /* Internal functions */
@@ -582,6 +756,8 @@ void FACT_INTERNAL_GetNextWave(
 	FACTEvent *evt,
 	FACTEventInstance *evtInst
 );
+void FACT_INTERNAL_GrowSoundPool(FACTAudioEngine *engine, FACTSoundBank *sb);
+void FACT_INTERNAL_FreeSoundPool(FACTAudioEngine *engine);
 uint8_t FACT_INTERNAL_CreateSound(FACTCue *cue, uint16_t fadeInMS);
 void FACT_INTERNAL_DestroySound(FACTSoundInstance *sound);
 void FACT_INTERNAL_BeginFadeOut(FACTSoundInstance *sound, uint16_t fadeOutMS);
@@ -589,12 +765,41 @@ void FACT_INTERNAL_BeginReleaseRPC(FACTSoundInstance *sound, uint16_t releaseMS)
 
 void FACT_INTERNAL_SendCueNotification(FACTCue *cue, FACTNoticationsFlags flag, uint8_t type);
 
+void FACT_INTERNAL_ScheduleCue(FACTCue *cue);
+void FACT_INTERNAL_UnscheduleCue(FACTCue *cue);
+void FACT_INTERNAL_WakeAPIThread(FACTAudioEngine *engine);
+
+void FACT_INTERNAL_PurgeCueCommands(FACTAudioEngine *engine, FACTCue *cue);
+
 /* RPC Helper Functions */
 
 FACTRPC* FACT_INTERNAL_GetRPC(FACTAudioEngine *engine, uint32_t code);
+void FACT_INTERNAL_BuildRPCTable(FACTAudioEngine *engine, FACTRPC *rpc);
+void FACT_INTERNAL_FindTimeVariables(FACTAudioEngine *engine);
+
+/* Virtual Voices */
+
+uint32_t FACT_INTERNAL_UpdateVirtualVoices(
+	FACTAudioEngine *engine,
+	uint32_t timestamp
+);
+
+/* Worker Pool */
+
+void FACT_INTERNAL_ParallelFor(
+	FACTAudioEngine *engine,
+	FACTJobFunc func,
+	void *data,
+	uint32_t count,
+	uint32_t minPerWorker
+);
+void FACT_INTERNAL_DestroyWorkers(FACTAudioEngine *engine);
 
 /* FACT Thread */
 
+/* FIXME: 10ms is based on the XAudio2 update time...? */
+#define FACT_API_UPDATE_MS 10
+
 int32_t FAUDIOCALL FACT_INTERNAL_APIThread(void* enginePtr);
 
 /* FAudio callbacks */
@@ -602,6 +807,26 @@ int32_t FAUDIOCALL FACT_INTERNAL_APIThread(void* enginePtr);
 void FACT_INTERNAL_OnBufferEnd(FAudioVoiceCallback *callback, void* pContext);
 void FACT_INTERNAL_OnStreamEnd(FAudioVoiceCallback *callback);
 
+/* Notification Queue */
+
+void FACT_INTERNAL_InitNotificationQueue(FACTAudioEngine *engine);
+void FACT_INTERNAL_QueueNotification(
+	FACTAudioEngine *engine,
+	const FACTNotification *note
+);
+void FACT_INTERNAL_DispatchNotifications(FACTAudioEngine *engine);
+
+/* Wave pooling */
+
+#define FACT_WAVE_POOL_MAX 16
+
+FACTWave* FACT_INTERNAL_ReuseWave(
+	FACTWaveBank *wb,
+	const FAudioWaveFormatEx *format
+);
+uint8_t FACT_INTERNAL_RetireWave(FACTWave *wave);
+void FACT_INTERNAL_FreeWavePool(FACTWaveBank *wb);
+
 /* FAudioIOStream functions */
 
 int32_t FACTCALL FACT_INTERNAL_DefaultReadFile(
@@ -642,4 +867,35 @@ uint32_t FACT_INTERNAL_ParseWaveBank(
 	FACTWaveBank **ppWaveBank
 );
 
+/* Binary cache functions */
+
+#define FACT_CACHE_MAGIC_ENGINE		0x43455846 /* 'FXEC' */
+#define FACT_CACHE_MAGIC_SOUNDBANK	0x43535846 /* 'FXSC' */
+
+uint8_t FACT_INTERNAL_IsCache(
+	const void *pvBuffer,
+	uint32_t dwSize,
+	uint32_t magic
+);
+uint32_t FACT_INTERNAL_SerializeAudioEngine(
+	FACTAudioEngine *pEngine,
+	void *pBuffer,
+	uint32_t *pdwSize
+);
+uint32_t FACT_INTERNAL_SerializeSoundBank(
+	FACTSoundBank *pSoundBank,
+	void *pBuffer,
+	uint32_t *pdwSize
+);
+uint32_t FACT_INTERNAL_LoadAudioEngineCache(
+	FACTAudioEngine *pEngine,
+	const FACTRuntimeParameters *pParams
+);
+uint32_t FACT_INTERNAL_LoadSoundBankCache(
+	FACTAudioEngine *pEngine,
+	const void *pvBuffer,
+	uint32_t dwSize,
+	FACTSoundBank **ppSoundBank
+);
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
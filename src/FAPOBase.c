@@ -90,7 +90,7 @@ void CreateFAPOBaseWithCustomAllocatorEXT(
 	fapo->m_pParameterBlocks = pParameterBlocks;
 	fapo->m_pCurrentParameters = pParameterBlocks;
 	fapo->m_pCurrentParametersInternal = pParameterBlocks;
-	fapo->m_uCurrentParametersIndex = 0;
+	fapo->m_uCurrentParametersIndex = FAUDIO_TRIPLEBUFFER_INIT;
 	fapo->m_uParameterBlockByteSize = uParameterBlockByteSize;
 	fapo->m_fNewerResultsReady = 0;
 	fapo->m_fProducer = fProducer;
@@ -377,11 +377,20 @@ void FAPOBase_ProcessThru(
 	}
 }
 
+/* m_uCurrentParametersIndex holds the triple buffer state for the three
+ * parameter blocks. SetParameters writes into the writer's block and publishes
+ * it, Process picks up the newest block, and neither waits for the other.
+ */
+#define PARAMETER_STATE(fapo) \
+	((volatile int32_t*) &(fapo)->m_uCurrentParametersIndex)
+
 void FAPOBase_SetParameters(
 	FAPOBase *fapo,
 	const void* pParameters,
 	uint32_t ParameterByteSize
 ) {
+	uint32_t slot;
+
 	FAudio_assert(!fapo->m_fProducer);
 
 	/* User callback for validation */
@@ -391,23 +400,17 @@ void FAPOBase_SetParameters(
 		ParameterByteSize
 	);
 
-	/* Increment parameter block index... */
-	fapo->m_uCurrentParametersIndex += 1;
-	if (fapo->m_uCurrentParametersIndex == 3)
-	{
-		fapo->m_uCurrentParametersIndex = 0;
-	}
-	fapo->m_pCurrentParametersInternal = fapo->m_pParameterBlocks + (
-		fapo->m_uParameterBlockByteSize *
-		fapo->m_uCurrentParametersIndex
-	);
-
 	/* Copy to what will eventually be the next parameter update */
+	slot = FAudio_INTERNAL_TripleBufferBeginWrite(PARAMETER_STATE(fapo));
 	FAudio_memcpy(
-		fapo->m_pCurrentParametersInternal,
+		fapo->m_pParameterBlocks + (
+			fapo->m_uParameterBlockByteSize *
+			slot
+		),
 		pParameters,
 		ParameterByteSize
 	);
+	FAudio_INTERNAL_TripleBufferEndWrite(PARAMETER_STATE(fapo));
 }
 
 void FAPOBase_GetParameters(
@@ -430,22 +433,102 @@ void FAPOBase_OnSetParameters(
 ) {
 }
 
+static inline void FAPOBase_INTERNAL_AcquireParameters(FAPOBase *fapo)
+{
+	if (FAudio_INTERNAL_TripleBufferAcquire(PARAMETER_STATE(fapo)))
+	{
+		fapo->m_pCurrentParameters = fapo->m_pParameterBlocks + (
+			fapo->m_uParameterBlockByteSize *
+			FAudio_INTERNAL_TripleBufferReadSlot(PARAMETER_STATE(fapo))
+		);
+
+		/* Not reported by ParametersChanged yet */
+		fapo->m_pCurrentParametersInternal = NULL;
+	}
+}
+
 uint8_t FAPOBase_ParametersChanged(FAPOBase *fapo)
 {
-	/* Internal will get updated when SetParameters is called */
-	return fapo->m_pCurrentParametersInternal != fapo->m_pCurrentParameters;
+	uint8_t changed;
+
+	/* This works both before and after BeginProcess. A block that arrives
+	 * between the two is reported by the next call instead.
+	 */
+	FAPOBase_INTERNAL_AcquireParameters(fapo);
+	changed = fapo->m_pCurrentParametersInternal != fapo->m_pCurrentParameters;
+	fapo->m_pCurrentParametersInternal = fapo->m_pCurrentParameters;
+	return changed;
 }
 
 uint8_t* FAPOBase_BeginProcess(FAPOBase *fapo)
 {
 	/* Set the latest block as "current", this is what Process will use now */
-	fapo->m_pCurrentParameters = fapo->m_pCurrentParametersInternal;
+	FAPOBase_INTERNAL_AcquireParameters(fapo);
 	return fapo->m_pCurrentParameters;
 }
 
 void FAPOBase_EndProcess(FAPOBase *fapo)
 {
-	/* I'm 100% sure my parameter block increment is wrong... */
+	/* Nothing to do, the reader's block is only given back when a newer one
+	 * is acquired
+	 */
+}
+
+void FAPOParameterRamp_ResetEXT(
+	FAPOParameterRampEXT *pRamp,
+	float Value
+) {
+	pRamp->Current = Value;
+	pRamp->Target = Value;
+	pRamp->Step = 0.0f;
+	pRamp->FramesLeft = 0;
+}
+
+void FAPOParameterRamp_SetTargetEXT(
+	FAPOParameterRampEXT *pRamp,
+	float Target,
+	uint32_t FrameCount
+) {
+	if (FrameCount == 0)
+	{
+		FAPOParameterRamp_ResetEXT(pRamp, Target);
+		return;
+	}
+
+	/* Always starts from wherever the last ramp got to */
+	pRamp->Target = Target;
+	pRamp->Step = (Target - pRamp->Current) / (float) FrameCount;
+	pRamp->FramesLeft = FrameCount;
+}
+
+void FAPOParameterRamp_FillEXT(
+	FAPOParameterRampEXT *pRamp,
+	float *pValues,
+	uint32_t FrameCount
+) {
+	uint32_t i, ramped;
+
+	ramped = FAudio_min(FrameCount, pRamp->FramesLeft);
+	for (i = 0; i < ramped; i += 1)
+	{
+		pRamp->Current += pRamp->Step;
+		pValues[i] = pRamp->Current;
+	}
+	pRamp->FramesLeft -= ramped;
+
+	/* Land exactly on the target, whatever the rounding did */
+	if (pRamp->FramesLeft == 0)
+	{
+		pRamp->Current = pRamp->Target;
+		if (ramped > 0)
+		{
+			pValues[ramped - 1] = pRamp->Target;
+		}
+	}
+	for (i = ramped; i < FrameCount; i += 1)
+	{
+		pValues[i] = pRamp->Current;
+	}
 }
 
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
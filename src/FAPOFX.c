@@ -83,6 +83,18 @@ uint32_t FAPOFX_CreateFXWithCustomAllocatorEXT(
 	CHECK_AND_RETURN(Reverb)
 	CHECK_AND_RETURN(Echo)
 	#undef CHECK_AND_RETURN
+	if (FAudio_memcmp(clsid, &FAPOFX_CLSID_FXReverbLowCPUEXT, sizeof(FAudioGUID)) == 0)
+	{
+		return FAPOFXCreateReverbLowCPU(
+			pEffect,
+			pInitData,
+			InitDataByteSize,
+			customMalloc,
+			customFree,
+			customRealloc,
+			0
+		);
+	}
 	return -1;
 }
 
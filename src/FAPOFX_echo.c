@@ -65,7 +65,8 @@ static FAPORegistrationProperties FXEchoProperties =
 		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
 		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
 		FAPO_FLAG_INPLACE_SUPPORTED |
-		FAPO_FLAG_INPLACE_REQUIRED
+		FAPO_FLAG_INPLACE_REQUIRED |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
 	),
 	/*.MinInputBufferCount = */ 1,
 	/*.MaxInputBufferCount = */  1,
@@ -109,7 +110,8 @@ static FAPORegistrationProperties FXEchoProperties_LEGACY =
 		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
 		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
 		FAPO_FLAG_INPLACE_SUPPORTED |
-		FAPO_FLAG_INPLACE_REQUIRED
+		FAPO_FLAG_INPLACE_REQUIRED |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
 	),
 	/*.MinInputBufferCount = */ 1,
 	/*.MaxInputBufferCount = */  1,
@@ -117,13 +119,245 @@ static FAPORegistrationProperties FXEchoProperties_LEGACY =
 	/*.MaxOutputBufferCount =*/ 1
 };
 
+/* The delay line holds interleaved frames, so a run of frames between two
+ * wrap points is one contiguous array for both the read and the write side.
+ * It's allocated once for FAPOFXECHO_MAX_DELAY, so changing the delay never
+ * allocates. A new delay takes over by crossfading from the old read tap to
+ * the new one, which avoids both clicks and the pitch bend of a sliding tap.
+ */
+
+#define FXECHO_FADE_MS 20
+
 typedef struct FAPOFXEcho
 {
 	FAPOBase base;
 
-	/* TODO */
+	uint16_t channels;
+	uint32_t sampleRate;
+
+	/* [capacity][channels], allocated by LockForProcess */
+	float *line;
+	uint32_t capacity;	/* In frames */
+	uint32_t write_idx;
+
+	uint32_t delay;		/* Current read tap, in frames */
+	uint32_t target_delay;	/* Starts fading in once the current fade ends */
+	uint32_t fade_from;	/* Old read tap */
+	uint32_t fade_remaining;
+	uint32_t fade_length;
+
+	/* Frames since anything audible was written to the line, up to capacity */
+	uint32_t quiet_frames;
 } FAPOFXEcho;
 
+static inline uint32_t FAPOFXEcho_INTERNAL_DelayFrames(
+	FAPOFXEcho *fapo,
+	float delay_ms
+) {
+	uint32_t frames;
+	delay_ms = FAudio_clamp(
+		delay_ms,
+		FAPOFXECHO_MIN_DELAY,
+		FAPOFXECHO_MAX_DELAY
+	);
+	frames = (uint32_t) ((delay_ms * fapo->sampleRate / 1000.0f) + 0.5f);
+	return FAudio_clamp(frames, 1, fapo->capacity - 1);
+}
+
+static inline uint32_t FAPOFXEcho_INTERNAL_ReadIndex(
+	FAPOFXEcho *fapo,
+	uint32_t delay
+) {
+	return (fapo->write_idx >= delay) ?
+		(fapo->write_idx - delay) :
+		(fapo->write_idx + fapo->capacity - delay);
+}
+
+/* Energy of the frames written to the line since start_idx */
+static float FAPOFXEcho_INTERNAL_WrittenEnergy(
+	FAPOFXEcho *fapo,
+	uint32_t start_idx,
+	uint32_t frames
+) {
+	uint32_t i, n;
+	const float *line;
+	float total = 0.0f;
+
+	while (frames > 0)
+	{
+		n = FAudio_min(frames, fapo->capacity - start_idx);
+		line = fapo->line + (start_idx * fapo->channels);
+		for (i = 0; i < n * fapo->channels; i += 1)
+		{
+			total += line[i] * line[i];
+		}
+		frames -= n;
+		start_idx = 0;
+	}
+	return total;
+}
+
+/* Runs the echo over interleaved frames in place */
+static void FAPOFXEcho_INTERNAL_Process(
+	FAPOFXEcho *fapo,
+	float *buffer,
+	uint32_t frames,
+	float wet,
+	float dry,
+	float feedback
+) {
+	uint32_t i, c, n, chunk, read_idx, fade_idx;
+	float *write;
+	const float *tap, *old_tap;
+	float x, d, g, step;
+	const uint16_t channels = fapo->channels;
+
+	while (frames > 0)
+	{
+		/* A new delay waits for the current fade to finish */
+		if (fapo->fade_remaining == 0 && fapo->target_delay != fapo->delay)
+		{
+			fapo->fade_from = fapo->delay;
+			fapo->delay = fapo->target_delay;
+			fapo->fade_remaining = fapo->fade_length;
+		}
+
+		/* Run until the write tap or a read tap wraps around, so the
+		 * inner loops are plain array walks
+		 */
+		read_idx = FAPOFXEcho_INTERNAL_ReadIndex(fapo, fapo->delay);
+		chunk = FAudio_min(frames, fapo->capacity - fapo->write_idx);
+		chunk = FAudio_min(chunk, fapo->capacity - read_idx);
+		write = fapo->line + (fapo->write_idx * channels);
+		tap = fapo->line + (read_idx * channels);
+
+		if (fapo->fade_remaining > 0)
+		{
+			fade_idx = FAPOFXEcho_INTERNAL_ReadIndex(fapo, fapo->fade_from);
+			chunk = FAudio_min(chunk, fapo->capacity - fade_idx);
+			chunk = FAudio_min(chunk, fapo->fade_remaining);
+			old_tap = fapo->line + (fade_idx * channels);
+
+			step = 1.0f / fapo->fade_length;
+			for (i = 0; i < chunk; i += 1)
+			{
+				g = (fapo->fade_length - fapo->fade_remaining + i) * step;
+				for (c = 0; c < channels; c += 1)
+				{
+					n = (i * channels) + c;
+					d = old_tap[n] + ((tap[n] - old_tap[n]) * g);
+					x = buffer[n];
+					write[n] = x + (feedback * d);
+					buffer[n] = (x * dry) + (d * wet);
+				}
+			}
+
+			fapo->fade_remaining -= chunk;
+		}
+		else
+		{
+			/* The tap is always at least one frame behind the write
+			 * position, so each sample is read before it's replaced
+			 */
+			n = chunk * channels;
+			for (i = 0; i < n; i += 1)
+			{
+				d = tap[i];
+				x = buffer[i];
+				write[i] = x + (feedback * d);
+				buffer[i] = (x * dry) + (d * wet);
+			}
+		}
+
+		buffer += chunk * channels;
+		frames -= chunk;
+		fapo->write_idx += chunk;
+		if (fapo->write_idx == fapo->capacity)
+		{
+			fapo->write_idx = 0;
+		}
+
+	}
+}
+
+uint32_t FAPOFXEcho_LockForProcess(
+	FAPOFXEcho *fapo,
+	uint32_t InputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pInputLockedParameters,
+	uint32_t OutputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pOutputLockedParameters
+) {
+	const FAPOFXEchoParameters *params = (const FAPOFXEchoParameters*)
+		fapo->base.m_pParameterBlocks;
+	uint32_t result;
+
+	/* Call parent to do basic validation */
+	result = FAPOBase_LockForProcess(
+		&fapo->base,
+		InputLockedParameterCount,
+		pInputLockedParameters,
+		OutputLockedParameterCount,
+		pOutputLockedParameters
+	);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	/* Save the things we care about */
+	fapo->channels = pInputLockedParameters->pFormat->nChannels;
+	fapo->sampleRate = pInputLockedParameters->pFormat->nSamplesPerSec;
+
+	/* Allocate the delay line for the longest possible delay */
+	fapo->capacity = (uint32_t) (
+		FAPOFXECHO_MAX_DELAY * fapo->sampleRate / 1000.0f
+	) + 2;
+	fapo->line = (float*) fapo->base.pMalloc(
+		sizeof(float) * fapo->capacity * fapo->channels
+	);
+	if (fapo->line == NULL)
+	{
+		FAPOBase_UnlockForProcess(&fapo->base);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	FAudio_zero(fapo->line, sizeof(float) * fapo->capacity * fapo->channels);
+	fapo->write_idx = 0;
+
+	/* The initial delay doesn't need a fade */
+	fapo->fade_length = FXECHO_FADE_MS * fapo->sampleRate / 1000;
+	fapo->delay = FAPOFXEcho_INTERNAL_DelayFrames(fapo, params->Delay);
+	fapo->target_delay = fapo->delay;
+	fapo->fade_from = fapo->delay;
+	fapo->fade_remaining = 0;
+	fapo->quiet_frames = fapo->capacity;
+	return 0;
+}
+
+void FAPOFXEcho_UnlockForProcess(FAPOFXEcho *fapo)
+{
+	if (fapo->line != NULL)
+	{
+		fapo->base.pFree(fapo->line);
+		fapo->line = NULL;
+	}
+	FAPOBase_UnlockForProcess(&fapo->base);
+}
+
+void FAPOFXEcho_Reset(FAPOFXEcho *fapo)
+{
+	FAPOBase_Reset(&fapo->base);
+	if (fapo->line != NULL)
+	{
+		FAudio_zero(
+			fapo->line,
+			sizeof(float) * fapo->capacity * fapo->channels
+		);
+		fapo->delay = fapo->target_delay;
+		fapo->fade_remaining = 0;
+		fapo->quiet_frames = fapo->capacity;
+	}
+}
+
 uint32_t FAPOFXEcho_Initialize(
 	FAPOFXEcho *fapo,
 	const void* pData,
@@ -150,9 +384,110 @@ void FAPOFXEcho_Process(
 	FAPOProcessBufferParameters* pOutputProcessParameters,
 	int32_t IsEnabled
 ) {
-	FAPOBase_BeginProcess(&fapo->base);
+	FAPOFXEchoParameters *params;
+	uint8_t update_params = FAPOBase_ParametersChanged(&fapo->base);
+	float mix, feedback, total;
+	uint64_t fpstate;
+	float *buffer = (float*) pInputProcessParameters->pBuffer;
+	uint32_t i, samples, start_idx, reach;
+
+	params = (FAPOFXEchoParameters*) FAPOBase_BeginProcess(&fapo->base);
+
+	/* The new delay is picked up by the processing loop, never allocated */
+	if (update_params)
+	{
+		fapo->target_delay = FAPOFXEcho_INTERNAL_DelayFrames(
+			fapo,
+			params->Delay
+		);
+	}
+
+	/* In-place is required, so there's nothing to copy when disabled */
+	if (IsEnabled == 0)
+	{
+		pOutputProcessParameters->BufferFlags = pInputProcessParameters->BufferFlags;
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
 
-	/* TODO */
+	/* XAudio2 passes a 'silent' buffer when no input buffer is available to play the effect tail */
+	samples = pInputProcessParameters->ValidFrameCount * fapo->channels;
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		FAudio_zero(buffer, samples * sizeof(float));
+	}
+
+	mix = FAudio_clamp(
+		params->WetDryMix,
+		FAPOFXECHO_MIN_WETDRYMIX,
+		FAPOFXECHO_MAX_WETDRYMIX
+	);
+	feedback = FAudio_clamp(
+		params->Feedback,
+		FAPOFXECHO_MIN_FEEDBACK,
+		FAPOFXECHO_MAX_FEEDBACK
+	);
+
+	/* The feedback path decays into denormals after the input goes silent */
+	fpstate = FAudio_INTERNAL_FlushDenormals();
+	start_idx = fapo->write_idx;
+	FAPOFXEcho_INTERNAL_Process(
+		fapo,
+		buffer,
+		pInputProcessParameters->ValidFrameCount,
+		mix,
+		1.0f - mix,
+		feedback
+	);
+	FAudio_INTERNAL_RestoreDenormals(fpstate);
+
+	/* Set BufferFlags to silent so PLAY_TAILS knows when to stop. Only the
+	 * tail needs checking, real input always makes a valid buffer.
+	 */
+	pOutputProcessParameters->BufferFlags = FAPO_BUFFER_VALID;
+	if (pInputProcessParameters->BufferFlags != FAPO_BUFFER_SILENT)
+	{
+		fapo->quiet_frames = 0;
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
+
+	/* The echo of a sound is still in the line long after this quantum's
+	 * output went quiet, so the line has to be quiet for at least as far
+	 * back as any read tap (including a pending one) can reach. Feedback
+	 * writes back into the line, so this also waits for it to decay.
+	 */
+	if (FAPOFXEcho_INTERNAL_WrittenEnergy(
+		fapo,
+		start_idx,
+		pInputProcessParameters->ValidFrameCount
+	) < 0.0000001f) {
+		fapo->quiet_frames = FAudio_min(
+			fapo->quiet_frames + pInputProcessParameters->ValidFrameCount,
+			fapo->capacity
+		);
+	}
+	else
+	{
+		fapo->quiet_frames = 0;
+	}
+	reach = FAudio_max(fapo->delay, fapo->target_delay);
+	if (fapo->fade_remaining > 0)
+	{
+		reach = FAudio_max(reach, fapo->fade_from);
+	}
+	if (fapo->quiet_frames >= reach)
+	{
+		total = 0.0f;
+		for (i = 0; i < samples; i += 1)
+		{
+			total += buffer[i] * buffer[i];
+		}
+		if (total < 0.0000001f)
+		{
+			pOutputProcessParameters->BufferFlags = FAPO_BUFFER_SILENT;
+		}
+	}
 
 	FAPOBase_EndProcess(&fapo->base);
 }
@@ -160,6 +495,10 @@ void FAPOFXEcho_Process(
 void FAPOFXEcho_Free(void* fapo)
 {
 	FAPOFXEcho *echo = (FAPOFXEcho*) fapo;
+	if (echo->line != NULL)
+	{
+		echo->base.pFree(echo->line);
+	}
 	echo->base.pFree(echo->base.m_pParameterBlocks);
 	echo->base.pFree(fapo);
 }
@@ -233,9 +572,20 @@ uint32_t FAPOFXCreateEcho(
 		customRealloc
 	);
 
+	result->channels = 0;
+	result->sampleRate = 0;
+	result->line = NULL;
+	result->capacity = 0;
+
 	/* Function table... */
+	result->base.base.LockForProcess = (LockForProcessFunc)
+		FAPOFXEcho_LockForProcess;
+	result->base.base.UnlockForProcess = (UnlockForProcessFunc)
+		FAPOFXEcho_UnlockForProcess;
 	result->base.base.Initialize = (InitializeFunc)
 		FAPOFXEcho_Initialize;
+	result->base.base.Reset = (ResetFunc)
+		FAPOFXEcho_Reset;
 	result->base.base.Process = (ProcessFunc)
 		FAPOFXEcho_Process;
 	result->base.Destructor = FAPOFXEcho_Free;
@@ -117,13 +117,348 @@ static FAPORegistrationProperties FXEQProperties_LEGACY =
 	/*.MaxOutputBufferCount =*/ 1
 };
 
+/* Each band is a peaking biquad in transposed direct form II. The filter state
+ * is kept per channel, in lanes of 4, so one SIMD register filters 4 channels
+ * of a frame at once; the coefficients are the same for every channel.
+ */
+
+#define FXEQ_BAND_COUNT 4
+
+typedef struct FXEQBand
+{
+	uint8_t active;	/* Unity gain bands are skipped */
+	float b0, b1, b2, a1, a2;
+} FXEQBand;
+
 typedef struct FAPOFXEQ
 {
 	FAPOBase base;
 
-	/* TODO */
+	uint16_t channels;
+	uint16_t lanes;		/* channels, rounded up to 4 */
+	uint32_t sampleRate;
+	FXEQBand band[FXEQ_BAND_COUNT];
+
+	/* [band][z1, z2][lanes], allocated by LockForProcess */
+	float *state;
 } FAPOFXEQ;
 
+static void FAPOFXEQ_INTERNAL_SetBand(
+	FAPOFXEQ *fapo,
+	uint32_t index,
+	float frequency,
+	float gain,
+	float q
+) {
+	const float TWOPI = 6.283185307179586476925286766559005f;
+	FXEQBand *band = &fapo->band[index];
+	float A, w0, alpha, cosw0, a0;
+
+	/* A unity gain peak is a plain wire, and its state stays at zero */
+	if (gain == 1.0f)
+	{
+		band->active = 0;
+		FAudio_zero(
+			fapo->state + (index * 2 * fapo->lanes),
+			sizeof(float) * 2 * fapo->lanes
+		);
+		return;
+	}
+	band->active = 1;
+
+	/* Peaking EQ, from the RBJ Audio EQ Cookbook. The parameters are
+	 * clamped so the filter stays stable at the lowest frame rates.
+	 */
+	frequency = FAudio_clamp(
+		frequency,
+		FAPOFXEQ_MIN_FREQUENCY_CENTER,
+		fapo->sampleRate * 0.49f
+	);
+	gain = FAudio_clamp(gain, FAPOFXEQ_MIN_GAIN, FAPOFXEQ_MAX_GAIN);
+	q = FAudio_clamp(q, FAPOFXEQ_MIN_BANDWIDTH, FAPOFXEQ_MAX_BANDWIDTH);
+
+	A = FAudio_sqrtf(gain);
+	w0 = TWOPI * frequency / fapo->sampleRate;
+	cosw0 = FAudio_cosf(w0);
+	alpha = FAudio_sinf(w0) / (2.0f * q);
+	a0 = 1.0f + (alpha / A);
+
+	band->b0 = (1.0f + (alpha * A)) / a0;
+	band->b1 = (-2.0f * cosw0) / a0;
+	band->b2 = (1.0f - (alpha * A)) / a0;
+	band->a1 = band->b1;
+	band->a2 = (1.0f - (alpha / A)) / a0;
+}
+
+static void FAPOFXEQ_INTERNAL_SetParameters(
+	FAPOFXEQ *fapo,
+	const FAPOFXEQParameters *params
+) {
+	FAPOFXEQ_INTERNAL_SetBand(
+		fapo,
+		0,
+		params->FrequencyCenter0,
+		params->Gain0,
+		params->Bandwidth0
+	);
+	FAPOFXEQ_INTERNAL_SetBand(
+		fapo,
+		1,
+		params->FrequencyCenter1,
+		params->Gain1,
+		params->Bandwidth1
+	);
+	FAPOFXEQ_INTERNAL_SetBand(
+		fapo,
+		2,
+		params->FrequencyCenter2,
+		params->Gain2,
+		params->Bandwidth2
+	);
+	FAPOFXEQ_INTERNAL_SetBand(
+		fapo,
+		3,
+		params->FrequencyCenter3,
+		params->Gain3,
+		params->Bandwidth3
+	);
+}
+
+/* Filters one channel of one band in place, for the channels that don't fill
+ * a SIMD register
+ */
+static inline void FAPOFXEQ_INTERNAL_ProcessChannel(
+	const FXEQBand *band,
+	float *z1,
+	float *z2,
+	float *buffer,
+	uint16_t stride,
+	uint32_t frames
+) {
+	uint32_t i;
+	float x, y;
+	float s1 = *z1;
+	float s2 = *z2;
+
+	for (i = 0; i < frames; i += 1, buffer += stride)
+	{
+		x = *buffer;
+		y = (band->b0 * x) + s1;
+		s1 = (band->b1 * x) - (band->a1 * y) + s2;
+		s2 = (band->b2 * x) - (band->a2 * y);
+		*buffer = y;
+	}
+	*z1 = s1;
+	*z2 = s2;
+}
+
+/* Whether any band still holds enough of the last sound to be heard */
+static uint8_t FAPOFXEQ_INTERNAL_IsRinging(FAPOFXEQ *fapo)
+{
+	uint32_t i;
+	for (i = 0; i < FXEQ_BAND_COUNT * 2 * fapo->lanes; i += 1)
+	{
+		if (FAudio_fabsf(fapo->state[i]) > 0.0000001f)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Filters one band in place, for frames of 'channels' interleaved samples.
+ * Channels go 4 at a time, then 2 at a time with 64-bit loads, and the last
+ * odd channel is done on its own.
+ */
+static void FAPOFXEQ_INTERNAL_ProcessBand(
+	FAPOFXEQ *fapo,
+	uint32_t index,
+	float *buffer,
+	uint32_t frames
+) {
+	const FXEQBand *band = &fapo->band[index];
+	float *z1 = fapo->state + (index * 2 * fapo->lanes);
+	float *z2 = z1 + fapo->lanes;
+	const uint16_t channels = fapo->channels;
+	uint32_t c = 0;
+
+#if HAVE_SSE2_INTRINSICS
+	const __m128 b0 = _mm_set1_ps(band->b0);
+	const __m128 b1 = _mm_set1_ps(band->b1);
+	const __m128 b2 = _mm_set1_ps(band->b2);
+	const __m128 a1 = _mm_set1_ps(band->a1);
+	const __m128 a2 = _mm_set1_ps(band->a2);
+	__m128 x, y, s1, s2;
+	float *frame;
+	uint32_t i;
+
+	#define FXEQ_BIQUAD \
+		y = _mm_add_ps(_mm_mul_ps(b0, x), s1); \
+		s1 = _mm_add_ps( \
+			_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), \
+			s2 \
+		); \
+		s2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+	for (; c + 4 <= channels; c += 4)
+	{
+		s1 = _mm_loadu_ps(z1 + c);
+		s2 = _mm_loadu_ps(z2 + c);
+		for (i = 0, frame = buffer + c; i < frames; i += 1, frame += channels)
+		{
+			x = _mm_loadu_ps(frame);
+			FXEQ_BIQUAD
+			_mm_storeu_ps(frame, y);
+		}
+		_mm_storeu_ps(z1 + c, s1);
+		_mm_storeu_ps(z2 + c, s2);
+	}
+	if (c + 2 <= channels)
+	{
+		/* The state is padded to 4 lanes, so full loads are safe */
+		s1 = _mm_loadu_ps(z1 + c);
+		s2 = _mm_loadu_ps(z2 + c);
+		for (i = 0, frame = buffer + c; i < frames; i += 1, frame += channels)
+		{
+			x = _mm_castpd_ps(_mm_load_sd((const double*) frame));
+			FXEQ_BIQUAD
+			_mm_storel_pi((__m64*) frame, y);
+		}
+		_mm_storeu_ps(z1 + c, s1);
+		_mm_storeu_ps(z2 + c, s2);
+		c += 2;
+	}
+	#undef FXEQ_BIQUAD
+#elif HAVE_NEON_INTRINSICS
+	const float32x4_t b0 = vdupq_n_f32(band->b0);
+	const float32x4_t b1 = vdupq_n_f32(band->b1);
+	const float32x4_t b2 = vdupq_n_f32(band->b2);
+	const float32x4_t a1 = vdupq_n_f32(band->a1);
+	const float32x4_t a2 = vdupq_n_f32(band->a2);
+	const float32x2_t zero = vdup_n_f32(0.0f);
+	float32x4_t x, y, s1, s2;
+	float *frame;
+	uint32_t i;
+
+	#define FXEQ_BIQUAD \
+		y = vaddq_f32(vmulq_f32(b0, x), s1); \
+		s1 = vaddq_f32( \
+			vsubq_f32(vmulq_f32(b1, x), vmulq_f32(a1, y)), \
+			s2 \
+		); \
+		s2 = vsubq_f32(vmulq_f32(b2, x), vmulq_f32(a2, y));
+	for (; c + 4 <= channels; c += 4)
+	{
+		s1 = vld1q_f32(z1 + c);
+		s2 = vld1q_f32(z2 + c);
+		for (i = 0, frame = buffer + c; i < frames; i += 1, frame += channels)
+		{
+			x = vld1q_f32(frame);
+			FXEQ_BIQUAD
+			vst1q_f32(frame, y);
+		}
+		vst1q_f32(z1 + c, s1);
+		vst1q_f32(z2 + c, s2);
+	}
+	if (c + 2 <= channels)
+	{
+		/* The state is padded to 4 lanes, so full loads are safe */
+		s1 = vld1q_f32(z1 + c);
+		s2 = vld1q_f32(z2 + c);
+		for (i = 0, frame = buffer + c; i < frames; i += 1, frame += channels)
+		{
+			x = vcombine_f32(vld1_f32(frame), zero);
+			FXEQ_BIQUAD
+			vst1_f32(frame, vget_low_f32(y));
+		}
+		vst1q_f32(z1 + c, s1);
+		vst1q_f32(z2 + c, s2);
+		c += 2;
+	}
+	#undef FXEQ_BIQUAD
+#endif
+
+	for (; c < channels; c += 1)
+	{
+		FAPOFXEQ_INTERNAL_ProcessChannel(
+			band,
+			z1 + c,
+			z2 + c,
+			buffer + c,
+			channels,
+			frames
+		);
+	}
+}
+
+uint32_t FAPOFXEQ_LockForProcess(
+	FAPOFXEQ *fapo,
+	uint32_t InputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pInputLockedParameters,
+	uint32_t OutputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pOutputLockedParameters
+) {
+	uint32_t result;
+
+	/* Call parent to do basic validation */
+	result = FAPOBase_LockForProcess(
+		&fapo->base,
+		InputLockedParameterCount,
+		pInputLockedParameters,
+		OutputLockedParameterCount,
+		pOutputLockedParameters
+	);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	/* Save the things we care about */
+	fapo->channels = pInputLockedParameters->pFormat->nChannels;
+	fapo->lanes = (fapo->channels + 3) & ~3;
+	fapo->sampleRate = pInputLockedParameters->pFormat->nSamplesPerSec;
+
+	fapo->state = (float*) fapo->base.pMalloc(
+		sizeof(float) * FXEQ_BAND_COUNT * 2 * fapo->lanes
+	);
+	if (fapo->state == NULL)
+	{
+		FAPOBase_UnlockForProcess(&fapo->base);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	FAudio_zero(
+		fapo->state,
+		sizeof(float) * FXEQ_BAND_COUNT * 2 * fapo->lanes
+	);
+
+	FAPOFXEQ_INTERNAL_SetParameters(
+		fapo,
+		(const FAPOFXEQParameters*) fapo->base.m_pParameterBlocks
+	);
+	return 0;
+}
+
+void FAPOFXEQ_UnlockForProcess(FAPOFXEQ *fapo)
+{
+	if (fapo->state != NULL)
+	{
+		fapo->base.pFree(fapo->state);
+		fapo->state = NULL;
+	}
+	FAPOBase_UnlockForProcess(&fapo->base);
+}
+
+void FAPOFXEQ_Reset(FAPOFXEQ *fapo)
+{
+	FAPOBase_Reset(&fapo->base);
+	if (fapo->state != NULL)
+	{
+		FAudio_zero(
+			fapo->state,
+			sizeof(float) * FXEQ_BAND_COUNT * 2 * fapo->lanes
+		);
+	}
+}
+
 uint32_t FAPOFXEQ_Initialize(
 	FAPOFXEQ *fapo,
 	const void* pData,
@@ -150,9 +485,62 @@ void FAPOFXEQ_Process(
 	FAPOProcessBufferParameters* pOutputProcessParameters,
 	int32_t IsEnabled
 ) {
-	FAPOBase_BeginProcess(&fapo->base);
+	FAPOFXEQParameters *params;
+	uint8_t update_params = FAPOBase_ParametersChanged(&fapo->base);
+	uint32_t i;
+
+	params = (FAPOFXEQParameters*) FAPOBase_BeginProcess(&fapo->base);
+
+	/* Only rebuild the filters when the application changed something */
+	if (update_params)
+	{
+		FAPOFXEQ_INTERNAL_SetParameters(fapo, params);
+	}
+
+	/* In-place is required, so there's nothing to copy when disabled */
+	if (IsEnabled == 0)
+	{
+		pOutputProcessParameters->BufferFlags = pInputProcessParameters->BufferFlags;
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
 
-	/* TODO */
+	/* Silence still has to run through the bands until they stop ringing,
+	 * or the leftover state lands on the start of the next sound
+	 */
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		if (!FAPOFXEQ_INTERNAL_IsRinging(fapo))
+		{
+			FAudio_zero(
+				fapo->state,
+				sizeof(float) * FXEQ_BAND_COUNT * 2 * fapo->lanes
+			);
+			pOutputProcessParameters->BufferFlags = FAPO_BUFFER_SILENT;
+			FAPOBase_EndProcess(&fapo->base);
+			return;
+		}
+		FAudio_zero(
+			pInputProcessParameters->pBuffer,
+			sizeof(float) *
+				pInputProcessParameters->ValidFrameCount *
+				fapo->channels
+		);
+	}
+
+	for (i = 0; i < FXEQ_BAND_COUNT; i += 1)
+	{
+		if (fapo->band[i].active)
+		{
+			FAPOFXEQ_INTERNAL_ProcessBand(
+				fapo,
+				i,
+				(float*) pInputProcessParameters->pBuffer,
+				pInputProcessParameters->ValidFrameCount
+			);
+		}
+	}
+	pOutputProcessParameters->BufferFlags = FAPO_BUFFER_VALID;
 
 	FAPOBase_EndProcess(&fapo->base);
 }
@@ -160,6 +548,10 @@ void FAPOFXEQ_Process(
 void FAPOFXEQ_Free(void* fapo)
 {
 	FAPOFXEQ *eq = (FAPOFXEQ*) fapo;
+	if (eq->state != NULL)
+	{
+		eq->base.pFree(eq->state);
+	}
 	eq->base.pFree(eq->base.m_pParameterBlocks);
 	eq->base.pFree(fapo);
 }
@@ -242,9 +634,20 @@ uint32_t FAPOFXCreateEQ(
 		customRealloc
 	);
 
+	result->channels = 0;
+	result->lanes = 0;
+	result->sampleRate = 0;
+	result->state = NULL;
+
 	/* Function table... */
+	result->base.base.LockForProcess = (LockForProcessFunc)
+		FAPOFXEQ_LockForProcess;
+	result->base.base.UnlockForProcess = (UnlockForProcessFunc)
+		FAPOFXEQ_UnlockForProcess;
 	result->base.base.Initialize = (InitializeFunc)
 		FAPOFXEQ_Initialize;
+	result->base.base.Reset = (ResetFunc)
+		FAPOFXEQ_Reset;
 	result->base.base.Process = (ProcessFunc)
 		FAPOFXEQ_Process;
 	result->base.Destructor = FAPOFXEQ_Free;
@@ -117,13 +117,378 @@ static FAPORegistrationProperties FXMasteringLimiterProperties_LEGACY =
 	/*.MaxOutputBufferCount =*/ 1
 };
 
+/* The limiter delays the signal by FXLIMITER_LOOKAHEAD_MS, so it can see a
+ * peak coming and have the gain down before the peak gets to the output:
+ *
+ * - The gain each frame needs (FXLIMITER_CEILING / peak) goes through a
+ *   sliding minimum covering the look-ahead window, kept in a monotonic deque.
+ * - Going up, the gain recovers at the Release rate. Going down, it follows
+ *   the minimum right away.
+ * - A moving average over the same window turns the steps into ramps. Every
+ *   value averaged for a frame already covers that frame's peak, so the
+ *   ramp is always down in time.
+ *
+ * The per-frame peaks, the most expensive part on big masters, are found
+ * with SIMD across channels before any of that runs.
+ *
+ * MSDN doesn't give Loudness a unit, so it's used as an input gain where
+ * FAPOFXMASTERINGLIMITER_DEFAULT_LOUDNESS is unity. Release is scaled to
+ * FXLIMITER_RELEASE_MS milliseconds per step.
+ */
+
+#define FXLIMITER_LOOKAHEAD_MS 2
+#define FXLIMITER_RELEASE_MS 10.0f
+#define FXLIMITER_CEILING 1.0f
+
 typedef struct FAPOFXMasteringLimiter
 {
 	FAPOBase base;
 
-	/* TODO */
+	uint16_t channels;
+	uint32_t sampleRate;
+	float input_gain;
+	float release_coef;
+
+	/* Everything below is allocated by LockForProcess */
+	uint32_t window;	/* Look-ahead frames + 1 */
+	uint32_t max_frames;
+	float *block;		/* Scratch, one value per frame */
+
+	/* [window - 1][channels] */
+	float *delay;
+	uint32_t delay_idx;
+
+	/* Sliding minimum of the needed gain, [window] */
+	float *min_value;
+	uint32_t *min_frame;
+	uint32_t min_head;
+	uint32_t min_count;
+	uint32_t frame;
+
+	/* Release follower and moving average, [window] */
+	float release_gain;
+	float *average;
+	uint32_t average_idx;
+	double average_sum;
 } FAPOFXMasteringLimiter;
 
+static void FAPOFXMasteringLimiter_INTERNAL_SetParameters(
+	FAPOFXMasteringLimiter *fapo,
+	const FAPOFXMasteringLimiterParameters *params
+) {
+	uint32_t release = FAudio_clamp(
+		params->Release,
+		FAPOFXMASTERINGLIMITER_MIN_RELEASE,
+		FAPOFXMASTERINGLIMITER_MAX_RELEASE
+	);
+	uint32_t loudness = FAudio_clamp(
+		params->Loudness,
+		FAPOFXMASTERINGLIMITER_MIN_LOUDNESS,
+		FAPOFXMASTERINGLIMITER_MAX_LOUDNESS
+	);
+
+	fapo->input_gain = (float) loudness / FAPOFXMASTERINGLIMITER_DEFAULT_LOUDNESS;
+	fapo->release_coef = 1.0f - (float) FAudio_exp(
+		-1000.0 / (release * FXLIMITER_RELEASE_MS * fapo->sampleRate)
+	);
+}
+
+static void FAPOFXMasteringLimiter_INTERNAL_Clear(FAPOFXMasteringLimiter *fapo)
+{
+	uint32_t i;
+
+	FAudio_zero(
+		fapo->delay,
+		sizeof(float) * (fapo->window - 1) * fapo->channels
+	);
+	fapo->delay_idx = 0;
+	fapo->min_head = 0;
+	fapo->min_count = 0;
+	fapo->frame = 0;
+	fapo->release_gain = 1.0f;
+	for (i = 0; i < fapo->window; i += 1)
+	{
+		fapo->average[i] = 1.0f;
+	}
+	fapo->average_idx = 0;
+	fapo->average_sum = fapo->window;
+}
+
+/* Finds the largest absolute sample of every frame */
+static void FAPOFXMasteringLimiter_INTERNAL_Peaks(
+	FAPOFXMasteringLimiter *fapo,
+	const float *buffer,
+	float *peaks,
+	uint32_t frames
+) {
+	uint32_t i, c;
+	const uint16_t channels = fapo->channels;
+	float peak, sample;
+
+#if HAVE_SSE2_INTRINSICS
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	__m128 max;
+	if (channels >= 4)
+	{
+		for (i = 0; i < frames; i += 1, buffer += channels)
+		{
+			max = _mm_andnot_ps(sign, _mm_loadu_ps(buffer));
+			for (c = 4; c + 4 <= channels; c += 4)
+			{
+				max = _mm_max_ps(
+					max,
+					_mm_andnot_ps(sign, _mm_loadu_ps(buffer + c))
+				);
+			}
+			max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+			max = _mm_max_ss(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(1, 1, 1, 1)));
+			peak = _mm_cvtss_f32(max);
+			for (; c < channels; c += 1)
+			{
+				sample = FAudio_fabsf(buffer[c]);
+				peak = (sample > peak) ? sample : peak;
+			}
+			peaks[i] = peak;
+		}
+		return;
+	}
+#elif HAVE_NEON_INTRINSICS
+	float32x4_t max;
+	float32x2_t half;
+	if (channels >= 4)
+	{
+		for (i = 0; i < frames; i += 1, buffer += channels)
+		{
+			max = vabsq_f32(vld1q_f32(buffer));
+			for (c = 4; c + 4 <= channels; c += 4)
+			{
+				max = vmaxq_f32(max, vabsq_f32(vld1q_f32(buffer + c)));
+			}
+			half = vmax_f32(vget_low_f32(max), vget_high_f32(max));
+			peak = vget_lane_f32(vpmax_f32(half, half), 0);
+			for (; c < channels; c += 1)
+			{
+				sample = FAudio_fabsf(buffer[c]);
+				peak = (sample > peak) ? sample : peak;
+			}
+			peaks[i] = peak;
+		}
+		return;
+	}
+#endif
+
+	for (i = 0; i < frames; i += 1, buffer += channels)
+	{
+		peak = 0.0f;
+		for (c = 0; c < channels; c += 1)
+		{
+			sample = FAudio_fabsf(buffer[c]);
+			peak = (sample > peak) ? sample : peak;
+		}
+		peaks[i] = peak;
+	}
+}
+
+/* Turns the per-frame peaks into the gain for each output frame, in place */
+static void FAPOFXMasteringLimiter_INTERNAL_Gains(
+	FAPOFXMasteringLimiter *fapo,
+	float *block,
+	uint32_t frames
+) {
+	uint32_t i, tail;
+	float peak, needed, held, release;
+	const float scale = fapo->input_gain / fapo->window;
+
+	for (i = 0; i < frames; i += 1, fapo->frame += 1)
+	{
+		peak = block[i] * fapo->input_gain;
+		needed = (peak > FXLIMITER_CEILING) ?
+			(FXLIMITER_CEILING / peak) :
+			1.0f;
+
+		/* Anything at the back that's no smaller can never be the
+		 * minimum again, since this frame outlives it
+		 */
+		while (fapo->min_count > 0)
+		{
+			tail = fapo->min_head + fapo->min_count - 1;
+			if (tail >= fapo->window)
+			{
+				tail -= fapo->window;
+			}
+			if (fapo->min_value[tail] < needed)
+			{
+				break;
+			}
+			fapo->min_count -= 1;
+		}
+		tail = fapo->min_head + fapo->min_count;
+		if (tail >= fapo->window)
+		{
+			tail -= fapo->window;
+		}
+		fapo->min_value[tail] = needed;
+		fapo->min_frame[tail] = fapo->frame;
+		fapo->min_count += 1;
+
+		/* Drop the front once it's left the window */
+		if ((fapo->frame - fapo->min_frame[fapo->min_head]) >= fapo->window)
+		{
+			fapo->min_head += 1;
+			if (fapo->min_head == fapo->window)
+			{
+				fapo->min_head = 0;
+			}
+			fapo->min_count -= 1;
+		}
+		held = fapo->min_value[fapo->min_head];
+
+		/* Attack immediately, release slowly */
+		release = fapo->release_gain + (
+			(held - fapo->release_gain) * fapo->release_coef
+		);
+		fapo->release_gain = (held < release) ? held : release;
+
+		fapo->average_sum += fapo->release_gain - fapo->average[fapo->average_idx];
+		fapo->average[fapo->average_idx] = fapo->release_gain;
+		fapo->average_idx += 1;
+		if (fapo->average_idx == fapo->window)
+		{
+			fapo->average_idx = 0;
+		}
+
+		block[i] = (float) fapo->average_sum * scale;
+	}
+}
+
+/* Delays the buffer by the look-ahead and applies the gains, in place */
+static void FAPOFXMasteringLimiter_INTERNAL_Apply(
+	FAPOFXMasteringLimiter *fapo,
+	float *buffer,
+	const float *gains,
+	uint32_t frames
+) {
+	uint32_t i, c, chunk;
+	float *delay;
+	float sample;
+	const uint16_t channels = fapo->channels;
+	const uint32_t length = fapo->window - 1;
+
+	while (frames > 0)
+	{
+		/* Run until the delay line wraps around */
+		chunk = FAudio_min(frames, length - fapo->delay_idx);
+		delay = fapo->delay + (fapo->delay_idx * channels);
+		for (i = 0; i < chunk; i += 1)
+		{
+			for (c = 0; c < channels; c += 1)
+			{
+				sample = delay[c];
+				delay[c] = buffer[c];
+				buffer[c] = sample * gains[i];
+			}
+			delay += channels;
+			buffer += channels;
+		}
+
+		gains += chunk;
+		frames -= chunk;
+		fapo->delay_idx += chunk;
+		if (fapo->delay_idx == length)
+		{
+			fapo->delay_idx = 0;
+		}
+	}
+}
+
+uint32_t FAPOFXMasteringLimiter_LockForProcess(
+	FAPOFXMasteringLimiter *fapo,
+	uint32_t InputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pInputLockedParameters,
+	uint32_t OutputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pOutputLockedParameters
+) {
+	uint32_t result, floats;
+
+	/* Call parent to do basic validation */
+	result = FAPOBase_LockForProcess(
+		&fapo->base,
+		InputLockedParameterCount,
+		pInputLockedParameters,
+		OutputLockedParameterCount,
+		pOutputLockedParameters
+	);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	/* Save the things we care about */
+	fapo->channels = pInputLockedParameters->pFormat->nChannels;
+	fapo->sampleRate = pInputLockedParameters->pFormat->nSamplesPerSec;
+	fapo->max_frames = pInputLockedParameters->MaxFrameCount;
+	fapo->window = (
+		FXLIMITER_LOOKAHEAD_MS * fapo->sampleRate / 1000
+	) + 1;
+
+	floats = (
+		fapo->max_frames +				/* block */
+		(fapo->window - 1) * fapo->channels +		/* delay */
+		fapo->window +					/* min_value */
+		fapo->window					/* average */
+	);
+	fapo->block = (float*) fapo->base.pMalloc(sizeof(float) * floats);
+	fapo->min_frame = (uint32_t*) fapo->base.pMalloc(
+		sizeof(uint32_t) * fapo->window
+	);
+	if (fapo->block == NULL || fapo->min_frame == NULL)
+	{
+		if (fapo->block != NULL)
+		{
+			fapo->base.pFree(fapo->block);
+			fapo->block = NULL;
+		}
+		if (fapo->min_frame != NULL)
+		{
+			fapo->base.pFree(fapo->min_frame);
+			fapo->min_frame = NULL;
+		}
+		FAPOBase_UnlockForProcess(&fapo->base);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	fapo->delay = fapo->block + fapo->max_frames;
+	fapo->min_value = fapo->delay + (fapo->window - 1) * fapo->channels;
+	fapo->average = fapo->min_value + fapo->window;
+
+	FAPOFXMasteringLimiter_INTERNAL_Clear(fapo);
+	FAPOFXMasteringLimiter_INTERNAL_SetParameters(
+		fapo,
+		(const FAPOFXMasteringLimiterParameters*) fapo->base.m_pParameterBlocks
+	);
+	return 0;
+}
+
+void FAPOFXMasteringLimiter_UnlockForProcess(FAPOFXMasteringLimiter *fapo)
+{
+	if (fapo->block != NULL)
+	{
+		fapo->base.pFree(fapo->block);
+		fapo->base.pFree(fapo->min_frame);
+		fapo->block = NULL;
+		fapo->min_frame = NULL;
+	}
+	FAPOBase_UnlockForProcess(&fapo->base);
+}
+
+void FAPOFXMasteringLimiter_Reset(FAPOFXMasteringLimiter *fapo)
+{
+	FAPOBase_Reset(&fapo->base);
+	if (fapo->block != NULL)
+	{
+		FAPOFXMasteringLimiter_INTERNAL_Clear(fapo);
+	}
+}
+
 uint32_t FAPOFXMasteringLimiter_Initialize(
 	FAPOFXMasteringLimiter *fapo,
 	const void* pData,
@@ -150,9 +515,55 @@ void FAPOFXMasteringLimiter_Process(
 	FAPOProcessBufferParameters* pOutputProcessParameters,
 	int32_t IsEnabled
 ) {
-	FAPOBase_BeginProcess(&fapo->base);
+	FAPOFXMasteringLimiterParameters *params;
+	uint8_t update_params = FAPOBase_ParametersChanged(&fapo->base);
+	float *buffer = (float*) pInputProcessParameters->pBuffer;
+	uint32_t frames = pInputProcessParameters->ValidFrameCount;
+	uint32_t i, samples;
+	float total;
+
+	params = (FAPOFXMasteringLimiterParameters*) FAPOBase_BeginProcess(
+		&fapo->base
+	);
 
-	/* TODO */
+	if (update_params)
+	{
+		FAPOFXMasteringLimiter_INTERNAL_SetParameters(fapo, params);
+	}
+
+	/* In-place is required, so there's nothing to copy when disabled */
+	if (IsEnabled == 0)
+	{
+		pOutputProcessParameters->BufferFlags = pInputProcessParameters->BufferFlags;
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
+
+	/* The look-ahead still holds audio when the input goes silent */
+	samples = frames * fapo->channels;
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		FAudio_zero(buffer, samples * sizeof(float));
+	}
+
+	FAPOFXMasteringLimiter_INTERNAL_Peaks(fapo, buffer, fapo->block, frames);
+	FAPOFXMasteringLimiter_INTERNAL_Gains(fapo, fapo->block, frames);
+	FAPOFXMasteringLimiter_INTERNAL_Apply(fapo, buffer, fapo->block, frames);
+
+	/* Set BufferFlags to silent so PLAY_TAILS knows when to stop */
+	pOutputProcessParameters->BufferFlags = FAPO_BUFFER_VALID;
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		total = 0.0f;
+		for (i = 0; i < samples; i += 1)
+		{
+			total += buffer[i] * buffer[i];
+		}
+		if (total < 0.0000001f)
+		{
+			pOutputProcessParameters->BufferFlags = FAPO_BUFFER_SILENT;
+		}
+	}
 
 	FAPOBase_EndProcess(&fapo->base);
 }
@@ -160,6 +571,11 @@ void FAPOFXMasteringLimiter_Process(
 void FAPOFXMasteringLimiter_Free(void* fapo)
 {
 	FAPOFXMasteringLimiter *limiter = (FAPOFXMasteringLimiter*) fapo;
+	if (limiter->block != NULL)
+	{
+		limiter->base.pFree(limiter->block);
+		limiter->base.pFree(limiter->min_frame);
+	}
 	limiter->base.pFree(limiter->base.m_pParameterBlocks);
 	limiter->base.pFree(fapo);
 }
@@ -232,9 +648,20 @@ uint32_t FAPOFXCreateMasteringLimiter(
 		customRealloc
 	);
 
+	result->channels = 0;
+	result->sampleRate = 0;
+	result->block = NULL;
+	result->min_frame = NULL;
+
 	/* Function table... */
+	result->base.base.LockForProcess = (LockForProcessFunc)
+		FAPOFXMasteringLimiter_LockForProcess;
+	result->base.base.UnlockForProcess = (UnlockForProcessFunc)
+		FAPOFXMasteringLimiter_UnlockForProcess;
 	result->base.base.Initialize = (InitializeFunc)
 		FAPOFXMasteringLimiter_Initialize;
+	result->base.base.Reset = (ResetFunc)
+		FAPOFXMasteringLimiter_Reset;
 	result->base.base.Process = (ProcessFunc)
 		FAPOFXMasteringLimiter_Process;
 	result->base.Destructor = FAPOFXMasteringLimiter_Free;
@@ -25,6 +25,7 @@
  */
 
 #include "FAPOFX.h"
+#include "FAudioFX.h"
 #include "FAudio_internal.h"
 
 /* FXReverb FAPO Implementation */
@@ -65,7 +66,8 @@ static FAPORegistrationProperties FXReverbProperties =
 		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
 		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
 		FAPO_FLAG_INPLACE_SUPPORTED |
-		FAPO_FLAG_INPLACE_REQUIRED
+		FAPO_FLAG_INPLACE_REQUIRED |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
 	),
 	/*.MinInputBufferCount = */ 1,
 	/*.MaxInputBufferCount = */  1,
@@ -109,7 +111,8 @@ static FAPORegistrationProperties FXReverbProperties_LEGACY =
 		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
 		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
 		FAPO_FLAG_INPLACE_SUPPORTED |
-		FAPO_FLAG_INPLACE_REQUIRED
+		FAPO_FLAG_INPLACE_REQUIRED |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
 	),
 	/*.MinInputBufferCount = */ 1,
 	/*.MaxInputBufferCount = */  1,
@@ -117,13 +120,206 @@ static FAPORegistrationProperties FXReverbProperties_LEGACY =
 	/*.MaxOutputBufferCount =*/ 1
 };
 
+/* FAudio extension, runs a smaller network for effects on lots of voices */
+
+const FAudioGUID FAPOFX_CLSID_FXReverbLowCPUEXT =
+{
+	0x6FB8D8CB,
+	0xC43F,
+	0x4B44,
+	{
+		0xB3,
+		0xBE,
+		0xA3,
+		0x0D,
+		0x1A,
+		0x0A,
+		0x99,
+		0x00
+	}
+};
+
+static FAPORegistrationProperties FXReverbProperties_LowCPU =
+{
+	/* .clsid = */ {0},
+	/* .FriendlyName = */
+	{
+		'F', 'X', 'R', 'e', 'v', 'e', 'r', 'b', '\0'
+	},
+	/*.CopyrightInfo = */
+	{
+		'C', 'o', 'p', 'y', 'r', 'i', 'g', 'h', 't', ' ', '(', 'c', ')',
+		'E', 't', 'h', 'a', 'n', ' ', 'L', 'e', 'e', '\0'
+	},
+	/*.MajorVersion = */ 0,
+	/*.MinorVersion = */ 0,
+	/*.Flags = */(
+		FAPO_FLAG_FRAMERATE_MUST_MATCH |
+		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
+		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
+		FAPO_FLAG_INPLACE_SUPPORTED |
+		FAPO_FLAG_INPLACE_REQUIRED |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
+	),
+	/*.MinInputBufferCount = */ 1,
+	/*.MaxInputBufferCount = */  1,
+	/*.MinOutputBufferCount = */ 1,
+	/*.MaxOutputBufferCount =*/ 1
+};
+
+/* FXReverb runs the same network as FAudioFX's Reverb. Both of its parameters
+ * are subjective, so they're mapped onto the Reverb's like this:
+ *
+ * - Diffusion sets both EarlyDiffusion and LateDiffusion.
+ * - RoomSize scales the decay time and the two pre-delays, so small rooms
+ *   answer quickly and die out quickly.
+ *
+ * Everything else uses the Reverb's defaults, except that the dry signal is
+ * kept, since FXReverb is an in-place effect on the voice itself.
+ */
+
+#define FXREVERB_WET_DRY_MIX		50.0f
+#define FXREVERB_MAX_DECAY_TIME		5.0f	/* Seconds, at RoomSize 1.0 */
+#define FXREVERB_MAX_REFLECTIONS_DELAY	30.0f	/* Milliseconds */
+#define FXREVERB_MAX_REVERB_DELAY	20.0f	/* Milliseconds */
+
 typedef struct FAPOFXReverb
 {
 	FAPOBase base;
 
-	/* TODO */
+	uint8_t lowCPU;
+	uint16_t channels;
+
+	/* Created by LockForProcess */
+	struct DspReverb *reverb;
 } FAPOFXReverb;
 
+static void FAPOFXReverb_INTERNAL_SetParameters(
+	FAPOFXReverb *fapo,
+	const FAPOFXReverbParameters *fxparams
+) {
+	FAudioFXReverbParameters params;
+	uint8_t diffusion;
+	float roomSize;
+
+	diffusion = (uint8_t) (FAudio_clamp(
+		fxparams->Diffusion,
+		FAPOFXREVERB_MIN_DIFFUSION,
+		FAPOFXREVERB_MAX_DIFFUSION
+	) * FAUDIOFX_REVERB_MAX_DIFFUSION + 0.5f);
+	roomSize = FAudio_clamp(
+		fxparams->RoomSize,
+		FAPOFXREVERB_MIN_ROOMSIZE,
+		FAPOFXREVERB_MAX_ROOMSIZE
+	);
+
+	params.WetDryMix = FXREVERB_WET_DRY_MIX;
+	params.ReflectionsDelay = (uint32_t) (roomSize * FXREVERB_MAX_REFLECTIONS_DELAY);
+	params.ReverbDelay = (uint8_t) (roomSize * FXREVERB_MAX_REVERB_DELAY);
+	params.RearDelay = FAUDIOFX_REVERB_DEFAULT_REAR_DELAY;
+	params.PositionLeft = FAUDIOFX_REVERB_DEFAULT_POSITION;
+	params.PositionRight = FAUDIOFX_REVERB_DEFAULT_POSITION;
+	params.PositionMatrixLeft = FAUDIOFX_REVERB_DEFAULT_POSITION_MATRIX;
+	params.PositionMatrixRight = FAUDIOFX_REVERB_DEFAULT_POSITION_MATRIX;
+	params.EarlyDiffusion = diffusion;
+	params.LateDiffusion = diffusion;
+	params.LowEQGain = FAUDIOFX_REVERB_DEFAULT_LOW_EQ_GAIN;
+	params.LowEQCutoff = FAUDIOFX_REVERB_DEFAULT_LOW_EQ_CUTOFF;
+	params.HighEQGain = FAUDIOFX_REVERB_DEFAULT_HIGH_EQ_GAIN;
+	params.HighEQCutoff = FAUDIOFX_REVERB_DEFAULT_HIGH_EQ_CUTOFF;
+	params.RoomFilterFreq = FAUDIOFX_REVERB_DEFAULT_ROOM_FILTER_FREQ;
+	params.RoomFilterMain = FAUDIOFX_REVERB_DEFAULT_ROOM_FILTER_MAIN;
+	params.RoomFilterHF = FAUDIOFX_REVERB_DEFAULT_ROOM_FILTER_HF;
+	params.ReflectionsGain = FAUDIOFX_REVERB_DEFAULT_REFLECTIONS_GAIN;
+	params.ReverbGain = FAUDIOFX_REVERB_DEFAULT_REVERB_GAIN;
+	params.DecayTime = FAudio_max(
+		roomSize * FXREVERB_MAX_DECAY_TIME,
+		FAUDIOFX_REVERB_MIN_DECAY_TIME
+	);
+	params.Density = FAUDIOFX_REVERB_DEFAULT_DENSITY;
+	params.RoomSize = roomSize * FAUDIOFX_REVERB_MAX_ROOM_SIZE;
+
+	FAudio_INTERNAL_SetReverbNetworkParameters(fapo->reverb, &params);
+}
+
+uint32_t FAPOFXReverb_LockForProcess(
+	FAPOFXReverb *fapo,
+	uint32_t InputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pInputLockedParameters,
+	uint32_t OutputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pOutputLockedParameters
+) {
+	const FAudioWaveFormatEx *format = pInputLockedParameters->pFormat;
+	uint32_t result;
+	uint8_t supported;
+
+	/* The network only knows mono, stereo and 5.1. Other formats are
+	 * passed through untouched, rather than failing the voice.
+	 */
+	supported = (
+		(format->nChannels == 1 || format->nChannels == 2 || format->nChannels == 6) &&
+		format->nSamplesPerSec >= FAUDIOFX_REVERB_MIN_FRAMERATE &&
+		format->nSamplesPerSec <= FAUDIOFX_REVERB_MAX_FRAMERATE
+	);
+
+	/* Call parent to do basic validation */
+	result = FAPOBase_LockForProcess(
+		&fapo->base,
+		InputLockedParameterCount,
+		pInputLockedParameters,
+		OutputLockedParameterCount,
+		pOutputLockedParameters
+	);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	/* Save the things we care about */
+	fapo->channels = format->nChannels;
+	if (!supported)
+	{
+		return 0;
+	}
+
+	/* Create the network */
+	fapo->reverb = FAudio_INTERNAL_CreateReverbNetwork(
+		format->nSamplesPerSec,
+		fapo->channels,
+		fapo->lowCPU,
+		fapo->base.pMalloc
+	);
+	if (fapo->reverb == NULL)
+	{
+		FAPOBase_UnlockForProcess(&fapo->base);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	FAPOFXReverb_INTERNAL_SetParameters(
+		fapo,
+		(const FAPOFXReverbParameters*) fapo->base.m_pParameterBlocks
+	);
+	return 0;
+}
+
+void FAPOFXReverb_UnlockForProcess(FAPOFXReverb *fapo)
+{
+	if (fapo->reverb != NULL)
+	{
+		FAudio_INTERNAL_DestroyReverbNetwork(fapo->reverb, fapo->base.pFree);
+		fapo->reverb = NULL;
+	}
+	FAPOBase_UnlockForProcess(&fapo->base);
+}
+
+void FAPOFXReverb_Reset(FAPOFXReverb *fapo)
+{
+	FAPOBase_Reset(&fapo->base);
+	if (fapo->reverb != NULL)
+	{
+		FAudio_INTERNAL_ResetReverbNetwork(fapo->reverb);
+	}
+}
+
 uint32_t FAPOFXReverb_Initialize(
 	FAPOFXReverb *fapo,
 	const void* pData,
@@ -150,9 +346,53 @@ void FAPOFXReverb_Process(
 	FAPOProcessBufferParameters* pOutputProcessParameters,
 	int32_t IsEnabled
 ) {
-	FAPOBase_BeginProcess(&fapo->base);
+	FAPOFXReverbParameters *params;
+	uint8_t update_params = FAPOBase_ParametersChanged(&fapo->base);
+	uint64_t fpstate;
+	float total;
+
+	params = (FAPOFXReverbParameters*) FAPOBase_BeginProcess(&fapo->base);
 
-	/* TODO */
+	/* Update parameters before doing anything else */
+	if (update_params && fapo->reverb != NULL)
+	{
+		FAPOFXReverb_INTERNAL_SetParameters(fapo, params);
+	}
+
+	/* In-place is required, so there's nothing to copy when disabled, or
+	 * when the format has no network to run through
+	 */
+	if (IsEnabled == 0 || fapo->reverb == NULL)
+	{
+		pOutputProcessParameters->BufferFlags = pInputProcessParameters->BufferFlags;
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
+
+	/* A silent buffer still has to run through the network for the tail */
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		FAudio_zero(
+			pInputProcessParameters->pBuffer,
+			pInputProcessParameters->ValidFrameCount * fapo->channels * sizeof(float)
+		);
+	}
+
+	fpstate = FAudio_INTERNAL_FlushDenormals();
+	total = FAudio_INTERNAL_ProcessReverbNetwork(
+		fapo->reverb,
+		(float*) pInputProcessParameters->pBuffer,
+		pInputProcessParameters->ValidFrameCount
+	);
+	FAudio_INTERNAL_RestoreDenormals(fpstate);
+
+	/* Set BufferFlags to silent so PLAY_TAILS knows when to stop */
+	pOutputProcessParameters->BufferFlags = FAudio_INTERNAL_UpdateReverbNetworkSilence(
+		fapo->reverb,
+		pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT,
+		pInputProcessParameters->ValidFrameCount,
+		total
+	) ? FAPO_BUFFER_SILENT : FAPO_BUFFER_VALID;
 
 	FAPOBase_EndProcess(&fapo->base);
 }
@@ -160,20 +400,25 @@ void FAPOFXReverb_Process(
 void FAPOFXReverb_Free(void* fapo)
 {
 	FAPOFXReverb *reverb = (FAPOFXReverb*) fapo;
+	if (reverb->reverb != NULL)
+	{
+		FAudio_INTERNAL_DestroyReverbNetwork(reverb->reverb, reverb->base.pFree);
+	}
 	reverb->base.pFree(reverb->base.m_pParameterBlocks);
 	reverb->base.pFree(fapo);
 }
 
 /* Public API */
 
-uint32_t FAPOFXCreateReverb(
+static uint32_t FAPOFXReverb_INTERNAL_Create(
 	FAPO **pEffect,
 	const void *pInitData,
 	uint32_t InitDataByteSize,
 	FAudioMallocFunc customMalloc,
 	FAudioFreeFunc customFree,
 	FAudioReallocFunc customRealloc,
-	uint8_t legacy
+	uint8_t legacy,
+	uint8_t lowCPU
 ) {
 	const FAPOFXReverbParameters fxdefault =
 	{
@@ -221,9 +466,16 @@ uint32_t FAPOFXCreateReverb(
 		&FAPOFX_CLSID_FXReverb,
 		sizeof(FAudioGUID)
 	);
+	FAudio_memcpy(
+		&FXReverbProperties_LowCPU.clsid,
+		&FAPOFX_CLSID_FXReverbLowCPUEXT,
+		sizeof(FAudioGUID)
+	);
 	CreateFAPOBaseWithCustomAllocatorEXT(
 		&result->base,
-		legacy ? &FXReverbProperties_LEGACY : &FXReverbProperties,
+		lowCPU ? &FXReverbProperties_LowCPU :
+			legacy ? &FXReverbProperties_LEGACY :
+			&FXReverbProperties,
 		params,
 		sizeof(FAPOFXReverbParameters),
 		0,
@@ -232,9 +484,19 @@ uint32_t FAPOFXCreateReverb(
 		customRealloc
 	);
 
+	result->lowCPU = lowCPU;
+	result->channels = 0;
+	result->reverb = NULL;
+
 	/* Function table... */
+	result->base.base.LockForProcess = (LockForProcessFunc)
+		FAPOFXReverb_LockForProcess;
+	result->base.base.UnlockForProcess = (UnlockForProcessFunc)
+		FAPOFXReverb_UnlockForProcess;
 	result->base.base.Initialize = (InitializeFunc)
 		FAPOFXReverb_Initialize;
+	result->base.base.Reset = (ResetFunc)
+		FAPOFXReverb_Reset;
 	result->base.base.Process = (ProcessFunc)
 		FAPOFXReverb_Process;
 	result->base.Destructor = FAPOFXReverb_Free;
@@ -244,4 +506,46 @@ uint32_t FAPOFXCreateReverb(
 	return 0;
 }
 
+uint32_t FAPOFXCreateReverb(
+	FAPO **pEffect,
+	const void *pInitData,
+	uint32_t InitDataByteSize,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc,
+	uint8_t legacy
+) {
+	return FAPOFXReverb_INTERNAL_Create(
+		pEffect,
+		pInitData,
+		InitDataByteSize,
+		customMalloc,
+		customFree,
+		customRealloc,
+		legacy,
+		0
+	);
+}
+
+uint32_t FAPOFXCreateReverbLowCPU(
+	FAPO **pEffect,
+	const void *pInitData,
+	uint32_t InitDataByteSize,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc,
+	uint8_t legacy
+) {
+	return FAPOFXReverb_INTERNAL_Create(
+		pEffect,
+		pInitData,
+		InitDataByteSize,
+		customMalloc,
+		customFree,
+		customRealloc,
+		0,
+		1
+	);
+}
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
@@ -165,7 +165,8 @@ uint32_t FAudio_Release(FAudio *audio)
 		FAudio_StopEngine(audio);
 		audio->pFree(audio->decodeCache);
 		audio->pFree(audio->resampleCache);
-		audio->pFree(audio->effectChainCache);
+		audio->pFree(audio->effectChainCache[0]);
+		audio->pFree(audio->effectChainCache[1]);
 		LOG_MUTEX_DESTROY(audio, audio->sourceLock)
 		FAudio_PlatformDestroyMutex(audio->sourceLock);
 		LOG_MUTEX_DESTROY(audio, audio->submixLock)
@@ -511,6 +512,9 @@ uint32_t FAudio_CreateSourceVoice(
 
 	/* Default Levels */
 	(*ppSourceVoice)->volume = 1.0f;
+	(*ppSourceVoice)->rampVolume = 1.0f;
+	(*ppSourceVoice)->fadeVolume = 1.0f;
+	(*ppSourceVoice)->fadeTarget = 1.0f;
 	(*ppSourceVoice)->channelVolume = (float*) audio->pMalloc(
 		sizeof(float) * (*ppSourceVoice)->outputChannels
 	);
@@ -634,6 +638,9 @@ uint32_t FAudio_CreateSubmixVoice(
 
 	/* Default Levels */
 	(*ppSubmixVoice)->volume = 1.0f;
+	(*ppSubmixVoice)->rampVolume = 1.0f;
+	(*ppSubmixVoice)->fadeVolume = 1.0f;
+	(*ppSubmixVoice)->fadeTarget = 1.0f;
 	(*ppSubmixVoice)->channelVolume = (float*) audio->pMalloc(
 		sizeof(float) * (*ppSubmixVoice)->outputChannels
 	);
@@ -713,6 +720,9 @@ uint32_t FAudio_CreateMasteringVoice(
 
 	/* Default Levels */
 	(*ppMasteringVoice)->volume = 1.0f;
+	(*ppMasteringVoice)->rampVolume = 1.0f;
+	(*ppMasteringVoice)->fadeVolume = 1.0f;
+	(*ppMasteringVoice)->fadeTarget = 1.0f;
 
 	/* Master Properties */
 	(*ppMasteringVoice)->master.inputChannels = InputChannels;
@@ -1022,41 +1032,6 @@ void FAudio_GetProcessingQuantum(
 
 /* FAudioVoice Interface */
 
-static void FAudio_RecalcMixMatrix(FAudioVoice *voice, uint32_t sendIndex)
-{
-	uint32_t oChan, s, d;
-	FAudioVoice *out = voice->sends.pSends[sendIndex].pOutputVoice;
-	float volume, *matrix = voice->mixCoefficients[sendIndex];
-
-	if (voice->type == FAUDIO_VOICE_SUBMIX)
-	{
-		volume = 1.f;
-	}
-	else
-	{
-		volume = voice->volume;
-	}
-
-	if (out->type == FAUDIO_VOICE_MASTER)
-	{
-		oChan = out->master.inputChannels;
-	}
-	else
-	{
-		oChan = out->mix.inputChannels;
-	}
-
-	for (d = 0; d < oChan; d += 1)
-	{
-		for (s = 0; s < voice->outputChannels; s += 1)
-		{
-			matrix[d * voice->outputChannels + s] = volume *
-				voice->channelVolume[s] *
-				voice->sendCoefficients[sendIndex][d * voice->outputChannels + s];
-		}
-	}
-}
-
 void FAudioVoice_GetVoiceDetails(
 	FAudioVoice *voice,
 	FAudioVoiceDetails *pVoiceDetails
@@ -1136,10 +1111,12 @@ uint32_t FAudioVoice_SetOutputVoices(
 	for (i = 0; i < voice->sends.SendCount; i += 1)
 	{
 		voice->audio->pFree(voice->mixCoefficients[i]);
+		voice->audio->pFree(voice->rampCoefficients[i]);
 	}
 	if (voice->mixCoefficients != NULL)
 	{
 		voice->audio->pFree(voice->mixCoefficients);
+		voice->audio->pFree(voice->rampCoefficients);
 	}
 	if (voice->sendMix != NULL)
 	{
@@ -1181,7 +1158,9 @@ uint32_t FAudioVoice_SetOutputVoices(
 		/* No sends? Nothing to do... */
 		voice->sendCoefficients = NULL;
 		voice->mixCoefficients = NULL;
+		voice->rampCoefficients = NULL;
 		voice->sendMix = NULL;
+		voice->volumeRamp = 0;
 		FAudio_zero(&voice->sends, sizeof(FAudioVoiceSends));
 
 		FAudio_PlatformUnlockMutex(voice->volumeLock);
@@ -1210,6 +1189,9 @@ uint32_t FAudioVoice_SetOutputVoices(
 	voice->mixCoefficients = (float**) voice->audio->pMalloc(
 		sizeof(float*) * pSendList->SendCount
 	);
+	voice->rampCoefficients = (float**) voice->audio->pMalloc(
+		sizeof(float*) * pSendList->SendCount
+	);
 	voice->sendMix = (FAudioMixCallback*) voice->audio->pMalloc(
 		sizeof(FAudioMixCallback) * pSendList->SendCount
 	);
@@ -1230,6 +1212,9 @@ uint32_t FAudioVoice_SetOutputVoices(
 		voice->mixCoefficients[i] = (float*) voice->audio->pMalloc(
 			sizeof(float) * voice->outputChannels * outChannels
 		);
+		voice->rampCoefficients[i] = (float*) voice->audio->pMalloc(
+			sizeof(float) * voice->outputChannels * outChannels
+		);
 
 		FAudio_assert(voice->outputChannels > 0 && voice->outputChannels < 9);
 		FAudio_assert(outChannels > 0 && outChannels < 9);
@@ -1238,7 +1223,14 @@ uint32_t FAudioVoice_SetOutputVoices(
 			FAUDIO_INTERNAL_MATRIX_DEFAULTS[voice->outputChannels - 1][outChannels - 1],
 			voice->outputChannels * outChannels * sizeof(float)
 		);
-		FAudio_RecalcMixMatrix(voice, i);
+		FAudio_INTERNAL_RecalcMixMatrix(voice, i);
+
+		/* New sends start out at their levels, no ramp */
+		FAudio_memcpy(
+			voice->rampCoefficients[i],
+			voice->mixCoefficients[i],
+			voice->outputChannels * outChannels * sizeof(float)
+		);
 
 		if (voice->outputChannels == 1)
 		{
@@ -1324,6 +1316,7 @@ uint32_t FAudioVoice_SetOutputVoices(
 			);
 		}
 	}
+	voice->volumeRamp = 0;
 
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
@@ -1481,6 +1474,8 @@ uint32_t FAudioVoice_SetEffectChain(
 			{
 				voice->effects.inPlaceProcessing[i] = (pProps->Flags & FAPO_FLAG_INPLACE_SUPPORTED) == FAPO_FLAG_INPLACE_SUPPORTED;
 				voice->effects.inPlaceProcessing[i] &= (channelCount == voice->effects.desc[i].OutputChannels);
+				voice->effects.overwritesOutput[i] = (pProps->Flags & FAPO_FLAG_OVERWRITES_OUTPUT_EXT) == FAPO_FLAG_OVERWRITES_OUTPUT_EXT;
+				voice->effects.silenceStaysSilent[i] = (pProps->Flags & FAPO_FLAG_SILENCE_STAYS_SILENT_EXT) == FAPO_FLAG_SILENCE_STAYS_SILENT_EXT;
 				channelCount = voice->effects.desc[i].OutputChannels;
 
 				/* Fails if in-place processing is mandatory and
@@ -1578,6 +1573,9 @@ uint32_t FAudioVoice_SetEffectParameters(
 	uint32_t ParametersByteSize,
 	uint32_t OperationSet
 ) {
+	uint32_t slot, oldSize;
+	uint8_t *blocks;
+
 	LOG_API_ENTER(voice->audio)
 
 	if (OperationSet != FAUDIO_COMMIT_NOW && voice->audio->active)
@@ -1593,31 +1591,60 @@ uint32_t FAudioVoice_SetEffectParameters(
 		return 0;
 	}
 
-	if (voice->effects.parameters[EffectIndex] == NULL)
-	{
-		voice->effects.parameters[EffectIndex] = voice->audio->pMalloc(
-			ParametersByteSize
-		);
-		voice->effects.parameterSizes[EffectIndex] = ParametersByteSize;
-	}
-	FAudio_PlatformLockMutex(voice->effectLock);
-	LOG_MUTEX_LOCK(voice->audio, voice->effectLock)
+	/* The mixer reads the newest published block without locking, so the
+	 * effect lock is only needed when the blocks have to grow.
+	 */
+	slot = FAudio_INTERNAL_TripleBufferBeginWrite(
+		&voice->effects.parameterStates[EffectIndex]
+	);
 	if (voice->effects.parameterSizes[EffectIndex] < ParametersByteSize)
 	{
-		voice->effects.parameters[EffectIndex] = voice->audio->pRealloc(
-			voice->effects.parameters[EffectIndex],
-			ParametersByteSize
+		FAudio_PlatformLockMutex(voice->effectLock);
+		LOG_MUTEX_LOCK(voice->audio, voice->effectLock)
+		oldSize = voice->effects.parameterSizes[EffectIndex];
+		if (voice->effects.parameters[EffectIndex] == NULL)
+		{
+			voice->effects.parameters[EffectIndex] = voice->audio->pMalloc(
+				ParametersByteSize * 3
+			);
+		}
+		else
+		{
+			voice->effects.parameters[EffectIndex] = voice->audio->pRealloc(
+				voice->effects.parameters[EffectIndex],
+				ParametersByteSize * 3
+			);
+		}
+		blocks = (uint8_t*) voice->effects.parameters[EffectIndex];
+
+		/* Move the last two blocks out to the new size, since one of
+		 * them may have been published and not read yet
+		 */
+		FAudio_memmove(
+			blocks + (ParametersByteSize * 2),
+			blocks + (oldSize * 2),
+			oldSize
+		);
+		FAudio_memmove(
+			blocks + ParametersByteSize,
+			blocks + oldSize,
+			oldSize
 		);
 		voice->effects.parameterSizes[EffectIndex] = ParametersByteSize;
+		FAudio_PlatformUnlockMutex(voice->effectLock);
+		LOG_MUTEX_UNLOCK(voice->audio, voice->effectLock)
 	}
 	FAudio_memcpy(
-		voice->effects.parameters[EffectIndex],
+		(uint8_t*) voice->effects.parameters[EffectIndex] + (
+			voice->effects.parameterSizes[EffectIndex] *
+			slot
+		),
 		pParameters,
 		ParametersByteSize
 	);
-	voice->effects.parameterUpdates[EffectIndex] = 1;
-	FAudio_PlatformUnlockMutex(voice->effectLock);
-	LOG_MUTEX_UNLOCK(voice->audio, voice->effectLock)
+	FAudio_INTERNAL_TripleBufferEndWrite(
+		&voice->effects.parameterStates[EffectIndex]
+	);
 	LOG_API_EXIT(voice->audio)
 	return 0;
 }
@@ -1901,7 +1928,13 @@ uint32_t FAudioVoice_SetVolume(
 
 	for (i = 0; i < voice->sends.SendCount; i += 1)
 	{
-		FAudio_RecalcMixMatrix(voice, i);
+		FAudio_INTERNAL_RecalcMixMatrix(voice, i);
+	}
+
+	/* Submix and master volumes ramp on their own, see rampVolume */
+	if (voice->type == FAUDIO_VOICE_SOURCE)
+	{
+		voice->volumeRamp = 1;
 	}
 
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
@@ -1923,6 +1956,98 @@ void FAudioVoice_GetVolume(
 	LOG_API_EXIT(voice->audio)
 }
 
+uint32_t FAudioVoice_SetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float Volume,
+	uint32_t FadeMilliseconds,
+	uint32_t OperationSet
+) {
+	uint32_t i, sampleRate;
+
+	LOG_API_ENTER(voice->audio)
+
+	if (OperationSet != FAUDIO_COMMIT_NOW && voice->audio->active)
+	{
+		FAudio_OPERATIONSET_QueueSetFadeVolumeEXT(
+			voice,
+			Volume,
+			FadeMilliseconds,
+			OperationSet
+		);
+		LOG_API_EXIT(voice->audio)
+		return 0;
+	}
+
+	FAudio_PlatformLockMutex(voice->sendLock);
+	LOG_MUTEX_LOCK(voice->audio, voice->sendLock)
+
+	FAudio_PlatformLockMutex(voice->volumeLock);
+	LOG_MUTEX_LOCK(voice->audio, voice->volumeLock)
+
+	voice->fadeTarget = FAudio_clamp(
+		Volume,
+		-FAUDIO_MAX_VOLUME_LEVEL,
+		FAUDIO_MAX_VOLUME_LEVEL
+	);
+
+	/* The mixer counts the fade down by one quantum per pass. Without a
+	 * mastering voice nothing is mixed, so the voice's own rate will do.
+	 */
+	if (voice->audio->master != NULL)
+	{
+		sampleRate = voice->audio->master->master.inputSampleRate;
+	}
+	else if (voice->type == FAUDIO_VOICE_SOURCE)
+	{
+		sampleRate = voice->src.format->nSamplesPerSec;
+	}
+	else
+	{
+		sampleRate = voice->mix.inputSampleRate;
+	}
+	voice->fadeFrames = (uint32_t) (
+		(uint64_t) FadeMilliseconds *
+		sampleRate /
+		1000
+	);
+
+	/* No fade still ramps across the next quantum, like SetVolume */
+	if (voice->fadeFrames == 0)
+	{
+		voice->fadeVolume = voice->fadeTarget;
+		if (voice->type == FAUDIO_VOICE_SOURCE)
+		{
+			for (i = 0; i < voice->sends.SendCount; i += 1)
+			{
+				FAudio_INTERNAL_RecalcMixMatrix(voice, i);
+			}
+			voice->volumeRamp = 1;
+		}
+	}
+
+	FAudio_PlatformUnlockMutex(voice->volumeLock);
+	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
+
+	FAudio_PlatformUnlockMutex(voice->sendLock);
+	LOG_MUTEX_UNLOCK(voice->audio, voice->sendLock)
+
+	LOG_API_EXIT(voice->audio)
+	return 0;
+}
+
+void FAudioVoice_GetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float *pVolume
+) {
+	LOG_API_ENTER(voice->audio)
+	FAudio_PlatformLockMutex(voice->volumeLock);
+	LOG_MUTEX_LOCK(voice->audio, voice->volumeLock)
+	*pVolume = voice->fadeVolume;
+	FAudio_PlatformUnlockMutex(voice->volumeLock);
+	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
+	LOG_API_EXIT(voice->audio)
+}
+
 uint32_t FAudioVoice_SetChannelVolumes(
 	FAudioVoice *voice,
 	uint32_t Channels,
@@ -1977,8 +2102,9 @@ uint32_t FAudioVoice_SetChannelVolumes(
 
 	for (i = 0; i < voice->sends.SendCount; i += 1)
 	{
-		FAudio_RecalcMixMatrix(voice, i);
+		FAudio_INTERNAL_RecalcMixMatrix(voice, i);
 	}
+	voice->volumeRamp = 1;
 
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
@@ -2116,7 +2242,8 @@ uint32_t FAudioVoice_SetOutputMatrix(
 		sizeof(float) * SourceChannels * DestinationChannels
 	);
 
-	FAudio_RecalcMixMatrix(voice, i);
+	FAudio_INTERNAL_RecalcMixMatrix(voice, i);
+	voice->volumeRamp = 1;
 
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
@@ -2295,10 +2422,12 @@ void FAudioVoice_DestroyVoice(FAudioVoice *voice)
 		for (i = 0; i < voice->sends.SendCount; i += 1)
 		{
 			voice->audio->pFree(voice->mixCoefficients[i]);
+			voice->audio->pFree(voice->rampCoefficients[i]);
 		}
 		if (voice->mixCoefficients != NULL)
 		{
 			voice->audio->pFree(voice->mixCoefficients);
+			voice->audio->pFree(voice->rampCoefficients);
 		}
 		if (voice->sendMix != NULL)
 		{
@@ -2397,6 +2526,19 @@ uint32_t FAudioSourceVoice_Start(
 	FAudio_assert(voice->type == FAUDIO_VOICE_SOURCE);
 
 	FAudio_assert(Flags == 0);
+
+	/* A stopped voice was silent, so the first quantum shouldn't ramp from
+	 * whatever it last played
+	 */
+	if (voice->src.active == 0)
+	{
+		FAudio_PlatformLockMutex(voice->volumeLock);
+		LOG_MUTEX_LOCK(voice->audio, voice->volumeLock)
+		voice->volumeSnap = 1;
+		FAudio_PlatformUnlockMutex(voice->volumeLock);
+		LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
+	}
+
 	voice->src.active = 1;
 	LOG_API_EXIT(voice->audio)
 	return 0;
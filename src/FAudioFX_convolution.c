@@ -0,0 +1,1284 @@
+/* FAudio - XAudio Reimplementation for FNA
+ *
+ * Copyright (c) 2011-2022 Ethan Lee, Luigi Auriemma, and the MonoGame Team
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software in a
+ * product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ * Ethan "flibitijibibo" Lee <flibitijibibo@flibitijibibo.com>
+ *
+ */
+
+#include "FAudioFX.h"
+#include "FAudio_internal.h"
+
+/* The impulse response is split into three parts, so that the effect has no
+ * latency and long rooms don't need huge FFTs on every quantum:
+ *
+ * - The head, the first CONV_HEAD_SIZE frames, is a plain FIR filter.
+ * - Stage 0 is a uniformly partitioned overlap-save convolution with
+ *   CONV_HEAD_SIZE blocks. In uniform mode, it covers the rest of the IR.
+ * - In non-uniform mode, stage 0 stops at 2 * CONV_TAIL_SIZE and stage 1 covers
+ *   the rest with CONV_TAIL_SIZE blocks. Its output isn't needed until one
+ *   whole tail block after its input is complete, which is what lets the
+ *   worker threads compute it in the background.
+ *
+ * Each stage keeps the spectra of its past input blocks (the frequency-domain
+ * delay line) and multiplies them against the spectra of the IR partitions, so
+ * an input block is only transformed once no matter how long the IR is.
+ */
+
+#define CONV_HEAD_SIZE 128
+#define CONV_TAIL_SIZE 2048
+#define CONV_MAX_STAGES 2
+
+/* Utility: Real FFT */
+
+/* Real transforms of 2 * size samples, done as a complex transform of size
+ * points plus a split step. Spectra are stored as separate real and imaginary
+ * arrays of size + 1 bins. The inverse is not normalized.
+ */
+typedef struct ConvFFT
+{
+	uint32_t size;
+	uint32_t *bitrev;
+	float *twiddle_cos;	/* size / 2 */
+	float *twiddle_sin;
+	float *split_cos;	/* size + 1 */
+	float *split_sin;
+} ConvFFT;
+
+static uint32_t ConvFFT_Create(
+	ConvFFT *fft,
+	uint32_t size,
+	FAudioMallocFunc pMalloc
+) {
+	uint32_t i, bits, log2size;
+	const double PI = 3.14159265358979323846;
+
+	fft->size = size;
+	fft->bitrev = (uint32_t*) pMalloc(sizeof(uint32_t) * size);
+	fft->twiddle_cos = (float*) pMalloc(
+		sizeof(float) * (size + (size + 1) * 2)
+	);
+	if (fft->bitrev == NULL || fft->twiddle_cos == NULL)
+	{
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	fft->twiddle_sin = fft->twiddle_cos + (size / 2);
+	fft->split_cos = fft->twiddle_sin + (size / 2);
+	fft->split_sin = fft->split_cos + (size + 1);
+
+	for (log2size = 0; (1u << log2size) < size; log2size += 1);
+	for (i = 0; i < size; i += 1)
+	{
+		uint32_t j = 0;
+		for (bits = 0; bits < log2size; bits += 1)
+		{
+			j |= ((i >> bits) & 1) << (log2size - 1 - bits);
+		}
+		fft->bitrev[i] = j;
+	}
+	for (i = 0; i < size / 2; i += 1)
+	{
+		fft->twiddle_cos[i] = (float) FAudio_cos(2.0 * PI * i / size);
+		fft->twiddle_sin[i] = (float) FAudio_sin(2.0 * PI * i / size);
+	}
+	for (i = 0; i <= size; i += 1)
+	{
+		fft->split_cos[i] = (float) FAudio_cos(PI * i / size);
+		fft->split_sin[i] = (float) FAudio_sin(PI * i / size);
+	}
+	return 0;
+}
+
+static void ConvFFT_Destroy(ConvFFT *fft, FAudioFreeFunc pFree)
+{
+	if (fft->bitrev != NULL)
+	{
+		pFree(fft->bitrev);
+	}
+	if (fft->twiddle_cos != NULL)
+	{
+		pFree(fft->twiddle_cos);
+	}
+	FAudio_zero(fft, sizeof(ConvFFT));
+}
+
+/* In-place radix-2 butterflies on data that's already in bit-reversed order.
+ * sign is -1.0f for the forward transform and 1.0f for the inverse.
+ */
+static void ConvFFT_Butterflies(
+	const ConvFFT *fft,
+	float *re,
+	float *im,
+	float sign
+) {
+	uint32_t len, half, step, i, j, a, b;
+	float wr, wi, tr, ti;
+
+	for (len = 2; len <= fft->size; len <<= 1)
+	{
+		half = len / 2;
+		step = fft->size / len;
+		for (j = 0; j < half; j += 1)
+		{
+			wr = fft->twiddle_cos[j * step];
+			wi = sign * fft->twiddle_sin[j * step];
+			for (i = j; i < fft->size; i += len)
+			{
+				a = i;
+				b = i + half;
+				tr = re[b] * wr - im[b] * wi;
+				ti = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+/* samples: 2 * size, re/im: size + 1, scratch: 2 * size */
+static void ConvFFT_Forward(
+	const ConvFFT *fft,
+	const float *samples,
+	float *re,
+	float *im,
+	float *scratch
+) {
+	uint32_t i, a, b;
+	float er, ei, odd_r, odd_i, c, s;
+	float *zr = scratch;
+	float *zi = scratch + fft->size;
+
+	/* Even samples are the real part, odd samples are the imaginary part */
+	for (i = 0; i < fft->size; i += 1)
+	{
+		zr[fft->bitrev[i]] = samples[i * 2];
+		zi[fft->bitrev[i]] = samples[i * 2 + 1];
+	}
+	ConvFFT_Butterflies(fft, zr, zi, -1.0f);
+
+	/* Split the even and odd halves back apart */
+	for (i = 0; i <= fft->size; i += 1)
+	{
+		a = (i == fft->size) ? 0 : i;
+		b = (i == 0) ? 0 : (fft->size - i);
+		er = 0.5f * (zr[a] + zr[b]);
+		ei = 0.5f * (zi[a] - zi[b]);
+		odd_r = 0.5f * (zi[a] + zi[b]);
+		odd_i = -0.5f * (zr[a] - zr[b]);
+		c = fft->split_cos[i];
+		s = fft->split_sin[i];
+		re[i] = er + c * odd_r + s * odd_i;
+		im[i] = ei + c * odd_i - s * odd_r;
+	}
+}
+
+/* re/im: size + 1, samples: 2 * size, scratch: 2 * size */
+static void ConvFFT_Inverse(
+	const ConvFFT *fft,
+	const float *re,
+	const float *im,
+	float *samples,
+	float *scratch
+) {
+	uint32_t i, b;
+	float er, ei, wr, wi, odd_r, odd_i, c, s;
+	float *zr = scratch;
+	float *zi = scratch + fft->size;
+
+	/* Merge the halves into one complex spectrum */
+	for (i = 0; i < fft->size; i += 1)
+	{
+		b = fft->size - i;
+		er = 0.5f * (re[i] + re[b]);
+		ei = 0.5f * (im[i] - im[b]);
+		wr = 0.5f * (re[i] - re[b]);
+		wi = 0.5f * (im[i] + im[b]);
+		c = fft->split_cos[i];
+		s = fft->split_sin[i];
+		odd_r = wr * c - wi * s;
+		odd_i = wr * s + wi * c;
+		zr[fft->bitrev[i]] = er - odd_i;
+		zi[fft->bitrev[i]] = ei + odd_r;
+	}
+	ConvFFT_Butterflies(fft, zr, zi, 1.0f);
+
+	for (i = 0; i < fft->size; i += 1)
+	{
+		samples[i * 2] = zr[i];
+		samples[i * 2 + 1] = zi[i];
+	}
+}
+
+/* Convolution Stages */
+
+typedef struct ConvStage
+{
+	uint32_t block_size;		/* The FFT is 2 * block_size samples */
+	uint32_t bins;			/* block_size + 1 */
+	uint32_t offset;		/* First IR frame covered by the stage */
+	uint32_t partition_count;
+	ConvFFT fft;
+
+	/* [ir_channel][partition][re, im][bins], scaled by 1 / block_size */
+	float *ir_spectra;
+
+	/* [channel][partition][re, im][bins], allocated by LockForProcess */
+	float *fdl;
+	uint32_t fdl_index;		/* Newest input spectrum */
+} ConvStage;
+
+static uint32_t ConvStage_Create(
+	ConvStage *stage,
+	const FAudioFXImpulseResponseEXT *ir,
+	uint32_t block_size,
+	uint32_t offset,
+	uint32_t end,
+	FAudioMallocFunc pMalloc,
+	FAudioFreeFunc pFree
+) {
+	uint32_t c, p, i, start, len;
+	uint32_t stride;
+	float *window, *scratch, *spectrum;
+	const float scale = 1.0f / block_size;
+
+	stage->block_size = block_size;
+	stage->bins = block_size + 1;
+	stage->offset = offset;
+	stage->partition_count = (end - offset + block_size - 1) / block_size;
+	stage->fdl = NULL;
+	stage->fdl_index = 0;
+	stride = stage->bins * 2;
+
+	if (ConvFFT_Create(&stage->fft, block_size, pMalloc) != 0)
+	{
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	stage->ir_spectra = (float*) pMalloc(
+		sizeof(float) * stride * stage->partition_count * ir->ChannelCount
+	);
+	window = (float*) pMalloc(sizeof(float) * block_size * 4);
+	if (stage->ir_spectra == NULL || window == NULL)
+	{
+		if (window != NULL)
+		{
+			pFree(window);
+		}
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	scratch = window + (block_size * 2);
+
+	/* Each partition is zero-padded to the FFT size, so overlap-save only
+	 * keeps the half of the result that didn't wrap around
+	 */
+	spectrum = stage->ir_spectra;
+	for (c = 0; c < ir->ChannelCount; c += 1)
+	for (p = 0; p < stage->partition_count; p += 1, spectrum += stride)
+	{
+		start = offset + (p * block_size);
+		len = FAudio_min(block_size, end - start);
+		FAudio_zero(window, sizeof(float) * block_size * 2);
+		for (i = 0; i < len; i += 1)
+		{
+			window[i] = ir->pSamples[
+				(start + i) * ir->ChannelCount + c
+			] * scale;
+		}
+		ConvFFT_Forward(
+			&stage->fft,
+			window,
+			spectrum,
+			spectrum + stage->bins,
+			scratch
+		);
+	}
+
+	pFree(window);
+	return 0;
+}
+
+static void ConvStage_Destroy(ConvStage *stage, FAudioFreeFunc pFree)
+{
+	ConvFFT_Destroy(&stage->fft, pFree);
+	if (stage->ir_spectra != NULL)
+	{
+		pFree(stage->ir_spectra);
+		stage->ir_spectra = NULL;
+	}
+	if (stage->fdl != NULL)
+	{
+		pFree(stage->fdl);
+		stage->fdl = NULL;
+	}
+}
+
+/* Multiplies partitions [first, last) of one IR channel against the matching
+ * input spectra and transforms the sum back. out gets the newest block_size
+ * samples of the result. acc: 2 * bins, time and scratch: 2 * block_size.
+ */
+static void ConvStage_Convolve(
+	const ConvStage *stage,
+	const float *ir_spectra,
+	const float *fdl,
+	uint32_t newest,
+	uint32_t first,
+	uint32_t last,
+	float *acc,
+	float *time,
+	float *scratch,
+	float *out
+) {
+	uint32_t p, i, slot;
+	const uint32_t bins = stage->bins;
+	const uint32_t stride = bins * 2;
+	const float *xr, *xi, *hr, *hi;
+	float *ar = acc;
+	float *ai = acc + bins;
+
+	FAudio_zero(acc, sizeof(float) * stride);
+	for (p = first; p < last; p += 1)
+	{
+		slot = (newest + stage->partition_count - p) % stage->partition_count;
+		xr = fdl + (slot * stride);
+		xi = xr + bins;
+		hr = ir_spectra + (p * stride);
+		hi = hr + bins;
+		for (i = 0; i < bins; i += 1)
+		{
+			ar[i] += xr[i] * hr[i] - xi[i] * hi[i];
+			ai[i] += xr[i] * hi[i] + xi[i] * hr[i];
+		}
+	}
+
+	ConvFFT_Inverse(&stage->fft, ar, ai, time, scratch);
+	FAudio_memcpy(
+		out,
+		time + stage->block_size,
+		sizeof(float) * stage->block_size
+	);
+}
+
+/* Convolution Reverb FAPO Implementation */
+
+const FAudioGUID FAudioFX_CLSID_ConvolutionReverbEXT =
+{
+	0x3F8A5C21,
+	0x7B04,
+	0x4E6D,
+	{
+		0x9A,
+		0x51,
+		0x2C,
+		0xD7,
+		0x0E,
+		0x86,
+		0xB3,
+		0x4F
+	}
+};
+
+static FAPORegistrationProperties ConvolutionReverbProperties =
+{
+	/* .clsid = */ {0},
+	/* .FriendlyName = */
+	{
+		'C', 'o', 'n', 'v', 'o', 'l', 'u', 't', 'i', 'o', 'n',
+		'R', 'e', 'v', 'e', 'r', 'b', '\0'
+	},
+	/*.CopyrightInfo = */
+	{
+		'C', 'o', 'p', 'y', 'r', 'i', 'g', 'h', 't', ' ', '(', 'c', ')',
+		'E', 't', 'h', 'a', 'n', ' ', 'L', 'e', 'e', '\0'
+	},
+	/*.MajorVersion = */ 0,
+	/*.MinorVersion = */ 0,
+	/*.Flags = */ (
+		FAPO_FLAG_CHANNELS_MUST_MATCH |
+		FAPO_FLAG_FRAMERATE_MUST_MATCH |
+		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
+		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
+		FAPO_FLAG_INPLACE_SUPPORTED
+	),
+	/*.MinInputBufferCount = */ 1,
+	/*.MaxInputBufferCount = */ 1,
+	/*.MinOutputBufferCount = */ 1,
+	/*.MaxOutputBufferCount = */ 1
+};
+
+static inline int8_t IsFloatFormat(const FAudioWaveFormatEx *format)
+{
+	if (format->wFormatTag == FAUDIO_FORMAT_IEEE_FLOAT)
+	{
+		/* Plain ol' WaveFormatEx */
+		return 1;
+	}
+
+	if (format->wFormatTag == FAUDIO_FORMAT_EXTENSIBLE)
+	{
+		/* WaveFormatExtensible, match GUID */
+		#define MAKE_SUBFORMAT_GUID(guid, fmt) \
+			static FAudioGUID KSDATAFORMAT_SUBTYPE_##guid = \
+			{ \
+				(uint16_t) (fmt), 0x0000, 0x0010, \
+				{ \
+					0x80, 0x00, 0x00, 0xaa, \
+					0x00, 0x38, 0x9b, 0x71 \
+				} \
+			}
+		MAKE_SUBFORMAT_GUID(IEEE_FLOAT, 3);
+		#undef MAKE_SUBFORMAT_GUID
+
+		if (FAudio_memcmp(
+			&((FAudioWaveFormatExtensible*) format)->SubFormat,
+			&KSDATAFORMAT_SUBTYPE_IEEE_FLOAT,
+			sizeof(FAudioGUID)
+		) == 0) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+struct FAudioFXConvolutionReverb;
+
+typedef struct ConvWorker
+{
+	struct FAudioFXConvolutionReverb *fapo;
+	FAudioThread thread;
+	FAudioSemaphore wake;
+	FAudioSemaphore done;
+	uint8_t quit;
+
+	/* Tail partitions handled by this worker */
+	uint32_t first;
+	uint32_t last;
+
+	float *acc;
+	float *time;
+	float *scratch;
+	float *result;		/* [channel][CONV_TAIL_SIZE] */
+} ConvWorker;
+
+typedef struct FAudioFXConvolutionReverb
+{
+	FAPOBase base;
+
+	/* Impulse response, set at creation */
+	uint32_t ir_channels;
+	float *head;			/* [ir_channel][CONV_HEAD_SIZE], reversed */
+	uint32_t stage_count;
+	ConvStage stage[CONV_MAX_STAGES];
+	uint32_t worker_request;
+
+	/* Stream state, allocated by LockForProcess */
+	uint16_t channels;
+	uint16_t blockAlign;
+	uint32_t position;
+	uint32_t history_mask;
+	float *history;			/* [channel][history_mask + 1] */
+	uint32_t ring_mask;
+	float *ring;			/* [channel][ring_mask + 1] */
+	float *acc;
+	float *time;
+	float *scratch;
+	float *block;			/* One stage output, or the FIR input */
+	float *wet;			/* [channel][CONV_HEAD_SIZE] */
+
+	/* Tail workers, only used by the non-uniform mode */
+	ConvWorker *workers;
+	uint32_t worker_count;
+	uint8_t tail_pending;
+	uint32_t tail_newest;
+	uint32_t tail_position;
+} FAudioFXConvolutionReverb;
+
+static inline const float* ConvIRChannel(
+	FAudioFXConvolutionReverb *fapo,
+	const ConvStage *stage,
+	uint16_t channel
+) {
+	return stage->ir_spectra + (
+		(fapo->ir_channels == 1 ? 0 : channel) *
+		stage->partition_count *
+		stage->bins * 2
+	);
+}
+
+static void ConvWorker_Run(ConvWorker *worker)
+{
+	FAudioFXConvolutionReverb *fapo = worker->fapo;
+	const ConvStage *stage = &fapo->stage[CONV_MAX_STAGES - 1];
+	uint16_t c;
+
+	for (c = 0; c < fapo->channels; c += 1)
+	{
+		ConvStage_Convolve(
+			stage,
+			ConvIRChannel(fapo, stage, c),
+			stage->fdl + (c * stage->partition_count * stage->bins * 2),
+			fapo->tail_newest,
+			worker->first,
+			worker->last,
+			worker->acc,
+			worker->time,
+			worker->scratch,
+			worker->result + (c * CONV_TAIL_SIZE)
+		);
+	}
+}
+
+static int32_t FAUDIOCALL ConvWorker_Thread(void *workerPtr)
+{
+	ConvWorker *worker = (ConvWorker*) workerPtr;
+
+	FAudio_PlatformWaitSemaphore(worker->wake, FAUDIO_WAIT_INFINITE);
+	while (!worker->quit)
+	{
+		ConvWorker_Run(worker);
+		FAudio_PlatformPostSemaphore(worker->done);
+		FAudio_PlatformWaitSemaphore(worker->wake, FAUDIO_WAIT_INFINITE);
+	}
+	return 0;
+}
+
+static void FAudioFXConvolutionReverb_INTERNAL_CreateWorkers(
+	FAudioFXConvolutionReverb *fapo
+) {
+	ConvWorker *worker;
+	uint32_t i, count;
+	const ConvStage *stage = &fapo->stage[CONV_MAX_STAGES - 1];
+	const uint32_t floats = (
+		(stage->bins * 2) +
+		(CONV_TAIL_SIZE * 4) +
+		(CONV_TAIL_SIZE * fapo->channels)
+	);
+
+	count = FAudio_min(fapo->worker_request, stage->partition_count);
+	fapo->workers = (ConvWorker*) fapo->base.pMalloc(
+		sizeof(ConvWorker) * count
+	);
+	if (fapo->workers == NULL)
+	{
+		return;
+	}
+	for (i = 0; i < count; i += 1)
+	{
+		worker = &fapo->workers[i];
+		FAudio_zero(worker, sizeof(ConvWorker));
+		worker->fapo = fapo;
+		worker->acc = (float*) fapo->base.pMalloc(sizeof(float) * floats);
+		if (worker->acc == NULL)
+		{
+			break;
+		}
+		worker->time = worker->acc + (stage->bins * 2);
+		worker->scratch = worker->time + (CONV_TAIL_SIZE * 2);
+		worker->result = worker->scratch + (CONV_TAIL_SIZE * 2);
+		worker->wake = FAudio_PlatformCreateSemaphore(0);
+		worker->done = FAudio_PlatformCreateSemaphore(0);
+		worker->thread = FAudio_PlatformCreateThread(
+			ConvWorker_Thread,
+			"FAudioConvolution",
+			worker
+		);
+		if (worker->thread == NULL)
+		{
+			/* Run with whatever we managed to start */
+			FAudio_PlatformDestroySemaphore(worker->wake);
+			FAudio_PlatformDestroySemaphore(worker->done);
+			fapo->base.pFree(worker->acc);
+			break;
+		}
+		fapo->worker_count += 1;
+	}
+
+	/* Hand out the partitions now, they never change while locked */
+	for (i = 0; i < fapo->worker_count; i += 1)
+	{
+		worker = &fapo->workers[i];
+		worker->first = (stage->partition_count * i) / fapo->worker_count;
+		worker->last = (stage->partition_count * (i + 1)) / fapo->worker_count;
+	}
+	if (fapo->worker_count == 0)
+	{
+		fapo->base.pFree(fapo->workers);
+		fapo->workers = NULL;
+	}
+}
+
+/* Adds one block of stage output to the output ring, starting at pos */
+static inline void FAudioFXConvolutionReverb_INTERNAL_Accumulate(
+	FAudioFXConvolutionReverb *fapo,
+	uint16_t channel,
+	uint32_t pos,
+	const float *block,
+	uint32_t count
+) {
+	uint32_t i;
+	float *ring = fapo->ring + (channel * (fapo->ring_mask + 1));
+	for (i = 0; i < count; i += 1)
+	{
+		ring[(pos + i) & fapo->ring_mask] += block[i];
+	}
+}
+
+/* Waits for the tail that's due at the current position */
+static void FAudioFXConvolutionReverb_INTERNAL_JoinTail(
+	FAudioFXConvolutionReverb *fapo
+) {
+	uint32_t i;
+	uint16_t c;
+
+	if (!fapo->tail_pending)
+	{
+		return;
+	}
+	for (i = 0; i < fapo->worker_count; i += 1)
+	{
+		FAudio_PlatformWaitSemaphore(
+			fapo->workers[i].done,
+			FAUDIO_WAIT_INFINITE
+		);
+	}
+	for (i = 0; i < fapo->worker_count; i += 1)
+	for (c = 0; c < fapo->channels; c += 1)
+	{
+		FAudioFXConvolutionReverb_INTERNAL_Accumulate(
+			fapo,
+			c,
+			fapo->tail_position,
+			fapo->workers[i].result + (c * CONV_TAIL_SIZE),
+			CONV_TAIL_SIZE
+		);
+	}
+	fapo->tail_pending = 0;
+}
+
+/* Transforms the input block that just finished and queues its output */
+static void FAudioFXConvolutionReverb_INTERNAL_RunStage(
+	FAudioFXConvolutionReverb *fapo,
+	uint32_t index
+) {
+	uint32_t i;
+	uint16_t c;
+	ConvStage *stage = &fapo->stage[index];
+	const uint32_t size = stage->block_size;
+	const uint32_t stride = stage->bins * 2;
+	const uint32_t history_size = fapo->history_mask + 1;
+	const uint32_t start = fapo->position - (size * 2);
+
+	/* The output of the finished block starts one partition later */
+	const uint32_t pos = fapo->position + (stage->offset - size);
+	const uint8_t threaded = (
+		index == CONV_MAX_STAGES - 1 &&
+		fapo->worker_count > 0
+	);
+
+	/* The workers are still reading the delay line we're about to write */
+	if (threaded)
+	{
+		FAudioFXConvolutionReverb_INTERNAL_JoinTail(fapo);
+	}
+
+	stage->fdl_index = (stage->fdl_index + 1) % stage->partition_count;
+	for (c = 0; c < fapo->channels; c += 1)
+	{
+		const float *history = fapo->history + (c * history_size);
+		float *spectrum = stage->fdl + (
+			((c * stage->partition_count) + stage->fdl_index) * stride
+		);
+		for (i = 0; i < size * 2; i += 1)
+		{
+			fapo->time[i] = history[(start + i) & fapo->history_mask];
+		}
+		ConvFFT_Forward(
+			&stage->fft,
+			fapo->time,
+			spectrum,
+			spectrum + stage->bins,
+			fapo->scratch
+		);
+	}
+
+	if (threaded)
+	{
+		/* Not needed until the next tail block, let the workers have it */
+		fapo->tail_newest = stage->fdl_index;
+		fapo->tail_position = pos;
+		fapo->tail_pending = 1;
+		for (i = 0; i < fapo->worker_count; i += 1)
+		{
+			FAudio_PlatformPostSemaphore(fapo->workers[i].wake);
+		}
+		return;
+	}
+
+	for (c = 0; c < fapo->channels; c += 1)
+	{
+		ConvStage_Convolve(
+			stage,
+			ConvIRChannel(fapo, stage, c),
+			stage->fdl + (c * stage->partition_count * stride),
+			stage->fdl_index,
+			0,
+			stage->partition_count,
+			fapo->acc,
+			fapo->time,
+			fapo->scratch,
+			fapo->block
+		);
+		FAudioFXConvolutionReverb_INTERNAL_Accumulate(
+			fapo,
+			c,
+			pos,
+			fapo->block,
+			size
+		);
+	}
+}
+
+static float FAudioFXConvolutionReverb_INTERNAL_Process(
+	FAudioFXConvolutionReverb *fapo,
+	const float *in,
+	float *out,
+	uint32_t frames,
+	float wet_gain,
+	float dry_gain
+) {
+	uint32_t i, j, n, s, start;
+	uint16_t c;
+	float *history, *ring, *wet;
+	const float *head;
+	float sample, squared_sum = 0.0f;
+	const uint32_t history_size = fapo->history_mask + 1;
+	const uint32_t ring_size = fapo->ring_mask + 1;
+
+	while (frames > 0)
+	{
+		/* Stop at every head block, that's when the stages run */
+		n = CONV_HEAD_SIZE - (fapo->position & (CONV_HEAD_SIZE - 1));
+		n = FAudio_min(n, frames);
+
+		/* Consume all the input first, for in-place processing */
+		for (c = 0; c < fapo->channels; c += 1)
+		{
+			history = fapo->history + (c * history_size);
+			for (i = 0; i < n; i += 1)
+			{
+				history[(fapo->position + i) & fapo->history_mask] =
+					in[i * fapo->channels + c];
+			}
+		}
+
+		for (c = 0; c < fapo->channels; c += 1)
+		{
+			history = fapo->history + (c * history_size);
+			ring = fapo->ring + (c * ring_size);
+			wet = fapo->wet + (c * CONV_HEAD_SIZE);
+			head = fapo->head + (
+				(fapo->ir_channels == 1 ? 0 : c) * CONV_HEAD_SIZE
+			);
+
+			/* Linearize the head's input so the FIR doesn't wrap */
+			start = fapo->position - (CONV_HEAD_SIZE - 1);
+			for (i = 0; i < n + CONV_HEAD_SIZE - 1; i += 1)
+			{
+				fapo->block[i] = history[(start + i) & fapo->history_mask];
+			}
+			for (i = 0; i < n; i += 1)
+			{
+				sample = 0.0f;
+				for (j = 0; j < CONV_HEAD_SIZE; j += 1)
+				{
+					sample += head[j] * fapo->block[i + j];
+				}
+				s = (fapo->position + i) & fapo->ring_mask;
+				wet[i] = sample + ring[s];
+				ring[s] = 0.0f;
+			}
+			for (i = 0; i < n; i += 1)
+			{
+				sample = (
+					fapo->block[i + CONV_HEAD_SIZE - 1] * dry_gain +
+					wet[i] * wet_gain
+				);
+				out[i * fapo->channels + c] = sample;
+				squared_sum += sample * sample;
+			}
+		}
+
+		in += n * fapo->channels;
+		out += n * fapo->channels;
+		frames -= n;
+		fapo->position += n;
+
+		for (s = 0; s < fapo->stage_count; s += 1)
+		{
+			if ((fapo->position & (fapo->stage[s].block_size - 1)) == 0)
+			{
+				FAudioFXConvolutionReverb_INTERNAL_RunStage(fapo, s);
+			}
+		}
+	}
+
+	return squared_sum;
+}
+
+static void FAudioFXConvolutionReverb_INTERNAL_Unlock(
+	FAudioFXConvolutionReverb *fapo
+) {
+	ConvWorker *worker;
+	uint32_t i;
+
+	FAudioFXConvolutionReverb_INTERNAL_JoinTail(fapo);
+	for (i = 0; i < fapo->worker_count; i += 1)
+	{
+		worker = &fapo->workers[i];
+		worker->quit = 1;
+		FAudio_PlatformPostSemaphore(worker->wake);
+		FAudio_PlatformWaitThread(worker->thread, NULL);
+		FAudio_PlatformDestroySemaphore(worker->wake);
+		FAudio_PlatformDestroySemaphore(worker->done);
+		fapo->base.pFree(worker->acc);
+	}
+	if (fapo->workers != NULL)
+	{
+		fapo->base.pFree(fapo->workers);
+		fapo->workers = NULL;
+	}
+	fapo->worker_count = 0;
+
+	for (i = 0; i < fapo->stage_count; i += 1)
+	{
+		if (fapo->stage[i].fdl != NULL)
+		{
+			fapo->base.pFree(fapo->stage[i].fdl);
+			fapo->stage[i].fdl = NULL;
+		}
+	}
+	if (fapo->history != NULL)
+	{
+		fapo->base.pFree(fapo->history);
+		fapo->history = NULL;
+	}
+	fapo->ring = NULL;
+}
+
+static void FAudioFXConvolutionReverb_INTERNAL_Clear(
+	FAudioFXConvolutionReverb *fapo
+) {
+	uint32_t i;
+
+	FAudioFXConvolutionReverb_INTERNAL_JoinTail(fapo);
+	fapo->position = 0;
+	FAudio_zero(
+		fapo->history,
+		sizeof(float) * fapo->channels * (fapo->history_mask + 1)
+	);
+	FAudio_zero(
+		fapo->ring,
+		sizeof(float) * fapo->channels * (fapo->ring_mask + 1)
+	);
+	for (i = 0; i < fapo->stage_count; i += 1)
+	{
+		FAudio_zero(
+			fapo->stage[i].fdl,
+			sizeof(float) * fapo->channels *
+				fapo->stage[i].partition_count *
+				fapo->stage[i].bins * 2
+		);
+		fapo->stage[i].fdl_index = 0;
+	}
+}
+
+uint32_t FAudioFXConvolutionReverb_LockForProcess(
+	FAudioFXConvolutionReverb *fapo,
+	uint32_t InputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pInputLockedParameters,
+	uint32_t OutputLockedParameterCount,
+	const FAPOLockForProcessBufferParameters *pOutputLockedParameters
+) {
+	uint32_t i, max_block, floats;
+	uint32_t result;
+
+	/* Convolution specific validation */
+	if (!IsFloatFormat(pInputLockedParameters->pFormat))
+	{
+		return FAPO_E_FORMAT_UNSUPPORTED;
+	}
+	if (	fapo->ir_channels != 1 &&
+		fapo->ir_channels != pInputLockedParameters->pFormat->nChannels	)
+	{
+		return FAPO_E_FORMAT_UNSUPPORTED;
+	}
+
+	/* Call parent to do basic validation */
+	result = FAPOBase_LockForProcess(
+		&fapo->base,
+		InputLockedParameterCount,
+		pInputLockedParameters,
+		OutputLockedParameterCount,
+		pOutputLockedParameters
+	);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	/* Save the things we care about */
+	fapo->channels = pInputLockedParameters->pFormat->nChannels;
+	fapo->blockAlign = pInputLockedParameters->pFormat->nBlockAlign;
+
+	/* Both rings need two blocks of the largest stage, plus the head */
+	max_block = CONV_HEAD_SIZE;
+	for (i = 0; i < fapo->stage_count; i += 1)
+	{
+		max_block = FAudio_max(max_block, fapo->stage[i].block_size);
+	}
+	fapo->history_mask = (max_block * 4) - 1;
+	fapo->ring_mask = (max_block * 4) - 1;
+
+	floats = (
+		(fapo->history_mask + 1) * fapo->channels +	/* history */
+		(fapo->ring_mask + 1) * fapo->channels +	/* ring */
+		(max_block + 1) * 2 +				/* acc */
+		max_block * 2 +					/* time */
+		max_block * 2 +					/* scratch */
+		FAudio_max(max_block, CONV_HEAD_SIZE * 2) +	/* block */
+		CONV_HEAD_SIZE * fapo->channels			/* wet */
+	);
+	fapo->history = (float*) fapo->base.pMalloc(sizeof(float) * floats);
+	if (fapo->history == NULL)
+	{
+		FAPOBase_UnlockForProcess(&fapo->base);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	fapo->ring = fapo->history + (fapo->history_mask + 1) * fapo->channels;
+	fapo->acc = fapo->ring + (fapo->ring_mask + 1) * fapo->channels;
+	fapo->time = fapo->acc + (max_block + 1) * 2;
+	fapo->scratch = fapo->time + max_block * 2;
+	fapo->block = fapo->scratch + max_block * 2;
+	fapo->wet = fapo->block + FAudio_max(max_block, CONV_HEAD_SIZE * 2);
+
+	for (i = 0; i < fapo->stage_count; i += 1)
+	{
+		fapo->stage[i].fdl = (float*) fapo->base.pMalloc(
+			sizeof(float) * fapo->channels *
+				fapo->stage[i].partition_count *
+				fapo->stage[i].bins * 2
+		);
+		if (fapo->stage[i].fdl == NULL)
+		{
+			FAudioFXConvolutionReverb_INTERNAL_Unlock(fapo);
+			FAPOBase_UnlockForProcess(&fapo->base);
+			return FAUDIO_E_OUT_OF_MEMORY;
+		}
+	}
+	FAudioFXConvolutionReverb_INTERNAL_Clear(fapo);
+
+	/* If the threads can't start, the tail just runs on this thread */
+	if (fapo->stage_count == CONV_MAX_STAGES && fapo->worker_request > 0)
+	{
+		FAudioFXConvolutionReverb_INTERNAL_CreateWorkers(fapo);
+	}
+
+	return 0;
+}
+
+void FAudioFXConvolutionReverb_UnlockForProcess(
+	FAudioFXConvolutionReverb *fapo
+) {
+	FAudioFXConvolutionReverb_INTERNAL_Unlock(fapo);
+	FAPOBase_UnlockForProcess(&fapo->base);
+}
+
+uint32_t FAudioFXConvolutionReverb_Initialize(
+	FAudioFXConvolutionReverb *fapo,
+	const void* pData,
+	uint32_t DataByteSize
+) {
+	#define INITPARAMS(offset) \
+		FAudio_memcpy( \
+			fapo->base.m_pParameterBlocks + DataByteSize * offset, \
+			pData, \
+			DataByteSize \
+		);
+	INITPARAMS(0)
+	INITPARAMS(1)
+	INITPARAMS(2)
+	#undef INITPARAMS
+	return 0;
+}
+
+void FAudioFXConvolutionReverb_Process(
+	FAudioFXConvolutionReverb *fapo,
+	uint32_t InputProcessParameterCount,
+	const FAPOProcessBufferParameters* pInputProcessParameters,
+	uint32_t OutputProcessParameterCount,
+	FAPOProcessBufferParameters* pOutputProcessParameters,
+	int32_t IsEnabled
+) {
+	FAudioFXConvolutionReverbParametersEXT *params;
+	float mix, total;
+	uint64_t fpstate;
+
+	params = (FAudioFXConvolutionReverbParametersEXT*) FAPOBase_BeginProcess(
+		&fapo->base
+	);
+
+	/* Handle disabled filter */
+	if (IsEnabled == 0)
+	{
+		pOutputProcessParameters->BufferFlags = pInputProcessParameters->BufferFlags;
+
+		if (	pOutputProcessParameters->BufferFlags != FAPO_BUFFER_SILENT &&
+			pOutputProcessParameters->pBuffer != pInputProcessParameters->pBuffer	)
+		{
+			FAudio_memcpy(
+				pOutputProcessParameters->pBuffer,
+				pInputProcessParameters->pBuffer,
+				pInputProcessParameters->ValidFrameCount * fapo->blockAlign
+			);
+		}
+
+		FAPOBase_EndProcess(&fapo->base);
+		return;
+	}
+
+	/* XAudio2 passes a 'silent' buffer when no input buffer is available to play the effect tail */
+	if (pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT)
+	{
+		FAudio_zero(
+			pInputProcessParameters->pBuffer,
+			pInputProcessParameters->ValidFrameCount * fapo->blockAlign
+		);
+	}
+
+	fpstate = FAudio_INTERNAL_FlushDenormals();
+
+	mix = params->WetDryMix / 100.0f;
+	total = FAudioFXConvolutionReverb_INTERNAL_Process(
+		fapo,
+		(const float*) pInputProcessParameters->pBuffer,
+		(float*) pOutputProcessParameters->pBuffer,
+		pInputProcessParameters->ValidFrameCount,
+		mix * params->Gain,
+		1.0f - mix
+	);
+
+	FAudio_INTERNAL_RestoreDenormals(fpstate);
+
+	/* Set BufferFlags to silent so PLAY_TAILS knows when to stop */
+	pOutputProcessParameters->BufferFlags = (total < 0.0000001f) ?
+		FAPO_BUFFER_SILENT :
+		FAPO_BUFFER_VALID;
+
+	FAPOBase_EndProcess(&fapo->base);
+}
+
+void FAudioFXConvolutionReverb_Reset(FAudioFXConvolutionReverb *fapo)
+{
+	FAPOBase_Reset(&fapo->base);
+	if (fapo->history != NULL)
+	{
+		FAudioFXConvolutionReverb_INTERNAL_Clear(fapo);
+	}
+}
+
+void FAudioFXConvolutionReverb_Free(void* fapo)
+{
+	FAudioFXConvolutionReverb *conv = (FAudioFXConvolutionReverb*) fapo;
+	uint32_t i;
+
+	FAudioFXConvolutionReverb_INTERNAL_Unlock(conv);
+	for (i = 0; i < conv->stage_count; i += 1)
+	{
+		ConvStage_Destroy(&conv->stage[i], conv->base.pFree);
+	}
+	if (conv->head != NULL)
+	{
+		conv->base.pFree(conv->head);
+	}
+	conv->base.pFree(conv->base.m_pParameterBlocks);
+	conv->base.pFree(fapo);
+}
+
+/* Public API */
+
+uint32_t FAudioCreateConvolutionReverbEXT(
+	FAPO** ppApo,
+	const FAudioFXImpulseResponseEXT *pImpulseResponse,
+	uint32_t Flags
+) {
+	return FAudioCreateConvolutionReverbWithCustomAllocatorEXT(
+		ppApo,
+		pImpulseResponse,
+		Flags,
+		FAudio_malloc,
+		FAudio_free,
+		FAudio_realloc
+	);
+}
+
+uint32_t FAudioCreateConvolutionReverbWithCustomAllocatorEXT(
+	FAPO** ppApo,
+	const FAudioFXImpulseResponseEXT *pImpulseResponse,
+	uint32_t Flags,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc
+) {
+	const FAudioFXConvolutionReverbParametersEXT fxdefault =
+	{
+		FAUDIOFX_CONVOLUTION_DEFAULT_WET_DRY_MIX_EXT,
+		FAUDIOFX_CONVOLUTION_DEFAULT_GAIN_EXT
+	};
+	FAudioFXConvolutionReverb *result;
+	uint8_t *params;
+	uint32_t c, i, frames, stage_end;
+
+	if (	pImpulseResponse == NULL ||
+		pImpulseResponse->pSamples == NULL ||
+		pImpulseResponse->ChannelCount == 0 ||
+		pImpulseResponse->FrameCount == 0 ||
+		pImpulseResponse->PartitionMode > FAUDIOFX_CONVOLUTION_PARTITION_NONUNIFORM_EXT ||
+		pImpulseResponse->WorkerCount > FAUDIOFX_CONVOLUTION_MAX_WORKERS_EXT	)
+	{
+		return FAUDIO_E_INVALID_ARG;
+	}
+	frames = pImpulseResponse->FrameCount;
+
+	/* Allocate... */
+	result = (FAudioFXConvolutionReverb*) customMalloc(
+		sizeof(FAudioFXConvolutionReverb)
+	);
+	params = (uint8_t*) customMalloc(
+		sizeof(FAudioFXConvolutionReverbParametersEXT) * 3
+	);
+	FAudio_zero(result, sizeof(FAudioFXConvolutionReverb));
+
+	/* Initialize... */
+	FAudio_memcpy(
+		&ConvolutionReverbProperties.clsid,
+		&FAudioFX_CLSID_ConvolutionReverbEXT,
+		sizeof(FAudioGUID)
+	);
+	CreateFAPOBaseWithCustomAllocatorEXT(
+		&result->base,
+		&ConvolutionReverbProperties,
+		params,
+		sizeof(FAudioFXConvolutionReverbParametersEXT),
+		0,
+		customMalloc,
+		customFree,
+		customRealloc
+	);
+
+	/* Function table... */
+	#define ASSIGN_VT(name) \
+		result->base.base.name = (name##Func) FAudioFXConvolutionReverb_##name;
+	ASSIGN_VT(LockForProcess);
+	ASSIGN_VT(UnlockForProcess);
+	ASSIGN_VT(Initialize);
+	ASSIGN_VT(Reset);
+	ASSIGN_VT(Process);
+	result->base.Destructor = FAudioFXConvolutionReverb_Free;
+	#undef ASSIGN_VT
+
+	/* Head, stored backwards so the FIR is a straight dot product */
+	result->ir_channels = pImpulseResponse->ChannelCount;
+	result->worker_request = pImpulseResponse->WorkerCount;
+	result->head = (float*) customMalloc(
+		sizeof(float) * CONV_HEAD_SIZE * result->ir_channels
+	);
+	if (result->head == NULL)
+	{
+		FAudioFXConvolutionReverb_Free(result);
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	FAudio_zero(
+		result->head,
+		sizeof(float) * CONV_HEAD_SIZE * result->ir_channels
+	);
+	for (c = 0; c < result->ir_channels; c += 1)
+	for (i = 0; i < FAudio_min(frames, CONV_HEAD_SIZE); i += 1)
+	{
+		result->head[c * CONV_HEAD_SIZE + (CONV_HEAD_SIZE - 1 - i)] =
+			pImpulseResponse->pSamples[i * result->ir_channels + c];
+	}
+
+	/* Partitions */
+	if (frames > CONV_HEAD_SIZE)
+	{
+		stage_end = frames;
+		if (pImpulseResponse->PartitionMode == FAUDIOFX_CONVOLUTION_PARTITION_NONUNIFORM_EXT)
+		{
+			stage_end = FAudio_min(frames, CONV_TAIL_SIZE * 2);
+		}
+		if (ConvStage_Create(
+			&result->stage[0],
+			pImpulseResponse,
+			CONV_HEAD_SIZE,
+			CONV_HEAD_SIZE,
+			stage_end,
+			customMalloc,
+			customFree
+		) != 0) {
+			result->stage_count = 1;
+			FAudioFXConvolutionReverb_Free(result);
+			return FAUDIO_E_OUT_OF_MEMORY;
+		}
+		result->stage_count = 1;
+
+		if (stage_end < frames)
+		{
+			if (ConvStage_Create(
+				&result->stage[1],
+				pImpulseResponse,
+				CONV_TAIL_SIZE,
+				CONV_TAIL_SIZE * 2,
+				frames,
+				customMalloc,
+				customFree
+			) != 0) {
+				result->stage_count = 2;
+				FAudioFXConvolutionReverb_Free(result);
+				return FAUDIO_E_OUT_OF_MEMORY;
+			}
+			result->stage_count = 2;
+		}
+	}
+
+	/* Prepare the default parameters */
+	result->base.base.Initialize(
+		result,
+		&fxdefault,
+		sizeof(FAudioFXConvolutionReverbParametersEXT)
+	);
+
+	/* Finally. */
+	*ppApo = &result->base.base;
+	return 0;
+}
+
+/* vim: set noexpandtab shiftwidth=8 tabstop=8: */
@@ -27,18 +27,6 @@
 #include "FAudioFX.h"
 #include "FAudio_internal.h"
 
-/* #define DISABLE_SUBNORMALS */
-#ifdef DISABLE_SUBNORMALS
-#include <math.h> /* ONLY USE THIS FOR fpclassify/_fpclass! */
-
-/* VS2010 doesn't define fpclassify (which is C99), so here it is. */
-#if defined(_MSC_VER) && !defined(fpclassify)
-#define IS_SUBNORMAL(a) (_fpclass(a) & (_FPCLASS_ND | _FPCLASS_PD))
-#else
-#define IS_SUBNORMAL(a) (fpclassify(a) == FP_SUBNORMAL)
-#endif
-#endif /* DISABLE_SUBNORMALS */
-
 /* Utility Functions */
 
 static inline float DbGainToFactor(float gain)
@@ -51,23 +39,15 @@ static inline uint32_t MsToSamples(float msec, int32_t sampleRate)
 	return (uint32_t) ((sampleRate * msec) / 1000.0f);
 }
 
-#ifndef DISABLE_SUBNORMALS
-#define Undenormalize(a) ((a))
-#else /* DISABLE_SUBNORMALS */
-static inline float Undenormalize(float sample_in)
-{
-	if (IS_SUBNORMAL(sample_in))
-	{
-		return 0.0f;
-	}
-	return sample_in;
-}
-#endif /* DISABLE_SUBNORMALS */
-
 /* Component - Delay */
 
 #define DSP_DELAY_MAX_DELAY_MS 300
 
+/* All of the components process whole blocks at a time, up to this many
+ * samples. The reverb network splits larger buffers into blocks of this size.
+ */
+#define DSP_MAX_BLOCK_SIZE 256
+
 typedef struct DspDelay
 {
 	int32_t	 sampleRate;
@@ -87,7 +67,14 @@ static inline void DspDelay_Initialize(
 	FAudio_assert(delay_ms >= 0 && delay_ms <= DSP_DELAY_MAX_DELAY_MS);
 
 	filter->sampleRate = sampleRate;
-	filter->capacity = MsToSamples(DSP_DELAY_MAX_DELAY_MS, sampleRate);
+
+	/* Leave room for one more block, so that DspDelay_ProcessBlock can
+	 * write a whole block before reading it, even at the longest delay
+	 */
+	filter->capacity = (
+		MsToSamples(DSP_DELAY_MAX_DELAY_MS, sampleRate) +
+		DSP_MAX_BLOCK_SIZE
+	);
 	filter->delay = MsToSamples(delay_ms, sampleRate);
 	filter->read_idx = 0;
 	filter->write_idx = filter->delay;
@@ -104,30 +91,84 @@ static inline void DspDelay_Change(DspDelay *filter, float delay_ms)
 	filter->read_idx = (filter->write_idx - filter->delay + filter->capacity) % filter->capacity;
 }
 
-static inline float DspDelay_Read(DspDelay *filter)
-{
-	float delay_out;
+static inline void DspDelay_ReadBlock(
+	DspDelay *filter,
+	float *samples,
+	uint32_t count
+) {
+	/* At most two segments, the end of the buffer and then the start */
+	uint32_t first = filter->capacity - filter->read_idx;
 
 	FAudio_assert(filter->read_idx < filter->capacity);
+	FAudio_assert(count <= DSP_MAX_BLOCK_SIZE);
+
+	if (count < first)
+	{
+		first = count;
+	}
+	FAudio_memcpy(
+		samples,
+		filter->buffer + filter->read_idx,
+		first * sizeof(float)
+	);
+	FAudio_memcpy(
+		samples + first,
+		filter->buffer,
+		(count - first) * sizeof(float)
+	);
 
-	delay_out = filter->buffer[filter->read_idx];
-	filter->read_idx = (filter->read_idx + 1) % filter->capacity;
-	return delay_out;
+	filter->read_idx += count;
+	if (filter->read_idx >= filter->capacity)
+	{
+		filter->read_idx -= filter->capacity;
+	}
 }
 
-static inline void DspDelay_Write(DspDelay *filter, float sample)
-{
+static inline void DspDelay_WriteBlock(
+	DspDelay *filter,
+	const float *samples,
+	uint32_t count
+) {
+	uint32_t first = filter->capacity - filter->write_idx;
+
 	FAudio_assert(filter->write_idx < filter->capacity);
+	FAudio_assert(count <= DSP_MAX_BLOCK_SIZE);
 
-	filter->buffer[filter->write_idx] = sample;
-	filter->write_idx = (filter->write_idx + 1) % filter->capacity;
+	if (count < first)
+	{
+		first = count;
+	}
+	FAudio_memcpy(
+		filter->buffer + filter->write_idx,
+		samples,
+		first * sizeof(float)
+	);
+	FAudio_memcpy(
+		filter->buffer,
+		samples + first,
+		(count - first) * sizeof(float)
+	);
+
+	filter->write_idx += count;
+	if (filter->write_idx >= filter->capacity)
+	{
+		filter->write_idx -= filter->capacity;
+	}
 }
 
-static inline float DspDelay_Process(DspDelay *filter, float sample_in)
-{
-	float delay_out = DspDelay_Read(filter);
-	DspDelay_Write(filter, sample_in);
-	return delay_out;
+/* samples_in and samples_out may be the same buffer */
+static inline void DspDelay_ProcessBlock(
+	DspDelay *filter,
+	const float *samples_in,
+	float *samples_out,
+	uint32_t count
+) {
+	/* Writing first means delays shorter than the block read what was just
+	 * written, and the extra block of capacity means nothing that's still
+	 * waiting to be read gets overwritten.
+	 */
+	DspDelay_WriteBlock(filter, samples_in, count);
+	DspDelay_ReadBlock(filter, samples_out, count);
 }
 
 /* FIXME: This is currently unused! What was it for...? -flibit
@@ -150,11 +191,14 @@ static inline void DspDelay_Destroy(DspDelay *filter, FAudioFreeFunc pFree)
 	pFree(filter->buffer);
 }
 
-static inline float DspComb_FeedbackFromRT60(DspDelay *delay, float rt60_ms)
-{
+static inline float DspComb_FeedbackFromRT60(
+	uint32_t delay,		/* In samples */
+	int32_t sampleRate,
+	float rt60_ms
+) {
 	float exponent = (
-		(-3.0f * delay->delay * 1000.0f) /
-		(delay->sampleRate * rt60_ms)
+		(-3.0f * delay * 1000.0f) /
+		(sampleRate * rt60_ms)
 	);
 	return (float) FAudio_pow(10.0f, exponent);
 }
@@ -234,10 +278,7 @@ static inline float DspBiQuad_Process(DspBiQuad *filter, float sample_in)
 	filter->delay0 = (filter->a1 * sample_in) - (filter->b1 * result) + filter->delay1;
 	filter->delay1 = (filter->a2 * sample_in) - (filter->b2 * result);
 
-	return Undenormalize(
-		(result * filter->c0) +
-		(sample_in * filter->d0)
-	);
+	return (result * filter->c0) + (sample_in * filter->d0);
 }
 
 static inline void DspBiQuad_Reset(DspBiQuad *filter)
@@ -250,21 +291,76 @@ static inline void DspBiQuad_Destroy(DspBiQuad *filter)
 {
 }
 
-/* Component - Comb Filter with Integrated Low/High Shelving Filters */
+/* Component - Comb Filter Bank with Integrated Low/High Shelving Filters */
 
-typedef struct DspCombShelving
+/* The reverb runs eight parallel comb filters per channel, all fed the same
+ * input and all using the same shelving filter coefficients, so they're kept
+ * together as one bank with one comb per SIMD lane. The delay lines are
+ * interleaved: each row of the buffer holds one sample for every comb, so
+ * writing a sample for all the combs is a single row. Reads still need one
+ * load per comb, since every comb has a different length.
+ *
+ * The interleaved buffer is only as long as the longest comb rather than the
+ * full DSP_DELAY_MAX_DELAY_MS, which keeps the whole bank in cache.
+ *
+ * Banks can be smaller than DSP_COMB_BANK_SIZE, for cheaper reverbs, but the
+ * comb count still has to be a multiple of 4.
+ */
+
+#define DSP_COMB_BANK_SIZE 8 /* Must be a multiple of 4 for the SIMD paths */
+
+typedef struct DspCombBank
 {
-	DspDelay comb_delay;
-	float comb_feedback_gain;
+	int32_t sampleRate;
+	uint32_t count;		/* Combs in use, also the row size */
+	uint32_t capacity;	/* In rows */
+	uint32_t delay[DSP_COMB_BANK_SIZE];	/* In samples */
+	uint32_t read_idx[DSP_COMB_BANK_SIZE];
+	uint32_t write_idx;
+	float *buffer;		/* capacity * count */
+	float comb_feedback_gain[DSP_COMB_BANK_SIZE];
 
+	/* Only the coefficients are used, the state is per-comb below.
+	 * The shelving filters are first-order, so there's no delay1.
+	 */
 	DspBiQuad low_shelving;
 	DspBiQuad high_shelving;
-} DspCombShelving;
+	float low_delay0[DSP_COMB_BANK_SIZE];
+	float high_delay0[DSP_COMB_BANK_SIZE];
+} DspCombBank;
+
+static inline void DspCombBank_Change(
+	DspCombBank *bank,
+	const float *delays_ms,
+	float rt60_ms
+) {
+	uint32_t i;
+
+	for (i = 0; i < bank->count; i += 1)
+	{
+		FAudio_assert(delays_ms[i] >= 0 && delays_ms[i] <= DSP_DELAY_MAX_DELAY_MS);
+
+		/* Length */
+		bank->delay[i] = MsToSamples(delays_ms[i], bank->sampleRate);
+		FAudio_assert(bank->delay[i] < bank->capacity);
+		bank->read_idx[i] = (
+			bank->write_idx - bank->delay[i] + bank->capacity
+		) % bank->capacity;
+
+		/* Decay time */
+		bank->comb_feedback_gain[i] = DspComb_FeedbackFromRT60(
+			bank->delay[i],
+			bank->sampleRate,
+			rt60_ms
+		);
+	}
+}
 
-static inline void DspCombShelving_Initialize(
-	DspCombShelving *filter,
+static inline void DspCombBank_Initialize(
+	DspCombBank *bank,
 	int32_t sampleRate,
-	float delay_ms,
+	uint32_t count,
+	const float *delays_ms,
 	float rt60_ms,
 	float low_frequency,
 	float low_gain,
@@ -272,14 +368,34 @@ static inline void DspCombShelving_Initialize(
 	float high_gain,
 	FAudioMallocFunc pMalloc
 ) {
-	DspDelay_Initialize(&filter->comb_delay, sampleRate, delay_ms, pMalloc);
-	filter->comb_feedback_gain = DspComb_FeedbackFromRT60(
-		&filter->comb_delay,
-		rt60_ms
+	float max_delay_ms = 0.0f;
+	uint32_t i;
+
+	FAudio_assert(count > 0 && count <= DSP_COMB_BANK_SIZE && (count % 4) == 0);
+
+	for (i = 0; i < count; i += 1)
+	{
+		max_delay_ms = FAudio_max(max_delay_ms, delays_ms[i]);
+	}
+
+	bank->sampleRate = sampleRate;
+	bank->count = count;
+	bank->capacity = MsToSamples(max_delay_ms, sampleRate) + 1;
+	bank->write_idx = 0;
+	bank->buffer = (float*) pMalloc(
+		bank->capacity * count * sizeof(float)
 	);
+	FAudio_zero(
+		bank->buffer,
+		bank->capacity * count * sizeof(float)
+	);
+	FAudio_zero(bank->low_delay0, sizeof(bank->low_delay0));
+	FAudio_zero(bank->high_delay0, sizeof(bank->high_delay0));
+
+	DspCombBank_Change(bank, delays_ms, rt60_ms);
 
 	DspBiQuad_Initialize(
-		&filter->low_shelving,
+		&bank->low_shelving,
 		sampleRate,
 		DSP_BIQUAD_LOWSHELVING,
 		low_frequency,
@@ -287,7 +403,7 @@ static inline void DspCombShelving_Initialize(
 		low_gain
 	);
 	DspBiQuad_Initialize(
-		&filter->high_shelving,
+		&bank->high_shelving,
 		sampleRate,
 		DSP_BIQUAD_HIGHSHELVING,
 		high_frequency,
@@ -296,39 +412,227 @@ static inline void DspCombShelving_Initialize(
 	);
 }
 
-static inline float DspCombShelving_Process(
-	DspCombShelving *filter,
-	float sample_in
+/* Writes the sum of all the comb outputs to samples_out.
+ * samples_in and samples_out may be the same buffer.
+ */
+static inline void DspCombBank_ProcessBlock(
+	DspCombBank *bank,
+	const float *samples_in,
+	float *samples_out,
+	uint32_t count
 ) {
-	float delay_out, feedback, to_buf;
+	const float *read[DSP_COMB_BANK_SIZE];
+	float *write;
+	uint32_t chunk, ofs, i, t;
+	const uint32_t combs = bank->count;
+
+#if HAVE_SSE2_INTRINSICS
+	const __m128 ha0 = _mm_set1_ps(bank->high_shelving.a0);
+	const __m128 ha1 = _mm_set1_ps(bank->high_shelving.a1);
+	const __m128 hb1 = _mm_set1_ps(bank->high_shelving.b1);
+	const __m128 hc0 = _mm_set1_ps(bank->high_shelving.c0);
+	const __m128 la0 = _mm_set1_ps(bank->low_shelving.a0);
+	const __m128 la1 = _mm_set1_ps(bank->low_shelving.a1);
+	const __m128 lb1 = _mm_set1_ps(bank->low_shelving.b1);
+	const __m128 lc0 = _mm_set1_ps(bank->low_shelving.c0);
+	__m128 in, delay_out, result, feedback, total;
+#elif HAVE_NEON_INTRINSICS
+	const float32x4_t ha0 = vdupq_n_f32(bank->high_shelving.a0);
+	const float32x4_t ha1 = vdupq_n_f32(bank->high_shelving.a1);
+	const float32x4_t hb1 = vdupq_n_f32(bank->high_shelving.b1);
+	const float32x4_t hc0 = vdupq_n_f32(bank->high_shelving.c0);
+	const float32x4_t la0 = vdupq_n_f32(bank->low_shelving.a0);
+	const float32x4_t la1 = vdupq_n_f32(bank->low_shelving.a1);
+	const float32x4_t lb1 = vdupq_n_f32(bank->low_shelving.b1);
+	const float32x4_t lc0 = vdupq_n_f32(bank->low_shelving.c0);
+	float32x4_t in, delay_out, result, feedback, total;
+	float32x2_t half;
+#else
+	float total[4];
+	float delay_out, result, feedback;
+#endif
+
+	while (count > 0)
+	{
+		/* Run until the first delay line wraps around, so the inner
+		 * loop doesn't have to check every sample
+		 */
+		chunk = bank->capacity - bank->write_idx;
+		for (i = 0; i < combs; i += 1)
+		{
+			if ((bank->capacity - bank->read_idx[i]) < chunk)
+			{
+				chunk = bank->capacity - bank->read_idx[i];
+			}
+			read[i] = bank->buffer + (bank->read_idx[i] * combs) + i;
+		}
+		if (count < chunk)
+		{
+			chunk = count;
+		}
+		write = bank->buffer + (bank->write_idx * combs);
+
+		for (t = 0; t < chunk; t += 1)
+		{
+			ofs = t * combs;
 
-	delay_out = DspDelay_Read(&filter->comb_delay);
+#if HAVE_SSE2_INTRINSICS
+			in = _mm_set1_ps(samples_in[t]);
+			total = _mm_setzero_ps();
+			for (i = 0; i < combs; i += 4)
+			{
+				delay_out = _mm_set_ps(
+					read[i + 3][ofs],
+					read[i + 2][ofs],
+					read[i + 1][ofs],
+					read[i + 0][ofs]
+				);
+				total = _mm_add_ps(total, delay_out);
+
+				/* Apply shelving filters, see DspBiQuad_Process */
+				result = _mm_add_ps(
+					_mm_mul_ps(ha0, delay_out),
+					_mm_loadu_ps(&bank->high_delay0[i])
+				);
+				_mm_storeu_ps(&bank->high_delay0[i], _mm_sub_ps(
+					_mm_mul_ps(ha1, delay_out),
+					_mm_mul_ps(hb1, result)
+				));
+				feedback = _mm_add_ps(_mm_mul_ps(result, hc0), delay_out);
+
+				result = _mm_add_ps(
+					_mm_mul_ps(la0, feedback),
+					_mm_loadu_ps(&bank->low_delay0[i])
+				);
+				_mm_storeu_ps(&bank->low_delay0[i], _mm_sub_ps(
+					_mm_mul_ps(la1, feedback),
+					_mm_mul_ps(lb1, result)
+				));
+				feedback = _mm_add_ps(_mm_mul_ps(result, lc0), feedback);
+
+				/* Apply comb filter */
+				_mm_storeu_ps(&write[ofs + i], _mm_add_ps(in, _mm_mul_ps(
+					_mm_loadu_ps(&bank->comb_feedback_gain[i]),
+					feedback
+				)));
+			}
 
-	/* Apply shelving filters */
-	feedback = DspBiQuad_Process(&filter->high_shelving, delay_out);
-	feedback = DspBiQuad_Process(&filter->low_shelving, feedback);
+			/* (0 + 2) + (1 + 3), same as the scalar path */
+			total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+			total = _mm_add_ss(total, _mm_shuffle_ps(total, total, _MM_SHUFFLE(1, 1, 1, 1)));
+			samples_out[t] = _mm_cvtss_f32(total);
+#elif HAVE_NEON_INTRINSICS
+			in = vdupq_n_f32(samples_in[t]);
+			total = vdupq_n_f32(0.0f);
+			for (i = 0; i < combs; i += 4)
+			{
+				delay_out = vdupq_n_f32(read[i + 0][ofs]);
+				delay_out = vsetq_lane_f32(read[i + 1][ofs], delay_out, 1);
+				delay_out = vsetq_lane_f32(read[i + 2][ofs], delay_out, 2);
+				delay_out = vsetq_lane_f32(read[i + 3][ofs], delay_out, 3);
+				total = vaddq_f32(total, delay_out);
+
+				/* Apply shelving filters, see DspBiQuad_Process */
+				result = vaddq_f32(
+					vmulq_f32(ha0, delay_out),
+					vld1q_f32(&bank->high_delay0[i])
+				);
+				vst1q_f32(&bank->high_delay0[i], vsubq_f32(
+					vmulq_f32(ha1, delay_out),
+					vmulq_f32(hb1, result)
+				));
+				feedback = vaddq_f32(vmulq_f32(result, hc0), delay_out);
+
+				result = vaddq_f32(
+					vmulq_f32(la0, feedback),
+					vld1q_f32(&bank->low_delay0[i])
+				);
+				vst1q_f32(&bank->low_delay0[i], vsubq_f32(
+					vmulq_f32(la1, feedback),
+					vmulq_f32(lb1, result)
+				));
+				feedback = vaddq_f32(vmulq_f32(result, lc0), feedback);
+
+				/* Apply comb filter */
+				vst1q_f32(&write[ofs + i], vaddq_f32(in, vmulq_f32(
+					vld1q_f32(&bank->comb_feedback_gain[i]),
+					feedback
+				)));
+			}
 
-	/* Apply comb filter */
-	to_buf = Undenormalize(sample_in + (filter->comb_feedback_gain * feedback));
-	DspDelay_Write(&filter->comb_delay, to_buf);
+			/* (0 + 2) + (1 + 3), same as the scalar path */
+			half = vadd_f32(vget_low_f32(total), vget_high_f32(total));
+			samples_out[t] = vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+			total[0] = total[1] = total[2] = total[3] = 0.0f;
+			for (i = 0; i < combs; i += 1)
+			{
+				delay_out = read[i][ofs];
+				total[i & 3] += delay_out;
+
+				/* Apply shelving filters, see DspBiQuad_Process */
+				result = (bank->high_shelving.a0 * delay_out) + bank->high_delay0[i];
+				bank->high_delay0[i] = (
+					(bank->high_shelving.a1 * delay_out) -
+					(bank->high_shelving.b1 * result)
+				);
+				feedback = (result * bank->high_shelving.c0) + delay_out;
+
+				result = (bank->low_shelving.a0 * feedback) + bank->low_delay0[i];
+				bank->low_delay0[i] = (
+					(bank->low_shelving.a1 * feedback) -
+					(bank->low_shelving.b1 * result)
+				);
+				feedback = (result * bank->low_shelving.c0) + feedback;
+
+				/* Apply comb filter */
+				write[ofs + i] = samples_in[t] + (bank->comb_feedback_gain[i] * feedback);
+			}
+			samples_out[t] = (total[0] + total[2]) + (total[1] + total[3]);
+#endif
+		}
 
-	return delay_out;
+		/* Advance the delay lines */
+		for (i = 0; i < combs; i += 1)
+		{
+			bank->read_idx[i] += chunk;
+			if (bank->read_idx[i] == bank->capacity)
+			{
+				bank->read_idx[i] = 0;
+			}
+		}
+		bank->write_idx += chunk;
+		if (bank->write_idx == bank->capacity)
+		{
+			bank->write_idx = 0;
+		}
+
+		samples_in += chunk;
+		samples_out += chunk;
+		count -= chunk;
+	}
 }
 
-static inline void DspCombShelving_Reset(DspCombShelving *filter)
+static inline void DspCombBank_Reset(DspCombBank *bank)
 {
-	DspDelay_Reset(&filter->comb_delay);
-	DspBiQuad_Reset(&filter->low_shelving);
-	DspBiQuad_Reset(&filter->high_shelving);
+	uint32_t i;
+
+	bank->write_idx = 0;
+	for (i = 0; i < bank->count; i += 1)
+	{
+		bank->read_idx[i] = (bank->capacity - bank->delay[i]) % bank->capacity;
+	}
+	FAudio_zero(
+		bank->buffer,
+		bank->capacity * bank->count * sizeof(float)
+	);
+	FAudio_zero(bank->low_delay0, sizeof(bank->low_delay0));
+	FAudio_zero(bank->high_delay0, sizeof(bank->high_delay0));
 }
 
-static inline void DspCombShelving_Destroy(
-	DspCombShelving *filter,
-	FAudioFreeFunc pFree
-) {
-	DspDelay_Destroy(&filter->comb_delay, pFree);
-	DspBiQuad_Destroy(&filter->low_shelving);
-	DspBiQuad_Destroy(&filter->high_shelving);
+static inline void DspCombBank_Destroy(DspCombBank *bank, FAudioFreeFunc pFree)
+{
+	pFree(bank->buffer);
 }
 
 /* Component - Delaying All-Pass Filter */
@@ -356,16 +660,40 @@ static inline void DspAllPass_Change(DspAllPass *filter, float delay_ms, float g
 	filter->feedback_gain = gain;
 }
 
-static inline float DspAllPass_Process(DspAllPass *filter, float sample_in)
-{
-	float delay_out, to_buf;
+/* samples_in and samples_out may be the same buffer */
+static inline void DspAllPass_ProcessBlock(
+	DspAllPass *filter,
+	const float *samples_in,
+	float *samples_out,
+	uint32_t count
+) {
+	float delay_out[DSP_MAX_BLOCK_SIZE];
+	float to_buf[DSP_MAX_BLOCK_SIZE];
+	uint32_t chunk, i;
 
-	delay_out = DspDelay_Read(&filter->delay);
+	while (count > 0)
+	{
+		/* The feedback is read before it's written, so a chunk can't be
+		 * longer than the delay
+		 */
+		chunk = count;
+		if (filter->delay.delay > 0 && filter->delay.delay < chunk)
+		{
+			chunk = filter->delay.delay;
+		}
 
-	to_buf = Undenormalize(sample_in + (filter->feedback_gain * delay_out));
-	DspDelay_Write(&filter->delay, to_buf);
+		DspDelay_ReadBlock(&filter->delay, delay_out, chunk);
+		for (i = 0; i < chunk; i += 1)
+		{
+			to_buf[i] = samples_in[i] + (filter->feedback_gain * delay_out[i]);
+			samples_out[i] = delay_out[i] - (filter->feedback_gain * to_buf[i]);
+		}
+		DspDelay_WriteBlock(&filter->delay, to_buf, chunk);
 
-	return Undenormalize(delay_out - (filter->feedback_gain * to_buf));
+		samples_in += chunk;
+		samples_out += chunk;
+		count -= chunk;
+	}
 }
 
 static inline void DspAllPass_Reset(DspAllPass *filter)
@@ -449,10 +777,18 @@ float RoomSize;			1 - 100 feet (NOT USED YET)
 
 */
 
-#define REVERB_COUNT_COMB	8
+#define REVERB_COUNT_COMB	DSP_COMB_BANK_SIZE
 #define REVERB_COUNT_APF_IN	1
 #define REVERB_COUNT_APF_OUT	4
 
+/* The low-CPU network keeps every other comb and the first two output
+ * all-pass filters, which roughly halves the per-channel cost. The combs are
+ * uncorrelated, so half as many of them need 1/sqrt(2) more attenuation to
+ * keep the same level.
+ */
+#define REVERB_COUNT_COMB_LOW_CPU	4
+#define REVERB_COUNT_APF_OUT_LOW_CPU	2
+
 static float COMB_DELAYS[REVERB_COUNT_COMB] =
 {
 	25.31f,
@@ -465,6 +801,14 @@ static float COMB_DELAYS[REVERB_COUNT_COMB] =
 	36.67f
 };
 
+static float COMB_DELAYS_LOW_CPU[REVERB_COUNT_COMB_LOW_CPU] =
+{
+	25.31f,
+	28.96f,
+	32.24f,
+	35.31f
+};
+
 static float APF_IN_DELAYS[REVERB_COUNT_APF_IN] =
 {
 	13.28f,
@@ -545,7 +889,7 @@ float FAudio_GetStereoSpreadDelayMS(int32_t total_channels, int32_t channel)
 typedef struct DspReverbChannel
 {
 	DspDelay reverb_delay;
-	DspCombShelving	lpf_comb[REVERB_COUNT_COMB];
+	DspCombBank lpf_comb;
 	DspAllPass apf_out[REVERB_COUNT_APF_OUT];
 	DspBiQuad room_high_shelf;
 	float early_gain;
@@ -562,11 +906,20 @@ typedef struct DspReverb
 	int32_t reverb_channels;
 	DspReverbChannel channel[5];
 
+	/* Fewer for the low-CPU network */
+	const float *comb_delays;
+	int32_t comb_count;
+	int32_t apf_out_count;
+	float comb_scale;
+
+	/* These are applied per sample, so they can ramp to new values */
 	float early_gain;
-	float reverb_gain;
-	float room_gain;
-	float wet_ratio;
-	float dry_ratio;
+	FAPOParameterRampEXT reverb_gain;
+	FAPOParameterRampEXT room_gain;
+	FAPOParameterRampEXT wet_ratio;
+
+	/* Frames of silent input and quiet output in a row */
+	uint32_t quiet_frames;
 } DspReverb;
 
 static inline void DspReverb_Create(
@@ -574,14 +927,31 @@ static inline void DspReverb_Create(
 	int32_t sampleRate,
 	int32_t in_channels,
 	int32_t out_channels,
+	uint8_t low_cpu,
 	FAudioMallocFunc pMalloc
 ) {
+	float comb_delays[REVERB_COUNT_COMB];
 	int32_t i, c;
 
 	FAudio_assert(in_channels == 1 || in_channels == 2 || in_channels == 6);
 	FAudio_assert(out_channels == 1 || out_channels == 2 || out_channels == 6);
 
 	FAudio_zero(reverb, sizeof(DspReverb));
+	if (low_cpu)
+	{
+		reverb->comb_delays = COMB_DELAYS_LOW_CPU;
+		reverb->comb_count = REVERB_COUNT_COMB_LOW_CPU;
+		reverb->apf_out_count = REVERB_COUNT_APF_OUT_LOW_CPU;
+		reverb->comb_scale = 0.70710678f / REVERB_COUNT_COMB_LOW_CPU;
+	}
+	else
+	{
+		reverb->comb_delays = COMB_DELAYS;
+		reverb->comb_count = REVERB_COUNT_COMB;
+		reverb->apf_out_count = REVERB_COUNT_APF_OUT;
+		reverb->comb_scale = 1.0f / REVERB_COUNT_COMB;
+	}
+
 	DspDelay_Initialize(&reverb->early_delay, sampleRate, 10, pMalloc);
 
 	for (i = 0; i < REVERB_COUNT_APF_IN; i += 1)
@@ -613,22 +983,24 @@ static inline void DspReverb_Create(
 			pMalloc
 		);
 
-		for (i = 0; i < REVERB_COUNT_COMB; i += 1)
+		for (i = 0; i < reverb->comb_count; i += 1)
 		{
-			DspCombShelving_Initialize(
-				&reverb->channel[c].lpf_comb[i],
-				sampleRate,
-				COMB_DELAYS[i] + FAudio_GetStereoSpreadDelayMS(reverb->reverb_channels, c),
-				500,
-				500,
-				-6,
-				5000,
-				-6,
-				pMalloc
-			);
+			comb_delays[i] = reverb->comb_delays[i] + FAudio_GetStereoSpreadDelayMS(reverb->reverb_channels, c);
 		}
+		DspCombBank_Initialize(
+			&reverb->channel[c].lpf_comb,
+			sampleRate,
+			reverb->comb_count,
+			comb_delays,
+			500,
+			500,
+			-6,
+			5000,
+			-6,
+			pMalloc
+		);
 
-		for (i = 0; i < REVERB_COUNT_APF_OUT; i += 1)
+		for (i = 0; i < reverb->apf_out_count; i += 1)
 		{
 			DspAllPass_Initialize(
 				&reverb->channel[c].apf_out[i],
@@ -651,9 +1023,9 @@ static inline void DspReverb_Create(
 	}
 
 	reverb->early_gain = 1.0f;
-	reverb->reverb_gain = 1.0f;
-	reverb->dry_ratio = 0.0f;
-	reverb->wet_ratio = 1.0f;
+	FAPOParameterRamp_ResetEXT(&reverb->reverb_gain, 1.0f);
+	FAPOParameterRamp_ResetEXT(&reverb->room_gain, 1.0f);
+	FAPOParameterRamp_ResetEXT(&reverb->wet_ratio, 1.0f);
 	reverb->in_channels = in_channels;
 	reverb->out_channels = out_channels;
 }
@@ -673,17 +1045,11 @@ static inline void DspReverb_Destroy(DspReverb *reverb, FAudioFreeFunc pFree)
 	{
 		DspDelay_Destroy(&reverb->channel[c].reverb_delay, pFree);
 
-		for (i = 0; i < REVERB_COUNT_COMB; i += 1)
-		{
-			DspCombShelving_Destroy(
-				&reverb->channel[c].lpf_comb[i],
-				pFree
-			);
-		}
+		DspCombBank_Destroy(&reverb->channel[c].lpf_comb, pFree);
 
 		DspBiQuad_Destroy(&reverb->channel[c].room_high_shelf);
 
-		for (i = 0; i < REVERB_COUNT_APF_OUT; i += 1)
+		for (i = 0; i < reverb->apf_out_count; i += 1)
 		{
 			DspAllPass_Destroy(
 				&reverb->channel[c].apf_out[i],
@@ -693,14 +1059,55 @@ static inline void DspReverb_Destroy(DspReverb *reverb, FAudioFreeFunc pFree)
 	}
 }
 
+static inline void DspReverb_Reset(DspReverb *reverb)
+{
+	int32_t i, c;
+
+	DspDelay_Reset(&reverb->early_delay);
+
+	for (i = 0; i < REVERB_COUNT_APF_IN; i += 1)
+	{
+		DspAllPass_Reset(&reverb->apf_in[i]);
+	}
+
+	for (c = 0; c < reverb->reverb_channels; c += 1)
+	{
+		DspDelay_Reset(&reverb->channel[c].reverb_delay);
+
+		DspCombBank_Reset(&reverb->channel[c].lpf_comb);
+
+		DspBiQuad_Reset(&reverb->channel[c].room_high_shelf);
+
+		for (i = 0; i < reverb->apf_out_count; i += 1)
+		{
+			DspAllPass_Reset(&reverb->channel[c].apf_out[i]);
+		}
+	}
+
+	reverb->quiet_frames = 0;
+
+	/* Finish any ramps */
+	FAPOParameterRamp_ResetEXT(&reverb->reverb_gain, reverb->reverb_gain.Target);
+	FAPOParameterRamp_ResetEXT(&reverb->room_gain, reverb->room_gain.Target);
+	FAPOParameterRamp_ResetEXT(&reverb->wet_ratio, reverb->wet_ratio.Target);
+}
+
+/* ramp_frames only applies to the gains, the rest of the network changes at
+ * once
+ */
 static inline void DspReverb_SetParameters(
 	DspReverb *reverb,
-	FAudioFXReverbParameters *params
+	FAudioFXReverbParameters *params,
+	uint32_t ramp_frames
 ) {
 	float early_diffusion, late_diffusion;
-	DspCombShelving *comb;
+	float comb_delays[REVERB_COUNT_COMB];
+	DspCombBank *comb;
 	int32_t i, c;
 
+	/* The delays are about to move, so start counting silence over */
+	reverb->quiet_frames = 0;
+
 	/* Pre-Delay */
 	DspDelay_Change(&reverb->early_delay, (float) params->ReflectionsDelay);
 
@@ -729,42 +1136,48 @@ static inline void DspReverb_SetParameters(
 			(float) params->ReverbDelay + channel_delay
 		);
 
-		for (i = 0; i < REVERB_COUNT_COMB; i += 1)
-		{
-			comb = &reverb->channel[c].lpf_comb[i];
+		comb = &reverb->channel[c].lpf_comb;
 
-			/* Set decay time of comb filter */
-			DspDelay_Change(
-				&comb->comb_delay,
-				COMB_DELAYS[i] + FAudio_GetStereoSpreadDelayMS(reverb->reverb_channels, c)
-			);
-			comb->comb_feedback_gain = DspComb_FeedbackFromRT60(
-				&comb->comb_delay,
-				FAudio_max(params->DecayTime, FAUDIOFX_REVERB_MIN_DECAY_TIME) * 1000.0f
-			);
-
-			/* High/Low shelving */
-			DspBiQuad_Change(
-				&comb->low_shelving,
-				DSP_BIQUAD_LOWSHELVING,
-				50.0f + params->LowEQCutoff * 50.0f,
-				0.0f,
-				params->LowEQGain - 8.0f
-			);
-			DspBiQuad_Change(
-				&comb->high_shelving,
-				DSP_BIQUAD_HIGHSHELVING,
-				1000 + params->HighEQCutoff * 500.0f,
-				0.0f,
-				params->HighEQGain - 8.0f
-			);
+		/* Set decay time of comb filters */
+		for (i = 0; i < reverb->comb_count; i += 1)
+		{
+			comb_delays[i] = reverb->comb_delays[i] + FAudio_GetStereoSpreadDelayMS(reverb->reverb_channels, c);
 		}
+		DspCombBank_Change(
+			comb,
+			comb_delays,
+			FAudio_max(params->DecayTime, FAUDIOFX_REVERB_MIN_DECAY_TIME) * 1000.0f
+		);
+
+		/* High/Low shelving */
+		DspBiQuad_Change(
+			&comb->low_shelving,
+			DSP_BIQUAD_LOWSHELVING,
+			50.0f + params->LowEQCutoff * 50.0f,
+			0.0f,
+			params->LowEQGain - 8.0f
+		);
+		DspBiQuad_Change(
+			&comb->high_shelving,
+			DSP_BIQUAD_HIGHSHELVING,
+			1000 + params->HighEQCutoff * 500.0f,
+			0.0f,
+			params->HighEQGain - 8.0f
+		);
 	}
 
 	/* Gain */
 	reverb->early_gain = DbGainToFactor(params->ReflectionsGain);
-	reverb->reverb_gain = DbGainToFactor(params->ReverbGain);
-	reverb->room_gain = DbGainToFactor(params->RoomFilterMain);
+	FAPOParameterRamp_SetTargetEXT(
+		&reverb->reverb_gain,
+		DbGainToFactor(params->ReverbGain),
+		ramp_frames
+	);
+	FAPOParameterRamp_SetTargetEXT(
+		&reverb->room_gain,
+		DbGainToFactor(params->RoomFilterMain),
+		ramp_frames
+	);
 
 	/* Late Diffusion */
 	late_diffusion = 0.6f - ((params->LateDiffusion / 15.0f) * 0.2f);
@@ -774,7 +1187,7 @@ static inline void DspReverb_SetParameters(
 		FAudio_ChannelPositionFlags position = FAudio_GetChannelPositionFlags(reverb->reverb_channels, c);
 		float gain;
 
-		for (i = 0; i < REVERB_COUNT_APF_OUT; i += 1)
+		for (i = 0; i < reverb->apf_out_count; i += 1)
 		{
 			DspAllPass_Change(
 				&reverb->channel[c].apf_out[i],
@@ -831,13 +1244,17 @@ static inline void DspReverb_SetParameters(
 	}
 
 	/* Wet/Dry Mix (100 = fully wet, 0 = fully dry) */
-	reverb->wet_ratio = params->WetDryMix / 100.0f;
-	reverb->dry_ratio = 1.0f - reverb->wet_ratio;
+	FAPOParameterRamp_SetTargetEXT(
+		&reverb->wet_ratio,
+		params->WetDryMix / 100.0f,
+		ramp_frames
+	);
 }
 
 static inline void DspReverb_SetParameters9(
 	DspReverb *reverb,
-	FAudioFXReverbParameters9 *params
+	FAudioFXReverbParameters9 *params,
+	uint32_t ramp_frames
 ) {
 	FAudioFXReverbParameters oldParams;
 	oldParams.WetDryMix = params->WetDryMix;
@@ -862,106 +1279,194 @@ static inline void DspReverb_SetParameters9(
 	oldParams.DecayTime = params->DecayTime;
 	oldParams.Density = params->Density;
 	oldParams.RoomSize = params->RoomSize;
-	DspReverb_SetParameters(reverb, &oldParams);
+	DspReverb_SetParameters(reverb, &oldParams, ramp_frames);
 }
 
-static inline float DspReverb_INTERNAL_ProcessEarly(
+/* Runs the whole network on one block of mono input, writing the wet signal
+ * for each reverb channel to late[c]. The components each run over the whole
+ * block in turn, so there's no per-sample call chain to get through.
+ */
+static inline void DspReverb_INTERNAL_ProcessBlock(
 	DspReverb *reverb,
-	float sample_in
+	const float *samples_in,
+	float late[][DSP_MAX_BLOCK_SIZE],
+	uint32_t count
 ) {
-	float early;
-	int32_t i;
+	float early[DSP_MAX_BLOCK_SIZE];
+	float reverb_gain[DSP_MAX_BLOCK_SIZE];
+	float room_gain[DSP_MAX_BLOCK_SIZE];
+	DspReverbChannel *channel;
+	float *sample_out;
+	float early_late;
+	uint32_t i;
+	int32_t c;
 
 	/* Pre-Delay */
-	early = DspDelay_Process(&reverb->early_delay, sample_in);
+	DspDelay_ProcessBlock(&reverb->early_delay, samples_in, early, count);
 
 	/* Early Reflections */
 	for (i = 0; i < REVERB_COUNT_APF_IN; i += 1)
 	{
-		early = DspAllPass_Process(&reverb->apf_in[i], early);
+		DspAllPass_ProcessBlock(&reverb->apf_in[i], early, early, count);
 	}
 
-	return early;
-}
+	/* The gains are shared by all channels, so step the ramps once */
+	FAPOParameterRamp_FillEXT(&reverb->reverb_gain, reverb_gain, count);
+	FAPOParameterRamp_FillEXT(&reverb->room_gain, room_gain, count);
 
-static inline float DspReverb_INTERNAL_ProcessChannel(
-	DspReverb *reverb,
-	DspReverbChannel *channel,
-	float sample_in
-) {
-	float revdelay, early_late, sample_out;
-	int32_t i;
+	for (c = 0; c < reverb->reverb_channels; c += 1)
+	{
+		channel = &reverb->channel[c];
+		sample_out = late[c];
 
-	revdelay = DspDelay_Process(&channel->reverb_delay, sample_in);
+		DspDelay_ProcessBlock(
+			&channel->reverb_delay,
+			early,
+			sample_out,
+			count
+		);
 
-	sample_out = 0.0f;
-	for (i = 0; i < REVERB_COUNT_COMB; i += 1)
-	{
-		sample_out += DspCombShelving_Process(
-			&channel->lpf_comb[i],
-			revdelay
+		DspCombBank_ProcessBlock(
+			&channel->lpf_comb,
+			sample_out,
+			sample_out,
+			count
 		);
+		for (i = 0; i < count; i += 1)
+		{
+			sample_out[i] *= reverb->comb_scale;
+		}
+
+		/* Output Diffusion */
+		for (i = 0; i < (uint32_t) reverb->apf_out_count; i += 1)
+		{
+			DspAllPass_ProcessBlock(
+				&channel->apf_out[i],
+				sample_out,
+				sample_out,
+				count
+			);
+		}
+
+		for (i = 0; i < count; i += 1)
+		{
+			/* Combine early reflections and reverberation */
+			early_late = (
+				(early[i] * channel->early_gain) +
+				(sample_out[i] * reverb_gain[i])
+			);
+
+			/* Room filter, PositionMatrixLeft/Right */
+			sample_out[i] = DspBiQuad_Process(
+				&channel->room_high_shelf,
+				early_late * room_gain[i]
+			) * channel->gain;
+		}
 	}
-	sample_out /= (float) REVERB_COUNT_COMB;
+}
+
+/* The longest path through the network, in frames. Sound that went in less
+ * than this long ago may still be on its way to the output.
+ */
+static inline uint32_t DspReverb_INTERNAL_Reach(DspReverb *reverb)
+{
+	uint32_t reach, path, comb, longest = 0;
+	int32_t i, c;
 
-	/* Output Diffusion */
-	for (i = 0; i < REVERB_COUNT_APF_OUT; i += 1)
+	reach = reverb->early_delay.delay;
+	for (i = 0; i < REVERB_COUNT_APF_IN; i += 1)
 	{
-		sample_out = DspAllPass_Process(
-			&channel->apf_out[i],
-			sample_out
-		);
+		reach += reverb->apf_in[i].delay.delay;
 	}
+	for (c = 0; c < reverb->reverb_channels; c += 1)
+	{
+		path = reverb->channel[c].reverb_delay.delay;
+		comb = 0;
+		for (i = 0; i < reverb->comb_count; i += 1)
+		{
+			comb = FAudio_max(comb, reverb->channel[c].lpf_comb.delay[i]);
+		}
+		path += comb;
+		for (i = 0; i < reverb->apf_out_count; i += 1)
+		{
+			path += reverb->channel[c].apf_out[i].delay.delay;
+		}
+		longest = FAudio_max(longest, path);
+	}
+	return reach + longest;
+}
 
-	/* Combine early reflections and reverberation */
-	early_late = (
-		(sample_in * channel->early_gain) +
-		(sample_out * reverb->reverb_gain)
-	);
+/* Quiet output alone isn't silence, the delay lines can still be holding
+ * sound. Only report it once the input has been silent and the output quiet
+ * for the whole reach of the network, then clear what's left so that the
+ * network really does stay silent (see SilenceStaysSilentEXT).
+ */
+static inline uint8_t DspReverb_INTERNAL_UpdateSilence(
+	DspReverb *reverb,
+	uint8_t input_silent,
+	uint32_t frames,
+	float total
+) {
+	uint32_t reach;
 
-	/* Room filter */
-	sample_out = DspBiQuad_Process(
-		&channel->room_high_shelf,
-		early_late * reverb->room_gain
-	);
+	if (!input_silent || total >= 0.0000001f)
+	{
+		reverb->quiet_frames = 0;
+		return 0;
+	}
 
-	/* PositionMatrixLeft/Right */
-	return sample_out * channel->gain;
+	reach = DspReverb_INTERNAL_Reach(reverb);
+	if (reverb->quiet_frames >= reach)
+	{
+		return 1;
+	}
+	reverb->quiet_frames += frames;
+	if (reverb->quiet_frames < reach)
+	{
+		return 0;
+	}
+	DspReverb_Reset(reverb);
+	reverb->quiet_frames = reach;
+	return 1;
 }
 
-/* Reverb Process Functions */
+/* Reverb Process Functions
+ * The ones with matching layouts may be run in place.
+ */
 
 static inline float DspReverb_INTERNAL_Process_1_to_1(
 	DspReverb *reverb,
-	float *restrict samples_in,
-	float *restrict samples_out,
+	float *samples_in,
+	float *samples_out,
 	size_t sample_count
 ) {
-	const float *in_end = samples_in + sample_count;
-	float in, early, late, out;
+	float late[1][DSP_MAX_BLOCK_SIZE];
+	float wet[DSP_MAX_BLOCK_SIZE];
+	float out;
 	float squared_sum = 0.0f;
+	uint32_t count, i;
 
-	while (samples_in < in_end)
+	while (sample_count > 0)
 	{
-		/* Input */
-		in = *samples_in++;
-
-		/* Early Reflections */
-		early = DspReverb_INTERNAL_ProcessEarly(reverb, in);
+		count = (uint32_t) FAudio_min(sample_count, DSP_MAX_BLOCK_SIZE);
 
 		/* Reverberation */
-		late = DspReverb_INTERNAL_ProcessChannel(
-			reverb,
-			&reverb->channel[0],
-			early
-		);
+		DspReverb_INTERNAL_ProcessBlock(reverb, samples_in, late, count);
+		FAPOParameterRamp_FillEXT(&reverb->wet_ratio, wet, count);
 
-		/* Wet/Dry Mix */
-		out = (late * reverb->wet_ratio) + (in * reverb->dry_ratio);
-		squared_sum += out * out;
+		for (i = 0; i < count; i += 1)
+		{
+			/* Wet/Dry Mix */
+			out = (late[0][i] * wet[i]) + (samples_in[i] * (1.0f - wet[i]));
+			squared_sum += out * out;
 
-		/* Output */
-		*samples_out++ = out;
+			/* Output */
+			samples_out[i] = out;
+		}
+
+		samples_in += count;
+		samples_out += count;
+		sample_count -= count;
 	}
 
 	return squared_sum;
@@ -973,38 +1478,42 @@ static inline float DspReverb_INTERNAL_Process_1_to_5p1(
 	float *restrict samples_out,
 	size_t sample_count
 ) {
-	const float *in_end = samples_in + sample_count;
-	float in, in_ratio, early, late[4];
+	float late[4][DSP_MAX_BLOCK_SIZE];
+	float wet[DSP_MAX_BLOCK_SIZE];
+	float in_ratio, out[4];
 	float squared_sum = 0.0f;
+	uint32_t count, i;
 	int32_t c;
 
-	while (samples_in < in_end)
+	while (sample_count > 0)
 	{
-		/* Input */
-		in = *samples_in++;
-		in_ratio = in * reverb->dry_ratio;
+		count = (uint32_t) FAudio_min(sample_count, DSP_MAX_BLOCK_SIZE);
 
-		/* Early Reflections */
-		early = DspReverb_INTERNAL_ProcessEarly(reverb, in);
+		/* Reverberation */
+		DspReverb_INTERNAL_ProcessBlock(reverb, samples_in, late, count);
+		FAPOParameterRamp_FillEXT(&reverb->wet_ratio, wet, count);
 
-		/* Reverberation with Wet/Dry Mix */
-		for (c = 0; c < 4; c += 1)
+		for (i = 0; i < count; i += 1)
 		{
-			late[c] = (DspReverb_INTERNAL_ProcessChannel(
-				reverb,
-				&reverb->channel[c],
-				early
-			) * reverb->wet_ratio) + in_ratio;
-			squared_sum += late[c] * late[c];
+			/* Wet/Dry Mix */
+			in_ratio = samples_in[i] * (1.0f - wet[i]);
+			for (c = 0; c < 4; c += 1)
+			{
+				out[c] = (late[c][i] * wet[i]) + in_ratio;
+				squared_sum += out[c] * out[c];
+			}
+
+			/* Output */
+			*samples_out++ = out[0];	/* Front Left */
+			*samples_out++ = out[1];	/* Front Right */
+			*samples_out++ = 0.0f;		/* Center */
+			*samples_out++ = 0.0f;		/* LFE */
+			*samples_out++ = out[2];	/* Rear Left */
+			*samples_out++ = out[3];	/* Rear Right */
 		}
 
-		/* Output */
-		*samples_out++ = late[0];	/* Front Left */
-		*samples_out++ = late[1];	/* Front Right */
-		*samples_out++ = 0.0f;		/* Center */
-		*samples_out++ = 0.0f;		/* LFE */
-		*samples_out++ = late[2];	/* Rear Left */
-		*samples_out++ = late[3];	/* Rear Right */
+		samples_in += count;
+		sample_count -= count;
 	}
 
 	return squared_sum;
@@ -1012,40 +1521,47 @@ static inline float DspReverb_INTERNAL_Process_1_to_5p1(
 
 static inline float DspReverb_INTERNAL_Process_2_to_2(
 	DspReverb *reverb,
-	float *restrict samples_in,
-	float *restrict samples_out,
+	float *samples_in,
+	float *samples_out,
 	size_t sample_count
 ) {
-	const float *in_end = samples_in + sample_count;
-	float in, early, late[2];
+	float in[DSP_MAX_BLOCK_SIZE];
+	float late[2][DSP_MAX_BLOCK_SIZE];
+	float wet[DSP_MAX_BLOCK_SIZE];
+	float out[2];
 	float squared_sum = 0;
+	size_t frame_count = sample_count / 2;
+	uint32_t count, i;
 
-	while (samples_in < in_end)
+	while (frame_count > 0)
 	{
+		count = (uint32_t) FAudio_min(frame_count, DSP_MAX_BLOCK_SIZE);
+
 		/* Input - Combine 2 channels into 1 */
-		in = (samples_in[0] + samples_in[1]) / 2.0f;
+		for (i = 0; i < count; i += 1)
+		{
+			in[i] = (samples_in[i * 2] + samples_in[i * 2 + 1]) / 2.0f;
+		}
 
-		/* Early Reflections */
-		early = DspReverb_INTERNAL_ProcessEarly(reverb, in);
+		/* Reverberation */
+		DspReverb_INTERNAL_ProcessBlock(reverb, in, late, count);
+		FAPOParameterRamp_FillEXT(&reverb->wet_ratio, wet, count);
 
-		/* Reverberation with Wet/Dry Mix */
-		late[0] = (DspReverb_INTERNAL_ProcessChannel(
-			reverb,
-			&reverb->channel[0],
-			early
-		) * reverb->wet_ratio) + samples_in[0] * reverb->dry_ratio;
-		late[1] = (DspReverb_INTERNAL_ProcessChannel(
-			reverb,
-			&reverb->channel[1],
-			early
-		) * reverb->wet_ratio) + samples_in[1] * reverb->dry_ratio;
-		squared_sum += (late[0] * late[0]) + (late[1] * late[1]);
+		for (i = 0; i < count; i += 1)
+		{
+			/* Wet/Dry Mix */
+			out[0] = (late[0][i] * wet[i]) + samples_in[0] * (1.0f - wet[i]);
+			out[1] = (late[1][i] * wet[i]) + samples_in[1] * (1.0f - wet[i]);
+			squared_sum += (out[0] * out[0]) + (out[1] * out[1]);
+
+			/* Output */
+			*samples_out++ = out[0];
+			*samples_out++ = out[1];
 
-		/* Output */
-		*samples_out++ = late[0];
-		*samples_out++ = late[1];
+			samples_in += 2;
+		}
 
-		samples_in += 2;
+		frame_count -= count;
 	}
 
 	return squared_sum;
@@ -1057,39 +1573,50 @@ static inline float DspReverb_INTERNAL_Process_2_to_5p1(
 	float *restrict samples_out,
 	size_t sample_count
 ) {
-	const float *in_end = samples_in + sample_count;
-	float in, in_ratio, early, late[4];
+	float in[DSP_MAX_BLOCK_SIZE];
+	float late[4][DSP_MAX_BLOCK_SIZE];
+	float wet[DSP_MAX_BLOCK_SIZE];
+	float in_ratio, out[4];
 	float squared_sum = 0;
+	size_t frame_count = sample_count / 2;
+	uint32_t count, i;
 	int32_t c;
 
-	while (samples_in < in_end)
+	while (frame_count > 0)
 	{
+		count = (uint32_t) FAudio_min(frame_count, DSP_MAX_BLOCK_SIZE);
+
 		/* Input - Combine 2 channels into 1 */
-		in = (samples_in[0] + samples_in[1]) / 2.0f;
-		in_ratio = in * reverb->dry_ratio;
-		samples_in += 2;
+		for (i = 0; i < count; i += 1)
+		{
+			in[i] = (samples_in[0] + samples_in[1]) / 2.0f;
+			samples_in += 2;
+		}
 
-		/* Early Reflections */
-		early = DspReverb_INTERNAL_ProcessEarly(reverb, in);
+		/* Reverberation */
+		DspReverb_INTERNAL_ProcessBlock(reverb, in, late, count);
+		FAPOParameterRamp_FillEXT(&reverb->wet_ratio, wet, count);
 
-		/* Reverberation with Wet/Dry Mix */
-		for (c = 0; c < 4; c += 1)
+		for (i = 0; i < count; i += 1)
 		{
-			late[c] = (DspReverb_INTERNAL_ProcessChannel(
-				reverb,
-				&reverb->channel[c],
-				early
-			) * reverb->wet_ratio) + in_ratio;
-			squared_sum += late[c] * late[c];
+			/* Wet/Dry Mix */
+			in_ratio = in[i] * (1.0f - wet[i]);
+			for (c = 0; c < 4; c += 1)
+			{
+				out[c] = (late[c][i] * wet[i]) + in_ratio;
+				squared_sum += out[c] * out[c];
+			}
+
+			/* Output */
+			*samples_out++ = out[0];	/* Front Left */
+			*samples_out++ = out[1];	/* Front Right */
+			*samples_out++ = 0.0f;		/* Center */
+			*samples_out++ = 0.0f;		/* LFE */
+			*samples_out++ = out[2];	/* Rear Left */
+			*samples_out++ = out[3];	/* Rear Right */
 		}
 
-		/* Output */
-		*samples_out++ = late[0];	/* Front Left */
-		*samples_out++ = late[1];	/* Front Right */
-		*samples_out++ = 0.0f;		/* Center */
-		*samples_out++ = 0.0f;		/* LFE */
-		*samples_out++ = late[2];	/* Rear Left */
-		*samples_out++ = late[3];	/* Rear Right */
+		frame_count -= count;
 	}
 
 	return squared_sum;
@@ -1097,45 +1624,57 @@ static inline float DspReverb_INTERNAL_Process_2_to_5p1(
 
 static inline float DspReverb_INTERNAL_Process_5p1_to_5p1(
 	DspReverb *reverb,
-	float *restrict samples_in,
-	float *restrict samples_out,
+	float *samples_in,
+	float *samples_out,
 	size_t sample_count
 ) {
-	const float *in_end = samples_in + sample_count;
-	float in, in_ratio, early, late[5];
+	float in[DSP_MAX_BLOCK_SIZE];
+	float late[5][DSP_MAX_BLOCK_SIZE];
+	float wet[DSP_MAX_BLOCK_SIZE];
+	float in_ratio, out[5];
 	float squared_sum = 0;
+	size_t frame_count = sample_count / 6;
+	uint32_t count, i;
 	int32_t c;
 
-	while (samples_in < in_end)
+	while (frame_count > 0)
 	{
+		count = (uint32_t) FAudio_min(frame_count, DSP_MAX_BLOCK_SIZE);
+
 		/* Input - Combine non-LFE channels into 1 */
-		in = (samples_in[0] + samples_in[1] + samples_in[2] +
-				samples_in[4] + samples_in[5]) / 5.0f;
-		in_ratio = in * reverb->dry_ratio;
+		for (i = 0; i < count; i += 1)
+		{
+			in[i] = (samples_in[i * 6] + samples_in[i * 6 + 1] +
+					samples_in[i * 6 + 2] + samples_in[i * 6 + 4] +
+					samples_in[i * 6 + 5]) / 5.0f;
+		}
 
-		/* Early Reflections */
-		early = DspReverb_INTERNAL_ProcessEarly(reverb, in);
+		/* Reverberation */
+		DspReverb_INTERNAL_ProcessBlock(reverb, in, late, count);
+		FAPOParameterRamp_FillEXT(&reverb->wet_ratio, wet, count);
 
-		/* Reverberation with Wet/Dry Mix */
-		for (c = 0; c < 5; c += 1)
+		for (i = 0; i < count; i += 1)
 		{
-			late[c] = (DspReverb_INTERNAL_ProcessChannel(
-				reverb,
-				&reverb->channel[c],
-				early
-			) * reverb->wet_ratio) + in_ratio;
-			squared_sum += late[c] * late[c];
-		}
+			/* Wet/Dry Mix */
+			in_ratio = in[i] * (1.0f - wet[i]);
+			for (c = 0; c < 5; c += 1)
+			{
+				out[c] = (late[c][i] * wet[i]) + in_ratio;
+				squared_sum += out[c] * out[c];
+			}
+
+			/* Output */
+			*samples_out++ = out[0];	/* Front Left */
+			*samples_out++ = out[1];	/* Front Right */
+			*samples_out++ = out[2];	/* Center */
+			*samples_out++ = samples_in[3];	/* LFE, pass through */
+			*samples_out++ = out[3];	/* Rear Left */
+			*samples_out++ = out[4];	/* Rear Right */
 
-		/* Output */
-		*samples_out++ = late[0];	/* Front Left */
-		*samples_out++ = late[1];	/* Front Right */
-		*samples_out++ = late[2];	/* Center */
-		*samples_out++ = samples_in[3];	/* LFE, pass through */
-		*samples_out++ = late[3];	/* Rear Left */
-		*samples_out++ = late[4];	/* Rear Right */
+			samples_in += 6;
+		}
 
-		samples_in += 6;
+		frame_count -= count;
 	}
 
 	return squared_sum;
@@ -1143,6 +1682,87 @@ static inline float DspReverb_INTERNAL_Process_5p1_to_5p1(
 
 #undef OUTPUT_SAMPLE
 
+/* Internal Network API, for FAPOFX_reverb.c */
+
+struct DspReverb* FAudio_INTERNAL_CreateReverbNetwork(
+	int32_t sampleRate,
+	int32_t channels,
+	uint8_t lowCPU,
+	FAudioMallocFunc pMalloc
+) {
+	DspReverb *reverb = (DspReverb*) pMalloc(sizeof(DspReverb));
+	if (reverb != NULL)
+	{
+		DspReverb_Create(
+			reverb,
+			sampleRate,
+			channels,
+			channels,
+			lowCPU,
+			pMalloc
+		);
+	}
+	return reverb;
+}
+
+void FAudio_INTERNAL_DestroyReverbNetwork(
+	struct DspReverb *reverb,
+	FAudioFreeFunc pFree
+) {
+	DspReverb_Destroy(reverb, pFree);
+	pFree(reverb);
+}
+
+void FAudio_INTERNAL_SetReverbNetworkParameters(
+	struct DspReverb *reverb,
+	const struct FAudioFXReverbParameters *params
+) {
+	DspReverb_SetParameters(reverb, (FAudioFXReverbParameters*) params, 0);
+}
+
+void FAudio_INTERNAL_ResetReverbNetwork(struct DspReverb *reverb)
+{
+	DspReverb_Reset(reverb);
+}
+
+uint8_t FAudio_INTERNAL_UpdateReverbNetworkSilence(
+	struct DspReverb *reverb,
+	uint8_t inputSilent,
+	uint32_t frames,
+	float total
+) {
+	return DspReverb_INTERNAL_UpdateSilence(
+		reverb,
+		inputSilent,
+		frames,
+		total
+	);
+}
+
+float FAudio_INTERNAL_ProcessReverbNetwork(
+	struct DspReverb *reverb,
+	float *buffer,
+	uint32_t frames
+) {
+	#define PROCESS(pin, pout) \
+		DspReverb_INTERNAL_Process_##pin##_to_##pout( \
+			reverb, \
+			buffer, \
+			buffer, \
+			frames * reverb->in_channels \
+		)
+	switch (reverb->out_channels)
+	{
+		case 1:
+			return PROCESS(1, 1);
+		case 2:
+			return PROCESS(2, 2);
+		default: /* 5.1 */
+			return PROCESS(5p1, 5p1);
+	}
+	#undef PROCESS
+}
+
 /* Reverb FAPO Implementation */
 
 const FAudioGUID FAudioFX_CLSID_AudioReverb = /* 2.7 */
@@ -1179,7 +1799,9 @@ static FAPORegistrationProperties ReverbProperties =
 		FAPO_FLAG_FRAMERATE_MUST_MATCH |
 		FAPO_FLAG_BITSPERSAMPLE_MUST_MATCH |
 		FAPO_FLAG_BUFFERCOUNT_MUST_MATCH |
-		FAPO_FLAG_INPLACE_SUPPORTED
+		FAPO_FLAG_INPLACE_SUPPORTED |
+		FAPO_FLAG_OVERWRITES_OUTPUT_EXT |
+		FAPO_FLAG_SILENCE_STAYS_SILENT_EXT
 	),
 	/*.MinInputBufferCount = */ 1,
 	/*.MaxInputBufferCount = */ 1,
@@ -1199,6 +1821,9 @@ typedef struct FAudioFXReverb
 
 	uint8_t apiVersion;
 	DspReverb reverb;
+
+	/* Set from any thread, read when new parameters arrive */
+	volatile int32_t rampFrames;
 } FAudioFXReverb;
 
 static inline int8_t IsFloatFormat(const FAudioWaveFormatEx *format)
@@ -1406,6 +2031,7 @@ uint32_t FAudioFXReverb_LockForProcess(
 		fapo->sampleRate,
 		fapo->inChannels,
 		fapo->outChannels,
+		0,
 		fapo->base.pMalloc
 	);
 
@@ -1414,14 +2040,16 @@ uint32_t FAudioFXReverb_LockForProcess(
 	{
 		DspReverb_SetParameters9(
 			&fapo->reverb,
-			(FAudioFXReverbParameters9*) fapo->base.m_pParameterBlocks
+			(FAudioFXReverbParameters9*) fapo->base.m_pParameterBlocks,
+			0
 		);
 	}
 	else
 	{
 		DspReverb_SetParameters(
 			&fapo->reverb,
-			(FAudioFXReverbParameters*) fapo->base.m_pParameterBlocks
+			(FAudioFXReverbParameters*) fapo->base.m_pParameterBlocks,
+			0
 		);
 	}
 
@@ -1504,6 +2132,8 @@ void FAudioFXReverb_Process(
 ) {
 	FAudioFXReverbParameters *params;
 	uint8_t update_params = FAPOBase_ParametersChanged(&fapo->base);
+	uint32_t ramp_frames;
+	uint64_t fpstate;
 	float total;
 
 	params = (FAudioFXReverbParameters*) FAPOBase_BeginProcess(&fapo->base);
@@ -1511,16 +2141,20 @@ void FAudioFXReverb_Process(
 	/* Update parameters before doing anything else  */
 	if (update_params)
 	{
+		ramp_frames = (uint32_t) FAudio_PlatformAtomicGet(
+			&fapo->rampFrames
+		);
 		if (fapo->apiVersion == 9)
 		{
 			DspReverb_SetParameters9(
 				&fapo->reverb,
-				(FAudioFXReverbParameters9*) params
+				(FAudioFXReverbParameters9*) params,
+				ramp_frames
 			);
 		}
 		else
 		{
-			DspReverb_SetParameters(&fapo->reverb, params);
+			DspReverb_SetParameters(&fapo->reverb, params, ramp_frames);
 		}
 	}
 	
@@ -1553,6 +2187,11 @@ void FAudioFXReverb_Process(
 		);
 	}
 
+	/* The feedback paths decay into denormals after the input goes silent,
+	 * so flush them to zero for the whole buffer
+	 */
+	fpstate = FAudio_INTERNAL_FlushDenormals();
+
 	/* Run reverb effect */
 	#define PROCESS(pin, pout) \
 		DspReverb_INTERNAL_Process_##pin##_to_##pout( \
@@ -1586,43 +2225,31 @@ void FAudioFXReverb_Process(
 	}
 	#undef PROCESS
 
+	FAudio_INTERNAL_RestoreDenormals(fpstate);
+
 	/* Set BufferFlags to silent so PLAY_TAILS knows when to stop */
-	pOutputProcessParameters->BufferFlags = (total < 0.0000001f) ?
-		FAPO_BUFFER_SILENT :
-		FAPO_BUFFER_VALID;
+	pOutputProcessParameters->BufferFlags = DspReverb_INTERNAL_UpdateSilence(
+		&fapo->reverb,
+		pInputProcessParameters->BufferFlags == FAPO_BUFFER_SILENT,
+		pInputProcessParameters->ValidFrameCount,
+		total
+	) ? FAPO_BUFFER_SILENT : FAPO_BUFFER_VALID;
 
 	FAPOBase_EndProcess(&fapo->base);
 }
 
 void FAudioFXReverb_Reset(FAudioFXReverb *fapo)
 {
-	int32_t i, c;
 	FAPOBase_Reset(&fapo->base);
 
 	/* Reset the cached state of the reverb filter */
-	DspDelay_Reset(&fapo->reverb.early_delay);
-
-	for (i = 0; i < REVERB_COUNT_APF_IN; i += 1)
-	{
-		DspAllPass_Reset(&fapo->reverb.apf_in[i]);
-	}
-
-	for (c = 0; c < fapo->reverb.reverb_channels; c += 1)
-	{
-		DspDelay_Reset(&fapo->reverb.channel[c].reverb_delay);
-
-		for (i = 0; i < REVERB_COUNT_COMB; i += 1)
-		{
-			DspCombShelving_Reset(&fapo->reverb.channel[c].lpf_comb[i]);
-		}
-
-		DspBiQuad_Reset(&fapo->reverb.channel[c].room_high_shelf);
+	DspReverb_Reset(&fapo->reverb);
+}
 
-		for (i = 0; i < REVERB_COUNT_APF_OUT; i += 1)
-		{
-			DspAllPass_Reset(&fapo->reverb.channel[c].apf_out[i]);
-		}
-	}
+void FAudioFXReverb_SetParameterRampEXT(FAPO *pReverb, uint32_t FrameCount)
+{
+	FAudioFXReverb *fapo = (FAudioFXReverb*) pReverb;
+	FAudio_PlatformAtomicSet(&fapo->rampFrames, (int32_t) FrameCount);
 }
 
 void FAudioFXReverb_Free(void* fapo)
@@ -1707,6 +2334,7 @@ uint32_t FAudioCreateReverbWithCustomAllocatorEXT(
 	result->outChannels = 0;
 	result->sampleRate = 0;
 	FAudio_zero(&result->reverb, sizeof(DspReverb));
+	result->rampFrames = 0;
 
 	/* Function table... */
 	#define ASSIGN_VT(name) \
@@ -1877,6 +2505,7 @@ uint32_t FAudioCreateReverb9WithCustomAllocatorEXT(
 	result->outChannels = 0;
 	result->sampleRate = 0;
 	FAudio_zero(&result->reverb, sizeof(DspReverb));
+	result->rampFrames = 0;
 
 	/* Function table... */
 	#define ASSIGN_VT(name) \
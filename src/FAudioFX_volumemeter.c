@@ -74,12 +74,206 @@ static FAPORegistrationProperties VolumeMeterProperties =
 	/*.MaxOutputBufferCount =*/ 1
 };
 
+/* The meter reads the interleaved buffer as one flat stream of vectors. Lane
+ * l of vector v always holds channel ((4 * v) + l) % channels, and the pattern
+ * repeats every lcm(channels, 4) samples. So the meter keeps one peak and one
+ * total accumulator per vector in that period, and sorts the lanes back into
+ * channels once at the end. Short periods are repeated until there are at
+ * least 4 vectors, so the adds don't wait on each other. Layouts with a period
+ * longer than VOLUMEMETER_MAX_VECTORS vectors (odd channel counts above 8)
+ * fall back to the scalar loop.
+ */
+
+#define VOLUMEMETER_MAX_VECTORS 8
+
 typedef struct FAudioFXVolumeMeter
 {
 	FAPOBase base;
 	uint16_t channels;
+
+	/* VolumeMeterHistoryEXT, allocated at creation so readers never see it
+	 * go away. Each entry is [peak][rms], ChannelCount floats each.
+	 */
+	float *history;
+	uint32_t historyChannels;
+	uint32_t historyLength;
+	uint32_t decimation;
+	volatile int32_t historyWritten;
+
+	/* The entry being collected, [peak][total] */
+	float *pending;
+	uint32_t pendingQuanta;
+	uint32_t pendingFrames;
 } FAudioFXVolumeMeter;
 
+/* Writes the peak and the sum of squares of each channel */
+static void FAudioFXVolumeMeter_INTERNAL_Measure(
+	const float *buffer,
+	uint32_t frames,
+	uint16_t channels,
+	float *peak,
+	float *total
+) {
+	uint32_t i;
+	uint16_t c;
+	float sample, sampleAbs;
+#if HAVE_SSE2_INTRINSICS || HAVE_NEON_INTRINSICS
+	uint32_t vectors, period, periods, v;
+	float lanes[2][VOLUMEMETER_MAX_VECTORS * 4];
+#if HAVE_SSE2_INTRINSICS
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	__m128 vpeak[VOLUMEMETER_MAX_VECTORS], vtotal[VOLUMEMETER_MAX_VECTORS];
+	__m128 in;
+#else
+	float32x4_t vpeak[VOLUMEMETER_MAX_VECTORS], vtotal[VOLUMEMETER_MAX_VECTORS];
+	float32x4_t in;
+#endif
+#endif
+
+	FAudio_zero(peak, channels * sizeof(float));
+	FAudio_zero(total, channels * sizeof(float));
+
+#if HAVE_SSE2_INTRINSICS || HAVE_NEON_INTRINSICS
+	/* Vectors per period: lcm(channels, 4) / 4 */
+	if ((channels % 4) == 0)
+	{
+		vectors = channels / 4;
+	}
+	else if ((channels % 2) == 0)
+	{
+		vectors = channels / 2;
+	}
+	else
+	{
+		vectors = channels;
+	}
+	while (vectors < 4)
+	{
+		vectors *= 2;
+	}
+
+	if (vectors <= VOLUMEMETER_MAX_VECTORS)
+	{
+		period = vectors * 4;
+		periods = (frames * channels) / period;
+
+		for (v = 0; v < vectors; v += 1)
+		{
+#if HAVE_SSE2_INTRINSICS
+			vpeak[v] = _mm_setzero_ps();
+			vtotal[v] = _mm_setzero_ps();
+#else
+			vpeak[v] = vdupq_n_f32(0.0f);
+			vtotal[v] = vdupq_n_f32(0.0f);
+#endif
+		}
+
+		for (i = 0; i < periods; i += 1)
+		{
+			for (v = 0; v < vectors; v += 1, buffer += 4)
+			{
+#if HAVE_SSE2_INTRINSICS
+				in = _mm_loadu_ps(buffer);
+				vpeak[v] = _mm_max_ps(vpeak[v], _mm_andnot_ps(sign, in));
+				vtotal[v] = _mm_add_ps(vtotal[v], _mm_mul_ps(in, in));
+#else
+				in = vld1q_f32(buffer);
+				vpeak[v] = vmaxq_f32(vpeak[v], vabsq_f32(in));
+				vtotal[v] = vaddq_f32(vtotal[v], vmulq_f32(in, in));
+#endif
+			}
+		}
+
+		/* Sort the lanes back into channels */
+		for (v = 0; v < vectors; v += 1)
+		{
+#if HAVE_SSE2_INTRINSICS
+			_mm_storeu_ps(&lanes[0][v * 4], vpeak[v]);
+			_mm_storeu_ps(&lanes[1][v * 4], vtotal[v]);
+#else
+			vst1q_f32(&lanes[0][v * 4], vpeak[v]);
+			vst1q_f32(&lanes[1][v * 4], vtotal[v]);
+#endif
+		}
+		for (v = 0, c = 0; v < period; v += 1)
+		{
+			if (lanes[0][v] > peak[c])
+			{
+				peak[c] = lanes[0][v];
+			}
+			total[c] += lanes[1][v];
+			c += 1;
+			if (c == channels)
+			{
+				c = 0;
+			}
+		}
+
+		/* Periods are whole frames, so the rest starts on a frame */
+		frames -= (periods * period) / channels;
+	}
+#endif
+
+	for (i = 0; i < frames; i += 1, buffer += channels)
+	{
+		for (c = 0; c < channels; c += 1)
+		{
+			sample = buffer[c];
+			sampleAbs = FAudio_fabsf(sample);
+			peak[c] = (sampleAbs > peak[c]) ? sampleAbs : peak[c];
+			total[c] += sample * sample;
+		}
+	}
+}
+
+/* Adds a quantum to the pending history entry, and publishes the entry once
+ * it covers Decimation quanta. There's only ever one writer, so the entry is
+ * filled in first and then made visible by bumping historyWritten.
+ */
+static void FAudioFXVolumeMeter_INTERNAL_UpdateHistory(
+	FAudioFXVolumeMeter *fapo,
+	const float *peak,
+	const float *total,
+	uint32_t frames
+) {
+	uint32_t c, written;
+	float *entry;
+	float *pendingPeak = fapo->pending;
+	float *pendingTotal = fapo->pending + fapo->historyChannels;
+
+	for (c = 0; c < fapo->historyChannels; c += 1)
+	{
+		if (peak[c] > pendingPeak[c])
+		{
+			pendingPeak[c] = peak[c];
+		}
+		pendingTotal[c] += total[c];
+	}
+	fapo->pendingFrames += frames;
+	fapo->pendingQuanta += 1;
+	if (fapo->pendingQuanta < fapo->decimation)
+	{
+		return;
+	}
+
+	written = (uint32_t) FAudio_PlatformAtomicGet(&fapo->historyWritten);
+	entry = fapo->history + (
+		(written % fapo->historyLength) * fapo->historyChannels * 2
+	);
+	for (c = 0; c < fapo->historyChannels; c += 1)
+	{
+		entry[c] = pendingPeak[c];
+		entry[fapo->historyChannels + c] = (fapo->pendingFrames > 0) ?
+			FAudio_sqrtf(pendingTotal[c] / fapo->pendingFrames) :
+			0.0f;
+	}
+	FAudio_PlatformAtomicSet(&fapo->historyWritten, (int32_t) (written + 1));
+
+	FAudio_zero(fapo->pending, fapo->historyChannels * 2 * sizeof(float));
+	fapo->pendingQuanta = 0;
+	fapo->pendingFrames = 0;
+}
+
 uint32_t FAudioFXVolumeMeter_LockForProcess(
 	FAudioFXVolumeMeter *fapo,
 	uint32_t InputLockedParameterCount,
@@ -117,6 +311,13 @@ uint32_t FAudioFXVolumeMeter_LockForProcess(
 		return FAUDIO_E_INVALID_ARG;
 	}
 
+	/* The history was sized for one channel count when it was created */
+	if (	fapo->history != NULL &&
+		pInputLockedParameters->pFormat->nChannels != fapo->historyChannels	)
+	{
+		return FAPO_E_FORMAT_UNSUPPORTED;
+	}
+
 	/* Allocate volume meter arrays */
 	fapo->channels = pInputLockedParameters->pFormat->nChannels;
 	levels[0].pPeakLevels = (float*) fapo->base.pMalloc(
@@ -149,34 +350,37 @@ void FAudioFXVolumeMeter_Process(
 	FAPOProcessBufferParameters* pOutputProcessParameters,
 	int32_t IsEnabled
 ) {
-	float peak;
-	float total;
-	float *buffer;
-	uint32_t i, j;
+	uint32_t i;
+	const uint32_t frames = pInputProcessParameters->ValidFrameCount;
 	FAudioFXVolumeMeterLevels *levels = (FAudioFXVolumeMeterLevels*)
 		FAPOBase_BeginProcess(&fapo->base);
 
-	/* TODO: This could probably be SIMD-ified... */
-	for (i = 0; i < fapo->channels; i += 1)
+	/* The RMS levels hold the sums of squares until the end */
+	FAudioFXVolumeMeter_INTERNAL_Measure(
+		(const float*) pInputProcessParameters->pBuffer,
+		frames,
+		fapo->channels,
+		levels->pPeakLevels,
+		levels->pRMSLevels
+	);
+
+	if (fapo->history != NULL)
 	{
-		peak = 0.0f;
-		total = 0.0f;
-		buffer = ((float*) pInputProcessParameters->pBuffer) + i;
-		for (j = 0; j < pInputProcessParameters->ValidFrameCount; j += 1, buffer += fapo->channels)
-		{
-			const float sampleAbs = FAudio_fabsf(*buffer);
-			if (sampleAbs > peak)
-			{
-				peak = sampleAbs;
-			}
-			total += (*buffer) * (*buffer);
-		}
-		levels->pPeakLevels[i] = peak;
-		levels->pRMSLevels[i] = FAudio_sqrtf(
-			total / pInputProcessParameters->ValidFrameCount
+		FAudioFXVolumeMeter_INTERNAL_UpdateHistory(
+			fapo,
+			levels->pPeakLevels,
+			levels->pRMSLevels,
+			frames
 		);
 	}
 
+	for (i = 0; i < fapo->channels; i += 1)
+	{
+		levels->pRMSLevels[i] = (frames > 0) ?
+			FAudio_sqrtf(levels->pRMSLevels[i] / frames) :
+			0.0f;
+	}
+
 	FAPOBase_EndProcess(&fapo->base);
 }
 
@@ -212,6 +416,10 @@ void FAudioFXVolumeMeter_GetParameters(
 void FAudioFXVolumeMeter_Free(void* fapo)
 {
 	FAudioFXVolumeMeter *volumemeter = (FAudioFXVolumeMeter*) fapo;
+	if (volumemeter->history != NULL)
+	{
+		volumemeter->base.pFree(volumemeter->history);
+	}
 	volumemeter->base.pFree(volumemeter->base.m_pParameterBlocks);
 	volumemeter->base.pFree(fapo);
 }
@@ -262,6 +470,9 @@ uint32_t FAudioCreateVolumeMeterWithCustomAllocatorEXT(
 		customRealloc
 	);
 
+	result->history = NULL;
+	result->pending = NULL;
+
 	/* Function table... */
 	result->base.base.LockForProcess = (LockForProcessFunc)
 		FAudioFXVolumeMeter_LockForProcess;
@@ -278,4 +489,154 @@ uint32_t FAudioCreateVolumeMeterWithCustomAllocatorEXT(
 	return 0;
 }
 
+uint32_t FAudioCreateVolumeMeterWithHistoryEXT(
+	FAPO** ppApo,
+	const FAudioFXVolumeMeterHistoryEXT *pHistory,
+	uint32_t Flags
+) {
+	return FAudioCreateVolumeMeterWithHistoryAndCustomAllocatorEXT(
+		ppApo,
+		pHistory,
+		Flags,
+		FAudio_malloc,
+		FAudio_free,
+		FAudio_realloc
+	);
+}
+
+uint32_t FAudioCreateVolumeMeterWithHistoryAndCustomAllocatorEXT(
+	FAPO** ppApo,
+	const FAudioFXVolumeMeterHistoryEXT *pHistory,
+	uint32_t Flags,
+	FAudioMallocFunc customMalloc,
+	FAudioFreeFunc customFree,
+	FAudioReallocFunc customRealloc
+) {
+	FAudioFXVolumeMeter *result;
+	uint32_t entries;
+	float *history;
+
+	if (	pHistory == NULL ||
+		pHistory->ChannelCount == 0 ||
+		pHistory->ChannelCount > FAUDIO_MAX_AUDIO_CHANNELS ||
+		pHistory->HistoryLength < 2 ||
+		pHistory->Decimation == 0	)
+	{
+		return FAUDIO_E_INVALID_ARG;
+	}
+
+	/* History entries, then the pending entry */
+	entries = pHistory->HistoryLength + 1;
+	history = (float*) customMalloc(
+		entries * pHistory->ChannelCount * 2 * sizeof(float)
+	);
+	if (history == NULL)
+	{
+		return FAUDIO_E_OUT_OF_MEMORY;
+	}
+	FAudio_zero(
+		history,
+		entries * pHistory->ChannelCount * 2 * sizeof(float)
+	);
+
+	FAudioCreateVolumeMeterWithCustomAllocatorEXT(
+		ppApo,
+		Flags,
+		customMalloc,
+		customFree,
+		customRealloc
+	);
+	result = (FAudioFXVolumeMeter*) *ppApo;
+	result->history = history;
+	result->historyChannels = pHistory->ChannelCount;
+	result->historyLength = pHistory->HistoryLength;
+	result->decimation = pHistory->Decimation;
+	result->historyWritten = 0;
+	result->pending = history + (
+		pHistory->HistoryLength * pHistory->ChannelCount * 2
+	);
+	result->pendingQuanta = 0;
+	result->pendingFrames = 0;
+	return 0;
+}
+
+uint32_t FAudioFXVolumeMeter_GetHistoryEXT(
+	FAPO *pVolumeMeter,
+	float *pPeakLevels,
+	float *pRMSLevels,
+	uint32_t EntryCount,
+	uint32_t *pTotalEntries
+) {
+	FAudioFXVolumeMeter *fapo = (FAudioFXVolumeMeter*) pVolumeMeter;
+	uint32_t first, last, check, valid, count, i, c, skip;
+	const float *entry;
+
+	if (fapo->history == NULL)
+	{
+		if (pTotalEntries != NULL)
+		{
+			*pTotalEntries = 0;
+		}
+		return 0;
+	}
+
+	/* The slot after the newest entry may be mid-write, so only
+	 * HistoryLength - 1 entries are safe to read
+	 */
+	last = (uint32_t) FAudio_PlatformAtomicGet(&fapo->historyWritten);
+	count = FAudio_min(FAudio_min(last, fapo->historyLength - 1), EntryCount);
+	first = last - count;
+
+	for (i = 0; i < count; i += 1)
+	{
+		entry = fapo->history + (
+			((first + i) % fapo->historyLength) * fapo->historyChannels * 2
+		);
+		for (c = 0; c < fapo->historyChannels; c += 1)
+		{
+			if (pPeakLevels != NULL)
+			{
+				pPeakLevels[(i * fapo->historyChannels) + c] = entry[c];
+			}
+			if (pRMSLevels != NULL)
+			{
+				pRMSLevels[(i * fapo->historyChannels) + c] = entry[fapo->historyChannels + c];
+			}
+		}
+	}
+
+	/* If the writer caught up with us while copying, the oldest entries
+	 * may be torn. Drop them and move the rest to the front.
+	 */
+	check = (uint32_t) FAudio_PlatformAtomicGet(&fapo->historyWritten);
+	valid = check - (fapo->historyLength - 1);
+	if ((int32_t) (valid - first) > 0)
+	{
+		skip = FAudio_min(valid - first, count);
+		count -= skip;
+		if (pPeakLevels != NULL)
+		{
+			FAudio_memmove(
+				pPeakLevels,
+				pPeakLevels + (skip * fapo->historyChannels),
+				count * fapo->historyChannels * sizeof(float)
+			);
+		}
+		if (pRMSLevels != NULL)
+		{
+			FAudio_memmove(
+				pRMSLevels,
+				pRMSLevels + (skip * fapo->historyChannels),
+				count * fapo->historyChannels * sizeof(float)
+			);
+		}
+	}
+
+	if (pTotalEntries != NULL)
+	{
+		*pTotalEntries = last;
+	}
+	return count;
+}
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
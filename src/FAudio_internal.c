@@ -294,6 +294,76 @@ void FAudio_INTERNAL_InsertSubmixSorted(
 	FAudio_PlatformUnlockMutex(lock);
 }
 
+/* Triple buffer state bits: the reader's slot, the shared slot, the writer's
+ * slot, whether the shared slot is newer than the reader's, and whether a
+ * writer is currently filling its slot.
+ */
+#define TRIPLEBUFFER_READER(state)	((state) & 0x3)
+#define TRIPLEBUFFER_SHARED(state)	(((state) >> 2) & 0x3)
+#define TRIPLEBUFFER_WRITER(state)	(((state) >> 4) & 0x3)
+#define TRIPLEBUFFER_NEW		0x40
+#define TRIPLEBUFFER_BUSY		0x80
+
+uint32_t FAudio_INTERNAL_TripleBufferBeginWrite(volatile int32_t *state)
+{
+	int32_t oldState;
+
+	/* Writers only ever wait for each other, never for the reader */
+	do
+	{
+		oldState = FAudio_PlatformAtomicGet(state) & ~TRIPLEBUFFER_BUSY;
+	} while (!FAudio_PlatformAtomicCAS(state, oldState, oldState | TRIPLEBUFFER_BUSY));
+
+	return TRIPLEBUFFER_WRITER(oldState);
+}
+
+void FAudio_INTERNAL_TripleBufferEndWrite(volatile int32_t *state)
+{
+	int32_t oldState, newState;
+
+	/* Swap the writer's slot with the shared one and mark it as new */
+	do
+	{
+		oldState = FAudio_PlatformAtomicGet(state);
+		newState = (
+			TRIPLEBUFFER_READER(oldState) |
+			(TRIPLEBUFFER_WRITER(oldState) << 2) |
+			(TRIPLEBUFFER_SHARED(oldState) << 4) |
+			TRIPLEBUFFER_NEW
+		);
+	} while (!FAudio_PlatformAtomicCAS(state, oldState, newState));
+}
+
+uint8_t FAudio_INTERNAL_TripleBufferAcquire(volatile int32_t *state)
+{
+	int32_t oldState, newState;
+
+	/* Swap the reader's slot with the shared one, if it has anything new.
+	 * Only the reader clears TRIPLEBUFFER_NEW, so this only retries when a
+	 * writer got in between.
+	 */
+	do
+	{
+		oldState = FAudio_PlatformAtomicGet(state);
+		if (!(oldState & TRIPLEBUFFER_NEW))
+		{
+			return 0;
+		}
+		newState = (
+			TRIPLEBUFFER_SHARED(oldState) |
+			(TRIPLEBUFFER_READER(oldState) << 2) |
+			(oldState & (0x3 << 4)) |
+			(oldState & TRIPLEBUFFER_BUSY)
+		);
+	} while (!FAudio_PlatformAtomicCAS(state, oldState, newState));
+	return 1;
+}
+
+uint32_t FAudio_INTERNAL_TripleBufferReadSlot(volatile int32_t *state)
+{
+	return TRIPLEBUFFER_READER(FAudio_PlatformAtomicGet(state));
+}
+
 static uint32_t FAudio_INTERNAL_GetBytesRequested(
 	FAudioSourceVoice *voice,
 	uint32_t decoding
@@ -642,20 +712,47 @@ static void FAudio_INTERNAL_ResizeEffectChainCache(FAudio *audio, uint32_t sampl
 	if (samples > audio->effectChainSamples)
 	{
 		audio->effectChainSamples = samples;
-		audio->effectChainCache = (float*) audio->pRealloc(
-			audio->effectChainCache,
+		audio->effectChainCache[0] = (float*) audio->pRealloc(
+			audio->effectChainCache[0],
+			sizeof(float) * audio->effectChainSamples
+		);
+		audio->effectChainCache[1] = (float*) audio->pRealloc(
+			audio->effectChainCache[1],
 			sizeof(float) * audio->effectChainSamples
 		);
 	}
 	LOG_FUNC_EXIT(audio)
 }
 
+/* Only used when a filter has run on a silent buffer, since the filter's state
+ * may still be ringing. Everywhere else, the mixer knows whether it wrote
+ * anything and passes that down instead of looking at the samples.
+ */
+static inline FAPOBufferFlags FAudio_INTERNAL_GetBufferFlags(
+	const float *buffer,
+	uint32_t samples
+) {
+	uint32_t i;
+	for (i = 0; i < samples; i += 1)
+	{
+		if (buffer[i] != 0.0f)
+		{
+			return FAPO_BUFFER_VALID;
+		}
+	}
+	return FAPO_BUFFER_SILENT;
+}
+
 static inline float *FAudio_INTERNAL_ProcessEffectChain(
 	FAudioVoice *voice,
 	float *buffer,
-	uint32_t *samples
+	float *output,
+	uint32_t *samples,
+	FAPOBufferFlags flags
 ) {
 	uint32_t i;
+	uint32_t maxChannels, lastCopy;
+	uint8_t cache, newParameters;
 	FAPO *fapo;
 	FAPOProcessBufferParameters srcParams, dstParams;
 
@@ -663,22 +760,40 @@ static inline float *FAudio_INTERNAL_ProcessEffectChain(
 
 	/* Set up the buffer to be written into */
 	srcParams.pBuffer = buffer;
-	srcParams.BufferFlags = FAPO_BUFFER_SILENT;
+	srcParams.BufferFlags = flags;
 	srcParams.ValidFrameCount = *samples;
-	for (i = 0; i < srcParams.ValidFrameCount; i += 1)
-	{
-		if (buffer[i] != 0.0f) /* Arbitrary! */
-		{
-			srcParams.BufferFlags = FAPO_BUFFER_VALID;
-			break;
-		}
-	}
 
 	/* Initialize output parameters to something sane */
 	dstParams.pBuffer = srcParams.pBuffer;
 	dstParams.BufferFlags = FAPO_BUFFER_VALID;
 	dstParams.ValidFrameCount = srcParams.ValidFrameCount;
 
+	/* Effects that can't process in place ping-pong between the two
+	 * effect chain caches, which have to be big enough before the first
+	 * one is written, since resizing them would move the data.
+	 */
+	maxChannels = 0;
+	lastCopy = voice->effects.count;
+	for (i = 0; i < voice->effects.count; i += 1)
+	{
+		if (!voice->effects.inPlaceProcessing[i])
+		{
+			maxChannels = FAudio_max(
+				maxChannels,
+				voice->effects.desc[i].OutputChannels
+			);
+			lastCopy = i;
+		}
+	}
+	if (maxChannels > 0)
+	{
+		FAudio_INTERNAL_ResizeEffectChainCache(
+			voice->audio,
+			maxChannels * srcParams.ValidFrameCount
+		);
+	}
+	cache = 0;
+
 	/* Update parameters, process! */
 	for (i = 0; i < voice->effects.count; i += 1)
 	{
@@ -686,36 +801,69 @@ static inline float *FAudio_INTERNAL_ProcessEffectChain(
 
 		if (!voice->effects.inPlaceProcessing[i])
 		{
-			if (dstParams.pBuffer == buffer)
+			/* The last copy can go straight to the output, as long
+			 * as it isn't also reading from it
+			 */
+			if (	i == lastCopy &&
+				output != NULL &&
+				srcParams.pBuffer != output	)
 			{
-				FAudio_INTERNAL_ResizeEffectChainCache(
-					voice->audio,
-					voice->effects.desc[i].OutputChannels * srcParams.ValidFrameCount
-				);
-				dstParams.pBuffer = voice->audio->effectChainCache;
+				dstParams.pBuffer = output;
 			}
 			else
 			{
-				/* FIXME: What if this is smaller because
-				 * inputChannels < desc[i].OutputChannels?
-				 */
-				dstParams.pBuffer = buffer;
+				dstParams.pBuffer = voice->audio->effectChainCache[cache];
+				cache ^= 1;
 			}
 
-			FAudio_zero(
-				dstParams.pBuffer,
-				voice->effects.desc[i].OutputChannels * srcParams.ValidFrameCount * sizeof(float)
-			);
+			if (!voice->effects.overwritesOutput[i])
+			{
+				FAudio_zero(
+					dstParams.pBuffer,
+					voice->effects.desc[i].OutputChannels * srcParams.ValidFrameCount * sizeof(float)
+				);
+			}
+		}
+
+		newParameters = FAudio_INTERNAL_TripleBufferAcquire(
+			&voice->effects.parameterStates[i]
+		);
+
+		/* An effect that promised silence stays silent has finished
+		 * its tail once it turned silence into silence, so until it
+		 * gets real input (or new parameters) again we already know
+		 * what it would write.
+		 */
+		if (	srcParams.BufferFlags == FAPO_BUFFER_SILENT &&
+			voice->effects.tailEnded[i] &&
+			!newParameters	)
+		{
+			if (	voice->effects.inPlaceProcessing[i] ||
+				voice->effects.overwritesOutput[i]	)
+			{
+				FAudio_zero(
+					dstParams.pBuffer,
+					voice->effects.desc[i].OutputChannels * srcParams.ValidFrameCount * sizeof(float)
+				);
+			}
+			dstParams.BufferFlags = FAPO_BUFFER_SILENT;
+			dstParams.ValidFrameCount = srcParams.ValidFrameCount;
+			FAudio_memcpy(&srcParams, &dstParams, sizeof(dstParams));
+			continue;
 		}
 
-		if (voice->effects.parameterUpdates[i])
+		if (newParameters)
 		{
 			fapo->SetParameters(
 				fapo,
-				voice->effects.parameters[i],
+				(uint8_t*) voice->effects.parameters[i] + (
+					voice->effects.parameterSizes[i] *
+					FAudio_INTERNAL_TripleBufferReadSlot(
+						&voice->effects.parameterStates[i]
+					)
+				),
 				voice->effects.parameterSizes[i]
 			);
-			voice->effects.parameterUpdates[i] = 0;
 		}
 
 		fapo->Process(
@@ -727,6 +875,24 @@ static inline float *FAudio_INTERNAL_ProcessEffectChain(
 			voice->effects.desc[i].InitialState
 		);
 
+		/* Effects that overwrite their output only promise to do so
+		 * when it's valid
+		 */
+		if (	dstParams.BufferFlags == FAPO_BUFFER_SILENT &&
+			!voice->effects.inPlaceProcessing[i] &&
+			voice->effects.overwritesOutput[i]	)
+		{
+			FAudio_zero(
+				dstParams.pBuffer,
+				voice->effects.desc[i].OutputChannels * dstParams.ValidFrameCount * sizeof(float)
+			);
+		}
+
+		voice->effects.tailEnded[i] = (
+			voice->effects.silenceStaysSilent[i] &&
+			srcParams.BufferFlags == FAPO_BUFFER_SILENT &&
+			dstParams.BufferFlags == FAPO_BUFFER_SILENT
+		);
 		FAudio_memcpy(&srcParams, &dstParams, sizeof(dstParams));
 	}
 
@@ -753,6 +919,149 @@ static void FAudio_INTERNAL_ResizeResampleCache(FAudio *audio, uint32_t samples)
        LOG_FUNC_EXIT(audio)
 }
 
+/* Volume Ramps */
+
+void FAudio_INTERNAL_RecalcMixMatrix(FAudioVoice *voice, uint32_t sendIndex)
+{
+	uint32_t oChan, s, d;
+	FAudioVoice *out = voice->sends.pSends[sendIndex].pOutputVoice;
+	float volume, *matrix = voice->mixCoefficients[sendIndex];
+
+	if (voice->type == FAUDIO_VOICE_SUBMIX)
+	{
+		volume = 1.f;
+	}
+	else
+	{
+		volume = voice->volume * voice->fadeVolume;
+	}
+
+	if (out->type == FAUDIO_VOICE_MASTER)
+	{
+		oChan = out->master.inputChannels;
+	}
+	else
+	{
+		oChan = out->mix.inputChannels;
+	}
+
+	for (d = 0; d < oChan; d += 1)
+	{
+		for (s = 0; s < voice->outputChannels; s += 1)
+		{
+			matrix[d * voice->outputChannels + s] = volume *
+				voice->channelVolume[s] *
+				voice->sendCoefficients[sendIndex][d * voice->outputChannels + s];
+		}
+	}
+}
+
+void FAudio_INTERNAL_FinishVolumeRamp(FAudioVoice *voice)
+{
+	uint32_t i, oChan;
+	FAudioVoice *out;
+
+	if (!voice->volumeRamp)
+	{
+		return;
+	}
+
+	for (i = 0; i < voice->sends.SendCount; i += 1)
+	{
+		out = voice->sends.pSends[i].pOutputVoice;
+		if (out->type == FAUDIO_VOICE_MASTER)
+		{
+			oChan = out->master.inputChannels;
+		}
+		else
+		{
+			oChan = out->mix.inputChannels;
+		}
+		FAudio_memcpy(
+			voice->rampCoefficients[i],
+			voice->mixCoefficients[i],
+			voice->outputChannels * oChan * sizeof(float)
+		);
+	}
+	voice->volumeRamp = 0;
+}
+
+/* Moves FadeVolumeEXT along by one quantum. Call with volumeLock held. */
+static void FAudio_INTERNAL_UpdateVolumeFade(FAudioVoice *voice)
+{
+	uint32_t i, step;
+
+	if (voice->fadeFrames == 0)
+	{
+		return;
+	}
+
+	step = FAudio_min(voice->fadeFrames, voice->audio->updateSize);
+	voice->fadeVolume += (voice->fadeTarget - voice->fadeVolume) * (
+		(float) step / (float) voice->fadeFrames
+	);
+	voice->fadeFrames -= step;
+	if (voice->fadeFrames == 0)
+	{
+		voice->fadeVolume = voice->fadeTarget;
+	}
+
+	/* Source voices carry the volume in their mix matrices */
+	if (voice->type == FAUDIO_VOICE_SOURCE)
+	{
+		for (i = 0; i < voice->sends.SendCount; i += 1)
+		{
+			FAudio_INTERNAL_RecalcMixMatrix(voice, i);
+		}
+		voice->volumeRamp = 1;
+	}
+}
+
+/* Submix/master volume, ramped from wherever the last quantum ended */
+static void FAudio_INTERNAL_AmplifyVoice(
+	FAudioVoice *voice,
+	float *buffer,
+	uint32_t frames,
+	uint32_t channels,
+	FAPOBufferFlags flags
+) {
+	float volume;
+
+	FAudio_PlatformLockMutex(voice->volumeLock);
+	LOG_MUTEX_LOCK(voice->audio, voice->volumeLock)
+
+	FAudio_INTERNAL_UpdateVolumeFade(voice);
+	volume = voice->volume * voice->fadeVolume;
+
+	if (flags != FAPO_BUFFER_SILENT)
+	{
+		if (volume != voice->rampVolume)
+		{
+			FAudio_INTERNAL_AmplifyRamp(
+				buffer,
+				frames,
+				channels,
+				voice->rampVolume,
+				volume
+			);
+		}
+		else if (volume != 1.0f)
+		{
+			FAudio_INTERNAL_Amplify(
+				buffer,
+				frames * channels,
+				volume
+			);
+		}
+	}
+
+	/* Silence has nothing to ramp, so just jump there */
+	voice->rampVolume = volume;
+
+	FAudio_PlatformUnlockMutex(voice->volumeLock);
+	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
+}
+
 static void FAudio_INTERNAL_MixSource(FAudioSourceVoice *voice)
 {
 	/* Iterators */
@@ -765,9 +1074,11 @@ static void FAudio_INTERNAL_MixSource(FAudioSourceVoice *voice)
 	uint32_t mixed;
 	uint32_t oChan;
 	FAudioVoice *out;
+	FAPOBufferFlags *outFlags;
 	uint32_t outputRate;
 	double stepd;
 	float *finalSamples;
+	FAPOBufferFlags flags;
 
 	LOG_FUNC_ENTER(voice->audio)
 
@@ -805,6 +1116,7 @@ static void FAudio_INTERNAL_MixSource(FAudioSourceVoice *voice)
 			mixed * voice->src.format->nChannels * sizeof(float)
 		);
 		finalSamples = voice->audio->resampleCache;
+		flags = FAPO_BUFFER_SILENT;
 		goto sendwork;
 	}
 
@@ -859,6 +1171,7 @@ static void FAudio_INTERNAL_MixSource(FAudioSourceVoice *voice)
 				mixed * voice->src.format->nChannels * sizeof(float)
 			);
 			finalSamples = voice->audio->resampleCache;
+			flags = FAPO_BUFFER_SILENT;
 			goto sendwork;
 		}
 
@@ -996,6 +1309,7 @@ static void FAudio_INTERNAL_MixSource(FAudioSourceVoice *voice)
 	FAudio_PlatformUnlockMutex(voice->src.bufferLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->src.bufferLock)
 	mixed = (uint32_t) toResample;
+	flags = FAPO_BUFFER_VALID;
 
 sendwork:
 
@@ -1014,6 +1328,14 @@ sendwork:
 		);
 		FAudio_PlatformUnlockMutex(voice->filterLock);
 		LOG_MUTEX_UNLOCK(voice->audio, voice->filterLock)
+
+		if (flags == FAPO_BUFFER_SILENT)
+		{
+			flags = FAudio_INTERNAL_GetBufferFlags(
+				finalSamples,
+				mixed * voice->src.format->nChannels
+			);
+		}
 	}
 
 	/* Process effect chain */
@@ -1035,8 +1357,11 @@ sendwork:
 		finalSamples = FAudio_INTERNAL_ProcessEffectChain(
 			voice,
 			finalSamples,
-			&mixed
+			NULL,
+			&mixed,
+			flags
 		);
+		flags = voice->effects.state;
 	}
 	FAudio_PlatformUnlockMutex(voice->effectLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->effectLock)
@@ -1053,6 +1378,12 @@ sendwork:
 	/* Send float cache to sends */
 	FAudio_PlatformLockMutex(voice->volumeLock);
 	LOG_MUTEX_LOCK(voice->audio, voice->volumeLock)
+	if (voice->volumeSnap)
+	{
+		FAudio_INTERNAL_FinishVolumeRamp(voice);
+		voice->volumeSnap = 0;
+	}
+	FAudio_INTERNAL_UpdateVolumeFade(voice);
 	for (i = 0; i < voice->sends.SendCount; i += 1)
 	{
 		out = voice->sends.pSends[i].pOutputVoice;
@@ -1060,21 +1391,41 @@ sendwork:
 		{
 			stream = out->master.output;
 			oChan = out->master.inputChannels;
+			outFlags = &out->master.inputFlags;
 		}
 		else
 		{
 			stream = out->mix.inputCache;
 			oChan = out->mix.inputChannels;
+			outFlags = &out->mix.inputFlags;
 		}
 
-		voice->sendMix[i](
-			mixed,
-			voice->outputChannels,
-			oChan,
-			finalSamples,
-			stream,
-			voice->mixCoefficients[i]
-		);
+		/* Mixing in silence wouldn't change anything */
+		if (flags != FAPO_BUFFER_SILENT && voice->volumeRamp)
+		{
+			FAudio_INTERNAL_MixRamp(
+				mixed,
+				voice->outputChannels,
+				oChan,
+				finalSamples,
+				stream,
+				voice->rampCoefficients[i],
+				voice->mixCoefficients[i]
+			);
+			*outFlags = FAPO_BUFFER_VALID;
+		}
+		else if (flags != FAPO_BUFFER_SILENT)
+		{
+			voice->sendMix[i](
+				mixed,
+				voice->outputChannels,
+				oChan,
+				finalSamples,
+				stream,
+				voice->mixCoefficients[i]
+			);
+			*outFlags = FAPO_BUFFER_VALID;
+		}
 
 		if (voice->sends.pSends[i].Flags & FAUDIO_SEND_USEFILTER)
 		{
@@ -1086,8 +1437,10 @@ sendwork:
 				mixed,
 				oChan
 			);
+			*outFlags = FAPO_BUFFER_VALID;
 		}
 	}
+	FAudio_INTERNAL_FinishVolumeRamp(voice);
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
 
@@ -1102,14 +1455,20 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 	float *stream;
 	uint32_t oChan;
 	FAudioVoice *out;
+	FAPOBufferFlags *outFlags;
+	FAPOBufferFlags flags;
 	uint32_t resampled;
 	uint64_t resampleOffset = 0;
 	float *finalSamples;
+	uint8_t cacheWritten = 0;
 
 	LOG_FUNC_ENTER(voice->audio)
 	FAudio_PlatformLockMutex(voice->sendLock);
 	LOG_MUTEX_LOCK(voice->audio, voice->sendLock)
 
+	/* Senders mark the input as valid when they write to it */
+	flags = voice->mix.inputFlags;
+
 	/* Resample */
 	if (voice->mix.resampleStep == FIXED_ONE)
 	{
@@ -1132,18 +1491,16 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 		);
 		finalSamples = voice->audio->resampleCache;
 	}
-	resampled = voice->mix.outputSamples * voice->mix.inputChannels;
+	resampled = voice->mix.outputSamples;
 
 	/* Submix overall volume is applied _before_ effects/filters, blech! */
-	if (voice->volume != 1.0f)
-	{
-		FAudio_INTERNAL_Amplify(
-			finalSamples,
-			resampled,
-			voice->volume
-		);
-	}
-	resampled /= voice->mix.inputChannels;
+	FAudio_INTERNAL_AmplifyVoice(
+		voice,
+		finalSamples,
+		resampled,
+		voice->mix.inputChannels,
+		flags
+	);
 
 	/* Filters */
 	if (voice->flags & FAUDIO_VOICE_USEFILTER)
@@ -1160,6 +1517,15 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 		);
 		FAudio_PlatformUnlockMutex(voice->filterLock);
 		LOG_MUTEX_UNLOCK(voice->audio, voice->filterLock)
+		cacheWritten |= (finalSamples == voice->mix.inputCache);
+
+		if (flags == FAPO_BUFFER_SILENT)
+		{
+			flags = FAudio_INTERNAL_GetBufferFlags(
+				finalSamples,
+				resampled * voice->mix.inputChannels
+			);
+		}
 	}
 
 	/* Process effect chain */
@@ -1167,11 +1533,16 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 	LOG_MUTEX_LOCK(voice->audio, voice->effectLock)
 	if (voice->effects.count > 0)
 	{
+		/* In-place effects may write to the input, even on silence */
+		cacheWritten |= (finalSamples == voice->mix.inputCache);
 		finalSamples = FAudio_INTERNAL_ProcessEffectChain(
 			voice,
 			finalSamples,
-			&resampled
+			NULL,
+			&resampled,
+			flags
 		);
+		flags = voice->effects.state;
 	}
 	FAudio_PlatformUnlockMutex(voice->effectLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->effectLock)
@@ -1192,21 +1563,41 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 		{
 			stream = out->master.output;
 			oChan = out->master.inputChannels;
+			outFlags = &out->master.inputFlags;
 		}
 		else
 		{
 			stream = out->mix.inputCache;
 			oChan = out->mix.inputChannels;
+			outFlags = &out->mix.inputFlags;
 		}
 
-		voice->sendMix[i](
-			resampled,
-			voice->outputChannels,
-			oChan,
-			finalSamples,
-			stream,
-			voice->mixCoefficients[i]
-		);
+		/* Mixing in silence wouldn't change anything */
+		if (flags != FAPO_BUFFER_SILENT && voice->volumeRamp)
+		{
+			FAudio_INTERNAL_MixRamp(
+				resampled,
+				voice->outputChannels,
+				oChan,
+				finalSamples,
+				stream,
+				voice->rampCoefficients[i],
+				voice->mixCoefficients[i]
+			);
+			*outFlags = FAPO_BUFFER_VALID;
+		}
+		else if (flags != FAPO_BUFFER_SILENT)
+		{
+			voice->sendMix[i](
+				resampled,
+				voice->outputChannels,
+				oChan,
+				finalSamples,
+				stream,
+				voice->mixCoefficients[i]
+			);
+			*outFlags = FAPO_BUFFER_VALID;
+		}
 
 		if (voice->sends.pSends[i].Flags & FAUDIO_SEND_USEFILTER)
 		{
@@ -1218,19 +1609,28 @@ static void FAudio_INTERNAL_MixSubmix(FAudioSubmixVoice *voice)
 				resampled,
 				oChan
 			);
+			*outFlags = FAPO_BUFFER_VALID;
 		}
 	}
+	FAudio_INTERNAL_FinishVolumeRamp(voice);
 	FAudio_PlatformUnlockMutex(voice->volumeLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->volumeLock)
 
-	/* Zero this at the end, for the next update */
+	/* Zero this at the end, for the next update, unless it's still zeroed.
+	 * A filter or effect that ran on it counts as a write, even when the
+	 * senders left it silent.
+	 */
 end:
 	FAudio_PlatformUnlockMutex(voice->sendLock);
 	LOG_MUTEX_UNLOCK(voice->audio, voice->sendLock)
-	FAudio_zero(
-		voice->mix.inputCache,
-		sizeof(float) * voice->mix.inputSamples
-	);
+	if (voice->mix.inputFlags != FAPO_BUFFER_SILENT || cacheWritten)
+	{
+		FAudio_zero(
+			voice->mix.inputCache,
+			sizeof(float) * voice->mix.inputSamples
+		);
+		voice->mix.inputFlags = FAPO_BUFFER_SILENT;
+	}
 	LOG_FUNC_EXIT(voice->audio)
 }
 
@@ -1321,6 +1721,7 @@ static void FAUDIOCALL FAudio_INTERNAL_GenerateOutput(FAudio *audio, float *outp
 	{
 		audio->master->master.output = output;
 	}
+	audio->master->master.inputFlags = FAPO_BUFFER_SILENT;
 
 	/* Mix sources */
 	FAudio_PlatformLockMutex(audio->sourceLock);
@@ -1356,14 +1757,13 @@ static void FAUDIOCALL FAudio_INTERNAL_GenerateOutput(FAudio *audio, float *outp
 	LOG_MUTEX_UNLOCK(audio, audio->submixLock)
 
 	/* Apply master volume */
-	if (audio->master->volume != 1.0f)
-	{
-		FAudio_INTERNAL_Amplify(
-			audio->master->master.output,
-			audio->updateSize * audio->master->master.inputChannels,
-			audio->master->volume
-		);
-	}
+	FAudio_INTERNAL_AmplifyVoice(
+		audio->master,
+		audio->master->master.output,
+		audio->updateSize,
+		audio->master->master.inputChannels,
+		audio->master->master.inputFlags
+	);
 
 	/* Process master effect chain */
 	FAudio_PlatformLockMutex(audio->master->effectLock);
@@ -1374,7 +1774,9 @@ static void FAUDIOCALL FAudio_INTERNAL_GenerateOutput(FAudio *audio, float *outp
 		effectOut = FAudio_INTERNAL_ProcessEffectChain(
 			audio->master,
 			audio->master->master.output,
-			&totalSamples
+			output,
+			&totalSamples,
+			audio->master->master.inputFlags
 		);
 
 		if (effectOut != output)
@@ -1389,7 +1791,7 @@ static void FAUDIOCALL FAudio_INTERNAL_GenerateOutput(FAudio *audio, float *outp
 		{
 			FAudio_zero(
 				output + (totalSamples * audio->master->outputChannels),
-				(audio->updateSize - totalSamples) * sizeof(float)
+				(audio->updateSize - totalSamples) * audio->master->outputChannels * sizeof(float)
 			);
 		}
 	}
@@ -1492,9 +1894,16 @@ void FAudio_INTERNAL_AllocEffectChain(
 		);
 	ALLOC_EFFECT_PROPERTY(parameters, void*)
 	ALLOC_EFFECT_PROPERTY(parameterSizes, uint32_t)
-	ALLOC_EFFECT_PROPERTY(parameterUpdates, uint8_t)
+	ALLOC_EFFECT_PROPERTY(parameterStates, int32_t)
 	ALLOC_EFFECT_PROPERTY(inPlaceProcessing, uint8_t)
+	ALLOC_EFFECT_PROPERTY(overwritesOutput, uint8_t)
+	ALLOC_EFFECT_PROPERTY(silenceStaysSilent, uint8_t)
+	ALLOC_EFFECT_PROPERTY(tailEnded, uint8_t)
 	#undef ALLOC_EFFECT_PROPERTY
+	for (i = 0; i < voice->effects.count; i += 1)
+	{
+		voice->effects.parameterStates[i] = FAUDIO_TRIPLEBUFFER_INIT;
+	}
 	LOG_FUNC_EXIT(voice->audio)
 }
 
@@ -1513,13 +1922,20 @@ void FAudio_INTERNAL_FreeEffectChain(FAudioVoice *voice)
 	{
 		voice->effects.desc[i].pEffect->UnlockForProcess(voice->effects.desc[i].pEffect);
 		voice->effects.desc[i].pEffect->Release(voice->effects.desc[i].pEffect);
+		if (voice->effects.parameters[i] != NULL)
+		{
+			voice->audio->pFree(voice->effects.parameters[i]);
+		}
 	}
 
 	voice->audio->pFree(voice->effects.desc);
 	voice->audio->pFree(voice->effects.parameters);
 	voice->audio->pFree(voice->effects.parameterSizes);
-	voice->audio->pFree(voice->effects.parameterUpdates);
+	voice->audio->pFree(voice->effects.parameterStates);
 	voice->audio->pFree(voice->effects.inPlaceProcessing);
+	voice->audio->pFree(voice->effects.overwritesOutput);
+	voice->audio->pFree(voice->effects.silenceStaysSilent);
+	voice->audio->pFree(voice->effects.tailEnded);
 	LOG_FUNC_EXIT(voice->audio)
 }
 
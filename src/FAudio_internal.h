@@ -210,10 +210,56 @@ extern void FAudio_Log(char const *msg);
 #define restrict
 #endif
 
+/* SSE/NEON Detection, for the mixer and the effects alike.
+ * This comes from MojoAL:
+ * https://hg.icculus.org/icculus/mojoAL/file/default/mojoal.c
+ */
+
+#if defined(__x86_64__) || defined(_M_X64)
+	/* Some platforms fail to define this... */
+	#ifndef __SSE2__
+	#define __SSE2__ 1
+	#endif
+
+	/* x86_64 guarantees SSE2. */
+	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	/* Some platforms fail to define this... */
+	#ifndef __ARM_NEON__
+	#define __ARM_NEON__ 1
+	#endif
+
+	/* AArch64 guarantees NEON. */
+	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
+#elif __MACOSX__
+	/* Some build systems may need to specify this. */
+	#if !defined(__SSE2__) && !defined(__ARM_NEON__)
+	#error macOS does not have SSE2/NEON? Bad compiler?
+	#endif
+
+	/* Mac OS X/Intel guarantees SSE2. */
+	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
+#else
+	/* Need plain C implementations to support all other hardware */
+	#define NEED_SCALAR_CONVERTER_FALLBACKS 1
+#endif
+
+/* Our NEON paths require AArch64, don't check __ARM_NEON__ here */
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HAVE_NEON_INTRINSICS 1
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
 /* Threading Types */
 
 typedef void* FAudioThread;
 typedef void* FAudioMutex;
+typedef void* FAudioSemaphore;
 typedef int32_t (FAUDIOCALL * FAudioThreadFunc)(void* data);
 typedef enum FAudioThreadPriority
 {
@@ -370,6 +416,12 @@ void FAudio_OPERATIONSET_QueueSetFrequencyRatio(
 	float Ratio,
 	uint32_t OperationSet
 );
+void FAudio_OPERATIONSET_QueueSetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float Volume,
+	uint32_t FadeMilliseconds,
+	uint32_t OperationSet
+);
 
 /* Public FAudio Types */
 
@@ -403,7 +455,7 @@ struct FAudio
 	uint32_t effectChainSamples;
 	float *decodeCache;
 	float *resampleCache;
-	float *effectChainCache;
+	float *effectChainCache[2];
 
 	/* Allocator callbacks */
 	FAudioMallocFunc pMalloc;
@@ -442,8 +494,11 @@ struct FAudioVoice
 		FAudioEffectDescriptor *desc;
 		void **parameters;
 		uint32_t *parameterSizes;
-		uint8_t *parameterUpdates;
+		int32_t *parameterStates; /* Triple buffer of parameters */
 		uint8_t *inPlaceProcessing;
+		uint8_t *overwritesOutput;
+		uint8_t *silenceStaysSilent;
+		uint8_t *tailEnded;
 	} effects;
 	FAudioFilterParameters filter;
 	FAudioFilterState *filterState;
@@ -456,6 +511,20 @@ struct FAudioVoice
 	uint32_t outputChannels;
 	FAudioMutex volumeLock;
 
+	/* Volume changes ramp across the next quantum instead of stepping.
+	 * rampCoefficients and rampVolume hold what the last quantum ended on,
+	 * volumeRamp is set when mixCoefficients has moved away from them.
+	 */
+	float **rampCoefficients;
+	float rampVolume;
+	uint8_t volumeRamp;
+	uint8_t volumeSnap; /* Just started, there's nothing to ramp from */
+
+	/* FadeVolumeEXT, counted in master frames */
+	float fadeVolume;
+	float fadeTarget;
+	uint32_t fadeFrames;
+
 	FAUDIONAMELESS union
 	{
 		struct
@@ -505,6 +574,9 @@ struct FAudioVoice
 			uint32_t inputChannels;
 			uint32_t inputSampleRate;
 			uint32_t processingStage;
+
+			/* Set by senders that wrote to inputCache */
+			FAPOBufferFlags inputFlags;
 		} mix;
 		struct
 		{
@@ -517,6 +589,9 @@ struct FAudioVoice
 			/* Read-only */
 			uint32_t inputChannels;
 			uint32_t inputSampleRate;
+
+			/* Set by senders that wrote to output */
+			FAPOBufferFlags inputFlags;
 		} master;
 	};
 };
@@ -539,8 +614,21 @@ uint32_t FAudio_INTERNAL_VoiceOutputFrequency(
 	FAudioVoice *voice,
 	const FAudioVoiceSends *pSendList
 );
+void FAudio_INTERNAL_RecalcMixMatrix(FAudioVoice *voice, uint32_t sendIndex);
+void FAudio_INTERNAL_FinishVolumeRamp(FAudioVoice *voice);
 extern const float FAUDIO_INTERNAL_MATRIX_DEFAULTS[8][8][64];
 
+/* Lock-free triple buffer, used to hand parameter blocks to the mixer thread.
+ * A writer fills the slot from BeginWrite and publishes it with EndWrite; the
+ * reader picks up the newest published slot with Acquire. The reader never
+ * waits, and writers only wait for each other.
+ */
+#define FAUDIO_TRIPLEBUFFER_INIT 0x24 /* Reader 0, shared 1, writer 2 */
+uint32_t FAudio_INTERNAL_TripleBufferBeginWrite(volatile int32_t *state);
+void FAudio_INTERNAL_TripleBufferEndWrite(volatile int32_t *state);
+uint8_t FAudio_INTERNAL_TripleBufferAcquire(volatile int32_t *state);
+uint32_t FAudio_INTERNAL_TripleBufferReadSlot(volatile int32_t *state);
+
 /* Debug */
 
 #ifdef FAUDIO_DISABLE_DEBUGCONFIGURATION
@@ -654,9 +742,44 @@ void FAudio_INTERNAL_debug_fmt(
 CREATE_FAPOFX_FUNC(EQ)
 CREATE_FAPOFX_FUNC(MasteringLimiter)
 CREATE_FAPOFX_FUNC(Reverb)
+CREATE_FAPOFX_FUNC(ReverbLowCPU)
 CREATE_FAPOFX_FUNC(Echo)
 #undef CREATE_FAPOFX_FUNC
 
+/* FAudioFX Reverb Network, shared with FAPOFX.
+ * Only 1, 2 and 6 channels are supported, processed in place.
+ */
+
+struct DspReverb;
+struct FAudioFXReverbParameters;
+
+struct DspReverb* FAudio_INTERNAL_CreateReverbNetwork(
+	int32_t sampleRate,
+	int32_t channels,
+	uint8_t lowCPU,
+	FAudioMallocFunc pMalloc
+);
+void FAudio_INTERNAL_DestroyReverbNetwork(
+	struct DspReverb *reverb,
+	FAudioFreeFunc pFree
+);
+void FAudio_INTERNAL_SetReverbNetworkParameters(
+	struct DspReverb *reverb,
+	const struct FAudioFXReverbParameters *params
+);
+void FAudio_INTERNAL_ResetReverbNetwork(struct DspReverb *reverb);
+uint8_t FAudio_INTERNAL_UpdateReverbNetworkSilence(	/* 1 when silent */
+	struct DspReverb *reverb,
+	uint8_t inputSilent,
+	uint32_t frames,
+	float total
+);
+float FAudio_INTERNAL_ProcessReverbNetwork(	/* Returns the squared sum */
+	struct DspReverb *reverb,
+	float *buffer,
+	uint32_t frames
+);
+
 /* SIMD Stuff */
 
 /* Callbacks declared as functions (rather than function pointers) are
@@ -698,6 +821,27 @@ extern void (*FAudio_INTERNAL_Amplify)(
 
 extern FAudioMixCallback FAudio_INTERNAL_Mix_Generic;
 
+/* Ramped variants, for quanta where the volume changes. These go from the
+ * first value/matrix to the second across the buffer, reaching the second on
+ * the last frame.
+ */
+void FAudio_INTERNAL_AmplifyRamp(
+	float *output,
+	uint32_t toAmplify,
+	uint32_t channels,
+	float fromVolume,
+	float toVolume
+);
+void FAudio_INTERNAL_MixRamp(
+	uint32_t toMix,
+	uint32_t srcChans,
+	uint32_t dstChans,
+	float *restrict srcData,
+	float *restrict dstData,
+	float *restrict fromCoefficients,
+	float *restrict toCoefficients
+);
+
 #define MIX_FUNC(type) \
 	extern void FAudio_INTERNAL_Mix_##type##_Scalar( \
 		uint32_t toMix, \
@@ -718,6 +862,25 @@ MIX_FUNC(2in_6out)
 MIX_FUNC(2in_8out)
 #undef MIX_FUNC
 
+/* F3DAudio's SoA kernels are always available, no InitSIMDFunctions needed */
+void FAudio_INTERNAL_EmitterDistances(
+	const float *restrict posX,
+	const float *restrict posY,
+	const float *restrict posZ,
+	float listenerX,
+	float listenerY,
+	float listenerZ,
+	float *restrict toListenerX,
+	float *restrict toListenerY,
+	float *restrict toListenerZ,
+	float *restrict distance,
+	uint32_t count
+);
+
+/* Flush-to-zero for DSP blocks, always pair these on the same thread */
+uint64_t FAudio_INTERNAL_FlushDenormals(void);
+void FAudio_INTERNAL_RestoreDenormals(uint64_t state);
+
 void FAudio_INTERNAL_InitSIMDFunctions(uint8_t hasSSE2, uint8_t hasNEON);
 
 /* Decoders */
@@ -777,12 +940,37 @@ FAudioThread FAudio_PlatformCreateThread(
 void FAudio_PlatformWaitThread(FAudioThread thread, int32_t *retval);
 void FAudio_PlatformThreadPriority(FAudioThreadPriority priority);
 uint64_t FAudio_PlatformGetThreadID(void);
+uint32_t FAudio_PlatformGetCPUCount(void);
 FAudioMutex FAudio_PlatformCreateMutex(void);
 void FAudio_PlatformDestroyMutex(FAudioMutex mutex);
 void FAudio_PlatformLockMutex(FAudioMutex mutex);
 void FAudio_PlatformUnlockMutex(FAudioMutex mutex);
+FAudioSemaphore FAudio_PlatformCreateSemaphore(uint32_t initialValue);
+void FAudio_PlatformDestroySemaphore(FAudioSemaphore sem);
+void FAudio_PlatformPostSemaphore(FAudioSemaphore sem);
+/* Returns 1 if the semaphore was taken, 0 on timeout */
+uint8_t FAudio_PlatformWaitSemaphore(FAudioSemaphore sem, uint32_t timeoutMS);
+#define FAUDIO_WAIT_INFINITE 0xFFFFFFFF
 void FAudio_sleep(uint32_t ms);
 
+/* Atomics */
+
+/* Returns 1 if *ptr was oldValue and has been set to newValue */
+uint8_t FAudio_PlatformAtomicCAS(
+	volatile int32_t *ptr,
+	int32_t oldValue,
+	int32_t newValue
+);
+int32_t FAudio_PlatformAtomicGet(volatile int32_t *ptr);
+void FAudio_PlatformAtomicSet(volatile int32_t *ptr, int32_t value);
+
+/* Pollable Events (-1 when the platform has none) */
+
+int32_t FAudio_PlatformCreateEventFD(void);
+void FAudio_PlatformDestroyEventFD(int32_t fd);
+void FAudio_PlatformSignalEventFD(int32_t fd);
+void FAudio_PlatformClearEventFD(int32_t fd);
+
 /* Time */
 
 uint32_t FAudio_timems(void);
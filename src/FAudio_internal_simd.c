@@ -26,53 +26,6 @@
 
 #include "FAudio_internal.h"
 
-/* SECTION 0: SSE/NEON Detection */
-
-/* The SSE/NEON detection comes from MojoAL:
- * https://hg.icculus.org/icculus/mojoAL/file/default/mojoal.c
- */
-
-#if defined(__x86_64__) || defined(_M_X64)
-	/* Some platforms fail to define this... */
-	#ifndef __SSE2__
-	#define __SSE2__ 1
-	#endif
-
-	/* x86_64 guarantees SSE2. */
-	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
-#elif defined(__aarch64__) || defined(_M_ARM64)
-	/* Some platforms fail to define this... */
-	#ifndef __ARM_NEON__
-	#define __ARM_NEON__ 1
-	#endif
-
-	/* AArch64 guarantees NEON. */
-	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
-#elif __MACOSX__
-	/* Some build systems may need to specify this. */
-	#if !defined(__SSE2__) && !defined(__ARM_NEON__)
-	#error macOS does not have SSE2/NEON? Bad compiler?
-	#endif
-
-	/* Mac OS X/Intel guarantees SSE2. */
-	#define NEED_SCALAR_CONVERTER_FALLBACKS 0
-#else
-	/* Need plain C implementations to support all other hardware */
-	#define NEED_SCALAR_CONVERTER_FALLBACKS 1
-#endif
-
-/* Our NEON paths require AArch64, don't check __ARM_NEON__ here */
-#if defined(__aarch64__) || defined(_M_ARM64)
-#include <arm_neon.h>
-#define HAVE_NEON_INTRINSICS 1
-#endif
-
-
-#ifdef __SSE2__
-#include <emmintrin.h>
-#define HAVE_SSE2_INTRINSICS 1
-#endif
-
 /* SECTION 1: Type Converters */
 
 /* The SSE/NEON converters are based on SDL_audiotypecvt:
@@ -1276,6 +1229,29 @@ void FAudio_INTERNAL_Amplify_NEON(
 }
 #endif /* HAVE_NEON_INTRINSICS */
 
+/* Only used on quanta where the volume changes, so no SIMD versions */
+void FAudio_INTERNAL_AmplifyRamp(
+	float *output,
+	uint32_t toAmplify,
+	uint32_t channels,
+	float fromVolume,
+	float toVolume
+) {
+	uint32_t i, c;
+	float volume;
+	for (i = 0; i < toAmplify; i += 1, output += channels)
+	{
+		volume = fromVolume + (
+			(toVolume - fromVolume) *
+			((float) (i + 1) / (float) toAmplify)
+		);
+		for (c = 0; c < channels; c += 1)
+		{
+			output[c] *= volume;
+		}
+	}
+}
+
 /* SECTION 4: Mixer Functions */
 
 void FAudio_INTERNAL_Mix_Generic_Scalar(
@@ -1543,7 +1519,141 @@ void FAudio_INTERNAL_Mix_2in_8out_Scalar(
 	}
 }
 
-/* SECTION 5: InitSIMDFunctions. Assigns based on SSE2/NEON support. */
+void FAudio_INTERNAL_MixRamp(
+	uint32_t toMix,
+	uint32_t srcChans,
+	uint32_t dstChans,
+	float *restrict src,
+	float *restrict dst,
+	float *restrict from,
+	float *restrict to
+) {
+	uint32_t i, co, ci, c;
+	float t;
+	for (i = 0; i < toMix; i += 1, src += srcChans, dst += dstChans)
+	{
+		/* Lands exactly on the new matrix for the last frame */
+		t = (float) (i + 1) / (float) toMix;
+		for (co = 0; co < dstChans; co += 1)
+		{
+			for (ci = 0; ci < srcChans; ci += 1)
+			{
+				c = co * srcChans + ci;
+				dst[co] += src[ci] * (from[c] + ((to[c] - from[c]) * t));
+			}
+		}
+	}
+}
+
+/* SECTION 5: F3DAudio Kernels */
+
+/* F3DAudio can be used without ever creating an FAudio instance, so these are
+ * picked at compile time instead of going through InitSIMDFunctions.
+ */
+
+void FAudio_INTERNAL_EmitterDistances(
+	const float *restrict posX,
+	const float *restrict posY,
+	const float *restrict posZ,
+	float listenerX,
+	float listenerY,
+	float listenerZ,
+	float *restrict toListenerX,
+	float *restrict toListenerY,
+	float *restrict toListenerZ,
+	float *restrict distance,
+	uint32_t count
+) {
+	uint32_t i = 0;
+
+#if HAVE_SSE2_INTRINSICS
+	const __m128 lx = _mm_set1_ps(listenerX);
+	const __m128 ly = _mm_set1_ps(listenerY);
+	const __m128 lz = _mm_set1_ps(listenerZ);
+	__m128 x, y, z;
+	for (; i + 4 <= count; i += 4)
+	{
+		x = _mm_sub_ps(lx, _mm_loadu_ps(posX + i));
+		y = _mm_sub_ps(ly, _mm_loadu_ps(posY + i));
+		z = _mm_sub_ps(lz, _mm_loadu_ps(posZ + i));
+		_mm_storeu_ps(toListenerX + i, x);
+		_mm_storeu_ps(toListenerY + i, y);
+		_mm_storeu_ps(toListenerZ + i, z);
+		_mm_storeu_ps(distance + i, _mm_sqrt_ps(_mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+			_mm_mul_ps(z, z)
+		)));
+	}
+#elif HAVE_NEON_INTRINSICS
+	const float32x4_t lx = vdupq_n_f32(listenerX);
+	const float32x4_t ly = vdupq_n_f32(listenerY);
+	const float32x4_t lz = vdupq_n_f32(listenerZ);
+	float32x4_t x, y, z;
+	for (; i + 4 <= count; i += 4)
+	{
+		x = vsubq_f32(lx, vld1q_f32(posX + i));
+		y = vsubq_f32(ly, vld1q_f32(posY + i));
+		z = vsubq_f32(lz, vld1q_f32(posZ + i));
+		vst1q_f32(toListenerX + i, x);
+		vst1q_f32(toListenerY + i, y);
+		vst1q_f32(toListenerZ + i, z);
+		vst1q_f32(distance + i, vsqrtq_f32(vaddq_f32(
+			vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)),
+			vmulq_f32(z, z)
+		)));
+	}
+#endif
+
+	/* Scalar fallback, also picks up the tail of the SIMD paths */
+	for (; i < count; i += 1)
+	{
+		toListenerX[i] = listenerX - posX[i];
+		toListenerY[i] = listenerY - posY[i];
+		toListenerZ[i] = listenerZ - posZ[i];
+		distance[i] = FAudio_sqrtf(
+			(toListenerX[i] * toListenerX[i]) +
+			(toListenerY[i] * toListenerY[i]) +
+			(toListenerZ[i] * toListenerZ[i])
+		);
+	}
+}
+
+/* SECTION 6: Denormal Control */
+
+/* Feedback filters decay into denormals once their input goes quiet, and
+ * denormal math is very slow on most CPUs. Rather than checking every sample,
+ * DSP code can turn on flush-to-zero/denormals-are-zero for a whole block.
+ * This is per-thread state, so always restore it before returning to the
+ * caller!
+ */
+
+uint64_t FAudio_INTERNAL_FlushDenormals(void)
+{
+#if HAVE_SSE2_INTRINSICS
+	const uint32_t csr = _mm_getcsr();
+	_mm_setcsr(csr | 0x8040); /* FTZ | DAZ */
+	return csr;
+#elif HAVE_NEON_INTRINSICS && (defined(__GNUC__) || defined(__clang__))
+	uint64_t fpcr;
+	__asm__ __volatile__ ("mrs %0, fpcr" : "=r" (fpcr));
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (fpcr | (1 << 24))); /* FZ */
+	return fpcr;
+#else
+	/* No portable way to do this, denormals will just be slow */
+	return 0;
+#endif
+}
+
+void FAudio_INTERNAL_RestoreDenormals(uint64_t state)
+{
+#if HAVE_SSE2_INTRINSICS
+	_mm_setcsr((uint32_t) state);
+#elif HAVE_NEON_INTRINSICS && (defined(__GNUC__) || defined(__clang__))
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (state));
+#endif
+}
+
+/* SECTION 7: InitSIMDFunctions. Assigns based on SSE2/NEON support. */
 
 void (*FAudio_INTERNAL_Convert_U8_To_F32)(
 	const uint8_t *restrict src,
@@ -43,7 +43,8 @@ typedef enum FAudio_OPERATIONSET_Type
 	FAUDIOOP_START,
 	FAUDIOOP_STOP,
 	FAUDIOOP_EXITLOOP,
-	FAUDIOOP_SETFREQUENCYRATIO
+	FAUDIOOP_SETFREQUENCYRATIO,
+	FAUDIOOP_SETFADEVOLUMEEXT
 } FAudio_OPERATIONSET_Type;
 
 struct FAudio_OPERATIONSET_Operation
@@ -110,6 +111,11 @@ struct FAudio_OPERATIONSET_Operation
 		{
 			float Ratio;
 		} SetFrequencyRatio;
+		struct
+		{
+			float Volume;
+			uint32_t FadeMilliseconds;
+		} SetFadeVolumeEXT;
 	} Data;
 
 	FAudio_OPERATIONSET_Operation *next;
@@ -244,6 +250,15 @@ static inline void ExecuteOperation(FAudio_OPERATIONSET_Operation *op)
 		);
 	break;
 
+	case FAUDIOOP_SETFADEVOLUMEEXT:
+		FAudioVoice_SetFadeVolumeEXT(
+			op->Voice,
+			op->Data.SetFadeVolumeEXT.Volume,
+			op->Data.SetFadeVolumeEXT.FadeMilliseconds,
+			FAUDIO_COMMIT_NOW
+		);
+	break;
+
 	default:
 		FAudio_assert(0 && "Unrecognized operation type!");
 	break;
@@ -697,6 +712,30 @@ void FAudio_OPERATIONSET_QueueSetFrequencyRatio(
 	LOG_MUTEX_UNLOCK(voice->audio, voice->audio->operationLock)
 }
 
+void FAudio_OPERATIONSET_QueueSetFadeVolumeEXT(
+	FAudioVoice *voice,
+	float Volume,
+	uint32_t FadeMilliseconds,
+	uint32_t OperationSet
+) {
+	FAudio_OPERATIONSET_Operation *op;
+
+	FAudio_PlatformLockMutex(voice->audio->operationLock);
+	LOG_MUTEX_LOCK(voice->audio, voice->audio->operationLock)
+
+	op = QueueOperation(
+		voice,
+		FAUDIOOP_SETFADEVOLUMEEXT,
+		OperationSet
+	);
+
+	op->Data.SetFadeVolumeEXT.Volume = Volume;
+	op->Data.SetFadeVolumeEXT.FadeMilliseconds = FadeMilliseconds;
+
+	FAudio_PlatformUnlockMutex(voice->audio->operationLock);
+	LOG_MUTEX_UNLOCK(voice->audio, voice->audio->operationLock)
+}
+
 /* Called when releasing the engine */
 
 void FAudio_OPERATIONSET_ClearAll(FAudio *audio)
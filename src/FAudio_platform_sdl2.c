@@ -34,6 +34,11 @@
 #include <cubeb/cubeb.h>
 #endif
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
 #if !SDL_VERSION_ATLEAST(2, 24, 0)
 #error "SDL version older than 2.24.0"
 #endif /* !SDL_VERSION_ATLEAST */
@@ -728,6 +733,11 @@ uint64_t FAudio_PlatformGetThreadID(void)
 	return (uint64_t) SDL_ThreadID();
 }
 
+uint32_t FAudio_PlatformGetCPUCount(void)
+{
+	return (uint32_t) SDL_GetCPUCount();
+}
+
 FAudioMutex FAudio_PlatformCreateMutex()
 {
 	return (FAudioMutex) SDL_CreateMutex();
@@ -748,11 +758,98 @@ void FAudio_PlatformUnlockMutex(FAudioMutex mutex)
 	SDL_UnlockMutex((SDL_mutex*) mutex);
 }
 
+FAudioSemaphore FAudio_PlatformCreateSemaphore(uint32_t initialValue)
+{
+	return (FAudioSemaphore) SDL_CreateSemaphore(initialValue);
+}
+
+void FAudio_PlatformDestroySemaphore(FAudioSemaphore sem)
+{
+	SDL_DestroySemaphore((SDL_sem*) sem);
+}
+
+void FAudio_PlatformPostSemaphore(FAudioSemaphore sem)
+{
+	SDL_SemPost((SDL_sem*) sem);
+}
+
+uint8_t FAudio_PlatformWaitSemaphore(FAudioSemaphore sem, uint32_t timeoutMS)
+{
+	if (timeoutMS == FAUDIO_WAIT_INFINITE)
+	{
+		return SDL_SemWait((SDL_sem*) sem) == 0;
+	}
+	return SDL_SemWaitTimeout((SDL_sem*) sem, timeoutMS) == 0;
+}
+
 void FAudio_sleep(uint32_t ms)
 {
 	SDL_Delay(ms);
 }
 
+/* Atomics */
+
+uint8_t FAudio_PlatformAtomicCAS(
+	volatile int32_t *ptr,
+	int32_t oldValue,
+	int32_t newValue
+) {
+	return SDL_AtomicCAS((SDL_atomic_t*) ptr, oldValue, newValue);
+}
+
+int32_t FAudio_PlatformAtomicGet(volatile int32_t *ptr)
+{
+	return SDL_AtomicGet((SDL_atomic_t*) ptr);
+}
+
+void FAudio_PlatformAtomicSet(volatile int32_t *ptr, int32_t value)
+{
+	SDL_AtomicSet((SDL_atomic_t*) ptr, value);
+}
+
+/* Pollable Events */
+
+int32_t FAudio_PlatformCreateEventFD(void)
+{
+#ifdef __linux__
+	return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+	return -1;
+#endif
+}
+
+void FAudio_PlatformDestroyEventFD(int32_t fd)
+{
+#ifdef __linux__
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+#endif
+}
+
+void FAudio_PlatformSignalEventFD(int32_t fd)
+{
+#ifdef __linux__
+	if (fd >= 0)
+	{
+		eventfd_write(fd, 1);
+	}
+#endif
+}
+
+void FAudio_PlatformClearEventFD(int32_t fd)
+{
+#ifdef __linux__
+	eventfd_t value;
+	if (fd >= 0)
+	{
+		/* Nonblocking, this just fails if nothing was signaled */
+		eventfd_read(fd, &value);
+	}
+#endif
+}
+
 /* Time */
 
 uint32_t FAudio_timems()
@@ -545,6 +545,75 @@ void FAudio_PlatformDestroyMutex(FAudioMutex mutex)
 	FAudio_free(mutex);
 }
 
+FAudioSemaphore FAudio_PlatformCreateSemaphore(uint32_t initialValue)
+{
+	return CreateSemaphoreExW(
+		NULL,
+		initialValue,
+		0x7FFFFFFF,
+		NULL,
+		0,
+		SEMAPHORE_ALL_ACCESS
+	);
+}
+
+void FAudio_PlatformDestroySemaphore(FAudioSemaphore sem)
+{
+	if (sem) CloseHandle(sem);
+}
+
+void FAudio_PlatformPostSemaphore(FAudioSemaphore sem)
+{
+	if (sem) ReleaseSemaphore(sem, 1, NULL);
+}
+
+uint8_t FAudio_PlatformWaitSemaphore(FAudioSemaphore sem, uint32_t timeoutMS)
+{
+	/* FAUDIO_WAIT_INFINITE == INFINITE */
+	return WaitForSingleObjectEx(sem, timeoutMS, FALSE) == WAIT_OBJECT_0;
+}
+
+uint8_t FAudio_PlatformAtomicCAS(
+	volatile int32_t *ptr,
+	int32_t oldValue,
+	int32_t newValue
+) {
+	return InterlockedCompareExchange(
+		(volatile LONG*) ptr,
+		newValue,
+		oldValue
+	) == oldValue;
+}
+
+int32_t FAudio_PlatformAtomicGet(volatile int32_t *ptr)
+{
+	return InterlockedCompareExchange((volatile LONG*) ptr, 0, 0);
+}
+
+void FAudio_PlatformAtomicSet(volatile int32_t *ptr, int32_t value)
+{
+	InterlockedExchange((volatile LONG*) ptr, value);
+}
+
+/* Pollable events are Linux-only for now */
+
+int32_t FAudio_PlatformCreateEventFD(void)
+{
+	return -1;
+}
+
+void FAudio_PlatformDestroyEventFD(int32_t fd)
+{
+}
+
+void FAudio_PlatformSignalEventFD(int32_t fd)
+{
+}
+
+void FAudio_PlatformClearEventFD(int32_t fd)
+{
+}
+
 struct FAudioThreadArgs
 {
 	FAudioThreadFunc func;
@@ -595,6 +664,13 @@ uint64_t FAudio_PlatformGetThreadID(void)
 	return GetCurrentThreadId();
 }
 
+uint32_t FAudio_PlatformGetCPUCount(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+}
+
 void FAudio_sleep(uint32_t ms)
 {
 	Sleep(ms);
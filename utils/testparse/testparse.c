@@ -27,6 +27,26 @@
 #include <FACT_internal.h> /* DO NOT INCLUDE THIS IN REAL CODE! */
 #include <SDL.h>
 
+/* Set by -c, writes a BinaryCacheEXT file next to each XGS/XSB */
+static const char *cachePath = NULL;
+
+static void write_cache(const char *path, void *buf, uint32_t len)
+{
+	SDL_RWops *out;
+	char name[1024];
+
+	SDL_snprintf(name, sizeof(name), "%s.cache", path);
+	out = SDL_RWFromFile(name, "wb");
+	if (out == NULL)
+	{
+		printf("%s could not be written!\n", name);
+		return;
+	}
+	SDL_RWwrite(out, buf, len, 1);
+	SDL_RWclose(out);
+	printf("Wrote %s (%u bytes)\n", name, len);
+}
+
 static void print_soundbank(FACTAudioEngine *engine, uint8_t *buf, size_t len)
 {
 	FACTSoundBank *sb;
@@ -39,6 +59,16 @@ static void print_soundbank(FACTAudioEngine *engine, uint8_t *buf, size_t len)
 		0,
 		&sb
 	);
+	if (cachePath != NULL)
+	{
+		uint32_t cacheLen;
+		void *cache;
+		FACTSoundBank_SerializeEXT(sb, NULL, &cacheLen);
+		cache = SDL_malloc(cacheLen);
+		FACTSoundBank_SerializeEXT(sb, cache, &cacheLen);
+		write_cache(cachePath, cache, cacheLen);
+		SDL_free(cache);
+	}
 	printf("SoundBank \"%s\"\n", sb->name);
 	printf("\tWaveBank Dependencies:\n");
 	for (i = 0; i < sb->wavebankCount; i += 1)
@@ -438,6 +468,15 @@ int main(int argc, char **argv)
 	uint8_t *buf;
 	size_t len;
 	uint32_t i, j;
+	uint8_t writeCache = 0;
+
+	/* -c writes out BinaryCacheEXT files for the XGS and each XSB */
+	if (argc > 1 && SDL_strcmp(argv[1], "-c") == 0)
+	{
+		writeCache = 1;
+		argc -= 1;
+		argv += 1;
+	}
 
 	/* We need an AudioEngine, SoundBank and WaveBank! */
 	if (argc < 2)
@@ -454,6 +493,17 @@ int main(int argc, char **argv)
 	FACTAudioEngine_Initialize(engine, &params);
 	SDL_free(buf);
 
+	if (writeCache)
+	{
+		uint32_t cacheLen;
+		void *cache;
+		FACTAudioEngine_SerializeEXT(engine, NULL, &cacheLen);
+		cache = SDL_malloc(cacheLen);
+		FACTAudioEngine_SerializeEXT(engine, cache, &cacheLen);
+		write_cache(argv[1], cache, cacheLen);
+		SDL_free(cache);
+	}
+
 	/* Print AudioEngine information */
 	printf("AudioEngine:\n");
 	for (i = 0; i < engine->categoryCount; i += 1)
@@ -556,8 +606,10 @@ int main(int argc, char **argv)
 		{
 			printf("%s invalid input!\n", argv[i]);
 		}
-		else if (*((uint32_t*) buf) == 0x4B424453)
+		else if (	*((uint32_t*) buf) == 0x4B424453 ||
+				*((uint32_t*) buf) == FACT_CACHE_MAGIC_SOUNDBANK	)
 		{
+			cachePath = writeCache ? argv[i] : NULL;
 			print_soundbank(engine, buf, len);
 		}
 		else if (*((uint32_t*) buf) == 0x444E4257)
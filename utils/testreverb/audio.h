@@ -100,4 +100,16 @@ extern PFN_AUDIO_WAVE_STOP audio_wave_stop;
 
 extern PFN_AUDIO_EFFECT_CHANGE audio_effect_change;
 
+// benchmark
+const size_t AUDIO_REVERB_BENCHMARK_MAX_RESULTS = 5;
+
+struct ReverbBenchmarkResult
+{
+	int in_channels;
+	int out_channels;
+	double ms_per_second;	// processing time per second of audio, < 0 on failure
+};
+
+size_t audio_reverb_benchmark(const ReverbParameters *params, ReverbBenchmarkResult *results);
+
 #endif // FAUDIOFILTERDEMO_AUDIO_H
@@ -0,0 +1,106 @@
+#include "audio.h"
+
+#include <FAudio.h>
+#include <FAudioFX.h>
+#include <FAPO.h>
+#include <SDL.h>
+
+// Runs FAudio's reverb FAPO directly, without any voices or an audio device,
+// so only the effect itself is timed. Each layout processes the same noise
+// burst followed by silence, so the tail is measured too.
+
+static const uint32_t BENCHMARK_SAMPLERATE = 48000;
+static const uint32_t BENCHMARK_QUANTUM = BENCHMARK_SAMPLERATE / 100;
+static const uint32_t BENCHMARK_SECONDS = 10;
+
+static const int benchmark_layouts[][2] =
+{
+	{1, 1},
+	{1, 6},
+	{2, 2},
+	{2, 6},
+	{6, 6}
+};
+
+static void benchmark_format(FAudioWaveFormatEx *format, int channels)
+{
+	format->wFormatTag = FAUDIO_FORMAT_IEEE_FLOAT;
+	format->nChannels = channels;
+	format->nSamplesPerSec = BENCHMARK_SAMPLERATE;
+	format->nAvgBytesPerSec = BENCHMARK_SAMPLERATE * channels * 4;
+	format->nBlockAlign = channels * 4;
+	format->wBitsPerSample = 32;
+	format->cbSize = 0;
+}
+
+static double benchmark_layout(const ReverbParameters *params, int in_channels, int out_channels)
+{
+	FAPO *fapo = NULL;
+	if (FAudioCreateReverb(&fapo, 0) != 0)
+	{
+		return -1.0;
+	}
+	fapo->SetParameters(fapo, params, sizeof(ReverbParameters));
+
+	FAudioWaveFormatEx in_format, out_format;
+	benchmark_format(&in_format, in_channels);
+	benchmark_format(&out_format, out_channels);
+
+	FAPOLockForProcessBufferParameters in_lock = {&in_format, BENCHMARK_QUANTUM};
+	FAPOLockForProcessBufferParameters out_lock = {&out_format, BENCHMARK_QUANTUM};
+	if (fapo->LockForProcess(fapo, 1, &in_lock, 1, &out_lock) != 0)
+	{
+		fapo->Release(fapo);
+		return -1.0;
+	}
+
+	float *input = new float[BENCHMARK_QUANTUM * in_channels];
+	float *output = new float[BENCHMARK_QUANTUM * out_channels];
+
+	FAPOProcessBufferParameters in_buffer = {input, FAPO_BUFFER_VALID, BENCHMARK_QUANTUM};
+	FAPOProcessBufferParameters out_buffer = {output, FAPO_BUFFER_VALID, BENCHMARK_QUANTUM};
+
+	uint32_t seed = 1;
+	uint64_t elapsed = 0;
+	uint32_t quantum_count = BENCHMARK_SECONDS * 100;
+
+	for (uint32_t q = 0; q < quantum_count; ++q)
+	{
+		// one second of noise, then let the tail ring out
+		for (uint32_t i = 0; i < BENCHMARK_QUANTUM * in_channels; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			input[i] = (q < 100) ? ((seed >> 8) / 16777216.0f) - 0.5f : 0.0f;
+		}
+
+		uint64_t start = SDL_GetPerformanceCounter();
+		fapo->Process(fapo, 1, &in_buffer, 1, &out_buffer, 1);
+		elapsed += SDL_GetPerformanceCounter() - start;
+	}
+
+	fapo->UnlockForProcess(fapo);
+	fapo->Release(fapo);
+	delete[] input;
+	delete[] output;
+
+	// milliseconds of processing per second of audio
+	return (elapsed * 1000.0) / SDL_GetPerformanceFrequency() / BENCHMARK_SECONDS;
+}
+
+size_t audio_reverb_benchmark(const ReverbParameters *params, ReverbBenchmarkResult *results)
+{
+	size_t count = sizeof(benchmark_layouts) / sizeof(benchmark_layouts[0]);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		results[i].in_channels = benchmark_layouts[i][0];
+		results[i].out_channels = benchmark_layouts[i][1];
+		results[i].ms_per_second = benchmark_layout(
+			params,
+			results[i].in_channels,
+			results[i].out_channels
+		);
+	}
+
+	return count;
+}
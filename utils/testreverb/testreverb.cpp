@@ -5,7 +5,7 @@
 
 const char* TOOL_NAME = "Reverb Test Tool";
 int TOOL_WIDTH = 640;
-int TOOL_HEIGHT = 850;
+int TOOL_HEIGHT = 990;
 
 int next_window_dims(int y_pos, int height)
 {
@@ -163,6 +163,38 @@ void FAudioTool_Update()
 
 	ImGui::End();
 
+	window_y = next_window_dims(window_y, 140);
+	ImGui::Begin("Benchmark");
+
+		static ReverbBenchmarkResult benchmark_results[AUDIO_REVERB_BENCHMARK_MAX_RESULTS];
+		static size_t benchmark_result_count = 0;
+
+		if (ImGui::Button("Run (FAudio, current settings)"))
+		{
+			benchmark_result_count = audio_reverb_benchmark(&reverb_params, benchmark_results);
+		}
+
+		for (size_t i = 0; i < benchmark_result_count; ++i)
+		{
+			const ReverbBenchmarkResult *result = &benchmark_results[i];
+			if (result->ms_per_second < 0.0)
+			{
+				ImGui::Text("%d -> %d: failed", result->in_channels, result->out_channels);
+			}
+			else
+			{
+				ImGui::Text(
+					"%d -> %d: %.2f ms per second of audio (%.0fx realtime)",
+					result->in_channels,
+					result->out_channels,
+					result->ms_per_second,
+					1000.0 / result->ms_per_second
+				);
+			}
+		}
+
+	ImGui::End();
+
 	// audio control
 	static AudioContext *player = NULL;
 